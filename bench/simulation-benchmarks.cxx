@@ -0,0 +1,359 @@
+// This file uses the Google Benchmark framework to measure the hot paths of the physics simulation.
+
+// Every benchmark sweeps the particle count over powers of ten and reports particles/s (and pair interactions/s where the number of pairs
+// is known). Run the 'bench' executable with --benchmark_format=json (or --benchmark_out=results.json) to keep results for comparison
+// between builds.
+
+// The naming convention for a benchmark is as follows: BM_[ClassName]_[methodName]([Variant])
+
+#include "particle.h"        // Include the Particle class definition.
+#include "simulation.h"      // Include the Simulation class definition.
+#include "analysis.h"        // Include the InSituAnalysis class definition.
+#include "event-generator.h" // Include the EventGenerator class definition.
+#include <benchmark/benchmark.h> // Include the Google Benchmark framework.
+#include <algorithm>         // Required for std::shuffle.
+#include <cmath>             // Required for std::cbrt and std::sqrt.
+#include <cstdint>           // Required for std::int64_t.
+#include <cstdio>            // Required for std::remove.
+#include <map>               // Required for caching the exact forces of each particle count.
+#include <string>            // Required for std::string.
+#include <random>            // Required for placing particles at random positions.
+#include <vector>            // Required for using the std::vector container.
+
+namespace {
+
+// Reports how many particles (and, if known, how many particle pairs) one iteration processed, as rates.
+void setRates(benchmark::State& state, double particles, double pairs = 0.0) {
+    state.counters["particles/s"] = benchmark::Counter(particles, benchmark::Counter::kIsIterationInvariantRate);
+    if (pairs > 0.0) {
+        state.counters["pairs/s"] = benchmark::Counter(pairs, benchmark::Counter::kIsIterationInvariantRate);
+    }
+}
+
+// Fills a simulation with count protons of alternating charge scattered in a cube whose volume grows with count (constant density).
+void scatterParticles(Simulation& sim, std::size_t count) {
+    std::default_random_engine engine(1);
+    const double side = std::cbrt(static_cast<double>(count)) * 0.5;
+    std::uniform_real_distribution<double> positionDist(0.0, side);
+    for (std::size_t i = 0; i < count; ++i) {
+        sim.createParticle(ParticleType::PROTON, 0.93827, (i % 2 == 0) ? +1.0 : -1.0, 0.0, 0.0, 0.0, 0.0);
+        sim.particles.x[i] = positionDist(engine);
+        sim.particles.y[i] = positionDist(engine);
+        sim.particles.z[i] = positionDist(engine);
+    }
+}
+
+// Returns standalone Particle records for the same configuration as scatterParticles().
+std::vector<Particle> scatterParticleRecords(std::size_t count) {
+    Simulation sim;
+    scatterParticles(sim, count);
+    std::vector<Particle> records;
+    records.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        records.push_back(sim.particles.get(i));
+    }
+    return records;
+}
+
+} // namespace
+
+// Particle::addForce over every pair (the original scalar all-pairs loop).
+static void BM_Particle_addForce(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    std::vector<Particle> particles = scatterParticleRecords(count);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < count; ++i) {
+            for (std::size_t j = i + 1; j < count; ++j) {
+                particles[i].addForce(particles[j]);
+            }
+        }
+        benchmark::DoNotOptimize(particles.data());
+        benchmark::ClobberMemory();
+    }
+    setRates(state, static_cast<double>(count), 0.5 * static_cast<double>(count) * static_cast<double>(count - 1));
+}
+BENCHMARK(BM_Particle_addForce)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+// Simulation::computeForces with the exact all-pairs solver.
+static void BM_Simulation_computeForcesAllPairs(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::ALL_PAIRS);
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    setRates(state, static_cast<double>(count), 0.5 * static_cast<double>(count) * static_cast<double>(count - 1));
+}
+BENCHMARK(BM_Simulation_computeForcesAllPairs)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::computeForces with the all-pairs solver in mixed precision (float pair kernels, double sums).
+static void BM_Simulation_computeForcesAllPairsMixed(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::ALL_PAIRS);
+    sim.setForcePrecision(ForcePrecision::MIXED);
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    setRates(state, static_cast<double>(count), 0.5 * static_cast<double>(count) * static_cast<double>(count - 1));
+}
+BENCHMARK(BM_Simulation_computeForcesAllPairsMixed)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::computeForces with the Barnes-Hut solver (default opening angle).
+static void BM_Simulation_computeForcesBarnesHut(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::BARNES_HUT);
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_computeForcesBarnesHut)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::computeForces with the Barnes-Hut solver over a sweep of opening angles (second argument, theta x 100), reporting the
+// RMS force error relative to the RMS exact force of the all-pairs solver next to the time. The exact forces are computed once per count,
+// outside the timed loop.
+static void BM_Simulation_computeForcesBarnesHutAccuracy(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    static std::map<std::size_t, ParticleStore> exactForces;
+    if (exactForces.find(count) == exactForces.end()) {
+        Simulation exact;
+        scatterParticles(exact, count);
+        exact.setForceSolver(ForceSolver::ALL_PAIRS);
+        exact.computeForces();
+        exactForces[count] = exact.particles;
+    }
+    const ParticleStore& exact = exactForces[count];
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::BARNES_HUT);
+    sim.setOpeningAngle(static_cast<double>(state.range(1)) / 100.0);
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    double errorSum = 0.0, forceSum = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double dx = sim.particles.fx[i] - exact.fx[i];
+        const double dy = sim.particles.fy[i] - exact.fy[i];
+        const double dz = sim.particles.fz[i] - exact.fz[i];
+        errorSum += dx * dx + dy * dy + dz * dz;
+        forceSum += exact.fx[i] * exact.fx[i] + exact.fy[i] * exact.fy[i] + exact.fz[i] * exact.fz[i];
+    }
+    setRates(state, static_cast<double>(count));
+    state.counters["rms_error"] = std::sqrt(errorSum / forceSum);
+}
+BENCHMARK(BM_Simulation_computeForcesBarnesHutAccuracy)->ArgsProduct({{1000, 10000, 100000}, {20, 35, 50, 70, 100}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::computeForces with the cell-list solver (unit cutoff, no neighbor-list reuse).
+static void BM_Simulation_computeForcesCellList(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::CELL_LIST);
+    sim.setCutoff(1.0);
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_computeForcesCellList)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::computeForces with the particle-mesh solver on a 64^3 mesh, as plain PM (second argument 0) or as P3M with exact corrections
+// within 5 mesh cells (second argument 5). The mesh costs the same at every particle count; the corrections grow with the density.
+static void BM_Simulation_computeForcesParticleMesh(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::PARTICLE_MESH);
+    sim.setParticleMesh(64, static_cast<double>(state.range(1)));
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_computeForcesParticleMesh)->ArgsProduct({{1000, 10000, 100000}, {0, 5}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::computeForces with the cell-list solver's neighbor list, with the particles stored in random order (as scattered) or after a
+// Morton reorder. The list is built once, so each iteration measures the neighbor gathers, which the reorder turns into nearby reads.
+static void computeForcesNeighborList(benchmark::State& state, bool sorted) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    sim.setForceSolver(ForceSolver::CELL_LIST);
+    sim.setCutoff(1.0);
+    sim.setNeighborListSkin(0.1);
+    if (sorted) {
+        sim.reorderParticles();
+    }
+    for (auto _ : state) {
+        sim.computeForces();
+        benchmark::DoNotOptimize(sim.particles.fx.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+static void BM_Simulation_computeForcesNeighborListUnsorted(benchmark::State& state) { computeForcesNeighborList(state, false); }
+static void BM_Simulation_computeForcesNeighborListSorted(benchmark::State& state) { computeForcesNeighborList(state, true); }
+BENCHMARK(BM_Simulation_computeForcesNeighborListUnsorted)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Simulation_computeForcesNeighborListSorted)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Simulation::reorderParticles on particles in random storage order (keys, radix sort and the permutation of every column).
+static void BM_Simulation_reorderParticles(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    std::vector<std::uint32_t> shuffle(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        shuffle[i] = static_cast<std::uint32_t>(i);
+    }
+    std::shuffle(shuffle.begin(), shuffle.end(), std::default_random_engine(2));
+    for (auto _ : state) {
+        state.PauseTiming();
+        sim.particles.permute(shuffle);
+        state.ResumeTiming();
+        sim.reorderParticles();
+        benchmark::DoNotOptimize(sim.particles.x.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_reorderParticles)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+// Particle::update over an array of standalone particle records (array-of-structures layout).
+static void BM_Particle_update(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    std::vector<Particle> particles = scatterParticleRecords(count);
+    for (auto _ : state) {
+        for (auto& particle : particles) {
+            particle.update(1e-12);
+        }
+        benchmark::DoNotOptimize(particles.data());
+        benchmark::ClobberMemory();
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Particle_update)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Simulation::updateParticles (column-wise integration plus the decay pass) for stable particles.
+static void BM_Simulation_updateParticles(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    scatterParticles(sim, count);
+    for (auto _ : state) {
+        sim.updateParticles(1e-12);
+        benchmark::DoNotOptimize(sim.particles.x.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_updateParticles)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Simulation::decayParticles for a population of charged kaons, with a step that lets about 1% of them decay.
+// Every decay replaces one particle by one product, so the population keeps its size from iteration to iteration.
+static void BM_Simulation_decayParticles(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    for (std::size_t i = 0; i < count; ++i) {
+        sim.createParticle(ParticleType::KAON_POSITIVE);
+    }
+    for (auto _ : state) {
+        sim.decayParticles(1.24e-10);
+    }
+    setRates(state, static_cast<double>(count));
+    state.counters["decays/s"] = benchmark::Counter(static_cast<double>(sim.getDecayCount()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Simulation_decayParticles)->RangeMultiplier(10)->Range(100, 1000000);
+
+// InSituAnalysis::fill, binning one generated event into every spectrum per call on the default thread pool.
+static void BM_InSituAnalysis_fill(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    EventConfig config;
+    config.meanMultiplicity = static_cast<double>(count);
+    config.poissonMultiplicity = false;
+    Simulation sim;
+    sim.generateEvent(EventGenerator(config));
+    ThreadPool pool(0);
+    InSituAnalysis analysis;
+    for (auto _ : state) {
+        analysis.fill(sim.particles, pool);
+    }
+    analysis.endEvent();
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_InSituAnalysis_fill)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Simulation::createParticle, one particle per call, into a cleared store (capacity is kept between iterations).
+static void BM_Simulation_createParticle(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    Simulation sim;
+    for (auto _ : state) {
+        sim.particles.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            sim.createParticle(ParticleType::PION_POSITIVE);
+        }
+        benchmark::DoNotOptimize(sim.particles.vx.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_createParticle)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Simulation::generateEvent, one whole event of count particles per call, into a cleared store.
+static void BM_Simulation_generateEvent(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    EventConfig config;
+    config.meanMultiplicity = static_cast<double>(count);
+    config.poissonMultiplicity = false;
+    EventGenerator eventGenerator(config);
+    Simulation sim;
+    for (auto _ : state) {
+        sim.particles.clear();
+        sim.generateEvent(eventGenerator);
+        benchmark::DoNotOptimize(sim.particles.vx.data());
+    }
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_generateEvent)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Simulation::saveCheckpoint, one uncompressed checkpoint of count particles per call.
+static void BM_Simulation_saveCheckpoint(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    EventConfig config;
+    config.meanMultiplicity = static_cast<double>(count);
+    config.poissonMultiplicity = false;
+    Simulation sim;
+    sim.generateEvent(EventGenerator(config));
+    const std::string path = "bench-checkpoint.ckpt";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sim.saveCheckpoint(path));
+    }
+    std::remove(path.c_str());
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_saveCheckpoint)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+// Simulation::loadCheckpoint, one restore of count particles per call.
+static void BM_Simulation_loadCheckpoint(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    EventConfig config;
+    config.meanMultiplicity = static_cast<double>(count);
+    config.poissonMultiplicity = false;
+    Simulation sim;
+    sim.generateEvent(EventGenerator(config));
+    const std::string path = "bench-checkpoint.ckpt";
+    sim.saveCheckpoint(path);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sim.loadCheckpoint(path));
+    }
+    std::remove(path.c_str());
+    setRates(state, static_cast<double>(count));
+}
+BENCHMARK(BM_Simulation_loadCheckpoint)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "interaction.h"    // Include the interaction policies.
+#include "thread-pool.h"    // Include the ThreadPool class definition.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint8_t and std::uint32_t.
+#include <utility>          // Required for std::pair.
+#include <vector>           // Required for using the std::vector container.
+
+// Arithmetic precision of the all-pairs pair loop.
+enum class ForcePrecision {
+    DOUBLE, // Positions, pair kernels and sums in double
+    MIXED   // Float positions relative to a double origin per block, float pair kernels, double sums across tiles (Coulomb law only)
+};
+
+// Computes the exact force between every pair of particles (Coulomb's law of Particle::addForce by default), in parallel.
+//
+// The particles are cut into blocks of tileSize particles, and the triangle of block pairs is split into tiles.
+// Each tile (I, J) evaluates every particle pair between block I and block J once and applies Newton's third law inside the tile.
+// Tiles are grouped into rounds (a round-robin tournament over the blocks) so that no block appears twice in the same round.
+// The tiles of a round can then run on any thread without write races, and every particle receives its contributions in the same
+// round order no matter how many threads there are, which makes the result bit-for-bit independent of the thread count.
+// The pair loop itself is the Coulomb row kernel chosen for the CPU at startup (see coulomb-kernel.h), or, for the other force laws, the
+// generic row of the interaction policy. If the law skips neutral particles and there are any, the charged particles are first gathered
+// into compact columns, so the tiles never visit a pair that contributes nothing.
+//
+// In MIXED precision, every block gets a double-precision origin (the centre of its bounding box) and its positions and charges are
+// gathered as float offsets from it. A tile moves each target into the source block's frame in double before rounding it to float, so
+// close pairs keep the accuracy of their separation however far they are from the coordinate origin; the Coulomb pairs then run in the
+// float row kernel (twice as many lanes per instruction) on half the bytes per source. The float sums cover one tile row or one tile and
+// are added to the double force columns, so the rounding error does not grow with the particle count. The other force laws, and
+// computeForcesOn(), always run in double.
+class AllPairsSolver {
+public:
+    static constexpr std::size_t tileSize = 256; // Particles per block. Two blocks of positions, charges and force accumulators fit in L1 cache.
+
+    InteractionSettings interaction; // Force law (Coulomb by default)
+    ForcePrecision precision = ForcePrecision::DOUBLE; // Precision of computeForces() for the Coulomb law
+
+    void computeForces(ParticleStore& particles, ThreadPool& pool); // Adds the pairwise forces of all particles to their force columns.
+    void computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool); // Adds the forces of all particles on the flagged ones only.
+
+private:
+    // Per-thread force accumulators for the two blocks of the tile being evaluated. They are added to the force columns when the tile is done.
+    struct TileScratch {
+        double fx[2 * tileSize];
+        double fy[2 * tileSize];
+        double fz[2 * tileSize];
+        float reactionX[tileSize]; // Single-precision reactions of block J (MIXED precision)
+        float reactionY[tileSize];
+        float reactionZ[tileSize];
+    };
+
+    // The columns the tiles read and write: the store's own, or the compact copies of the charged particles.
+    struct Columns {
+        const double* x;
+        const double* y;
+        const double* z;
+        const double* q;
+        double* fx;
+        double* fy;
+        double* fz;
+        std::size_t count;
+    };
+
+    template <typename Policy>
+    void computeAll(ParticleStore& particles, ThreadPool& pool, const Policy& policy); // computeForces() for one force law.
+    template <typename Policy>
+    void computeFlagged(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool, const Policy& policy); // computeForcesOn() for one force law.
+    template <typename Policy>
+    void computeTile(const Columns& columns, std::size_t blockI, std::size_t blockJ, TileScratch& scratch, const Policy& policy) const; // Evaluates all pairs of one tile.
+    void computeMixedTile(const Columns& columns, std::size_t blockI, std::size_t blockJ, TileScratch& scratch, float softening) const; // Evaluates the Coulomb pairs of one tile in float.
+    void gatherLocalColumns(const Columns& columns, std::size_t blockCount); // Computes the block origins and the float offsets from them.
+    Columns selectColumns(ParticleStore& particles, bool skipNeutral); // Returns the store's columns, or compact copies of the charged particles if some are neutral.
+    void scatterCompactForces(ParticleStore& particles) const; // Adds the forces of the compact columns to the store.
+    void buildSchedule(std::size_t blockCount); // Builds the rounds of tiles for blockCount blocks.
+
+    std::size_t scheduledBlocks = 0; // Block count that the current schedule was built for
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> rounds; // Tiles (I, J) of every round; no block appears twice in a round
+    std::vector<TileScratch> scratch; // One set of tile accumulators per thread
+    std::vector<std::uint32_t> targets; // Indices of the flagged particles (computeForcesOn)
+    bool compacted = false;              // Whether the last selectColumns() gathered the charged particles
+    std::vector<std::uint32_t> charged;  // Store index of each compact particle
+    std::vector<double> chargedX, chargedY, chargedZ, chargedQ;    // Positions and charges of the charged particles
+    std::vector<double> chargedFx, chargedFy, chargedFz;           // Their force accumulators
+    std::vector<double> blockOrigins;                              // Origin (x, y, z) of every block (MIXED precision)
+    std::vector<float> localX, localY, localZ, localQ;             // Positions relative to the block origins, and charges, in float
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "particle.h"       // Include the ParticleType definition.
+#include "particle-store.h" // Include the ParticleStore class and the ColumnView struct.
+#include "thread-pool.h"    // Include the ThreadPool class definition.
+#include <array>            // Required for std::array.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint64_t.
+#include <string>           // Required for std::string.
+#include <vector>           // Required for using the std::vector container.
+
+// Quantities that the in-situ analysis histograms per ParticleType.
+enum class Spectrum {
+    MOMENTUM,            // |p| = m |v| (GeV/c, with velocities in units of c)
+    TRANSVERSE_MOMENTUM, // p_T = m sqrt(vx^2 + vy^2), transverse to the z (beam) axis (GeV/c)
+    RAPIDITY,            // y = ln((E + p_z) / (E - p_z)) / 2 with E = sqrt(m^2 + p^2)
+    RADIUS,              // Distance from the collision point at the origin (m)
+    COUNT
+};
+
+constexpr std::size_t spectrumCount = static_cast<std::size_t>(Spectrum::COUNT);
+
+// Binning of one histogram: bins equal-width bins over [low, high). Values outside go to the underflow and overflow counts.
+struct HistogramAxis {
+    std::size_t bins = 50;
+    double low = 0.0;
+    double high = 1.0;
+};
+
+// Binning of every spectrum (indexed by Spectrum). The defaults cover the events of EventGenerator's default configuration.
+struct AnalysisConfig {
+    std::array<HistogramAxis, spectrumCount> axes = {{
+        {50, 0.0, 0.2},   // MOMENTUM
+        {50, 0.0, 0.2},   // TRANSVERSE_MOMENTUM
+        {50, -0.2, 0.2},  // RAPIDITY
+        {50, 0.0, 1e-3}   // RADIUS
+    }};
+};
+
+// In-situ analysis stage: fills per-species histograms while the simulation runs, so that production runs can keep the spectra instead of
+// writing full trajectories.
+//
+// fill() bins every particle's momentum, transverse momentum, rapidity and radius. The particles are split over the pool, and each worker
+// counts into its own bins, so filling needs no locks or atomics. endEvent() then adds the workers' bins together (once per event, a few
+// thousand integers) and into the run totals, together with the decay counts per parent species added by addDecays(). Simulation calls
+// fill() and addDecays() after the decays of a step (see Simulation::setAnalysis()); one analysis can collect the events that a
+// Simulation runs one after another, but not events running concurrently.
+class InSituAnalysis {
+public:
+    explicit InSituAnalysis(const AnalysisConfig& config = AnalysisConfig()); // Sets up empty histograms of a binning.
+
+    void fill(const ParticleStore& particles, ThreadPool& pool); // Adds every particle of the store to the current event's per-worker bins.
+    void addDecays(const std::array<std::uint64_t, particleTypeCount>& decays); // Adds the decays of a step, counted by parent species.
+    void endEvent(); // Merges the current event's bins and decays into the run totals.
+    void reset(); // Clears the totals and the current event.
+
+    ColumnView<std::uint64_t> getCounts(ParticleType type, Spectrum spectrum) const; // Returns the bins of one histogram (run totals).
+    std::uint64_t getUnderflow(ParticleType type, Spectrum spectrum) const; // Returns the count of values below the histogram's range.
+    std::uint64_t getOverflow(ParticleType type, Spectrum spectrum) const; // Returns the count of values at or above the histogram's range.
+    std::uint64_t getDecays(ParticleType type) const { return decays[static_cast<std::size_t>(type)]; } // Returns the decays of one parent species.
+    std::size_t getEventCount() const { return events; } // Returns the number of merged events.
+    std::uint64_t getFillCount() const { return fills; } // Returns the number of fill() calls of the merged events (for per-step normalization).
+    const AnalysisConfig& getConfig() const { return config; } // Returns the binning.
+    bool writeResults(const std::string& path) const; // Writes the totals as JSON (see formatAnalysisJson()); returns false on failure.
+
+private:
+    // Every histogram has its bins followed by an underflow and an overflow count; the histograms lie one after another, species-major.
+    std::size_t offsetOf(ParticleType type, Spectrum spectrum) const {
+        return static_cast<std::size_t>(type) * speciesStride + spectrumOffset[static_cast<std::size_t>(spectrum)];
+    }
+
+    AnalysisConfig config;
+    std::array<std::size_t, spectrumCount> spectrumOffset; // Offset of each spectrum within a species' histograms
+    std::size_t speciesStride = 0;                 // Counts per species (all spectra with their underflow and overflow)
+    std::vector<std::vector<std::uint64_t>> workerCounts; // Current event's counts of each pool worker
+    std::array<std::uint64_t, particleTypeCount> eventDecays = {}; // Current event's decays by parent species
+    std::uint64_t eventFills = 0;                  // Current event's fill() calls
+    std::vector<std::uint64_t> counts;             // Run totals of every histogram
+    std::array<std::uint64_t, particleTypeCount> decays = {}; // Run totals of the decays by parent species
+    std::size_t events = 0;                        // Merged events
+    std::uint64_t fills = 0;                       // fill() calls of the merged events
+};
+
+std::string formatAnalysisJson(const InSituAnalysis& analysis); // Formats the totals as a JSON object with one entry per species.
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "interaction.h"    // Include the interaction policies.
+#include "thread-pool.h"    // Include the ThreadPool class definition.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint32_t.
+#include <vector>           // Required for using the std::vector container.
+
+// Approximates the forces of a force law (Coulomb's law of Particle::addForce by default) with a Barnes-Hut octree, in O(N log N) instead of O(N^2).
+//
+// Every cell of the tree stores the net (signed) charge of the particles inside it and their dipole moment about the cell's center.
+// Charges of both signs partially cancel, so the dipole term carries most of the far field of a nearly neutral cell.
+// A cell whose size seen from a particle is below the opening angle (size / distance < openingAngle) acts on that particle through
+// this monopole-plus-dipole expansion; otherwise the cell is opened and its children (or, for leaves, its particles) are visited.
+// An opening angle of 0 opens every cell, which reduces to the exact pairwise sum. Angles above maxOpeningAngle are clamped to it: the
+// distance is measured to the cell's center, so above 2/sqrt(3) a cell could be accepted by a particle inside it and give it a self-force.
+// The tree walk is compiled per interaction policy, which supplies the pair law and the far field of a cell. If the law skips neutral
+// particles, they are left out of the tree altogether; a short-range law skips cells beyond its reach and opens cells that straddle it.
+class BarnesHutSolver {
+public:
+    double openingAngle = 0.5; // Opening angle theta. Smaller values are more accurate and slower; values above maxOpeningAngle act as maxOpeningAngle.
+    static constexpr double maxOpeningAngle = 1.0; // Largest opening angle used, so a cell never approximates a particle inside it
+    InteractionSettings interaction; // Force law (Coulomb by default)
+
+    static const std::size_t leafSize = 16;  // Maximum number of particles in a leaf cell
+    static const std::size_t maxDepth = 32;  // Cells this deep become leaves regardless of their size (coincident particles)
+
+    void computeForces(ParticleStore& particles, ThreadPool& pool); // Rebuilds the tree and adds the approximate forces to the force columns.
+    void computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool); // Same, but only for particles whose flag is set.
+    std::size_t getNodeCount() const { return nodes.size(); } // Returns the number of cells in the most recently built tree (zero if no particle was placed).
+
+    // Split force computation (for the task-graph step): prepareRanges() builds the tree, after which computeRange() can be called for
+    // disjoint ranges of store indices on any threads. The tree holds its own copy of the positions, so the store's positions may change
+    // while ranges are computed. The forces are the same, bit for bit, as those of computeForces().
+    void prepareRanges(const ParticleStore& particles); // Rebuilds the tree and the store-to-tree index map.
+    void computeRange(ParticleStore& particles, std::size_t begin, std::size_t end) const; // Adds the forces of the particles in [begin, end).
+
+private:
+    // One cell of the octree. Cells live in a flat array; the non-empty children of a cell are stored next to each other.
+    struct Node {
+        double center[3];        // Geometric center of the cell, also the expansion center of its multipoles
+        double halfSize;         // Half of the cell's edge length
+        double charge;           // Net charge of the particles in the cell
+        double dipole[3];        // Dipole moment of the particles about center
+        std::uint32_t begin;     // First particle of the cell (index into the tree-ordered arrays)
+        std::uint32_t end;       // One past the last particle of the cell
+        std::uint32_t firstChild; // Index of the first child cell
+        std::uint32_t childCount; // Number of (non-empty) child cells; zero for leaves
+    };
+
+    static constexpr std::uint32_t notInTree = 0xFFFFFFFFu; // Rank of a particle left out of the tree (a neutral particle)
+
+    template <typename Policy>
+    void computeTargets(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy); // Walks the tree for every (flagged) particle.
+    template <typename Policy>
+    void computeRangeWith(ParticleStore& particles, std::size_t begin, std::size_t end, const Policy& policy) const; // computeRange() for one force law.
+    bool build(const ParticleStore& particles); // Rebuilds the tree for the current particle positions; returns false if fewer than two particles interact.
+    void subdivide(std::uint32_t nodeIndex, std::size_t depth); // Splits a cell into octants and recurses into them.
+    void computeMoments(std::uint32_t nodeIndex); // Computes the charge and dipole of a cell (bottom-up).
+    template <typename Policy>
+    std::size_t accumulateForce(std::size_t target, double& fx, double& fy, double& fz, const Policy& policy) const; // Walks the tree for one particle; returns the number of particle and cell interactions.
+
+    std::vector<Node> nodes;            // Node pool, reused between steps
+    std::vector<std::uint32_t> order;   // Store index of the particle at each tree position
+    std::vector<std::uint32_t> rank;    // Tree position of each store index, or notInTree (prepareRanges)
+    std::vector<std::uint32_t> scratch; // Scratch buffer for partitioning a cell's particles into octants
+    std::vector<double> sx, sy, sz, sq; // Positions and charges in tree order, for streaming through leaves
+};
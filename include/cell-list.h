@@ -0,0 +1,88 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "thread-pool.h"    // Include the ThreadPool class definition.
+#include "checkpoint.h"     // Include the CheckpointWriter and CheckpointReader classes.
+#include "interaction.h"    // Include the interaction settings and policies.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint32_t.
+#include <vector>           // Required for using the std::vector container.
+
+// Computes the forces of a force law (Coulomb's by default) only between particles closer than a cutoff radius, in O(N).
+//
+// Every step the particles are binned into a uniform grid of cells with a counting sort, so the particles of each cell occupy a
+// contiguous range. Each particle then only looks at the cells within the cutoff radius of its own cell.
+//
+// With a skin distance greater than zero, the solver instead keeps a Verlet neighbor list of all pairs closer than cutoff + skin.
+// The list stays valid until some particle has moved more than skin / 2 since it was built, so most steps skip the grid entirely.
+//
+// Forces are evaluated per particle over its neighbors (each pair is visited from both sides), so the particles can be split
+// across threads without write conflicts and the result does not depend on the thread count.
+//
+// The force law is compiled into the pair loops (see interaction.h). If it skips neutral particles, the grid path leaves them out of the
+// grid; the neighbor list always holds every particle, so that its validity only depends on positions, and neutral particles are skipped
+// as targets instead.
+class CellListSolver {
+public:
+    double cutoff = 1.0;   // Pairs farther apart than this do not interact (m)
+    double cellSize = 0.0; // Edge length of a grid cell (m); zero means cellSize = cutoff + skin
+    double skin = 0.0;     // Verlet skin distance (m); zero rebuilds the grid every step and keeps no neighbor list
+    InteractionSettings interaction; // Force law (limited to the cutoff radius in any case)
+
+    void computeForces(ParticleStore& particles, ThreadPool& pool); // Adds the short-range forces to the force columns.
+    void computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool); // Same, but only for particles whose flag is set.
+    std::size_t getNeighborListBuildCount() const { return neighborListBuilds; } // Returns how many times the neighbor list has been built.
+    void invalidateNeighborList() { builtCutoff = -1.0; } // Forces the next force computation to rebuild the neighbor list (its buffers are kept).
+
+    // Split force computation (for the task-graph step): prepareRanges() bins the particles (and rebuilds a stale neighbor list), after
+    // which computeRange() can be called for disjoint ranges of store indices on any threads. It reads the solver's own copies of the
+    // positions, so the store's positions may change while ranges are computed. The forces are the same, bit for bit, as those of computeForces().
+    void prepareRanges(const ParticleStore& particles, ThreadPool& pool); // Bins the particles and copies what computeRange() reads.
+    void computeRange(ParticleStore& particles, std::size_t begin, std::size_t end) const; // Adds the forces of the particles in [begin, end).
+    void save(CheckpointWriter& checkpoint) const; // Writes the parameters and the neighbor list to a checkpoint.
+    bool load(CheckpointReader& checkpoint); // Restores the solver from a checkpoint; returns false if the checkpoint is damaged.
+
+private:
+    static constexpr std::uint32_t notBinned = 0xFFFFFFFFu; // Cell and rank of a particle left out of the grid
+
+    void buildGrid(const ParticleStore& particles, double reach, bool skipNeutral); // Bins the (charged) particles into cells (counting sort).
+    template <typename Policy>
+    void computeTargets(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy); // Computes the forces of every (flagged) particle.
+    template <typename Policy>
+    void computeFromGrid(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy); // Evaluates forces straight from the grid.
+    template <typename Policy>
+    void computeRangeWith(ParticleStore& particles, std::size_t begin, std::size_t end, const Policy& policy) const; // computeRange() for one force law.
+    bool neighborListIsStale(const ParticleStore& particles) const; // Checks whether any particle moved more than skin / 2 since the last build.
+    void buildNeighborList(const ParticleStore& particles, ThreadPool& pool); // Builds the Verlet neighbor list from the grid.
+    template <typename Policy>
+    void computeFromNeighborList(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy); // Evaluates forces over the neighbor list.
+    template <typename Policy>
+    std::size_t sumFromGrid(std::uint32_t a, long cx, long cy, long cz, double& gx, double& gy, double& gz,
+                            const Policy& policy) const; // Sums the field at one sorted position from its stencil.
+    template <typename Policy>
+    std::size_t sumFromNeighborList(std::size_t i, const double* x, const double* y, const double* z, const double* q,
+                                    double& gx, double& gy, double& gz, const Policy& policy) const; // Sums the field at one particle from its listed neighbors.
+
+    // Grid
+    double origin[3] = {0.0, 0.0, 0.0};      // Corner of the grid
+    double gridCellSize = 0.0;               // Cell edge length actually used (may be enlarged to bound the cell count)
+    std::size_t dims[3] = {0, 0, 0};         // Number of cells along each axis
+    int stencilReach = 1;                    // How many cells away a neighbor can be
+    std::vector<std::uint32_t> cellOfParticle; // Cell of each particle (or notBinned)
+    std::vector<std::uint32_t> cellStart;    // First sorted position of each cell (one extra entry marks the end)
+    std::vector<std::uint32_t> sortedIndex;  // Store index of the particle at each sorted position
+    std::vector<std::uint32_t> cellCursor;   // Scatter cursors of the counting sort
+    std::vector<double> sx, sy, sz, sq;      // Positions and charges in cell order
+
+    // Verlet neighbor list (compressed rows: the neighbors of particle i are neighbors[neighborStart[i] .. neighborStart[i + 1]))
+    std::vector<std::uint32_t> neighborStart;
+    std::vector<std::uint32_t> neighbors;
+    std::vector<double> referenceX, referenceY, referenceZ; // Positions at the time the list was built
+    std::size_t neighborListBuilds = 0;
+    double builtCutoff = -1.0; // Cutoff and skin the current list was built for
+    double builtSkin = -1.0;
+
+    // Split force computation
+    std::vector<std::uint32_t> rank;                // Sorted position of each store index, or notBinned (grid path)
+    std::vector<double> rangeX, rangeY, rangeZ, rangeQ; // Positions and charges by store index (neighbor-list path)
+};
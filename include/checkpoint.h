@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>    // Required for std::min.
+#include <cstddef>      // Required for std::size_t.
+#include <cstdint>      // Required for the fixed-width integer types.
+#include <cstring>      // Required for std::memcpy.
+#include <string>       // Required for std::string.
+#include <type_traits>  // Required for std::is_trivially_copyable and std::underlying_type.
+#include <vector>       // Required for using the std::vector container.
+
+// Checkpoint files.
+//
+// A checkpoint is one contiguous blob: a 32-byte file header (the magic "PSIMCKPT", a format version, flags, the payload size and the
+// stored size) followed by the payload, which is zlib-compressed if the compressed flag is set. The payload is a sequence of plain values
+// and whole columns (a uint64 element count followed by the raw elements, padded to 8 bytes), written and read back in a fixed order.
+// Values are stored in native byte order, so a checkpoint is meant to be restored on the same kind of machine that wrote it.
+constexpr char checkpointMagic[8] = {'P', 'S', 'I', 'M', 'C', 'K', 'P', 'T'};
+constexpr std::uint32_t checkpointVersion = 5;
+
+// Builds a checkpoint payload.
+class CheckpointWriter {
+public:
+    void reserve(std::size_t bytes) { payload.reserve(bytes); } // Reserves room for the payload, so that writing it does not reallocate.
+    const std::vector<char>& getPayload() const { return payload; } // Returns the payload written so far.
+
+    // Appends one value (any trivially copyable type).
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be checkpointed.");
+        append(&value, sizeof(T));
+    }
+
+    // Appends a whole column (std::vector or AlignedVector) with one copy.
+    template <typename Column>
+    void putColumn(const Column& column) {
+        static_assert(std::is_trivially_copyable<typename Column::value_type>::value, "Only columns of trivially copyable values can be checkpointed.");
+        const std::size_t bytes = column.size() * sizeof(typename Column::value_type);
+        put(static_cast<std::uint64_t>(column.size()));
+        append(column.data(), bytes);
+        payload.resize(payload.size() + (((bytes + 7) & ~std::size_t(7)) - bytes), 0);
+    }
+
+private:
+    // Appends raw bytes.
+    void append(const void* bytes, std::size_t count) {
+        const std::size_t offset = payload.size();
+        payload.resize(offset + count);
+        if (count > 0) {
+            std::memcpy(payload.data() + offset, bytes, count);
+        }
+    }
+
+    std::vector<char> payload;
+};
+
+// Reads a checkpoint payload back in the order it was written. Every read checks the remaining size and returns false if the payload
+// ends early, so a damaged checkpoint is reported instead of read past its end.
+class CheckpointReader {
+public:
+    CheckpointReader(const char* data, std::size_t size) : cursor(data), end(data + size) {}
+    bool atEnd() const { return cursor == end; } // Checks whether the whole payload has been read.
+
+    // Reads one value.
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be checkpointed.");
+        return take(&value, sizeof(T));
+    }
+
+    // Reads a flag written as a bool. Any byte other than 0 or 1 can only come from a damaged checkpoint and is rejected.
+    bool getFlag(bool& value) {
+        static_assert(sizeof(bool) == 1, "Flags are checkpointed as one byte.");
+        std::uint8_t byte = 0;
+        if (!get(byte) || byte > 1) {
+            return false;
+        }
+        value = (byte == 1);
+        return true;
+    }
+
+    // Reads an enumeration value, rejecting anything past the last enumerator (enumerators are numbered from 0).
+    template <typename Enum>
+    bool getEnum(Enum& value, Enum last) {
+        using Raw = typename std::make_unsigned<typename std::underlying_type<Enum>::type>::type;
+        Raw raw = 0;
+        if (!get(raw) || raw > static_cast<Raw>(last)) {
+            return false;
+        }
+        value = static_cast<Enum>(raw);
+        return true;
+    }
+
+    // Reads a whole column with one copy.
+    template <typename Column>
+    bool getColumn(Column& column) {
+        std::uint64_t count = 0;
+        if (!get(count) || count > static_cast<std::uint64_t>(end - cursor) / sizeof(typename Column::value_type)) {
+            return false;
+        }
+        column.resize(static_cast<std::size_t>(count));
+        const std::size_t bytes = column.size() * sizeof(typename Column::value_type);
+        const std::size_t paddedBytes = (bytes + 7) & ~std::size_t(7);
+        if (!take(column.data(), bytes)) {
+            return false;
+        }
+        const std::size_t padding = std::min(paddedBytes - bytes, static_cast<std::size_t>(end - cursor));
+        cursor += padding;
+        return true;
+    }
+
+private:
+    // Copies the next count bytes out of the payload.
+    bool take(void* bytes, std::size_t count) {
+        if (count > static_cast<std::size_t>(end - cursor)) {
+            return false;
+        }
+        if (count > 0) {
+            std::memcpy(bytes, cursor, count);
+        }
+        cursor += count;
+        return true;
+    }
+
+    const char* cursor;
+    const char* end;
+};
+
+bool isCheckpointCompressionAvailable(); // Checks whether this build can compress checkpoints (it was built with zlib).
+bool writeCheckpointFile(const std::string& path, const std::vector<char>& payload, bool compress); // Writes a payload as a checkpoint file; returns false on failure.
+bool readCheckpointFile(const std::string& path, std::vector<char>& payload); // Reads a checkpoint file's payload (decompressing it if needed); returns false on failure.
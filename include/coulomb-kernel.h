@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef> // Required for std::size_t.
+
+// Instruction sets that the Coulomb pair kernel has implementations for.
+enum class SimdLevel {
+    SCALAR, // Plain C++, one pair at a time
+    AVX2,   // 4 source particles per instruction (x86-64 with AVX2 and FMA)
+    AVX512  // 8 source particles per instruction (x86-64 with AVX-512F)
+};
+
+// Evaluates the Coulomb interaction (the same law as Particle::addForce, CoulombInteraction in interaction.h) between one target particle
+// and a contiguous run of count source particles, applying Newton's third law:
+//   for every source j:  f = kqi * q[j] * (r_j - r_i) / (|r_j - r_i|^2 + softening)^(3/2)
+//                        force on the target += f,  fx[j], fy[j], fz[j] -= f
+// The total force on the target is added to targetForce[0..2]. kqi is Coulomb's constant times the target's charge.
+using CoulombRowKernel = void (*)(double xi, double yi, double zi, double kqi,
+                                  const double* x, const double* y, const double* z, const double* q,
+                                  double* fx, double* fy, double* fz, std::size_t count, double targetForce[3], double softening);
+
+// Single-precision counterpart of CoulombRowKernel for the mixed-precision mode of the all-pairs solver (see ForcePrecision in all-pairs.h).
+// Positions are offsets from a nearby origin, so float keeps the separations of close pairs accurate; the vector kernels evaluate twice as
+// many pairs per instruction as the double ones. The sums cover at most one tile row (target) or tile (sources); the caller adds them to
+// double accumulators.
+using FloatCoulombRowKernel = void (*)(float xi, float yi, float zi, float kqi,
+                                       const float* x, const float* y, const float* z, const float* q,
+                                       float* fx, float* fy, float* fz, std::size_t count, float targetForce[3], float softening);
+
+SimdLevel detectSimdLevel(); // Returns the widest instruction set that this CPU (and operating system) supports.
+bool isSimdLevelSupported(SimdLevel level); // Checks whether the kernel for level can run on this CPU.
+CoulombRowKernel getCoulombRowKernel(SimdLevel level); // Returns the kernel for a given instruction set (the caller must check support).
+FloatCoulombRowKernel getFloatCoulombRowKernel(SimdLevel level); // Returns the single-precision kernel for a given instruction set (the caller must check support).
+
+// The kernel used by the force solvers. It is chosen once at startup from detectSimdLevel(), so one binary uses the best
+// instruction set on every node it runs on.
+CoulombRowKernel getActiveCoulombRowKernel(); // Returns the kernel used by the force solvers.
+FloatCoulombRowKernel getActiveFloatCoulombRowKernel(); // Returns the single-precision kernel of the same instruction set.
+SimdLevel getActiveSimdLevel(); // Returns the instruction set of the kernel used by the force solvers.
+void setActiveSimdLevel(SimdLevel level); // Overrides the startup choice (for validation runs). Unsupported levels fall back to SCALAR.
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>    // Required for std::array.
+#include <cstdint>  // Required for the fixed-width integer types.
+
+// What a random stream is used for. Each purpose has its own, non-overlapping range of counters.
+enum class RandomPurpose : std::uint32_t {
+    CREATION = 0,     // Species and initial velocity of a new particle
+    MULTIPLICITY = 1, // Number of particles of a generated event
+    DECAY = 2         // Decay times and decay modes of a particle (and its cascade) within one step
+};
+
+// Philox4x32-10 block function (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11).
+// Ten rounds of multiply-and-xor turn a 128-bit counter and a 64-bit key into 128 random bits. Every block is independent of every other
+// block, so any thread can compute the numbers for any counter without shared state.
+inline std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) {
+    constexpr std::uint64_t multiplier0 = 0xD2511F53u;
+    constexpr std::uint64_t multiplier1 = 0xCD9E8D57u;
+    constexpr std::uint32_t weyl0 = 0x9E3779B9u;
+    constexpr std::uint32_t weyl1 = 0xBB67AE85u;
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            key[0] += weyl0;
+            key[1] += weyl1;
+        }
+        const std::uint64_t product0 = multiplier0 * counter[0];
+        const std::uint64_t product1 = multiplier1 * counter[2];
+        counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product1),
+                   static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product0)};
+    }
+    return counter;
+}
+
+// Converts 32 random bits to a uniform number in the open interval (0, 1), so that its logarithm is always finite.
+inline double toUniform(std::uint32_t bits) {
+    return (static_cast<double>(bits) + 0.5) * (1.0 / 4294967296.0);
+}
+
+// A sequence of random numbers that belongs to one (purpose, particle, step) triple.
+// It meets the UniformRandomBitGenerator requirements, so it also works with the distributions of <random>.
+class RandomStream {
+public:
+    using result_type = std::uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    RandomStream(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) : counter(counter), key(key) {}
+
+    // Returns the next 32 random bits. A new Philox block is computed every fourth call.
+    result_type operator()() {
+        if (used == 4) {
+            block = philox4x32(counter, key);
+            ++counter[0]; // The low 24 bits of the first word count the blocks of the stream.
+            used = 0;
+        }
+        return block[used++];
+    }
+
+    double uniform() { return toUniform((*this)()); } // Returns the next uniform number in (0, 1).
+
+private:
+    std::array<std::uint32_t, 4> counter; // Counter of the next block
+    std::array<std::uint32_t, 2> key;     // Key (seed and event)
+    std::array<std::uint32_t, 4> block{}; // Current block
+    int used = 4;                         // Number of words of the current block already returned
+};
+
+// Counter-based random number generator keyed by (seed, event, particle id, step).
+//
+// The seed and the event id form the Philox key; the purpose, step and particle id form the counter. The numbers of a particle therefore
+// depend only on who the particle is and when they are drawn, never on how many other numbers were drawn before or by which thread, so
+// runs are bit-reproducible at any thread count. A stream holds up to 2^24 blocks, and steps are taken modulo 2^32.
+class CounterRng {
+public:
+    explicit CounterRng(std::uint32_t seed = 0, std::uint32_t event = 0) : key{seed, event} {}
+
+    std::uint32_t getSeed() const { return key[0]; } // Returns the seed.
+    std::uint32_t getEvent() const { return key[1]; } // Returns the event id.
+
+    // Returns the random stream of one particle for one purpose and step.
+    RandomStream stream(RandomPurpose purpose, std::uint64_t particle, std::uint64_t step) const {
+        return RandomStream(counterFor(purpose, particle, step), key);
+    }
+
+    // Returns the first block (four words) of a stream, for callers that need at most four numbers.
+    std::array<std::uint32_t, 4> block(RandomPurpose purpose, std::uint64_t particle, std::uint64_t step) const {
+        return philox4x32(counterFor(purpose, particle, step), key);
+    }
+
+private:
+    static std::array<std::uint32_t, 4> counterFor(RandomPurpose purpose, std::uint64_t particle, std::uint64_t step) {
+        return {static_cast<std::uint32_t>(purpose) << 24, static_cast<std::uint32_t>(step),
+                static_cast<std::uint32_t>(particle), static_cast<std::uint32_t>(particle >> 32)};
+    }
+
+    std::array<std::uint32_t, 2> key; // Philox key: seed and event id
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "particle.h"       // Include the ParticleType and DecayMode definitions.
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include <array>            // Required for std::array.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint32_t and std::uint64_t.
+#include "counter-rng.h"    // Include the CounterRng class definition.
+#include "observables.h"    // Include the Observables struct definition.
+#include <vector>           // Required for using the std::vector container.
+
+// Samples a decay mode in O(1) with Walker's alias method.
+// The branching ratios of a particle type's decay modes are normalized, so every decay ends in one of the listed modes.
+class AliasTable {
+public:
+    AliasTable() = default;
+    explicit AliasTable(DecayModeList modes); // Builds the table for a list of decay modes (Vose's algorithm).
+
+    bool empty() const { return outcome.empty(); } // Checks whether the table has no modes (stable particle types).
+    ParticleType sample(double u) const; // Returns the product type selected by a uniform random number u in [0, 1).
+
+private:
+    std::vector<double> threshold;      // Probability of keeping column k's own outcome
+    std::vector<std::uint32_t> alias;   // Outcome used when column k's own outcome is rejected
+    std::vector<ParticleType> outcome;  // Product type of each mode
+};
+
+const AliasTable& getDecayAliasTable(ParticleType type); // Returns the alias table of a particle type (built once, on first use).
+
+// Carries out the decays of one simulation step.
+//
+// Decay times are exponential: an unstable particle with mean lifetime tau decays within the step if a sampled time -tau * ln(u) is shorter
+// than the step. Its product is created at the parent's position with the parent's velocity, and because it was created part-way through
+// the step, it may decay again in the time that is left (a decay cascade).
+// All numbers of a parent and its cascade come from the parent's own (id, step) random stream, so whether a particle decays does not depend
+// on the other particles or on the order in which they are visited.
+// Parents are removed in one compaction pass and products are appended afterwards, in the order of their parents' ids, so the ids the
+// products get do not depend on where their parents were stored (the store may be reordered, see SpatialSorter). All scratch buffers keep their capacity between steps
+// and the particle store grows geometrically, so once an event has reached its steady-state size a step does not allocate.
+// A step can also be split into particle chunks: stageChunk() decides the decays of one chunk (chunks can be staged on different threads,
+// in any order) and applyStaged() then applies all chunks in chunk order, with exactly the result of decayParticles().
+class DecayEngine {
+public:
+    static const int maxCascadeDepth = 64; // A product that would decay more often than this within one step waits for the next step.
+
+    std::size_t decayParticles(ParticleStore& particles, double deltaTime, const CounterRng& rng, std::uint64_t step); // Decays particles; returns the number of decays.
+    void beginChunks(std::size_t chunkCount); // Prepares the staging areas of a step split into chunkCount chunks.
+    void stageChunk(const ParticleStore& particles, std::size_t chunk, std::size_t begin, std::size_t end,
+                    double deltaTime, const CounterRng& rng, std::uint64_t step); // Decides the decays of the particles in [begin, end) without changing the store.
+    std::size_t applyStaged(ParticleStore& particles); // Removes the staged parents and appends their products; returns the number of decays.
+    const Observables& getLastChange() const { return change; } // Returns how the last step changed the observables (products minus parents).
+    const std::array<std::uint64_t, particleTypeCount>& getLastDecaysByType() const { return decaysByType; } // Returns the last step's decays by parent species (cascades included).
+
+private:
+    // A product created during the step, with the time left in the step after its creation.
+    struct PendingProduct {
+        ParticleType type;
+        double x, y, z;
+        double vx, vy, vz;
+        double remainingTime;
+        RandomStream random; // The parent's random stream, continued by the cascade
+        std::uint64_t parentId; // Id of the parent (products are appended in parent id order)
+    };
+
+    // The decays staged for one chunk of particles.
+    struct ChunkStaging {
+        std::vector<std::uint32_t> decayedIndices; // Indices of the chunk's parents that decay this step (ascending)
+        std::vector<PendingProduct> products;      // Their products, waiting to be appended to the store
+        Observables removed;                       // Observables removed with the parents (count is modulo 2^64)
+        std::size_t decays = 0;                    // Decays of the chunk, including cascades
+        std::array<std::uint64_t, particleTypeCount> decaysByType = {}; // The same decays by parent species
+    };
+
+    std::vector<ChunkStaging> chunks;          // Staging area of each chunk (reused between steps)
+    std::size_t chunkCount = 0;                // Number of chunks in the current step
+    std::vector<std::uint32_t> decayedIndices; // Indices of all parents that decay this step (ascending)
+    std::vector<const PendingProduct*> productOrder; // Products of all chunks in the order they are appended
+    Observables change;                        // Observables of the products minus those of their parents (count is modulo 2^64)
+    std::array<std::uint64_t, particleTypeCount> decaysByType = {}; // Decays of the last step by parent species
+};
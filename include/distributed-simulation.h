@@ -0,0 +1,84 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "cell-list.h"      // Include the CellListSolver class definition.
+#include "thread-pool.h"    // Include the ThreadPool class definition.
+#include <mpi.h>            // Required for MPI_Comm and the MPI functions.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint64_t.
+#include <vector>           // Required for using the std::vector container.
+
+// Runs one event on several MPI ranks, each owning the particles in one slab of space.
+//
+// The box [boxMin, boxMax) is cut along x into one slab per rank; particles outside the box belong to the first or last slab. Forces are
+// the short-range forces of the cell-list solver, so a particle only needs the particles within the cutoff radius: every step each rank
+// sends the positions and charges of its particles within the cutoff of a slab face to that neighbor (the ghost layer). The ghost messages
+// are posted first and the forces of the interior particles, which need no ghosts, are computed while they are in flight; only then are
+// the boundary particles computed from the local particles and the ghosts.
+// After each step, particles that have left the slab migrate to the neighboring rank (repeatedly, if a particle crossed more than one slab).
+//
+// The ghost layer only reaches the neighboring slabs, so every slab must be at least as wide as the cutoff, i.e. the number of ranks may be
+// at most (boxMax - boxMin) / cutoff (see getMaxRankCount()); the constructor aborts the job with a message otherwise. Integration uses the semi-implicit Euler scheme of Particle::update. Decays are not carried out:
+// their products would need particle ids that are unique across ranks.
+class DistributedSimulation {
+public:
+    ParticleStore particles; // Particles owned by this rank (their ids are the global ids of the event)
+
+    DistributedSimulation(MPI_Comm communicator, double boxMin, double boxMax, double cutoff); // Sets up this rank's slab (aborts the job if the slabs would be narrower than the cutoff).
+    ~DistributedSimulation(); // Frees the MPI datatypes.
+
+    DistributedSimulation(const DistributedSimulation&) = delete;
+    DistributedSimulation& operator=(const DistributedSimulation&) = delete;
+
+    int getRank() const { return rank; } // Returns this rank's index in the communicator.
+    int getRankCount() const { return rankCount; } // Returns the number of ranks.
+    int ownerOf(double x) const; // Returns the rank whose slab holds the x coordinate.
+    static int getMaxRankCount(double boxMin, double boxMax, double cutoff); // Returns how many ranks the box can be split over with slabs at least cutoff wide (0 if none).
+    std::size_t getGhostCount() const { return ghostCount; } // Returns how many ghost particles the last force computation received.
+
+    void distribute(const ParticleStore& event); // Keeps the particles of an event (the same on every rank) that lie in this rank's slab.
+    void computeForces(); // Computes the short-range forces of the owned particles, exchanging ghost layers with the neighbors.
+    void updateParticles(double deltaTime); // Advances the owned particles by one Euler step, then migrates the ones that left the slab.
+    std::size_t getGlobalParticleCount() const; // Returns the number of particles on all ranks together (collective).
+    void gather(ParticleStore& event, int root = 0) const; // Collects all particles on root, ordered by id (collective).
+
+private:
+    // One particle on its way to another rank.
+    struct PackedParticle {
+        std::uint64_t id;
+        std::uint64_t type;
+        double mass, charge, lifetime;
+        double x, y, z;
+        double vx, vy, vz;
+        double fx, fy, fz;
+    };
+
+    // Position and charge of a ghost particle.
+    struct Ghost {
+        double x, y, z, charge;
+    };
+
+    static PackedParticle pack(const ParticleStore& store, std::size_t index); // Packs one particle of a store.
+    static void unpack(const PackedParticle& packed, ParticleStore& store); // Appends a packed particle to a store, keeping its id.
+    void migrate(); // Sends particles that left the slab to the neighbors until every particle is on its owner.
+
+    MPI_Comm communicator;
+    MPI_Datatype ghostType = MPI_DATATYPE_NULL;    // One Ghost, so messages count particles rather than bytes
+    MPI_Datatype particleType = MPI_DATATYPE_NULL; // One PackedParticle
+    int rank = 0;
+    int rankCount = 1;
+    int leftRank = MPI_PROC_NULL;  // Neighbor owning the slab below (MPI_PROC_NULL on the first rank)
+    int rightRank = MPI_PROC_NULL; // Neighbor owning the slab above (MPI_PROC_NULL on the last rank)
+    double boxMin, boxMax, slabWidth;
+    double domainBegin, domainEnd; // This rank's slab [domainBegin, domainEnd)
+    double cutoff;
+
+    ThreadPool pool{1};      // Each rank computes its forces on one thread
+    CellListSolver solver;   // Short-range force solver
+    ParticleStore work;      // Owned particles followed by the ghosts, for the force computation
+    std::vector<std::uint8_t> isTarget; // Particles whose forces the current pass computes
+    std::vector<Ghost> ghostsToLeft, ghostsToRight, ghostsFromLeft, ghostsFromRight;
+    std::vector<PackedParticle> leavingLeft, leavingRight, arrivingLeft, arrivingRight;
+    std::vector<std::uint32_t> leavingIndices;
+    std::size_t ghostCount = 0;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "event-generator.h" // Include the EventGenerator class definition.
+#include "simulation.h"      // Include the Simulation class definition.
+#include "thread-pool.h"     // Include the ThreadPool class definition.
+#include <cstddef>           // Required for std::size_t.
+#include <cstdint>           // Required for std::uint32_t.
+#include <vector>            // Required for using the std::vector container.
+
+// Runs many independent events, one Simulation each, spread across a thread pool.
+//
+// Parallelism is over events rather than inside them: each event's own force computation runs on a single thread, so the batch never
+// oversubscribes the machine and needs no synchronization beyond the pool's loop barrier. Event k shares the batch's seed and has event id k,
+// so it draws exactly the numbers a standalone Simulation with that seed and event id would, on any number of threads.
+class EventBatch {
+public:
+    std::vector<Simulation> events; // One simulation per event
+
+    explicit EventBatch(std::size_t eventCount, std::uint32_t seed = 0); // Creates eventCount empty events with event ids 0 to eventCount - 1.
+
+    void generate(const EventGenerator& eventGenerator, ThreadPool& pool); // Generates the particles of every event.
+    void run(std::size_t steps, double deltaTime, ThreadPool& pool); // Advances every event by steps steps (forces, integration and decays).
+    std::size_t getParticleCount() const; // Returns the number of particles in all events together.
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "particle.h"       // Include the ParticleType definition.
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "decay.h"          // Include the AliasTable class (reused to sample species).
+#include <array>            // Required for std::array.
+#include <cstddef>          // Required for std::size_t.
+#include "counter-rng.h"    // Include the CounterRng class definition.
+
+// Describes the events that an EventGenerator creates.
+struct EventConfig {
+    double meanMultiplicity = 1000.0; // Mean number of hadrons per event
+    bool poissonMultiplicity = true;  // Draws each event's multiplicity from a Poisson distribution (otherwise every event has the mean, rounded)
+    std::array<double, particleTypeCount> speciesWeights = {0.3, 0.3, 0.3, 0.04, 0.04, 0.02}; // Relative abundance of each ParticleType (pions dominate)
+    double velocityRange = 0.1;       // Velocity components are uniform in [-velocityRange, velocityRange)
+};
+
+// Creates whole collision events directly in a ParticleStore.
+//
+// Unlike Simulation::createParticle(), which appends one particle at a time, an event is generated column by column: the store grows once
+// to the event's size, then one pass draws each particle's species (with an alias table) and velocity from a single Philox block keyed by
+// its id, and copies its properties from the species registry. No particle's numbers depend on any other's.
+class EventGenerator {
+public:
+    explicit EventGenerator(const EventConfig& config = EventConfig()); // Builds the species table of a configuration.
+
+    std::size_t sampleMultiplicity(const CounterRng& rng) const; // Draws the number of particles of the event that rng is keyed to.
+    std::size_t generate(ParticleStore& particles, const CounterRng& rng) const; // Appends one event; returns its number of particles.
+    const EventConfig& getConfig() const { return config; } // Returns the configuration of the generated events.
+
+private:
+    EventConfig config;     // Configuration of the generated events
+    AliasTable speciesTable; // Samples a ParticleType with probability proportional to its weight
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "thread-pool.h" // Include the ThreadPool class definition.
+#include <complex>       // Required for std::complex.
+#include <cstddef>       // Required for std::size_t.
+#include <vector>        // Required for using the std::vector container.
+
+// Checks whether n is a power of two (and not zero).
+inline bool isPowerOfTwo(std::size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+// Fast Fourier transforms of a fixed power-of-two length, bundled so that the particle-mesh solver needs no external library.
+//
+// transform() is an in-place iterative radix-2 transform; the bit-reversal permutation and the twiddle factors are computed once per length.
+// The forward transform uses exp(-2 pi i j k / n) and neither direction is normalized, so a forward and an inverse transform multiply the
+// data by n.
+class Fft {
+public:
+    void setLength(std::size_t n); // Prepares the tables for transforms of length n (a power of two).
+    std::size_t getLength() const { return length; } // Returns the transform length.
+    void transform(std::complex<double>* data, bool inverse) const; // Transforms length contiguous values in place.
+
+private:
+    std::size_t length = 0;
+    std::vector<std::size_t> bitReversed;        // Index with its log2(length) bits reversed
+    std::vector<std::complex<double>> twiddles;  // exp(-2 pi i k / length) for k < length / 2
+};
+
+// Three-dimensional transforms of an n x n x n grid (x fastest: index (z * n + y) * n + x), as three passes of one-dimensional transforms
+// along x, y and z. A pass can be limited to the lines whose other two coordinates are below given bounds: zero-padded grids (the
+// free-space convolution of the particle-mesh solver) then skip the lines that hold only zeros, and the inverse transform skips the lines
+// whose results are not needed. The lines of a pass run in parallel, each worker copying its line into its own buffer.
+class Fft3d {
+public:
+    void setSize(std::size_t n); // Prepares transforms of n x n x n grids (n a power of two).
+    std::size_t getSize() const { return fft.getLength(); } // Returns the grid size along each axis.
+
+    // Transforms the lines along axis (0 = x, 1 = y, 2 = z) whose first other coordinate (y for x, x for y and z) is below limitA and
+    // whose second other coordinate (z for x and y, y for z) is below limitB.
+    void transformAxis(std::vector<std::complex<double>>& grid, int axis, std::size_t limitA, std::size_t limitB, bool inverse, ThreadPool& pool);
+    void transform(std::vector<std::complex<double>>& grid, bool inverse, ThreadPool& pool); // Transforms a whole grid along all three axes.
+
+private:
+    Fft fft;
+    std::vector<std::vector<std::complex<double>>> lines; // One line buffer per worker
+};
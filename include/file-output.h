@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string> // Required for std::string.
+
+// Writes text to a file through a temporary file (path + ".tmp") that is renamed into place, so a reader never sees a half-written file.
+// Returns false on failure. Callers that may write the same path from several threads must serialize their writes.
+bool writeFileAtomically(const std::string& path, const std::string& text);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "observables.h"    // Include the Observables struct definition.
+#include "checkpoint.h"     // Include the CheckpointWriter and CheckpointReader classes.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint8_t.
+#include <functional>       // Required for std::function.
+#include <vector>           // Required for using the std::vector container.
+
+// Selects the time integration scheme that Simulation::updateParticles() uses.
+enum class Integrator {
+    EULER,          // Semi-implicit Euler: v += a dt, then x += v dt (the scheme of Particle::update). One force evaluation per step.
+    LEAPFROG,       // Kick-drift leapfrog: velocities live at half steps. Symplectic, one force evaluation per step.
+    VELOCITY_VERLET, // Kick-drift-kick velocity Verlet: velocities at whole steps. Symplectic, one force evaluation per step (see below).
+    BLOCK_VERLET    // Velocity Verlet with hierarchical power-of-two block timesteps chosen per particle from its acceleration
+};
+
+// Computes forces for the integrator. A null mask means all particles; otherwise only the flagged particles get new forces (from all
+// particles as sources), and the forces of the others are left untouched.
+using ForceCallback = std::function<void(const std::vector<std::uint8_t>* isTarget)>;
+
+// Adds kickTime * F / m to every velocity, moves every position by driftTime * v, and zeroes every force, in one fused sweep.
+// With a non-null motion, the sweep also sums the kinetic energy and momentum of the new velocities into motion->kineticEnergy and
+// motion->momentum (the other fields are left alone), which saves a separate pass over the velocities.
+void kickDriftSweep(ParticleStore& particles, double kickTime, double driftTime, Observables* motion = nullptr);
+
+// Same as kickDriftSweep(), but only for the particles in [begin, end). Sweeps of disjoint ranges can run on different threads.
+void kickDriftSweep(ParticleStore& particles, std::size_t begin, std::size_t end, double kickTime, double driftTime, Observables* motion = nullptr);
+
+// Adds kickTime * F / m to every velocity. The forces are kept. motion works as in kickDriftSweep().
+void kickSweep(ParticleStore& particles, double kickTime, Observables* motion = nullptr);
+
+// Advances a particle store with the selected scheme.
+//
+// All schemes are built from the two sweeps above, which read the store's precomputed inverse masses instead of dividing by the mass.
+// Velocity Verlet needs the forces at the new positions to finish a step, so step() calls computeForces itself and leaves those forces in
+// the store; it returns true to tell the caller that the forces are already current for the next step and need not be recomputed.
+// Leapfrog stores v(t - dt/2): its first step kicks by half a step, and later steps kick by the mean of the previous and current step.
+//
+// Block timesteps: at the start of a step every particle picks a level L from its acceleration a, the smallest L with
+//   deltaTime / 2^L <= accuracy * sqrt(lengthScale / |a|),
+// capped at maxLevel. The step is then cut into 2^(finest level) ticks. A particle on level L is active every 2^(finest - L) ticks: it opens
+// its own velocity Verlet substep with a half kick, everyone drifts tick by tick, and when the substep ends only the active particles get
+// new forces and their closing half kick. A particle may move to a finer level whenever its substep ends, and to a coarser one only when
+// the end lines up with the coarser level's grid. All substeps end together at the end of the step, so the step ends with all forces current.
+class TimeIntegrator {
+public:
+    Integrator scheme = Integrator::EULER; // Scheme used by step()
+    static constexpr int maxSupportedLevel = 30; // Levels above this are clamped (a step never has more than 2^30 ticks)
+    int maxLevel = 8;          // Block timesteps: finest level (the smallest substep is deltaTime / 2^maxLevel)
+    double accuracy = 0.02;    // Block timesteps: dimensionless accuracy parameter (eta) of the level criterion
+    double lengthScale = 1e-5; // Block timesteps: length scale of the level criterion (m); the default is the force softening length
+
+    // Advances the store by deltaTime. The store must hold the forces at the current positions. Returns true if it holds the forces at the
+    // new positions afterwards (velocity Verlet and block timesteps), false if the forces were consumed and zeroed.
+    // With a non-null motion, the last velocity sweep of the step sets motion->kineticEnergy and motion->momentum from the stored velocities
+    // (for leapfrog these are the half-step velocities).
+    bool step(ParticleStore& particles, double deltaTime, const ForceCallback& computeForces, Observables* motion = nullptr);
+    bool isKickDrift() const { return scheme == Integrator::EULER || scheme == Integrator::LEAPFROG; } // Checks whether a step is a single kick-drift sweep (which can be split into particle ranges).
+    double beginKickDrift(double deltaTime); // Returns the kick time of a kick-drift step and advances the leapfrog state; the caller sweeps the particles.
+    void restart(); // Forgets the leapfrog half-step state (for example when velocities are set by hand or the scheme changes).
+    void save(CheckpointWriter& checkpoint) const; // Writes the scheme, its parameters and its state to a checkpoint.
+    bool load(CheckpointReader& checkpoint); // Restores the integrator from a checkpoint; returns false if the checkpoint is damaged.
+
+    int levelFor(double acceleration, double deltaTime) const; // Returns the block level for an acceleration magnitude.
+    const std::vector<std::uint8_t>& getLevels() const { return levels; } // Returns the level of each particle (block timesteps).
+    std::size_t getSubstepCount() const { return substeps; } // Returns the number of block substeps (ticks) taken so far.
+    std::size_t getTargetForceCount() const { return targetForces; } // Returns how many per-particle force evaluations the block substeps needed.
+
+private:
+    void blockStep(ParticleStore& particles, double deltaTime, const ForceCallback& computeForces, Observables* motion); // One step with block timesteps.
+
+    std::vector<std::uint8_t> levels;   // Block level of each particle
+    std::vector<std::uint8_t> isTarget; // Particles whose substep ends at the current tick
+    std::size_t substeps = 0;
+    std::size_t targetForces = 0;
+
+    bool staggered = false;        // Leapfrog: the stored velocities are half a step behind the positions
+    double previousDeltaTime = 0.0; // Leapfrog: step size of the previous step
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cmath>   // Required for std::sqrt and std::exp.
+#include <cstddef> // Required for std::size_t.
+#include <limits>  // Required for std::numeric_limits.
+#include <type_traits> // Required for std::decay_t.
+
+// Constants of the Coulomb interaction, shared by Particle::addForce() and the force solvers.
+constexpr double coulombConstant = 8.9875517873681764e9; // Coulomb's constant in N m^2/C^2
+constexpr double forceSoftening = 1e-10; // Small term added to squared distances to prevent division by zero
+
+// Force laws that the force solvers can be instantiated with.
+enum class InteractionModel {
+    COULOMB,        // Plain Coulomb, 1 / r^2 (the law of Particle::addForce)
+    YUKAWA,         // Screened Coulomb, exp(-r / lambda) / r potential
+    CUTOFF_COULOMB, // Coulomb inside a cutoff radius, nothing beyond it
+    NONE            // No interaction: the force solvers do no work at all
+};
+
+// Selects a force law and its parameters at run time. The solvers turn it into one of the policies below once per force computation.
+struct InteractionSettings {
+    InteractionModel model = InteractionModel::COULOMB; // Force law
+    double range = 1e-3;               // Screening length (YUKAWA) or cutoff radius (CUTOFF_COULOMB) in m; unused by the other models
+    double softening = forceSoftening; // Added to squared distances (m^2)
+};
+
+// Interaction policies.
+//
+// A policy describes one force law to the force solvers, which are instantiated per policy so that the law is compiled into their pair
+// loops (no virtual call or branch on the model per pair). Every policy has the same members:
+//   interacts       - false if there is no force at all; the solvers then skip all of their work.
+//   skipsNeutral    - true if the force is proportional to both charges, so neutral particles neither exert nor feel one; the solvers then
+//                     leave them out of their pair loops and trees entirely.
+//   shortRange      - true if S is zero beyond reach(); the tree solver then skips cells beyond it and never approximates a cell that
+//                     straddles it.
+//   coupling        - constant factor of the force (Coulomb's constant for the charge-weighted laws).
+//   pairScale(c, r2)   - c * S(r2), where the force on particle i from particle j is coupling * q_i * q_j * S(r2) * (r_j - r_i) and r2 is
+//                        the unsoftened squared distance. c carries the charges, so Coulomb keeps the single division of its kernels.
+//   farField(r2, s, d) - S(r2) and d = 2 dS/d(r2), which the tree solver needs for the monopole and dipole terms of a distant cell.
+//   reach()            - distance beyond which S is zero (infinity for long-range laws).
+// Like Particle::addForce, the force on particle i points along r_j - r_i for a positive product of charges.
+
+// Coulomb's law with a softened distance: S = 1 / (r2 + softening)^(3/2).
+struct CoulombInteraction {
+    static constexpr InteractionModel model = InteractionModel::COULOMB;
+    static constexpr bool interacts = true;
+    static constexpr bool skipsNeutral = true;
+    static constexpr bool shortRange = false;
+    static constexpr double coupling = coulombConstant;
+
+    double softening = forceSoftening; // Added to squared distances (m^2)
+
+    double pairScale(double charge, double r2) const {
+        const double distanceSquared = r2 + softening;
+        return charge / (distanceSquared * std::sqrt(distanceSquared));
+    }
+    void farField(double r2, double& scale, double& derivative) const {
+        const double invR = 1.0 / std::sqrt(r2 + softening);
+        scale = invR * invR * invR;
+        derivative = -3.0 * scale * invR * invR;
+    }
+    double reach() const { return std::numeric_limits<double>::infinity(); }
+};
+
+// Screened (Yukawa) Coulomb law with screening length lambda: S = exp(-r / lambda) (1 + r / lambda) / r^3, with r softened like Coulomb's.
+struct YukawaInteraction {
+    static constexpr InteractionModel model = InteractionModel::YUKAWA;
+    static constexpr bool interacts = true;
+    static constexpr bool skipsNeutral = true;
+    static constexpr bool shortRange = false;
+    static constexpr double coupling = coulombConstant;
+
+    double softening = forceSoftening;  // Added to squared distances (m^2)
+    double screeningLength = 1e-3;      // lambda (m)
+
+    double pairScale(double charge, double r2) const {
+        const double distanceSquared = r2 + softening;
+        const double distance = std::sqrt(distanceSquared);
+        const double x = distance / screeningLength;
+        return charge * std::exp(-x) * (1.0 + x) / (distanceSquared * distance);
+    }
+    void farField(double r2, double& scale, double& derivative) const {
+        const double distanceSquared = r2 + softening;
+        const double distance = std::sqrt(distanceSquared);
+        const double x = distance / screeningLength;
+        const double invR3 = 1.0 / (distanceSquared * distance);
+        const double screening = std::exp(-x);
+        scale = screening * (1.0 + x) * invR3;
+        derivative = -screening * (3.0 + 3.0 * x + x * x) * invR3 / distanceSquared;
+    }
+    double reach() const { return std::numeric_limits<double>::infinity(); }
+};
+
+// Coulomb's law truncated at a cutoff radius: S is Coulomb's inside the radius and zero beyond it.
+struct CutoffCoulombInteraction {
+    static constexpr InteractionModel model = InteractionModel::CUTOFF_COULOMB;
+    static constexpr bool interacts = true;
+    static constexpr bool skipsNeutral = true;
+    static constexpr bool shortRange = true;
+    static constexpr double coupling = coulombConstant;
+
+    double softening = forceSoftening; // Added to squared distances (m^2)
+    double cutoff = 1e-3;              // Pairs at least this far apart do not interact (m)
+
+    double pairScale(double charge, double r2) const {
+        const double distanceSquared = r2 + softening;
+        return r2 < cutoff * cutoff ? charge / (distanceSquared * std::sqrt(distanceSquared)) : 0.0;
+    }
+    void farField(double r2, double& scale, double& derivative) const {
+        const double invR = r2 < cutoff * cutoff ? 1.0 / std::sqrt(r2 + softening) : 0.0;
+        scale = invR * invR * invR;
+        derivative = -3.0 * scale * invR * invR;
+    }
+    double reach() const { return cutoff; }
+};
+
+// No interaction. The solvers return before touching any particle, so the forces stay as they were (zero after a reset).
+struct NoInteraction {
+    static constexpr InteractionModel model = InteractionModel::NONE;
+    static constexpr bool interacts = false;
+    static constexpr bool skipsNeutral = false;
+    static constexpr bool shortRange = false;
+    static constexpr double coupling = 0.0;
+
+    double pairScale(double, double) const { return 0.0; }
+    void farField(double, double& scale, double& derivative) const { scale = derivative = 0.0; }
+    double reach() const { return 0.0; }
+};
+
+// Builds the policy that settings describe and calls visit(policy) with it. This is the only place where the model is looked at at run
+// time; everything visit() instantiates is compiled for one policy.
+template <typename Visitor>
+void visitInteraction(const InteractionSettings& settings, Visitor&& visit) {
+    switch (settings.model) {
+        case InteractionModel::COULOMB:
+            visit(CoulombInteraction{settings.softening});
+            return;
+        case InteractionModel::YUKAWA:
+            visit(YukawaInteraction{settings.softening, settings.range});
+            return;
+        case InteractionModel::CUTOFF_COULOMB:
+            visit(CutoffCoulombInteraction{settings.softening, settings.range});
+            return;
+        case InteractionModel::NONE:
+            visit(NoInteraction{});
+            return;
+    }
+}
+
+// The compile-time flags of the policy that some settings select, for the code that prepares a solver's data outside the pair loops.
+struct InteractionTraits {
+    bool interacts;    // The policy's interacts
+    bool skipsNeutral; // The policy's skipsNeutral
+};
+
+// Returns the flags of the policy that settings select.
+inline InteractionTraits getInteractionTraits(const InteractionSettings& settings) {
+    InteractionTraits traits = {false, false};
+    visitInteraction(settings, [&](const auto& policy) {
+        using Policy = std::decay_t<decltype(policy)>;
+        traits = {Policy::interacts, Policy::skipsNeutral};
+    });
+    return traits;
+}
+
+// Adds the interaction between one target particle and a contiguous run of count source particles with a policy, applying Newton's third
+// law (the generic, compiler-vectorized counterpart of the Coulomb row kernels in coulomb-kernel.h). kqi is the coupling times the target's
+// charge; the total force on the target is added to targetForce[0..2] and the reactions are subtracted from fx, fy and fz.
+template <typename Policy>
+inline void interactionRow(const Policy& policy, double xi, double yi, double zi, double kqi,
+                           const double* x, const double* y, const double* z, const double* q,
+                           double* fx, double* fy, double* fz, std::size_t count, double targetForce[3]) {
+    double fxi = 0.0, fyi = 0.0, fzi = 0.0;
+    for (std::size_t j = 0; j < count; ++j) {
+        const double dx = x[j] - xi;
+        const double dy = y[j] - yi;
+        const double dz = z[j] - zi;
+        const double scale = policy.pairScale(kqi * q[j], dx*dx + dy*dy + dz*dz);
+        fxi += scale * dx;
+        fyi += scale * dy;
+        fzi += scale * dz;
+        fx[j] -= scale * dx;
+        fy[j] -= scale * dy;
+        fz[j] -= scale * dz;
+    }
+    targetForce[0] += fxi;
+    targetForce[1] += fyi;
+    targetForce[2] += fzi;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>       // Required for std::atomic.
+#include <condition_variable> // Required for std::condition_variable.
+#include <cstddef>      // Required for std::size_t.
+#include <cstdint>      // Required for the fixed-width integer types.
+#include <mutex>        // Required for std::mutex.
+#include <string>       // Required for std::string.
+#include <thread>       // Required for std::thread.
+#include <vector>       // Required for using the std::vector container.
+
+// Phases of a simulation step that are timed.
+enum class Phase {
+    FORCES,      // Force evaluation (Simulation::computeForces and the force evaluations inside an integrator step)
+    INTEGRATION, // Time integration (Simulation::updateParticles without the decays; includes the forces of velocity Verlet)
+    DECAY,       // Simulation::decayParticles
+    CREATION,    // Event generation
+    OUTPUT,      // Snapshot staging and checkpoint writing
+    REORDER,     // Space-filling-curve reordering of the particle store (including the disorder checks)
+    ANALYSIS,    // In-situ analysis stage (histogram filling after the decays of a step)
+    COUNT
+};
+
+// Event counters.
+enum class Counter {
+    PAIR_INTERACTIONS, // Pair interactions evaluated by the force solvers (particle-particle and, for Barnes-Hut, particle-cell)
+    DECAYS,            // Decays carried out, including cascades
+    PARTICLES_CREATED, // Particles added by creation, event generation and decays
+    PARTICLES_REMOVED, // Particles removed by decays
+    ALLOCATIONS,       // Reallocations of the particle store's columns (only these; other heap allocations are not counted)
+    BYTES_WRITTEN,     // Bytes written to snapshot and checkpoint files
+    COUNT
+};
+
+constexpr std::size_t phaseCount = static_cast<std::size_t>(Phase::COUNT);
+constexpr std::size_t counterCount = static_cast<std::size_t>(Counter::COUNT);
+
+const char* getPhaseName(Phase phase); // Returns the lower-case name of a phase (used in the exports).
+const char* getCounterName(Counter counter); // Returns the lower-case name of a counter (used in the exports).
+
+// Metrics of one thread. Only the owning thread writes them, so an update is a plain relaxed load and store (no lock, no atomic
+// read-modify-write); readers on other threads see a recent value.
+struct ThreadMetrics {
+    // One timed phase on the trace.
+    struct TraceEvent {
+        Phase phase;
+        std::uint64_t start;    // Nanoseconds since the process's metrics epoch
+        std::uint64_t duration; // Nanoseconds
+    };
+
+    std::size_t thread = 0; // Index of the thread, in order of first use
+    std::atomic<std::uint64_t> counters[counterCount] = {};
+    std::atomic<std::uint64_t> phaseCalls[phaseCount] = {};
+    std::atomic<std::uint64_t> phaseNanoseconds[phaseCount] = {};
+    std::vector<TraceEvent> trace; // Recorded only while tracing is on; read it only while the simulation is idle
+
+    // Adds amount to a counter.
+    void add(Counter counter, std::uint64_t amount) {
+        std::atomic<std::uint64_t>& value = counters[static_cast<std::size_t>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    void addPhase(Phase phase, std::uint64_t start, std::uint64_t duration); // Records one timed call of a phase.
+};
+
+ThreadMetrics& getThreadMetrics(); // Returns the calling thread's metrics (registered on first use; the only step that takes a lock).
+std::uint64_t getMetricsClock(); // Returns nanoseconds since the process's metrics epoch (a steady clock).
+
+// Times a phase from construction to destruction.
+class ScopedPhaseTimer {
+public:
+    explicit ScopedPhaseTimer(Phase phase) : phase(phase), start(getMetricsClock()) {}
+    ~ScopedPhaseTimer() { getThreadMetrics().addPhase(phase, start, getMetricsClock() - start); }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    Phase phase;
+    std::uint64_t start;
+};
+
+// Totals of all threads, plus each thread's own values (to spot load imbalance).
+struct MetricsSnapshot {
+    struct Values {
+        std::size_t thread = 0;
+        std::uint64_t counters[counterCount] = {};
+        std::uint64_t phaseCalls[phaseCount] = {};
+        std::uint64_t phaseNanoseconds[phaseCount] = {};
+    };
+
+    Values total;                // Sums over all threads (total.thread is unused)
+    std::vector<Values> threads; // One entry per thread that has recorded anything
+};
+
+MetricsSnapshot collectMetrics(); // Sums the metrics of all threads.
+void resetMetrics(); // Zeroes every thread's metrics and trace. Call it while the simulation is idle.
+bool areMetricsEnabled(); // Checks whether this build records metrics (it was built with PHYSICS_SIMULATION_METRICS).
+
+std::string formatMetricsJson(const MetricsSnapshot& metrics); // Formats metrics as a JSON object.
+std::string formatMetricsPrometheus(const MetricsSnapshot& metrics); // Formats metrics in the Prometheus text exposition format.
+
+void setTracing(bool enabled); // Starts or stops recording every timed phase for the Chrome trace.
+bool writeChromeTrace(const std::string& path); // Writes the recorded phases as Chrome trace events (chrome://tracing, Perfetto); returns false on failure. Call it while the simulation is idle.
+
+enum class MetricsFormat { JSON, PROMETHEUS };
+
+// Rewrites a metrics file at a fixed interval from a background thread, until it is destroyed (which writes the file one last time).
+// The file is written next to its final name and renamed into place, so a scraper never reads a half-written file.
+class PeriodicMetricsDump {
+public:
+    PeriodicMetricsDump(const std::string& path, double intervalSeconds, MetricsFormat format = MetricsFormat::PROMETHEUS);
+    ~PeriodicMetricsDump();
+
+    PeriodicMetricsDump(const PeriodicMetricsDump&) = delete;
+    PeriodicMetricsDump& operator=(const PeriodicMetricsDump&) = delete;
+
+    bool dump(); // Writes the file now; returns false on failure. Safe to call while the background thread is dumping.
+
+private:
+    std::string path;
+    double intervalSeconds;
+    MetricsFormat format;
+    bool stopping = false;
+    std::mutex mutex;
+    std::mutex writeMutex; // Serializes the writes of dump() (both write the same temporary file)
+    std::condition_variable wake;
+    std::thread dumpThread;
+};
+
+// Instrumentation macros. Without PHYSICS_SIMULATION_METRICS (CMake option ENABLE_METRICS=OFF) they compile to nothing.
+#ifdef PHYSICS_SIMULATION_METRICS
+#define METRICS_CONCATENATE_INNER(a, b) a##b
+#define METRICS_CONCATENATE(a, b) METRICS_CONCATENATE_INNER(a, b)
+#define METRICS_PHASE(phase) ScopedPhaseTimer METRICS_CONCATENATE(metricsPhaseTimer, __LINE__)(phase)
+#define METRICS_COUNT(counter, amount) getThreadMetrics().add(counter, static_cast<std::uint64_t>(amount))
+#define METRICS_REGISTER_THREAD() static_cast<void>(getThreadMetrics())
+#else
+#define METRICS_PHASE(phase) ((void)0)
+#define METRICS_COUNT(counter, amount) ((void)0)
+#define METRICS_REGISTER_THREAD() ((void)0)
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include <cstddef>          // Required for std::size_t.
+
+// Aggregate observables of a set of particles.
+// Simulation keeps one of these up to date as particles are created, moved and decayed, so reading it costs nothing per step.
+struct Observables {
+    std::size_t count = 0;        // Number of particles
+    double totalCharge = 0.0;     // Sum of the charges (e)
+    double totalLifetime = 0.0;   // Sum of the lifetimes (s)
+    double kineticEnergy = 0.0;   // Sum of m v^2 / 2
+    double momentum[3] = {0.0, 0.0, 0.0}; // Sum of m v
+
+    void add(double mass, double charge, double lifetime, double vx, double vy, double vz); // Adds one particle.
+    void remove(double mass, double charge, double lifetime, double vx, double vy, double vz); // Removes one particle.
+    Observables& operator+=(const Observables& other); // Adds the particles of another set.
+};
+
+// Measures the observables of the particles in [begin, end) of a store with a full scan.
+Observables measureObservables(const ParticleStore& particles, std::size_t begin, std::size_t end);
+
+// Measures the observables of every particle in a store with a full scan.
+inline Observables measureObservables(const ParticleStore& particles) {
+    return measureObservables(particles, 0, particles.size());
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "interaction.h"    // Include the interaction settings and policies.
+#include "thread-pool.h"    // Include the ThreadPool class definition.
+#include "checkpoint.h"     // Include the CheckpointWriter and CheckpointReader classes.
+#include "fft.h"            // Include the Fft3d class definition.
+#include <complex>          // Required for std::complex.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint8_t and std::uint32_t.
+#include <vector>           // Required for using the std::vector container.
+
+// Scheme that spreads a particle's charge over the nearest mesh nodes (and gathers the field back from the same nodes).
+enum class MeshAssignment {
+    CIC, // Cloud in cell: the 2 x 2 x 2 nodes around the particle, weights linear in the distance
+    TSC  // Triangular-shaped cloud: the 3 x 3 x 3 nodes around the nearest node, weights quadratic in the distance (smoother, less aliasing)
+};
+
+// Computes the Coulomb forces of Particle::addForce on a mesh (particle-mesh, PM), in O(N + M log M) for M mesh nodes, or with exact
+// short-range corrections (particle-particle particle-mesh, P3M).
+//
+// The Coulomb potential is split as 1 / r = erf(r / a) / r + erfc(r / a) / r, with a the splitting width (2 mesh cells). The smooth
+// first part is solved on the mesh: the charges are deposited on the nodes of a gridSize^3 mesh that spans the charged particles (CIC or
+// TSC), the potential is their convolution with the sampled smooth kernel, and the field is its fourth-order finite-difference gradient,
+// interpolated back to the particles with the same assignment. The convolution runs through FFTs of a grid padded to twice the mesh size
+// along each axis, with the kernel sampled at the wrapped separations, which gives the free-space (non-periodic) potential of an event
+// with no periodic images; the kernel's transform is divided by the squared transform of the assignment window, which the deposit and
+// the interpolation both apply. The transform of the kernel scales as 1 / cell size, so it is computed once per mesh size (and
+// assignment) and only rescaled when the mesh follows the particles.
+//
+// Plain PM resolves nothing below a few cells. With correctionCells > 0 (P3M), every pair closer than correctionCells mesh cells gets the
+// exact softened force of Particle::addForce minus the smooth part, found through a chaining mesh of cells at least that wide. The
+// short-range part of the pair force falls to 0.5% of the Coulomb force at 5 cells and to 0.05% at 6, so correctionCells of 5 to 6
+// gives forces within a few 1e-3 (RMS) of the all-pairs solver.
+//
+// Neutral particles neither deposit nor feel anything. The mesh solves Poisson's equation, so the solver only takes the Coulomb law (and
+// does nothing without an interaction); Simulation runs the other force laws on the Barnes-Hut solver instead. Each particle's force is a
+// sum over its own stencil and neighbors, so the result does not depend on the thread count.
+class ParticleMeshSolver {
+public:
+    std::size_t gridSize = 32;                       // Mesh nodes per axis (rounded up to a power of two, from 16 to maxGridSize)
+    static constexpr std::size_t maxGridSize = 512;  // Largest mesh used: its padded grid of (2 * 512)^3 complex values already takes 17 GB
+    MeshAssignment assignment = MeshAssignment::TSC; // Charge assignment and field interpolation scheme
+    double correctionCells = 0.0;                    // Radius of the exact short-range corrections in mesh cells (0 for plain PM)
+    InteractionSettings interaction;                 // Force law (only the Coulomb law is solved on the mesh)
+
+    void computeForces(ParticleStore& particles, ThreadPool& pool); // Solves the mesh and adds the forces to the force columns.
+    void computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool); // Same, but only for particles whose flag is set.
+    double getCellSize() const { return cellSize; } // Returns the mesh cell size of the last solve (m).
+
+    // Split force computation (for the task-graph step): prepareRanges() solves the mesh and bins the particles for the corrections, after
+    // which computeRange() can be called for disjoint ranges of store indices on any threads. It reads a particle's own position from the
+    // store and its neighbors' from the solver's copies, so other ranges' positions may change meanwhile. The forces are the same, bit for
+    // bit, as those of computeForces().
+    void prepareRanges(const ParticleStore& particles, ThreadPool& pool); // Solves the mesh and bins the particles.
+    void computeRange(ParticleStore& particles, std::size_t begin, std::size_t end) const; // Adds the forces of the particles in [begin, end).
+    void save(CheckpointWriter& checkpoint) const; // Writes the mesh parameters to a checkpoint.
+    bool load(CheckpointReader& checkpoint); // Restores the mesh parameters from a checkpoint; returns false if the checkpoint is damaged.
+
+private:
+    static constexpr double splittingCells = 2.0; // Splitting width a in mesh cells
+
+    bool prepare(const ParticleStore& particles, ThreadPool& pool); // Solves the mesh and bins the particles; returns false if nothing interacts.
+    bool placeMesh(const ParticleStore& particles); // Fits the mesh around the charged particles; returns false if nothing interacts.
+    void prepareKernel(ThreadPool& pool); // Computes the deconvolved transform of the smooth kernel for a mesh cell of 1 m (once per mesh size).
+    void depositCharges(const ParticleStore& particles); // Spreads the charges over the mesh nodes.
+    void solvePotential(ThreadPool& pool); // Convolves the charges with the kernel through the padded FFTs.
+    void differentiatePotential(ThreadPool& pool); // Computes the field at the nodes from the potential.
+    void binForCorrections(const ParticleStore& particles); // Bins the charged particles into the chaining mesh (counting sort).
+    void addForce(ParticleStore& particles, std::size_t i) const; // Adds the mesh force and the corrections of one particle.
+    void addCorrections(double xi, double yi, double zi, std::size_t self, double& gx, double& gy, double& gz) const; // Sums the short-range corrections at one position.
+
+    // Mesh
+    std::size_t meshSize = 0;              // Nodes per axis of the current mesh
+    double meshOrigin[3] = {0.0, 0.0, 0.0}; // Position of node (0, 0, 0)
+    double cellSize = 0.0;                 // Distance between nodes (m)
+    bool solved = false;                   // The last prepare() found at least two charged particles
+    Fft3d fft;                             // Transforms of the padded grid (2 meshSize per axis)
+    std::size_t kernelSize = 0;            // Mesh size that kernelTransform was computed for
+    MeshAssignment kernelAssignment = MeshAssignment::TSC; // Assignment scheme that kernelTransform was deconvolved for
+    std::vector<double> kernelTransform;   // Transform of the smooth kernel for a 1 m cell (real, as the kernel is even)
+    std::vector<std::complex<double>> padded; // Padded grid: charges, then their transform, then the potential
+    std::vector<double> potential;         // Potential at the mesh nodes (without Coulomb's constant)
+    std::vector<double> fieldX, fieldY, fieldZ; // Gradient of the potential at the mesh nodes
+
+    // Chaining mesh of the short-range corrections (see CellListSolver for the same counting sort)
+    double correctionRadius = 0.0;         // Pairs closer than this are corrected (m); zero for plain PM
+    double chainOrigin[3] = {0.0, 0.0, 0.0}; // Corner of the chaining mesh
+    double chainCellSize = 0.0;            // Edge length of a chaining cell (at least correctionRadius)
+    std::size_t chainDims[3] = {0, 0, 0};  // Number of chaining cells along each axis
+    std::vector<std::uint32_t> chainStart; // First sorted position of each chaining cell (one extra entry marks the end)
+    std::vector<std::uint32_t> chainCursor; // Scatter cursors of the counting sort
+    std::vector<std::uint32_t> chainOfParticle; // Chaining cell of each charged particle
+    std::vector<std::uint32_t> sortedIndex; // Store index of the particle at each sorted position
+    std::vector<double> sx, sy, sz, sq;    // Positions and charges in chaining-cell order
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "particle.h"   // Include the Particle class definition (used as the standalone particle record).
+#include <cstddef>      // Required for std::size_t.
+#include <cstdint>      // Required for std::uint32_t.
+#include <new>          // Required for aligned operator new and delete.
+#include <vector>       // Required for using the std::vector container.
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Allocator that returns storage aligned to a cache line, so that every column of the ParticleStore starts on a 64-byte boundary.
+// This lets the compiler use aligned vector loads and stores when it vectorizes loops over the columns.
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+// A std::vector whose buffer is cache-line aligned. Each column of the ParticleStore is one of these.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// Non-owning view of one 3D quantity (position, velocity or force) whose components live in three separate columns.
+// Indexing works like the double[3] arrays of Particle: v[0] is x, v[1] is y and v[2] is z.
+template <typename Scalar>
+struct Vec3Ref {
+    Scalar* components[3];
+    Scalar& operator[](std::size_t axis) const { return *components[axis]; }
+};
+
+// Non-owning, read-only view of one column (like a C++20 std::span). It stays valid until the column reallocates or shrinks.
+template <typename T>
+struct ColumnView {
+    const T* data = nullptr;
+    std::size_t count = 0;
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](std::size_t index) const { return data[index]; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+};
+
+// Non-owning, read-only view of the three position columns. positions.x[i], positions.y[i] and positions.z[i] are particle i's coordinates.
+struct PositionView {
+    ColumnView<double> x, y, z;
+
+    std::size_t size() const { return x.size(); }
+};
+
+// Lightweight proxy for one particle inside a ParticleStore.
+// It exposes the same fields as Particle, but each field is a reference into the store's columns, so reading or writing through it touches the store directly.
+// The mass is read-only through a proxy because the store keeps the inverse mass next to it (use ParticleStore::setMass()).
+template <typename Scalar, typename Type>
+struct BasicParticleRef {
+    Type& type;
+    const Scalar& mass;
+    Scalar& charge;
+    Scalar& lifetime;
+    Vec3Ref<Scalar> position;
+    Vec3Ref<Scalar> velocity;
+    Vec3Ref<Scalar> force;
+
+    bool isUnstable() const { return lifetime > 0; } // Same stability rule as Particle::isUnstable().
+};
+
+using ParticleRef = BasicParticleRef<double, ParticleType>;                  // Mutable view of a stored particle.
+using ConstParticleRef = BasicParticleRef<const double, const ParticleType>; // Read-only view of a stored particle.
+
+// Forward iterator over a ParticleStore. Dereferencing yields a proxy (by value) rather than a real reference.
+template <typename Store, typename Ref>
+class ParticleIterator {
+public:
+    ParticleIterator(Store* store, std::size_t index) : store(store), index(index) {}
+    Ref operator*() const { return (*store)[index]; }
+    ParticleIterator& operator++() { ++index; return *this; }
+    bool operator==(const ParticleIterator& other) const { return index == other.index; }
+    bool operator!=(const ParticleIterator& other) const { return index != other.index; }
+
+private:
+    Store* store;
+    std::size_t index;
+};
+
+// Stores all particles of a simulation in a structure-of-arrays layout.
+// Every property lives in its own contiguous, aligned column, so loops that only need a few properties (positions and charges for forces,
+// or forces, masses, velocities and positions for integration) stream through exactly the memory they use.
+class ParticleStore {
+public:
+    AlignedVector<std::uint64_t> id;  // Identifier of each particle, unique within the store (keys its random numbers)
+    AlignedVector<ParticleType> type; // Type of each particle
+    AlignedVector<double> mass;       // Mass of each particle (GeV/c^2)
+    AlignedVector<double> inverseMass; // 1 / mass of each particle, kept in step with the mass column so integrators multiply instead of divide
+    AlignedVector<double> charge;     // Charge of each particle (e)
+    AlignedVector<double> lifetime;   // Lifetime of each particle (s); zero for stable particles
+    AlignedVector<double> x, y, z;    // Position components (m)
+    AlignedVector<double> vx, vy, vz; // Velocity components
+    AlignedVector<double> fx, fy, fz; // Net force components (N)
+
+    using iterator = ParticleIterator<ParticleStore, ParticleRef>;
+    using const_iterator = ParticleIterator<const ParticleStore, ConstParticleRef>;
+
+    std::size_t size() const { return type.size(); } // Returns the number of stored particles.
+    bool empty() const { return type.empty(); } // Checks whether the store holds no particles.
+    std::size_t capacity() const { return type.capacity(); } // Returns how many particles fit before the columns reallocate.
+    void reserve(std::size_t count); // Reserves room for count particles in every column.
+    void ensureCapacity(std::size_t count); // Grows the capacity (at least doubling it) if fewer than count particles fit.
+    void clear(); // Removes all particles (capacity is kept) and restarts the particle ids at 0.
+    void resize(std::size_t count); // Shrinks or grows every column to count particles (new particles are zero-initialized and get fresh ids).
+    std::uint64_t getNextId() const { return nextId; } // Returns the id that the next added particle will get.
+    PositionView positions() const { return {view(x), view(y), view(z)}; } // Returns a view of the position columns (no copy).
+    template <typename T>
+    ColumnView<T> view(const AlignedVector<T>& column) const { return {column.data(), column.size()}; } // Returns a view of one of this store's columns.
+
+    void push_back(const Particle& particle); // Appends a copy of a standalone particle record.
+    void emplace_back(ParticleType type, double mass, double charge, double lifetime,
+                      double x, double y, double z, double vx, double vy, double vz); // Appends a particle from its fields (no Particle record is built), with zero force.
+    void removeIndices(const std::vector<std::uint32_t>& sortedIndices); // Removes the particles at the given (ascending) indices in one compaction pass, keeping the order of the rest.
+    void permute(const std::vector<std::uint32_t>& order); // Reorders every column so that the particle at index k is the one that was at order[k] (order is a permutation).
+    void setMass(std::size_t index, double mass); // Changes the mass of the particle at index (and its inverse mass).
+    Particle get(std::size_t index) const; // Returns a standalone copy of the stored particle at index.
+    void resetForces(); // Resets the net force on every particle to zero.
+    void update(double deltaTime); // Advances every particle by deltaTime (same Euler scheme as Particle::update), as one fused sweep over the columns.
+    void save(CheckpointWriter& checkpoint) const; // Writes every column and the next id to a checkpoint.
+    bool load(CheckpointReader& checkpoint); // Restores the store from a checkpoint; returns false if the checkpoint is damaged.
+
+    ParticleRef operator[](std::size_t index);
+    ConstParticleRef operator[](std::size_t index) const;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    std::uint64_t nextId = 0; // Id of the next added particle (ids are handed out in insertion order and never reused)
+
+    // Spare columns of permute(): each column is gathered into the spare of its type and swapped with it, so the spares keep the
+    // previous buffers and a permutation does not allocate once they have grown.
+    AlignedVector<std::uint64_t> spareIds;
+    AlignedVector<ParticleType> spareTypes;
+    AlignedVector<double> spareValues;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <vector>   // Required for using the std::vector container.
+#include <cstddef>       // Required for std::size_t.
+#include "interaction.h" // Include the Coulomb constants and the interaction policies.
 
 // Defines the types of particles in the simulation.
 // These are a few common hadrons that are significant for heavy ion collision studies.
@@ -13,12 +14,26 @@ enum class ParticleType {
     PROTON
 };
 
+constexpr std::size_t particleTypeCount = 6; // Number of entries in ParticleType
+
 // Represents a decay mode.
 struct DecayMode {
     ParticleType productType; // Type of decay product
     double branchingRatio;    // Probability of this decay mode
 };
 
+// Read-only view of a particle type's decay modes. The modes themselves live in the species registry (species.h) and are shared by every particle of the type.
+struct DecayModeList {
+    const DecayMode* modes = nullptr;
+    std::size_t count = 0;
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+    const DecayMode& operator[](std::size_t index) const { return modes[index]; }
+    const DecayMode* begin() const { return modes; }
+    const DecayMode* end() const { return modes + count; }
+};
+
 // Represents a particle in the simulation.
 class Particle {
 public:
@@ -26,7 +41,7 @@ public:
     double mass;           // Mass of the particle in electronvolts (GeV/c^2)
     double charge;         // Charge of the particle in elementary charge units (e)
     double lifetime;       // Lifetime of the particle in seconds (s), relevant for unstable particles
-    std::vector<DecayMode> decayModes; // Possible decay modes, relevant for unstable particles
+    DecayModeList decayModes; // Possible decay modes, relevant for unstable particles (a view into the species registry, so no per-particle allocation)
     double position[3];    // Position of the particle in 3D space (x, y, z), in meters (m), relative to an origin point in the simulated 3D space (0, 0, 0)
     double velocity[3];    // Velocity of the particle in 3D space (vx, vy, vz)
     double force[3];       // Net force acting on the particle (fx, fy, fz), in newtons (N)
@@ -39,7 +54,28 @@ public:
 
     void resetForce(); // Resets the net force on the particle to zero.
     void setDecayModes(); // Sets two possible decay modes for each particle type. (This is simplified for the purposes of this simulation).
+    static DecayModeList decayModesFor(ParticleType type); // Returns the decay modes of a particle type (empty for stable types).
     void addForce(Particle &other); // Calculates and adds the electromagnetic force exerted by another particle.
+    template <typename Policy>
+    void addForce(Particle& other, const Policy& policy); // Same, for any interaction policy (see interaction.h).
     void update(double deltaTime); // Updates the particle's state based on the net force acting on it and the elapsed time.
     bool isUnstable() const { return lifetime > 0; } // Checks the particle's lifetime property to determine if the particle is unstable and subject to decay.
-};
\ No newline at end of file
+};
+
+// Adds the force of an interaction policy between this particle and another, applying Newton's third law like addForce(Particle&).
+template <typename Policy>
+void Particle::addForce(Particle& other, const Policy& policy) {
+    if (!Policy::interacts) {
+        return;
+    }
+    const double dx = other.position[0] - position[0];
+    const double dy = other.position[1] - position[1];
+    const double dz = other.position[2] - position[2];
+    const double scale = policy.pairScale(Policy::coupling * charge * other.charge, dx*dx + dy*dy + dz*dz);
+    force[0] += scale * dx;
+    force[1] += scale * dy;
+    force[2] += scale * dz;
+    other.force[0] -= scale * dx;
+    other.force[1] -= scale * dy;
+    other.force[2] -= scale * dz;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "integrator.h"  // Include the Integrator enum.
+#include "interaction.h" // Include the InteractionModel enum.
+#include "simulation.h"  // Include the ForceSolver, ForcePrecision and MeshAssignment enums and the Simulation class definition.
+#include <cstddef>       // Required for std::size_t.
+#include <cstdint>       // Required for std::uint32_t.
+#include <ostream>       // Required for std::ostream.
+#include <string>        // Required for std::string.
+
+// Describes one run of the driver executable: which events to simulate, how, and where the results go.
+// Every field can be set from a config file ("key = value" lines) or from a command-line option ("--key value" or "--key=value") of the same name.
+struct RunConfig {
+    std::size_t events = 1;            // Number of events, simulated one after the other (event ids 0 to events - 1)
+    std::size_t steps = 100;           // Steps per event
+    double deltaTime = 1e-12;          // Time step (s)
+    double multiplicity = 1000.0;      // Mean number of particles per event (Poisson distributed)
+    ForceSolver solver = ForceSolver::BARNES_HUT; // Force algorithm
+    Integrator integrator = Integrator::LEAPFROG;  // Time integration scheme
+    InteractionModel interaction = InteractionModel::COULOMB; // Force law
+    double range = 1e-3;               // Screening length (yukawa) or cutoff radius (cutoff) of the force law (m)
+    ForcePrecision precision = ForcePrecision::DOUBLE; // Precision of the all-pairs Coulomb forces
+    double openingAngle = 0.5;         // Opening angle of the Barnes-Hut solver
+    double cutoff = 1e-3;              // Cutoff radius of the cell-list solver (m)
+    double skin = 0.0;                 // Verlet skin distance of the cell-list solver (0 disables neighbor-list reuse)
+    std::size_t meshSize = 32;         // Nodes per axis of the particle-mesh solver (rounded up to a power of two, at least 16)
+    double correctionCells = 0.0;      // Radius of the particle-mesh solver's exact short-range corrections in mesh cells (0 for plain PM)
+    MeshAssignment assignment = MeshAssignment::TSC; // Charge assignment scheme of the particle-mesh solver
+    std::size_t reorderInterval = 0;   // Steps between Morton reorders of the particles (0 for none)
+    double reorderDisorder = 0.25;     // Disorder above which the particles are reordered (0 for never)
+    std::size_t threads = 0;           // Worker threads (0 means one per hardware thread)
+    std::uint32_t seed = 0;            // Seed of the random number generator
+    std::string output;                // Snapshot file (empty for none); with several events, one file per event
+    std::size_t snapshotInterval = 10; // Steps between snapshots
+    std::size_t progressInterval = 10; // Steps between progress lines
+    std::string metricsPath;           // Metrics file rewritten during the run (empty for none); JSON if it ends in ".json", else Prometheus
+    double metricsInterval = 10.0;     // Seconds between rewrites of the metrics file
+    std::string tracePath;             // Chrome trace of every timed phase, written at the end of the run (empty for none)
+    std::string analysisPath;          // In-situ analysis results file, written at the end of the run (empty for no analysis)
+    std::size_t analysisInterval = 10; // Steps between the analysis' histogram fills
+};
+
+bool setRunOption(RunConfig& config, const std::string& key, const std::string& value, std::string& error); // Sets one field by its option name; returns false (with a message) for unknown keys or bad values.
+bool loadRunConfigFile(const std::string& path, RunConfig& config, std::string& error); // Applies the "key = value" lines of a config file; returns false (with a message) on the first bad line.
+bool parseRunArguments(int argc, const char* const argv[], RunConfig& config, bool& showHelp, std::string& error); // Applies command-line options in order (a --config file applies where it appears).
+std::string getRunUsage(); // Returns the help text listing every option.
+std::string getEventOutputPath(const std::string& output, std::size_t event, std::size_t eventCount); // Returns the snapshot file of one event.
+bool runSimulations(const RunConfig& config, std::ostream& log); // Runs every event of a configuration, reporting progress to log; returns false if an output file fails.
@@ -1,23 +1,119 @@
 #pragma once
 
 #include "particle.h"   // Include the Particle class definition.
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "all-pairs.h"  // Include the AllPairsSolver class definition.
+#include "analysis.h"   // Include the InSituAnalysis class definition.
+#include "barnes-hut.h" // Include the BarnesHutSolver class definition.
+#include "cell-list.h"  // Include the CellListSolver class definition.
+#include "particle-mesh.h" // Include the ParticleMeshSolver class definition.
+#include "decay.h"      // Include the DecayEngine class definition.
+#include "event-generator.h" // Include the EventGenerator class definition.
+#include "integrator.h" // Include the Integrator enum and the TimeIntegrator class definition.
+#include "observables.h" // Include the Observables struct definition.
+#include "spatial-sort.h" // Include the SpatialSorter class definition.
+#include "thread-pool.h" // Include the ThreadPool class definition.
+#include "task-graph.h" // Include the TaskGraph class definition.
+#include <memory>       // Required for std::shared_ptr.
 #include <vector>       // Required for using the std::vector container.
-#include <random>       // Required for using std::default_random_engine.
+#include "counter-rng.h" // Include the CounterRng class definition.
+#include <cstdint>      // Required for std::uint32_t and std::uint64_t.
 #include <tuple>        // Required for using std::tuple.
+#include <string>       // Required for std::string.
+
+class SnapshotWriter;
+
+// Selects the algorithm that Simulation::computeForces() uses.
+enum class ForceSolver {
+    ALL_PAIRS,  // Exact sum over every pair of particles, O(N^2)
+    BARNES_HUT, // Octree approximation with a tunable opening angle, O(N log N)
+    CELL_LIST,  // Short-range interaction within a cutoff radius on a uniform grid, O(N)
+    PARTICLE_MESH // Coulomb forces from an FFT Poisson solve on a mesh (PM), optionally with exact short-range corrections (P3M), O(N + M log M)
+};
 
 // Manages the simulation of particles, including force calculation and state updates.
 class Simulation {
 public:
-    std::vector<Particle> particles; // Container for all particles in the simulation
+    ParticleStore particles; // Container for all particles in the simulation (structure-of-arrays layout)
     void simulateCollision(); // Simulates a collision that generates a set number of particles.
-    void computeForces(); // Computes the forces between all pairs of particles.
+    size_t generateEvent(const EventGenerator& eventGenerator); // Appends a whole collision event in one bulk operation; returns its number of particles.
+    void setSeed(std::uint32_t seed); // Sets the seed of the random number generator (used for velocities, events and decays).
+    void setEventId(std::uint32_t event); // Sets the event id, which keys the random numbers together with the seed.
+    void startEvent(std::uint32_t event); // Empties the simulation for the next event, keeping every buffer's capacity.
+    void computeForces(); // Computes the forces between all pairs of particles (always; call it after writing particles' columns directly).
+    void setIntegrator(Integrator integrator); // Selects the time integration scheme used by updateParticles().
+    void setBlockTimesteps(int maxLevel, double accuracy = 0.02, double lengthScale = 1e-5); // Configures the block timesteps of the BLOCK_VERLET scheme.
+    const TimeIntegrator& getTimeIntegrator() const { return timeIntegrator; } // Returns the integrator (levels and substep statistics).
+    void setThreadCount(size_t threadCount); // Sets how many threads the force computation uses (0 means one per hardware thread).
+    void setForceSolver(ForceSolver solver); // Selects the force algorithm used by computeForces().
+    void setOpeningAngle(double theta); // Sets the opening angle of the Barnes-Hut solver (clamped to [0, 1]).
+    void setCutoff(double cutoff, double cellSize = 0.0); // Sets the cutoff radius and grid cell size of the cell-list solver (a cell size of 0 uses the cutoff); invalid values are ignored.
+    void setParticleMesh(size_t gridSize, double correctionCells = 0.0, MeshAssignment assignment = MeshAssignment::TSC); // Configures the particle-mesh solver (correction radius in mesh cells, 0 for plain PM).
+    void setNeighborListSkin(double skin); // Sets the Verlet skin distance of the cell-list solver (0 disables neighbor-list reuse).
+    void setReorder(size_t interval, double disorderThreshold = 0.0); // Sorts the particles into Morton order every interval steps and whenever their disorder exceeds the threshold (0 disables either).
+    void reorderParticles(); // Sorts the particles into Morton order now (ids and forces move with them).
+    size_t getReorderCount() const { return spatialSorter.getReorderCount(); } // Returns the number of reorders carried out so far.
+    void setAnalysis(InSituAnalysis* analysis, size_t interval = 1); // Attaches an in-situ analysis that is filled every interval steps (null detaches it; the caller keeps ownership).
+    void setInteraction(const InteractionSettings& interaction); // Selects the force law (and its range) of every force solver.
+    const InteractionSettings& getInteraction() const { return allPairsSolver.interaction; } // Returns the force law of the force solvers.
+    void setForcePrecision(ForcePrecision precision); // Selects double or mixed (float pair kernel) precision for the all-pairs Coulomb forces.
+    ForcePrecision getForcePrecision() const { return allPairsSolver.precision; } // Returns the precision of the all-pairs Coulomb forces.
     size_t getParticleCount(); // Returns the number of particles in the simulation.
-    std::vector<std::tuple<double, double, double>> getParticlePositions() const; // Returns the position of each particle in the simulation as vectors of triples.
+    std::vector<std::tuple<double, double, double>> getParticlePositions() const; // Returns a copy of the position of each particle as triples (per-step analysis should use getPositionView()).
+    PositionView getPositionView() const { return particles.positions(); } // Returns a view of the position columns (no copy).
+    ColumnView<double> getLifetimes() const { return particles.view(particles.lifetime); } // Returns a view of the lifetime column (no copy).
+    ColumnView<double> getCharges() const { return particles.view(particles.charge); } // Returns a view of the charge column (no copy).
     double getTotalLifetime() const; // Returns the sum of all particle lifetimes in the simulation.
+    const Observables& getObservables() const; // Returns the aggregate observables (count, charge, lifetime, kinetic energy, momentum) without a scan or any write.
+    void refreshObservables(); // Re-measures the observables with a full scan (needed after particles are added, removed or changed directly through the store).
     void updateParticles(double deltaTime); // Updates the state of all particles based on the computed forces and decay properties.
     void decayParticles(double deltaTime); // Checks for unstable particles and handles their decay.
+    void run(size_t steps, double deltaTime, SnapshotWriter* snapshots = nullptr, size_t snapshotInterval = 1); // Runs whole steps as task graphs over particle chunks, optionally writing snapshots every snapshotInterval steps (0 counts as 1; reuses forces left current by the previous step or computeForces()).
+    size_t getDecayCount() const { return decayCount; } // Returns the number of decays carried out so far.
+    void createParticle(ParticleType type); // Creates a particle of a given type with the mass, charge and lifetime from the species registry.
     void createParticle(ParticleType type, double mass, double charge, double lifetime, double x, double y, double z); // Creates a particle and adds it to the simulation.
+    bool saveCheckpoint(const std::string& path, bool compress = false) const; // Writes the whole simulation state to one checkpoint file; returns false on failure.
+    bool loadCheckpoint(const std::string& path); // Restores the state written by saveCheckpoint(); returns false (leaving the simulation unchanged) on failure.
 
 private:
-    std::default_random_engine generator; // Used for generating random numbers (for particle velocities or positions).
+    CounterRng rng; // Counter-based random numbers, keyed by (seed, event id, particle id, step)
+    std::uint64_t step = 0; // Number of decay steps carried out so far (the step part of the random key)
+    std::shared_ptr<ThreadPool> threadPool; // Worker threads for the force computation (created on first use)
+    ForceSolver forceSolver = ForceSolver::ALL_PAIRS; // Algorithm used by computeForces()
+    AllPairsSolver allPairsSolver; // Exact, tiled all-pairs force solver
+    BarnesHutSolver barnesHutSolver; // Approximate octree force solver
+    CellListSolver cellListSolver; // Short-range cutoff force solver
+    ParticleMeshSolver meshSolver; // Mesh (PM/P3M) Coulomb force solver
+    ForceSolver getActiveSolver() const; // Returns the solver that actually runs (the mesh solver hands the other force laws to Barnes-Hut).
+    DecayEngine decayEngine; // Monte Carlo decay stage
+    SpatialSorter spatialSorter; // Space-filling-curve reordering stage
+    size_t decayCount = 0; // Number of decays carried out so far
+    TimeIntegrator timeIntegrator; // Time integration scheme and its state
+    InSituAnalysis* analysis = nullptr; // In-situ analysis stage, or null if none is attached (not owned)
+    size_t analysisInterval = 1; // Steps between the analysis fills
+    bool forcesCurrent = false; // The force columns hold the forces at the current positions (left by a velocity Verlet step)
+    Observables observables; // Aggregate observables, updated by every creation, step and decay
+
+    // Task-graph steps (run())
+    static const size_t particlesPerChunk = 2048; // Particles per chunk: the unit of work of the force, integration and decay tasks
+    // Parameters of the step that the graph is running. The tasks read them, so the graph itself only changes with the chunk count.
+    struct ScheduledStep {
+        size_t count = 0;                  // Number of particles
+        double deltaTime = 0.0;            // Step size
+        double kickTime = 0.0;             // Kick time of the integrator's kick-drift sweep
+        bool computeForces = false;        // The force tasks compute the forces (false if they are already current or were computed up front)
+        SnapshotWriter* snapshot = nullptr; // Writer of the previous step's frame, or null if there is none
+        double snapshotTime = 0.0;         // Time of that frame
+    };
+    ScheduledStep scheduled;
+    TaskGraph stepGraph;                   // Snapshot, force, integration and decay tasks of one step
+    size_t graphChunks = 0;                // Chunk count that stepGraph was built for
+    std::vector<Observables> chunkMotion;  // Kinetic energy and momentum measured by each chunk's integration task
+
+    ThreadPool& pool(); // Returns the thread pool, creating it with one thread per hardware thread if none was set.
+    void evaluateForces(const std::vector<std::uint8_t>* isTarget = nullptr); // Clears and computes the forces of all (or only the flagged) particles.
+    void buildStepGraph(size_t chunkCount); // Builds the task graph of a step over chunkCount particle chunks.
+    void runScheduledStep(); // Runs one kick-drift step (set up in scheduled) through the task graph.
+    void reorderIfNeeded(); // Runs the reordering stage at the end of a step.
+    void analyzeStep(); // Runs the in-situ analysis stage after the decays of a step.
 };
\ No newline at end of file
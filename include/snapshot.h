@@ -0,0 +1,94 @@
+#pragma once
+
+#include "particle-store.h"   // Include the ParticleStore class definition.
+#include <condition_variable> // Required for std::condition_variable.
+#include <cstddef>            // Required for std::size_t.
+#include <cstdint>            // Required for the fixed-width integer types.
+#include <cstdio>             // Required for std::FILE.
+#include <deque>              // Required for std::deque.
+#include <mutex>              // Required for std::mutex.
+#include <string>             // Required for std::string.
+#include <thread>             // Required for std::thread.
+#include <vector>             // Required for using the std::vector container.
+
+// Binary snapshot files.
+//
+// A file starts with a 16-byte header (the magic "PSIMSNAP", a format version and the header size) followed by frames. Each frame is a
+// 48-byte frame header (magic, frame index, particle count, simulation time, frame size in bytes) followed by its columns:
+//   id (uint64) | x | y | z | vx | vy | vz (double) | type (uint8, padded to 8 bytes)
+// Every column starts on an 8-byte boundary, so a memory-mapped file can be read in place. Values are stored in native byte order.
+constexpr char snapshotMagic[8] = {'P', 'S', 'I', 'M', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t snapshotVersion = 1;
+
+// Read-only view of one frame of a memory-mapped snapshot file. The pointers stay valid as long as the reader lives.
+struct SnapshotFrame {
+    std::uint64_t index = 0;          // Frame index (0 for the first frame written)
+    double time = 0.0;                // Simulation time of the frame
+    std::size_t count = 0;            // Number of particles
+    const std::uint64_t* id = nullptr; // Particle ids
+    const std::uint8_t* type = nullptr; // Particle types (ParticleType values)
+    const double* x = nullptr;
+    const double* y = nullptr;
+    const double* z = nullptr;
+    const double* vx = nullptr;
+    const double* vy = nullptr;
+    const double* vz = nullptr;
+};
+
+// Appends snapshot frames to a file from a background I/O thread.
+//
+// write() only copies the store's columns into a staging buffer and returns; the I/O thread writes the buffer while the simulation goes on.
+// There are two staging buffers, so write() only waits if the disk has fallen a whole frame behind. The buffers keep their capacity, so in
+// steady state writing a frame does not allocate.
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter(); // Writes the remaining frames and closes the file.
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool open(const std::string& path); // Creates (or truncates) the file, writes its header and starts the I/O thread; returns false on failure.
+    bool isOpen() const { return file != nullptr; } // Checks whether a file is open.
+    bool close(); // Writes the remaining frames and closes the file; returns false if any write failed.
+    void write(const ParticleStore& particles, double time); // Stages one frame with the store's current state (the writer must be open).
+    bool flush(); // Waits until all staged frames are on disk; returns false if any write failed.
+    std::uint64_t getFrameCount() const { return nextFrame; } // Returns the number of frames staged so far.
+
+private:
+    void ioLoop(); // Writes ready buffers until the writer is destroyed.
+
+    std::FILE* file = nullptr;
+    std::vector<char> buffers[2];  // Staging buffers
+    bool busy[2] = {false, false}; // A buffer is busy from the moment it is staged until the I/O thread has written it
+    std::deque<int> ready;         // Staged buffers in frame order
+    int nextBuffer = 0;            // Buffer that the next frame is staged into
+    std::uint64_t nextFrame = 0;   // Index of the next frame
+    bool failed = false;           // A write failed
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable bufferReady; // Signalled when a buffer is staged or the writer shuts down
+    std::condition_variable bufferFree;  // Signalled when the I/O thread has written a buffer
+    std::thread ioThread;
+};
+
+// Memory-maps a snapshot file for random access to its frames.
+// A frame that was cut off (for example by a crash while writing) and everything after it are ignored.
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader(); // Unmaps the file.
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& path); // Maps the file and indexes its frames; returns false if it cannot be mapped or is not a snapshot file.
+    void close(); // Unmaps the file.
+    std::size_t getFrameCount() const { return frameOffsets.size(); } // Returns the number of complete frames.
+    SnapshotFrame getFrame(std::size_t index) const; // Returns a view of a frame (no data is copied), or an empty frame for an index out of range.
+
+private:
+    const char* data = nullptr; // Start of the mapping
+    std::size_t size = 0;       // Size of the mapping in bytes
+    std::vector<std::size_t> frameOffsets; // Byte offset of every frame
+};
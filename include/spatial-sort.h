@@ -0,0 +1,44 @@
+#pragma once
+
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "checkpoint.h"     // Include the CheckpointWriter and CheckpointReader classes.
+#include <cstddef>          // Required for std::size_t.
+#include <cstdint>          // Required for std::uint32_t and std::uint64_t.
+#include <vector>           // Required for using the std::vector container.
+
+std::uint64_t getMortonKey(std::uint32_t cx, std::uint32_t cy, std::uint32_t cz); // Interleaves three 21-bit cell coordinates into a 63-bit Morton (Z-order) key.
+
+// Keeps the particle store in space-filling-curve order.
+//
+// Particles are stored in creation order, with decay products appended at the end, so once they spread out, particles that are close in
+// space sit far apart in memory and the force passes miss the cache. A reorder gives every particle the Morton key of its cell in a 2^21
+// grid over the bounding cube, sorts the keys with a stable radix sort and permutes the whole store into key order (ParticleStore::permute()).
+// Particles keep their ids, which key their random numbers and are written to every snapshot frame, so decays and analysis do not depend
+// on the storage order; getLastOrder() gives callers the permutation for any per-particle state of their own.
+//
+// A reorder runs every interval steps, and whenever the disorder (the fraction of adjacent stored particles whose keys are out of order:
+// 0 right after a reorder, about 1/2 for a random order) exceeds disorderThreshold. Both triggers are off by default. The key and order
+// buffers keep their capacity, so reorders do not allocate once they have grown.
+class SpatialSorter {
+public:
+    std::size_t interval = 0;       // Steps between reorders (0 disables the periodic reorder)
+    double disorderThreshold = 0.0; // Reorder when the disorder exceeds this (0 disables the check)
+
+    bool isEnabled() const { return interval > 0 || disorderThreshold > 0.0; } // Checks whether either trigger is on.
+    bool reorderIfNeeded(ParticleStore& particles, std::uint64_t step); // Reorders if step is a multiple of interval or the store is too disordered; returns true if it did.
+    void reorder(ParticleStore& particles); // Sorts the store into Morton order.
+    double measureDisorder(const ParticleStore& particles); // Returns the fraction of adjacent particles whose keys are out of order.
+    const std::vector<std::uint32_t>& getLastOrder() const { return order; } // Returns the previous index of each particle after the last reorder.
+    std::size_t getReorderCount() const { return reorders; } // Returns the number of reorders so far.
+    void save(CheckpointWriter& checkpoint) const; // Writes the triggers and the reorder count to a checkpoint.
+    bool load(CheckpointReader& checkpoint); // Restores the sorter from a checkpoint; returns false if the checkpoint is damaged.
+
+private:
+    void computeKeys(const ParticleStore& particles); // Computes the Morton key of every particle over the current bounding cube.
+    double disorderOfKeys() const; // Returns the disorder of the computed keys.
+    void sortByKeys(ParticleStore& particles); // Radix-sorts the computed keys and permutes the store into their order.
+
+    std::vector<std::uint64_t> keys, spareKeys;   // Morton key of each particle (and the radix sort's second buffer)
+    std::vector<std::uint32_t> order, spareOrder; // Store index of each sorted position (and the radix sort's second buffer)
+    std::size_t reorders = 0;
+};
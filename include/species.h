@@ -0,0 +1,39 @@
+#pragma once
+
+#include "particle.h"   // Include the ParticleType and DecayMode definitions.
+#include <cstddef>      // Required for std::size_t.
+
+// Everything that is shared by all particles of one type: its physical properties and its decay modes.
+struct SpeciesInfo {
+    const char* name;          // Human-readable name
+    double mass;               // Mass in electronvolts (GeV/c^2)
+    double charge;             // Charge in elementary charge units (e)
+    double lifetime;           // Mean lifetime in seconds (s); zero for stable types
+    DecayMode decayModes[2];   // Decay modes (only the first decayModeCount entries are used)
+    std::size_t decayModeCount;  // Number of decay modes
+
+    constexpr DecayModeList decayModeList() const { return DecayModeList{decayModes, decayModeCount}; } // Returns a view of the decay modes.
+};
+
+// Compile-time registry of all particle species, indexed by ParticleType.
+// In a true particle physics context, decay modes are quite varied and dependent on many factors.
+// For simplicity, I will choose two representative decay modes per unstable type.
+inline constexpr SpeciesInfo speciesRegistry[] = {
+    {"Pion (+)", 0.13957, +1.0, 2.6e-8,  {{ParticleType::KAON_POSITIVE, 0.2},  {ParticleType::PROTON, 0.1}},        2}, // PION_POSITIVE
+    {"Pion (-)", 0.13957, -1.0, 2.6e-8,  {{ParticleType::KAON_NEGATIVE, 0.2},  {ParticleType::PROTON, 0.1}},        2}, // PION_NEGATIVE
+    // In reality, neutral pions decay into photons, but this is a simplification.
+    {"Pion (0)", 0.13498,  0.0, 8.5e-17, {{ParticleType::PION_POSITIVE, 0.5},  {ParticleType::PION_NEGATIVE, 0.5}}, 2}, // PION_NEUTRAL
+    {"Kaon (+)", 0.49367, +1.0, 1.24e-8, {{ParticleType::PION_POSITIVE, 0.63}, {ParticleType::PION_NEUTRAL, 0.21}},  2}, // KAON_POSITIVE
+    {"Kaon (-)", 0.49367, -1.0, 1.24e-8, {{ParticleType::PION_NEGATIVE, 0.63}, {ParticleType::PION_NEUTRAL, 0.21}},  2}, // KAON_NEGATIVE
+    // Protons are stable for all practical purposes in this context.
+    // So, they do not have decay modes in this simplified simulation.
+    {"Proton",   0.93827, +1.0, 0.0,     {{ParticleType::PROTON, 0.0},         {ParticleType::PROTON, 0.0}},        0}  // PROTON
+};
+
+// Returns the registry entry of a particle type.
+constexpr const SpeciesInfo& getSpecies(ParticleType type) {
+    return speciesRegistry[static_cast<std::size_t>(type)];
+}
+
+static_assert(sizeof(speciesRegistry) / sizeof(speciesRegistry[0]) == particleTypeCount, "The species registry needs one entry per ParticleType.");
+static_assert(getSpecies(ParticleType::PROTON).lifetime == 0.0, "Protons are stable in this simulation.");
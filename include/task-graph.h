@@ -0,0 +1,59 @@
+#pragma once
+
+#include "thread-pool.h"      // Include the ThreadPool class definition.
+#include <atomic>             // Required for std::atomic.
+#include <condition_variable> // Required for std::condition_variable.
+#include <cstddef>            // Required for std::size_t.
+#include <cstdint>            // Required for std::uint32_t.
+#include <functional>         // Required for std::function.
+#include <memory>             // Required for std::unique_ptr.
+#include <mutex>              // Required for std::mutex.
+#include <vector>             // Required for using the std::vector container.
+
+// A set of tasks with dependencies, run on the threads of a ThreadPool with work stealing.
+//
+// Every thread owns a queue. A task that completes pushes the successors it makes ready onto its own thread's queue, and the thread
+// continues with the most recently pushed one, so a chain such as forces -> integration -> decay of one particle chunk tends to stay on
+// one thread while its data is still in cache. A thread whose queue is empty steals the oldest task of another thread's queue, and
+// sleeps only while no task is ready anywhere. There is no barrier between the stages of different chains.
+// A graph is built once and can be run any number of times; a run of an unchanged graph on the same pool does not allocate.
+// Tasks must not call ThreadPool::parallelFor() on the pool that runs the graph.
+class TaskGraph {
+public:
+    using Task = std::function<void(std::size_t worker)>; // A task's work; worker identifies the thread (as in ThreadPool::parallelFor)
+
+    std::size_t add(Task task); // Adds a task; returns its id.
+    void addDependency(std::size_t before, std::size_t after); // Makes the task after wait until the task before has finished.
+    void clear(); // Removes every task.
+    std::size_t size() const { return nodes.size(); } // Returns the number of tasks.
+
+    void run(ThreadPool& pool); // Runs every task once (each after all of its prerequisites) and returns once all have finished.
+
+private:
+    struct Node {
+        Task task;
+        std::vector<std::uint32_t> successors; // Tasks that wait for this one
+        std::uint32_t prerequisites = 0;       // Number of tasks this one waits for
+    };
+
+    // A thread's queue of ready tasks. Every task is pushed at most once per run, so the slots never wrap around.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<std::uint32_t> slots; // Ready tasks in [head, tail)
+        std::size_t head = 0;             // Oldest ready task (taken by thieves)
+        std::size_t tail = 0;             // One past the newest ready task (taken by the owner)
+    };
+
+    void work(std::size_t worker); // Runs ready tasks on one thread until the whole graph has finished.
+    void push(std::size_t worker, std::uint32_t task); // Makes a task ready on a thread's queue.
+    bool take(std::size_t worker, std::uint32_t& task); // Takes the newest task of the thread's own queue, or steals the oldest of another.
+
+    std::vector<Node> nodes;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> remaining; // Unfinished prerequisites of each task in the current run
+    std::size_t remainingSize = 0;                           // Length of remaining
+    std::vector<std::unique_ptr<WorkQueue>> queues;          // One queue per pool thread
+    std::atomic<std::size_t> unfinished{0}; // Tasks of the current run that have not finished
+    std::atomic<std::size_t> ready{0};      // Tasks sitting in some queue
+    std::mutex sleepMutex;
+    std::condition_variable wake;           // Signalled when a task becomes ready or the run has finished
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable> // Required for std::condition_variable.
+#include <cstddef>            // Required for std::size_t.
+#include <mutex>              // Required for std::mutex.
+#include <thread>             // Required for std::thread.
+#include <vector>             // Required for using the std::vector container.
+#include <atomic>             // Required for std::atomic.
+
+// Non-owning reference to a loop body (a callable taking an index and a worker). Unlike std::function it never allocates, however much
+// the body's lambda captures, so starting a parallel loop costs no heap allocation. The body must outlive the loop, which parallelFor()
+// guarantees by returning only after every call has finished.
+class LoopBody {
+public:
+    template <typename Body>
+    LoopBody(const Body& body)
+        : object(&body), call([](const void* object, std::size_t index, std::size_t worker) { (*static_cast<const Body*>(object))(index, worker); }) {}
+
+    void operator()(std::size_t index, std::size_t worker) const { call(object, index, worker); }
+
+private:
+    const void* object;                                  // The referenced callable
+    void (*call)(const void*, std::size_t, std::size_t); // Calls the referenced callable's operator()
+};
+
+// A fixed-size pool of worker threads that runs loops in parallel.
+// The calling thread takes part in every loop as worker 0, so a pool of size 1 runs everything on the caller without any extra threads.
+class ThreadPool {
+public:
+    // Constructor: Starts threadCount - 1 worker threads (the caller is the remaining one) and waits until they are ready. A count of 0
+    // means one per hardware thread.
+    explicit ThreadPool(std::size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size() + 1; } // Returns the number of threads that run loop bodies, including the caller.
+
+    // Calls body(index, worker) for every index in [0, count) and returns once all calls have finished.
+    // Indices are handed out dynamically; worker is in [0, size()) and identifies the thread, so it can be used to select per-thread scratch data.
+    void parallelFor(std::size_t count, LoopBody body);
+
+private:
+    void workerLoop(std::size_t worker); // Waits for loops and runs their bodies until the pool is destroyed.
+    void runIndices(std::size_t worker); // Claims and runs indices of the current loop until none are left.
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;  // Signalled when a new loop starts or the pool shuts down.
+    std::condition_variable loopFinished; // Signalled when the last worker leaves the current loop (or a worker has started).
+
+    const LoopBody* body = nullptr;     // Body of the current loop
+    std::size_t count = 0;              // Number of indices in the current loop
+    std::atomic<std::size_t> next{0};   // Next unclaimed index of the current loop
+    std::size_t generation = 0;         // Incremented for every loop, so workers can tell a new loop from a spurious wake-up
+    std::size_t activeWorkers = 0;      // Number of worker threads still inside the current loop
+    std::size_t startedWorkers = 0;     // Number of worker threads that have finished starting up
+    bool stopping = false;
+};
@@ -0,0 +1,344 @@
+#include "all-pairs.h"      // Include the AllPairsSolver class definition.
+#include "interaction.h"    // Include the interaction policies.
+#include "coulomb-kernel.h" // Include the vectorized Coulomb pair kernels.
+#include "metrics.h"        // Include the instrumentation macros.
+#include <algorithm>        // Required for std::fill, std::find, std::min and std::minmax_element.
+
+// Adds the pairwise forces of all particles to their force columns, with the pair loop compiled for the selected force law.
+void AllPairsSolver::computeForces(ParticleStore& particles, ThreadPool& pool) {
+    visitInteraction(interaction, [&](const auto& policy) { computeAll(particles, pool, policy); });
+}
+
+// Adds the forces of all particles on the flagged particles only (the active particles of a block timestep).
+void AllPairsSolver::computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool) {
+    visitInteraction(interaction, [&](const auto& policy) { computeFlagged(particles, isTarget, pool, policy); });
+}
+
+// Returns the columns the tiles work on. If neutral particles can be skipped and there are any, the charged particles' positions and
+// charges are gathered (in store order) into compact columns with zeroed force accumulators; otherwise the store's columns are used.
+// The compact columns are reserved for every particle and keep their capacity, so gathering does not allocate once they have grown.
+AllPairsSolver::Columns AllPairsSolver::selectColumns(ParticleStore& particles, bool skipNeutral) {
+    const std::size_t count = particles.size();
+    compacted = skipNeutral && std::find(particles.charge.begin(), particles.charge.end(), 0.0) != particles.charge.end();
+    if (!compacted) {
+        return {particles.x.data(), particles.y.data(), particles.z.data(), particles.charge.data(),
+                particles.fx.data(), particles.fy.data(), particles.fz.data(), count};
+    }
+    charged.clear();
+    chargedX.clear();
+    chargedY.clear();
+    chargedZ.clear();
+    chargedQ.clear();
+    charged.reserve(count);
+    chargedX.reserve(count);
+    chargedY.reserve(count);
+    chargedZ.reserve(count);
+    chargedQ.reserve(count);
+    chargedFx.reserve(count);
+    chargedFy.reserve(count);
+    chargedFz.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (particles.charge[i] != 0.0) {
+            charged.push_back(static_cast<std::uint32_t>(i));
+            chargedX.push_back(particles.x[i]);
+            chargedY.push_back(particles.y[i]);
+            chargedZ.push_back(particles.z[i]);
+            chargedQ.push_back(particles.charge[i]);
+        }
+    }
+    chargedFx.assign(charged.size(), 0.0);
+    chargedFy.assign(charged.size(), 0.0);
+    chargedFz.assign(charged.size(), 0.0);
+    return {chargedX.data(), chargedY.data(), chargedZ.data(), chargedQ.data(),
+            chargedFx.data(), chargedFy.data(), chargedFz.data(), charged.size()};
+}
+
+// Adds the forces accumulated in the compact columns to the charged particles' force columns.
+void AllPairsSolver::scatterCompactForces(ParticleStore& particles) const {
+    for (std::size_t k = 0; k < charged.size(); ++k) {
+        particles.fx[charged[k]] += chargedFx[k];
+        particles.fy[charged[k]] += chargedFy[k];
+        particles.fz[charged[k]] += chargedFz[k];
+    }
+}
+
+// Adds the pairwise forces of one force law to the force columns.
+template <typename Policy>
+void AllPairsSolver::computeAll(ParticleStore& particles, ThreadPool& pool, const Policy& policy) {
+    if (!Policy::interacts) {
+        return;
+    }
+    const Columns columns = selectColumns(particles, Policy::skipsNeutral);
+    const std::size_t blockCount = (columns.count + tileSize - 1) / tileSize;
+    if (blockCount == 0) {
+        return;
+    }
+    if (blockCount != scheduledBlocks) {
+        buildSchedule(blockCount);
+    }
+    if (scratch.size() < pool.size()) {
+        scratch.resize(pool.size());
+    }
+
+    const bool mixed = Policy::model == InteractionModel::COULOMB && precision == ForcePrecision::MIXED;
+    if (mixed) {
+        gatherLocalColumns(columns, blockCount);
+    }
+
+    // Rounds run one after another; the tiles inside a round touch disjoint blocks and run in parallel.
+    for (const auto& round : rounds) {
+        pool.parallelFor(round.size(), [&](std::size_t tile, std::size_t worker) {
+            if constexpr (Policy::model == InteractionModel::COULOMB) {
+                if (mixed) {
+                    computeMixedTile(columns, round[tile].first, round[tile].second, scratch[worker], static_cast<float>(policy.softening));
+                    return;
+                }
+            }
+            computeTile(columns, round[tile].first, round[tile].second, scratch[worker], policy);
+        });
+    }
+    if (compacted) {
+        scatterCompactForces(particles);
+    }
+}
+
+// Adds the forces of all particles on the flagged particles only, in O(targets * N).
+// Newton's third law cannot be used, because the sources do not receive forces; the row kernel's reactions go to the thread's scratch
+// accumulators and are discarded. Each target sums its sources in index order, so the result does not depend on the thread count.
+template <typename Policy>
+void AllPairsSolver::computeFlagged(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool, const Policy& policy) {
+    if (!Policy::interacts) {
+        return;
+    }
+    const std::size_t count = particles.size();
+    targets.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (isTarget[i] && !(Policy::skipsNeutral && particles.charge[i] == 0.0)) {
+            targets.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    const Columns sources = selectColumns(particles, Policy::skipsNeutral);
+    if (targets.empty() || sources.count < 2) {
+        return;
+    }
+    if (scratch.size() < pool.size()) {
+        scratch.resize(pool.size());
+    }
+
+    const CoulombRowKernel kernel = getActiveCoulombRowKernel();
+    const double* x = particles.x.data();
+    const double* y = particles.y.data();
+    const double* z = particles.z.data();
+    const double* q = particles.charge.data();
+    const std::size_t targetsPerTask = 16;
+    const std::size_t taskCount = (targets.size() + targetsPerTask - 1) / targetsPerTask;
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t worker) {
+        TileScratch& reactions = scratch[worker];
+        const std::size_t last = std::min((task + 1) * targetsPerTask, targets.size());
+        METRICS_COUNT(Counter::PAIR_INTERACTIONS, (last - task * targetsPerTask) * (sources.count - 1));
+        for (std::size_t t = task * targetsPerTask; t < last; ++t) {
+            const std::uint32_t i = targets[t];
+            double force[3] = {0.0, 0.0, 0.0};
+            for (std::size_t begin = 0; begin < sources.count; begin += tileSize) {
+                const std::size_t length = std::min(tileSize, sources.count - begin);
+                std::fill(reactions.fx, reactions.fx + length, 0.0);
+                std::fill(reactions.fy, reactions.fy + length, 0.0);
+                std::fill(reactions.fz, reactions.fz + length, 0.0);
+                // The target itself is among the sources; its separation is zero, so the softened term contributes nothing.
+                if constexpr (Policy::model == InteractionModel::COULOMB) {
+                    kernel(x[i], y[i], z[i], Policy::coupling * q[i], sources.x + begin, sources.y + begin, sources.z + begin,
+                           sources.q + begin, reactions.fx, reactions.fy, reactions.fz, length, force, policy.softening);
+                } else {
+                    interactionRow(policy, x[i], y[i], z[i], Policy::coupling * q[i], sources.x + begin, sources.y + begin, sources.z + begin,
+                                   sources.q + begin, reactions.fx, reactions.fy, reactions.fz, length, force);
+                }
+            }
+            particles.fx[i] += force[0];
+            particles.fy[i] += force[1];
+            particles.fz[i] += force[2];
+        }
+    });
+}
+
+// Builds the rounds of tiles for blockCount blocks.
+// The first round holds the diagonal tiles (I, I). The other rounds come from the circle method for round-robin tournaments:
+// with an even number of blocks m, round r pairs block m - 1 with block r and block (r + k) with block (r - k) (mod m - 1).
+// An odd block count gets an extra "bye" block whose tiles are skipped.
+void AllPairsSolver::buildSchedule(std::size_t blockCount) {
+    rounds.clear();
+
+    std::vector<std::pair<std::size_t, std::size_t>> diagonal;
+    for (std::size_t block = 0; block < blockCount; ++block) {
+        diagonal.emplace_back(block, block);
+    }
+    rounds.push_back(diagonal);
+
+    const std::size_t m = blockCount + (blockCount % 2); // Round up to an even number of blocks.
+    for (std::size_t r = 0; r + 1 < m; ++r) {
+        std::vector<std::pair<std::size_t, std::size_t>> round;
+        auto addTile = [&](std::size_t a, std::size_t b) {
+            if (a < blockCount && b < blockCount) { // Skip tiles that involve the bye block.
+                round.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        };
+        addTile(m - 1, r);
+        for (std::size_t k = 1; k < m / 2; ++k) {
+            addTile((r + k) % (m - 1), (r + (m - 1) - k) % (m - 1));
+        }
+        if (!round.empty()) {
+            rounds.push_back(round);
+        }
+    }
+    scheduledBlocks = blockCount;
+}
+
+// Evaluates every particle pair between block I and block J (or every pair inside block I when I == J).
+// Forces are summed into the thread's scratch accumulators and added to the force columns once at the end of the tile.
+template <typename Policy>
+void AllPairsSolver::computeTile(const Columns& columns, std::size_t blockI, std::size_t blockJ, TileScratch& tile, const Policy& policy) const {
+    const std::size_t count = columns.count;
+    const std::size_t beginI = blockI * tileSize;
+    const std::size_t endI = std::min(beginI + tileSize, count);
+    const std::size_t beginJ = blockJ * tileSize;
+    const std::size_t endJ = std::min(beginJ + tileSize, count);
+    const std::size_t sizeI = endI - beginI;
+    const std::size_t sizeJ = endJ - beginJ;
+    METRICS_COUNT(Counter::PAIR_INTERACTIONS, blockI == blockJ ? sizeI * (sizeI - 1) / 2 : sizeI * sizeJ);
+
+    const double* __restrict x = columns.x;
+    const double* __restrict y = columns.y;
+    const double* __restrict z = columns.z;
+    const double* __restrict q = columns.q;
+
+    // Accumulators for block I live in [0, tileSize), accumulators for block J in [tileSize, 2 * tileSize).
+    std::fill(tile.fx, tile.fx + 2 * tileSize, 0.0);
+    std::fill(tile.fy, tile.fy + 2 * tileSize, 0.0);
+    std::fill(tile.fz, tile.fz + 2 * tileSize, 0.0);
+    double* accIx = tile.fx;
+    double* accIy = tile.fy;
+    double* accIz = tile.fz;
+    double* accJx = tile.fx + tileSize;
+    double* accJy = tile.fy + tileSize;
+    double* accJz = tile.fz + tileSize;
+
+    // The pair loop over each row of the tile runs in the Coulomb kernel selected for this CPU (scalar, AVX2 or AVX-512), or in the
+    // policy's generic row for the other force laws.
+    const CoulombRowKernel kernel = getActiveCoulombRowKernel();
+    const bool diagonal = (blockI == blockJ);
+    for (std::size_t a = 0; a < sizeI; ++a) {
+        const std::size_t i = beginI + a;
+        double targetForce[3] = {0.0, 0.0, 0.0};
+
+        // Inside a diagonal tile every pair is visited once by starting after particle i.
+        const std::size_t firstB = diagonal ? a + 1 : 0;
+        const std::size_t j = beginJ + firstB;
+        if constexpr (Policy::model == InteractionModel::COULOMB) {
+            kernel(x[i], y[i], z[i], Policy::coupling * q[i],
+                   x + j, y + j, z + j, q + j,
+                   accJx + firstB, accJy + firstB, accJz + firstB, sizeJ - firstB, targetForce, policy.softening);
+        } else {
+            interactionRow(policy, x[i], y[i], z[i], Policy::coupling * q[i],
+                           x + j, y + j, z + j, q + j,
+                           accJx + firstB, accJy + firstB, accJz + firstB, sizeJ - firstB, targetForce);
+        }
+        accIx[a] += targetForce[0];
+        accIy[a] += targetForce[1];
+        accIz[a] += targetForce[2];
+    }
+
+    // Reduce the tile's accumulators into the force columns. No other tile of this round touches blocks I or J.
+    double* __restrict fxOut = columns.fx;
+    double* __restrict fyOut = columns.fy;
+    double* __restrict fzOut = columns.fz;
+    for (std::size_t a = 0; a < sizeI; ++a) {
+        const std::size_t i = beginI + a;
+        fxOut[i] += accIx[a] + (diagonal ? accJx[a] : 0.0);
+        fyOut[i] += accIy[a] + (diagonal ? accJy[a] : 0.0);
+        fzOut[i] += accIz[a] + (diagonal ? accJz[a] : 0.0);
+    }
+    if (!diagonal) {
+        for (std::size_t b = 0; b < sizeJ; ++b) {
+            const std::size_t j = beginJ + b;
+            fxOut[j] += accJx[b];
+            fyOut[j] += accJy[b];
+            fzOut[j] += accJz[b];
+        }
+    }
+}
+
+// Gives every block the centre of its bounding box as origin and stores its positions as float offsets from it (and its charges as
+// float). The float columns are reserved for every particle, so gathering does not allocate once they have grown.
+void AllPairsSolver::gatherLocalColumns(const Columns& columns, std::size_t blockCount) {
+    localX.reserve(columns.count);
+    localY.reserve(columns.count);
+    localZ.reserve(columns.count);
+    localQ.reserve(columns.count);
+    localX.resize(columns.count);
+    localY.resize(columns.count);
+    localZ.resize(columns.count);
+    localQ.resize(columns.count);
+    blockOrigins.resize(3 * blockCount);
+    for (std::size_t block = 0; block < blockCount; ++block) {
+        const std::size_t begin = block * tileSize;
+        const std::size_t end = std::min(begin + tileSize, columns.count);
+        const double* position[3] = {columns.x, columns.y, columns.z};
+        float* local[3] = {localX.data(), localY.data(), localZ.data()};
+        for (int axis = 0; axis < 3; ++axis) {
+            const auto bounds = std::minmax_element(position[axis] + begin, position[axis] + end);
+            const double origin = 0.5 * (*bounds.first + *bounds.second);
+            blockOrigins[3 * block + axis] = origin;
+            for (std::size_t i = begin; i < end; ++i) {
+                local[axis][i] = static_cast<float>(position[axis][i] - origin);
+            }
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            localQ[i] = static_cast<float>(columns.q[i]);
+        }
+    }
+}
+
+// Evaluates the Coulomb pairs between block I and block J (or inside block I when I == J) in single precision.
+// Each target is moved into block J's frame in double and then rounded, so its separation from the sources is accurate to float precision
+// of the distance between the blocks, not of its coordinates. Each row's force on its target (a float sum over at most tileSize sources) is
+// added to the double force column as soon as the row is done, and the float reactions of block J once the tile is done.
+void AllPairsSolver::computeMixedTile(const Columns& columns, std::size_t blockI, std::size_t blockJ, TileScratch& tile, float softening) const {
+    const std::size_t count = columns.count;
+    const std::size_t beginI = blockI * tileSize;
+    const std::size_t endI = std::min(beginI + tileSize, count);
+    const std::size_t beginJ = blockJ * tileSize;
+    const std::size_t endJ = std::min(beginJ + tileSize, count);
+    const std::size_t sizeI = endI - beginI;
+    const std::size_t sizeJ = endJ - beginJ;
+    METRICS_COUNT(Counter::PAIR_INTERACTIONS, blockI == blockJ ? sizeI * (sizeI - 1) / 2 : sizeI * sizeJ);
+
+    std::fill(tile.reactionX, tile.reactionX + sizeJ, 0.0f);
+    std::fill(tile.reactionY, tile.reactionY + sizeJ, 0.0f);
+    std::fill(tile.reactionZ, tile.reactionZ + sizeJ, 0.0f);
+    const double* originJ = blockOrigins.data() + 3 * blockJ;
+    double* __restrict fxOut = columns.fx;
+    double* __restrict fyOut = columns.fy;
+    double* __restrict fzOut = columns.fz;
+
+    const FloatCoulombRowKernel kernel = getActiveFloatCoulombRowKernel();
+    const bool diagonal = (blockI == blockJ);
+    for (std::size_t a = 0; a < sizeI; ++a) {
+        const std::size_t i = beginI + a;
+        float targetForce[3] = {0.0f, 0.0f, 0.0f};
+
+        // Inside a diagonal tile every pair is visited once by starting after particle i.
+        const std::size_t firstB = diagonal ? a + 1 : 0;
+        const std::size_t j = beginJ + firstB;
+        kernel(static_cast<float>(columns.x[i] - originJ[0]), static_cast<float>(columns.y[i] - originJ[1]),
+               static_cast<float>(columns.z[i] - originJ[2]), static_cast<float>(CoulombInteraction::coupling * columns.q[i]),
+               localX.data() + j, localY.data() + j, localZ.data() + j, localQ.data() + j,
+               tile.reactionX + firstB, tile.reactionY + firstB, tile.reactionZ + firstB, sizeJ - firstB, targetForce, softening);
+        fxOut[i] += targetForce[0];
+        fyOut[i] += targetForce[1];
+        fzOut[i] += targetForce[2];
+    }
+    for (std::size_t b = 0; b < sizeJ; ++b) {
+        fxOut[beginJ + b] += tile.reactionX[b];
+        fyOut[beginJ + b] += tile.reactionY[b];
+        fzOut[beginJ + b] += tile.reactionZ[b];
+    }
+}
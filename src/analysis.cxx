@@ -0,0 +1,149 @@
+#include "analysis.h"    // Include the InSituAnalysis class definition.
+#include "file-output.h" // Include writeFileAtomically.
+#include "species.h"     // Include the species registry.
+#include <algorithm>     // Required for std::fill and std::min.
+#include <cmath>         // Required for std::log and std::sqrt.
+#include <sstream>      // Required for std::ostringstream.
+
+namespace {
+
+// Number of particles binned by one parallel task.
+const std::size_t particlesPerTask = 4096;
+
+const char* const spectrumNames[spectrumCount] = {"momentum", "transverse_momentum", "rapidity", "radius"};
+
+// Returns the slot of a value in a histogram: its bin, or bins for underflow and bins + 1 for overflow (NaN counts as underflow).
+inline std::size_t binOf(double value, const HistogramAxis& axis) {
+    const double scaled = (value - axis.low) / (axis.high - axis.low) * static_cast<double>(axis.bins);
+    if (!(scaled >= 0.0)) {
+        return axis.bins;
+    }
+    if (scaled >= static_cast<double>(axis.bins)) {
+        return axis.bins + 1;
+    }
+    return static_cast<std::size_t>(scaled);
+}
+
+} // namespace
+
+// Lays out the histograms of a binning and leaves them empty.
+InSituAnalysis::InSituAnalysis(const AnalysisConfig& analysisConfig) : config(analysisConfig) {
+    for (std::size_t s = 0; s < spectrumCount; ++s) {
+        spectrumOffset[s] = speciesStride;
+        speciesStride += config.axes[s].bins + 2;
+    }
+    counts.assign(particleTypeCount * speciesStride, 0);
+}
+
+// Adds every particle to the current event's bins. Each task bins a range of particles into the bins of the worker that runs it, so no
+// two threads ever write to the same counts.
+void InSituAnalysis::fill(const ParticleStore& particles, ThreadPool& pool) {
+    if (workerCounts.size() < pool.size()) {
+        workerCounts.resize(pool.size(), std::vector<std::uint64_t>(counts.size(), 0));
+    }
+    ++eventFills;
+    const std::size_t taskCount = (particles.size() + particlesPerTask - 1) / particlesPerTask;
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t worker) {
+        std::uint64_t* bins = workerCounts[worker].data();
+        const std::size_t begin = task * particlesPerTask;
+        const std::size_t end = std::min(begin + particlesPerTask, particles.size());
+        for (std::size_t i = begin; i < end; ++i) {
+            const double m = particles.mass[i];
+            const double px = m * particles.vx[i], py = m * particles.vy[i], pz = m * particles.vz[i];
+            const double transverse2 = px * px + py * py;
+            const double momentum2 = transverse2 + pz * pz;
+            const double energy = std::sqrt(m * m + momentum2);
+            const double values[spectrumCount] = {
+                std::sqrt(momentum2),
+                std::sqrt(transverse2),
+                0.5 * std::log((energy + pz) / (energy - pz)),
+                std::sqrt(particles.x[i] * particles.x[i] + particles.y[i] * particles.y[i] + particles.z[i] * particles.z[i])
+            };
+            std::uint64_t* species = bins + static_cast<std::size_t>(particles.type[i]) * speciesStride;
+            for (std::size_t s = 0; s < spectrumCount; ++s) {
+                ++species[spectrumOffset[s] + binOf(values[s], config.axes[s])];
+            }
+        }
+    });
+}
+
+// Adds the decays of a step, counted by parent species.
+void InSituAnalysis::addDecays(const std::array<std::uint64_t, particleTypeCount>& stepDecays) {
+    for (std::size_t t = 0; t < particleTypeCount; ++t) {
+        eventDecays[t] += stepDecays[t];
+    }
+}
+
+// Adds the workers' bins of the current event into the run totals and zeroes them for the next event. This runs once per event, after
+// the parallel fills have finished, so it needs no synchronization.
+void InSituAnalysis::endEvent() {
+    for (std::vector<std::uint64_t>& worker : workerCounts) {
+        for (std::size_t k = 0; k < counts.size(); ++k) {
+            counts[k] += worker[k];
+        }
+        std::fill(worker.begin(), worker.end(), 0);
+    }
+    for (std::size_t t = 0; t < particleTypeCount; ++t) {
+        decays[t] += eventDecays[t];
+    }
+    eventDecays = {};
+    fills += eventFills;
+    eventFills = 0;
+    ++events;
+}
+
+// Clears the totals and the current event.
+void InSituAnalysis::reset() {
+    for (std::vector<std::uint64_t>& worker : workerCounts) {
+        std::fill(worker.begin(), worker.end(), 0);
+    }
+    std::fill(counts.begin(), counts.end(), 0);
+    eventDecays = {};
+    decays = {};
+    eventFills = fills = 0;
+    events = 0;
+}
+
+// Returns the bins of one histogram of the run totals.
+ColumnView<std::uint64_t> InSituAnalysis::getCounts(ParticleType type, Spectrum spectrum) const {
+    return {counts.data() + offsetOf(type, spectrum), config.axes[static_cast<std::size_t>(spectrum)].bins};
+}
+
+// Returns the count of values below the range of one histogram.
+std::uint64_t InSituAnalysis::getUnderflow(ParticleType type, Spectrum spectrum) const {
+    return counts[offsetOf(type, spectrum) + config.axes[static_cast<std::size_t>(spectrum)].bins];
+}
+
+// Returns the count of values at or above the range of one histogram.
+std::uint64_t InSituAnalysis::getOverflow(ParticleType type, Spectrum spectrum) const {
+    return counts[offsetOf(type, spectrum) + config.axes[static_cast<std::size_t>(spectrum)].bins + 1];
+}
+
+// Writes the totals as JSON through a temporary file that is renamed into place, so a reader never sees a partial file.
+bool InSituAnalysis::writeResults(const std::string& path) const {
+    return writeFileAtomically(path, formatAnalysisJson(*this));
+}
+
+// Formats the totals as a JSON object: the event and fill counts, then per species its decays and, per spectrum, the binning, the bin
+// counts and the underflow and overflow counts.
+std::string formatAnalysisJson(const InSituAnalysis& analysis) {
+    std::ostringstream out;
+    out << "{\"events\":" << analysis.getEventCount() << ",\"fills\":" << analysis.getFillCount() << ",\"species\":[";
+    for (std::size_t t = 0; t < particleTypeCount; ++t) {
+        const ParticleType type = static_cast<ParticleType>(t);
+        out << (t ? "," : "") << "{\"name\":\"" << getSpecies(type).name << "\",\"decays\":" << analysis.getDecays(type);
+        for (std::size_t s = 0; s < spectrumCount; ++s) {
+            const Spectrum spectrum = static_cast<Spectrum>(s);
+            const HistogramAxis& axis = analysis.getConfig().axes[s];
+            out << ",\"" << spectrumNames[s] << "\":{\"low\":" << axis.low << ",\"high\":" << axis.high << ",\"counts\":[";
+            const ColumnView<std::uint64_t> bins = analysis.getCounts(type, spectrum);
+            for (std::size_t b = 0; b < bins.size(); ++b) {
+                out << (b ? "," : "") << bins[b];
+            }
+            out << "],\"underflow\":" << analysis.getUnderflow(type, spectrum) << ",\"overflow\":" << analysis.getOverflow(type, spectrum) << '}';
+        }
+        out << '}';
+    }
+    out << "]}\n";
+    return out.str();
+}
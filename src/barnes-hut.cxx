@@ -0,0 +1,324 @@
+#include "barnes-hut.h"  // Include the BarnesHutSolver class definition.
+#include "interaction.h" // Include the interaction policies.
+#include "metrics.h"     // Include the instrumentation macros.
+#include <algorithm>     // Required for std::min and std::max.
+#include <cmath>         // For mathematical operations.
+
+namespace {
+
+// Number of particles whose forces one parallel task computes. Neighboring tree positions walk similar paths through the tree.
+const std::size_t targetsPerTask = 64;
+
+// Returns the octant (0-7) of a point relative to a cell center. Bit 0 is x, bit 1 is y and bit 2 is z.
+inline unsigned octantOf(double x, double y, double z, const double center[3]) {
+    return (x >= center[0] ? 1u : 0u) | (y >= center[1] ? 2u : 0u) | (z >= center[2] ? 4u : 0u);
+}
+
+} // namespace
+
+// Rebuilds the tree and adds the approximate forces to the force columns.
+void BarnesHutSolver::computeForces(ParticleStore& particles, ThreadPool& pool) {
+    if (!build(particles)) {
+        return;
+    }
+    visitInteraction(interaction, [&](const auto& policy) { computeTargets(particles, nullptr, pool, policy); });
+}
+
+// Rebuilds the tree from all particles, but only adds forces to the particles whose flag is set (the active particles of a block timestep).
+void BarnesHutSolver::computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool) {
+    if (!build(particles)) {
+        return;
+    }
+    visitInteraction(interaction, [&](const auto& policy) { computeTargets(particles, isTarget.data(), pool, policy); });
+}
+
+// Rebuilds the tree and records the tree position of every store index, so forces can then be computed for ranges of store indices.
+// Particles left out of the tree keep the rank notInTree.
+void BarnesHutSolver::prepareRanges(const ParticleStore& particles) {
+    rank.assign(particles.size(), notInTree);
+    if (!build(particles)) {
+        return;
+    }
+    for (std::size_t position = 0; position < order.size(); ++position) {
+        rank[order[position]] = static_cast<std::uint32_t>(position);
+    }
+}
+
+// Walks the tree for the particles in [begin, end) of the store. Only those particles' forces are written.
+void BarnesHutSolver::computeRange(ParticleStore& particles, std::size_t begin, std::size_t end) const {
+    visitInteraction(interaction, [&](const auto& policy) { computeRangeWith(particles, begin, end, policy); });
+}
+
+// Walks the tree for the particles in [begin, end) of the store with one force law.
+template <typename Policy>
+void BarnesHutSolver::computeRangeWith(ParticleStore& particles, std::size_t begin, std::size_t end, const Policy& policy) const {
+    std::size_t interactions = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (rank[i] == notInTree) {
+            continue;
+        }
+        double fx = 0.0, fy = 0.0, fz = 0.0;
+        interactions += accumulateForce(rank[i], fx, fy, fz, policy);
+        particles.fx[i] += fx;
+        particles.fy[i] += fy;
+        particles.fz[i] += fz;
+    }
+    METRICS_COUNT(Counter::PAIR_INTERACTIONS, interactions);
+}
+
+// Walks the tree for every particle in it, or only for the flagged ones if isTarget is not null.
+template <typename Policy>
+void BarnesHutSolver::computeTargets(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy) {
+    // Every task owns a range of tree positions and writes only the forces of those particles, so tasks never conflict.
+    const std::size_t count = order.size();
+    const std::size_t taskCount = (count + targetsPerTask - 1) / targetsPerTask;
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t first = task * targetsPerTask;
+        const std::size_t last = std::min(first + targetsPerTask, count);
+        std::size_t interactions = 0;
+        for (std::size_t position = first; position < last; ++position) {
+            const std::uint32_t i = order[position];
+            if (isTarget && !isTarget[i]) {
+                continue;
+            }
+            double fx = 0.0, fy = 0.0, fz = 0.0;
+            interactions += accumulateForce(position, fx, fy, fz, policy);
+            particles.fx[i] += fx;
+            particles.fy[i] += fy;
+            particles.fz[i] += fz;
+        }
+        METRICS_COUNT(Counter::PAIR_INTERACTIONS, interactions);
+    });
+}
+
+// Rebuilds the tree for the current particle positions. Returns false (leaving an empty tree) if there is no force law or fewer than two
+// particles take part; if the force law skips neutral particles, only the charged ones are placed in the tree.
+// The node pool and the ordering buffers keep their capacity between steps, so a rebuild does not allocate once they have grown.
+bool BarnesHutSolver::build(const ParticleStore& particles) {
+    nodes.clear();
+    order.clear();
+    const InteractionTraits traits = getInteractionTraits(interaction);
+    if (!traits.interacts) {
+        return false;
+    }
+    order.reserve(particles.size());
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        if (!traits.skipsNeutral || particles.charge[i] != 0.0) {
+            order.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    const std::size_t count = order.size();
+    if (count < 2) {
+        order.clear();
+        return false;
+    }
+
+    // Bounding cube of the particles in the tree.
+    double low[3] = {particles.x[order[0]], particles.y[order[0]], particles.z[order[0]]};
+    double high[3] = {low[0], low[1], low[2]};
+    for (std::size_t position = 1; position < count; ++position) {
+        const std::uint32_t i = order[position];
+        low[0] = std::min(low[0], particles.x[i]);
+        low[1] = std::min(low[1], particles.y[i]);
+        low[2] = std::min(low[2], particles.z[i]);
+        high[0] = std::max(high[0], particles.x[i]);
+        high[1] = std::max(high[1], particles.y[i]);
+        high[2] = std::max(high[2], particles.z[i]);
+    }
+    double halfSize = 0.5 * std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    halfSize = halfSize * (1.0 + 1e-12) + 1e-300; // Keep the extreme particles strictly inside and avoid a zero-sized root.
+
+    scratch.reserve(particles.size()); // Sized for every particle, so a step with more charged particles than the last does not reallocate.
+    scratch.resize(count);
+    sq.reserve(particles.size());
+
+    // Temporarily keep the positions by store index (the octant sort looks them up); they are permuted into tree order after the build.
+    sx.assign(particles.x.begin(), particles.x.end());
+    sy.assign(particles.y.begin(), particles.y.end());
+    sz.assign(particles.z.begin(), particles.z.end());
+
+    Node root{};
+    root.center[0] = 0.5 * (low[0] + high[0]);
+    root.center[1] = 0.5 * (low[1] + high[1]);
+    root.center[2] = 0.5 * (low[2] + high[2]);
+    root.halfSize = halfSize;
+    root.begin = 0;
+    root.end = static_cast<std::uint32_t>(count);
+    nodes.push_back(root);
+    subdivide(0, 0);
+
+    // Gather positions and charges into tree order.
+    for (std::size_t position = 0; position < count; ++position) {
+        const std::uint32_t i = order[position];
+        sx[position] = particles.x[i];
+        sy[position] = particles.y[i];
+        sz[position] = particles.z[i];
+    }
+    sq.resize(count);
+    for (std::size_t position = 0; position < count; ++position) {
+        sq[position] = particles.charge[order[position]];
+    }
+
+    computeMoments(0);
+    return true;
+}
+
+// Splits a cell into octants (a counting sort of its particles) and recurses into the non-empty ones.
+void BarnesHutSolver::subdivide(std::uint32_t nodeIndex, std::size_t depth) {
+    const Node node = nodes[nodeIndex];
+    const std::uint32_t count = node.end - node.begin;
+    if (count <= leafSize || depth >= maxDepth) {
+        return;
+    }
+
+    std::uint32_t octantCount[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (std::uint32_t position = node.begin; position < node.end; ++position) {
+        const std::uint32_t i = order[position];
+        ++octantCount[octantOf(sx[i], sy[i], sz[i], node.center)];
+    }
+    std::uint32_t octantStart[8];
+    std::uint32_t running = node.begin;
+    for (unsigned octant = 0; octant < 8; ++octant) {
+        octantStart[octant] = running;
+        running += octantCount[octant];
+    }
+    std::uint32_t cursor[8];
+    std::copy(octantStart, octantStart + 8, cursor);
+    for (std::uint32_t position = node.begin; position < node.end; ++position) {
+        const std::uint32_t i = order[position];
+        scratch[cursor[octantOf(sx[i], sy[i], sz[i], node.center)]++] = i;
+    }
+    std::copy(scratch.begin() + node.begin, scratch.begin() + node.end, order.begin() + node.begin);
+
+    // Allocate the non-empty children next to each other at the end of the pool.
+    const std::uint32_t firstChild = static_cast<std::uint32_t>(nodes.size());
+    std::uint32_t childCount = 0;
+    const double childHalf = 0.5 * node.halfSize;
+    for (unsigned octant = 0; octant < 8; ++octant) {
+        if (octantCount[octant] == 0) {
+            continue;
+        }
+        Node child{};
+        child.center[0] = node.center[0] + ((octant & 1u) ? childHalf : -childHalf);
+        child.center[1] = node.center[1] + ((octant & 2u) ? childHalf : -childHalf);
+        child.center[2] = node.center[2] + ((octant & 4u) ? childHalf : -childHalf);
+        child.halfSize = childHalf;
+        child.begin = octantStart[octant];
+        child.end = octantStart[octant] + octantCount[octant];
+        nodes.push_back(child);
+        ++childCount;
+    }
+    nodes[nodeIndex].firstChild = firstChild;
+    nodes[nodeIndex].childCount = childCount;
+
+    for (std::uint32_t child = firstChild; child < firstChild + childCount; ++child) {
+        subdivide(child, depth + 1);
+    }
+}
+
+// Computes the net charge and dipole moment of a cell, about its center, from its children or its particles.
+void BarnesHutSolver::computeMoments(std::uint32_t nodeIndex) {
+    Node& node = nodes[nodeIndex];
+    double charge = 0.0;
+    double dipole[3] = {0.0, 0.0, 0.0};
+    if (node.childCount == 0) {
+        for (std::uint32_t position = node.begin; position < node.end; ++position) {
+            charge += sq[position];
+            dipole[0] += sq[position] * (sx[position] - node.center[0]);
+            dipole[1] += sq[position] * (sy[position] - node.center[1]);
+            dipole[2] += sq[position] * (sz[position] - node.center[2]);
+        }
+    } else {
+        for (std::uint32_t childIndex = node.firstChild; childIndex < node.firstChild + node.childCount; ++childIndex) {
+            computeMoments(childIndex);
+            const Node& child = nodes[childIndex];
+            // Shift the child's dipole to this cell's center: p = p_child + Q_child * (c_child - c).
+            charge += child.charge;
+            dipole[0] += child.dipole[0] + child.charge * (child.center[0] - node.center[0]);
+            dipole[1] += child.dipole[1] + child.charge * (child.center[1] - node.center[1]);
+            dipole[2] += child.dipole[2] + child.charge * (child.center[2] - node.center[2]);
+        }
+    }
+    node.charge = charge;
+    node.dipole[0] = dipole[0];
+    node.dipole[1] = dipole[1];
+    node.dipole[2] = dipole[2];
+}
+
+// Walks the tree for the particle at a tree position and sums the forces on it. Returns the number of interactions (opened-leaf particles
+// plus accepted cells), which is the solver's measure of work.
+// The sign convention follows Particle::addForce: the force on particle i from charge q_j at r_j is coupling q_i q_j S(r^2) (r_j - r_i).
+template <typename Policy>
+std::size_t BarnesHutSolver::accumulateForce(std::size_t target, double& fx, double& fy, double& fz, const Policy& policy) const {
+    const double xi = sx[target], yi = sy[target], zi = sz[target];
+    const double kqi = Policy::coupling * sq[target];
+    const double theta = std::min(openingAngle, maxOpeningAngle); // A cell containing the target is never accepted below 2/sqrt(3).
+    const double theta2 = theta * theta;
+    const double reach = policy.reach();
+
+    std::uint32_t stack[8 * maxDepth + 8];
+    std::size_t top = 0;
+    stack[top++] = 0;
+    double gx = 0.0, gy = 0.0, gz = 0.0; // Sum of q_j S(r^2) (r_j - r_i) over all sources
+    std::size_t interactions = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        const double rx = node.center[0] - xi;
+        const double ry = node.center[1] - yi;
+        const double rz = node.center[2] - zi;
+        const double r2 = rx*rx + ry*ry + rz*rz;
+        const double size = 2.0 * node.halfSize;
+
+        // A short-range law ignores cells entirely beyond its reach, and only approximates cells entirely within it. Every particle of a
+        // cell lies within half a diagonal (sqrt(3) halfSize) of its center.
+        bool straddlesReach = false;
+        if (Policy::shortRange) {
+            const double distance = std::sqrt(r2);
+            const double halfDiagonal = 1.7320508075688772 * node.halfSize;
+            if (distance - halfDiagonal >= reach) {
+                continue;
+            }
+            straddlesReach = distance + halfDiagonal >= reach;
+        }
+
+        // Far enough away: use the cell's monopole and dipole.
+        if (size * size < theta2 * r2 && !straddlesReach) {
+            double scale, derivative;
+            policy.farField(r2, scale, derivative);
+            const double pDotR = node.dipole[0]*rx + node.dipole[1]*ry + node.dipole[2]*rz;
+            // Q S R + S p + 2 S' R (p . R), with R pointing from the particle to the cell center (for Coulomb, S = 1 / R^3 and 2 S' = -3 / R^5).
+            const double radial = node.charge * scale + derivative * pDotR;
+            gx += radial * rx + node.dipole[0] * scale;
+            gy += radial * ry + node.dipole[1] * scale;
+            gz += radial * rz + node.dipole[2] * scale;
+            ++interactions;
+            continue;
+        }
+
+        if (node.childCount > 0) {
+            for (std::uint32_t child = node.firstChild; child < node.firstChild + node.childCount; ++child) {
+                stack[top++] = child;
+            }
+            continue;
+        }
+
+        // An opened leaf: sum its particles directly, skipping the target itself.
+        interactions += node.end - node.begin - (target >= node.begin && target < node.end ? 1 : 0);
+        for (std::uint32_t position = node.begin; position < node.end; ++position) {
+            if (position == target) {
+                continue;
+            }
+            const double dx = sx[position] - xi;
+            const double dy = sy[position] - yi;
+            const double dz = sz[position] - zi;
+            const double scale = policy.pairScale(sq[position], dx*dx + dy*dy + dz*dz);
+            gx += scale * dx;
+            gy += scale * dy;
+            gz += scale * dz;
+        }
+    }
+    fx = kqi * gx;
+    fy = kqi * gy;
+    fz = kqi * gz;
+    return interactions;
+}
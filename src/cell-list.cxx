@@ -0,0 +1,456 @@
+#include "cell-list.h"   // Include the CellListSolver class definition.
+#include "interaction.h" // Include the interaction policies.
+#include "metrics.h"     // Include the instrumentation macros.
+#include <algorithm>     // Required for std::min and std::max.
+#include <cmath>         // For mathematical operations.
+
+namespace {
+
+// Number of cells (grid path) or particles (neighbor list path) handled by one parallel task.
+const std::size_t cellsPerTask = 64;
+const std::size_t particlesPerTask = 256;
+
+// Grows a scratch buffer's capacity (at least doubling it) if fewer than count elements fit. The neighbor list changes size from step
+// to step as the particles move, and reallocating it to the exact size would allocate on almost every rebuild.
+template <typename Buffer>
+void reserveScratch(Buffer& buffer, std::size_t count) {
+    if (count > buffer.capacity()) {
+        buffer.reserve(std::max(count, 2 * buffer.capacity()));
+    }
+}
+
+// Returns the cell coordinate of a position along one axis, clamped to the grid.
+inline std::size_t cellCoordinate(double position, double origin, double cellSize, std::size_t dim) {
+    double cell = std::floor((position - origin) / cellSize);
+    if (cell < 0.0) {
+        return 0;
+    }
+    return std::min(static_cast<std::size_t>(cell), dim - 1);
+}
+
+} // namespace
+
+// Adds the short-range forces to the force columns, using the neighbor list when a skin is set and the grid otherwise.
+void CellListSolver::computeForces(ParticleStore& particles, ThreadPool& pool) {
+    visitInteraction(interaction, [&](const auto& policy) { computeTargets(particles, nullptr, pool, policy); });
+}
+
+// Adds the short-range forces only to the particles whose flag is set (the active particles of a block timestep).
+// All particles are still binned (and kept in the neighbor list), because every particle can be a source.
+void CellListSolver::computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool) {
+    visitInteraction(interaction, [&](const auto& policy) { computeTargets(particles, isTarget.data(), pool, policy); });
+}
+
+// Computes the forces of every particle, or only of the flagged ones if isTarget is not null.
+template <typename Policy>
+void CellListSolver::computeTargets(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy) {
+    if (!Policy::interacts || particles.size() < 2) {
+        return;
+    }
+    if (skin > 0.0) {
+        if (neighborListIsStale(particles)) {
+            buildGrid(particles, cutoff + skin, false);
+            buildNeighborList(particles, pool);
+        }
+        computeFromNeighborList(particles, isTarget, pool, policy);
+    } else {
+        buildGrid(particles, cutoff, Policy::skipsNeutral);
+        computeFromGrid(particles, isTarget, pool, policy);
+    }
+}
+
+// Bins the particles into a uniform grid with a counting sort, so the particles of each cell occupy a contiguous range of sortedIndex.
+// reach is the largest distance at which two particles still have to find each other. With skipNeutral, neutral particles are left out
+// (their cell is notBinned) and the grid only spans the charged ones.
+void CellListSolver::buildGrid(const ParticleStore& particles, double reach, bool skipNeutral) {
+    const std::size_t count = particles.size();
+    std::size_t binnedCount = 0;
+    double low[3] = {0.0, 0.0, 0.0};
+    double high[3] = {0.0, 0.0, 0.0};
+    for (std::size_t i = 0; i < count; ++i) {
+        if (skipNeutral && particles.charge[i] == 0.0) {
+            continue;
+        }
+        if (binnedCount++ == 0) {
+            low[0] = high[0] = particles.x[i];
+            low[1] = high[1] = particles.y[i];
+            low[2] = high[2] = particles.z[i];
+            continue;
+        }
+        low[0] = std::min(low[0], particles.x[i]);
+        low[1] = std::min(low[1], particles.y[i]);
+        low[2] = std::min(low[2], particles.z[i]);
+        high[0] = std::max(high[0], particles.x[i]);
+        high[1] = std::max(high[1], particles.y[i]);
+        high[2] = std::max(high[2], particles.z[i]);
+    }
+
+    // Sparse events would need an enormous grid, so the cells are enlarged until there are at most a few per particle.
+    const std::size_t maxCells = std::max<std::size_t>(27, 4 * binnedCount);
+    gridCellSize = (cellSize > 0.0) ? cellSize : reach;
+    while (true) {
+        std::size_t total = 1;
+        for (int axis = 0; axis < 3; ++axis) {
+            dims[axis] = static_cast<std::size_t>((high[axis] - low[axis]) / gridCellSize) + 1;
+            total *= dims[axis];
+        }
+        if (total <= maxCells) {
+            break;
+        }
+        gridCellSize *= 2.0;
+    }
+    origin[0] = low[0];
+    origin[1] = low[1];
+    origin[2] = low[2];
+    stencilReach = std::max(1, static_cast<int>(std::ceil(reach / gridCellSize)));
+
+    // Counting sort: count the particles per cell, turn the counts into start offsets, then scatter.
+    const std::size_t cellCount = dims[0] * dims[1] * dims[2];
+    cellOfParticle.resize(count);
+    // The cell count changes as the particles spread, but never exceeds maxCells, so the per-cell buffers are sized for that bound.
+    reserveScratch(cellStart, maxCells + 1);
+    cellStart.assign(cellCount + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (skipNeutral && particles.charge[i] == 0.0) {
+            cellOfParticle[i] = notBinned;
+            continue;
+        }
+        const std::size_t cx = cellCoordinate(particles.x[i], origin[0], gridCellSize, dims[0]);
+        const std::size_t cy = cellCoordinate(particles.y[i], origin[1], gridCellSize, dims[1]);
+        const std::size_t cz = cellCoordinate(particles.z[i], origin[2], gridCellSize, dims[2]);
+        const std::uint32_t cell = static_cast<std::uint32_t>((cz * dims[1] + cy) * dims[0] + cx);
+        cellOfParticle[i] = cell;
+        ++cellStart[cell + 1];
+    }
+    for (std::size_t cell = 0; cell < cellCount; ++cell) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    // Reserved for every particle, so that a step with more charged particles than the last does not reallocate.
+    sortedIndex.reserve(count);
+    sx.reserve(count);
+    sy.reserve(count);
+    sz.reserve(count);
+    sq.reserve(count);
+    sortedIndex.resize(binnedCount);
+    sx.resize(binnedCount);
+    sy.resize(binnedCount);
+    sz.resize(binnedCount);
+    sq.resize(binnedCount);
+    reserveScratch(cellCursor, maxCells);
+    cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (cellOfParticle[i] == notBinned) {
+            continue;
+        }
+        const std::uint32_t position = cellCursor[cellOfParticle[i]]++;
+        sortedIndex[position] = static_cast<std::uint32_t>(i);
+        sx[position] = particles.x[i];
+        sy[position] = particles.y[i];
+        sz[position] = particles.z[i];
+        sq[position] = particles.charge[i];
+    }
+}
+
+// Evaluates the forces straight from the grid: each particle visits the cells of its stencil and interacts with every particle within the cutoff.
+template <typename Policy>
+void CellListSolver::computeFromGrid(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy) {
+    const std::size_t cellCount = dims[0] * dims[1] * dims[2];
+    const std::size_t taskCount = (cellCount + cellsPerTask - 1) / cellsPerTask;
+
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t firstCell = task * cellsPerTask;
+        const std::size_t lastCell = std::min(firstCell + cellsPerTask, cellCount);
+        std::size_t interactions = 0;
+        for (std::size_t cell = firstCell; cell < lastCell; ++cell) {
+            if (cellStart[cell] == cellStart[cell + 1]) {
+                continue;
+            }
+            const long cx = static_cast<long>(cell % dims[0]);
+            const long cy = static_cast<long>((cell / dims[0]) % dims[1]);
+            const long cz = static_cast<long>(cell / (dims[0] * dims[1]));
+
+            for (std::uint32_t a = cellStart[cell]; a < cellStart[cell + 1]; ++a) {
+                const std::uint32_t i = sortedIndex[a];
+                if (isTarget && !isTarget[i]) {
+                    continue;
+                }
+                double gx = 0.0, gy = 0.0, gz = 0.0;
+                interactions += sumFromGrid(a, cx, cy, cz, gx, gy, gz, policy);
+                const double kqi = Policy::coupling * sq[a];
+                particles.fx[i] += kqi * gx;
+                particles.fy[i] += kqi * gy;
+                particles.fz[i] += kqi * gz;
+            }
+        }
+        METRICS_COUNT(Counter::PAIR_INTERACTIONS, interactions);
+    });
+}
+
+// Sums q_j S(r^2) (r_j - r_i) over the particles within the cutoff of the particle at sorted position a, which lies in cell (cx, cy, cz).
+// Returns the number of interactions.
+template <typename Policy>
+std::size_t CellListSolver::sumFromGrid(std::uint32_t a, long cx, long cy, long cz, double& gx, double& gy, double& gz,
+                                        const Policy& policy) const {
+    const double cutoffSquared = cutoff * cutoff;
+    const int reach = stencilReach;
+    const double xi = sx[a], yi = sy[a], zi = sz[a];
+    std::size_t interactions = 0;
+    for (long nz = std::max(0L, cz - reach); nz <= std::min<long>(dims[2] - 1, cz + reach); ++nz) {
+        for (long ny = std::max(0L, cy - reach); ny <= std::min<long>(dims[1] - 1, cy + reach); ++ny) {
+            // Cells along x are adjacent in memory, so a whole row of the stencil is one contiguous range of particles.
+            const long nxLow = std::max(0L, cx - reach);
+            const long nxHigh = std::min<long>(dims[0] - 1, cx + reach);
+            const std::size_t rowBase = (static_cast<std::size_t>(nz) * dims[1] + static_cast<std::size_t>(ny)) * dims[0];
+            const std::uint32_t begin = cellStart[rowBase + nxLow];
+            const std::uint32_t end = cellStart[rowBase + nxHigh + 1];
+            for (std::uint32_t b = begin; b < end; ++b) {
+                const double dx = sx[b] - xi;
+                const double dy = sy[b] - yi;
+                const double dz = sz[b] - zi;
+                const double r2 = dx*dx + dy*dy + dz*dz;
+                if (b == a || r2 >= cutoffSquared) {
+                    continue;
+                }
+                ++interactions;
+                const double scale = policy.pairScale(sq[b], r2);
+                gx += scale * dx;
+                gy += scale * dy;
+                gz += scale * dz;
+            }
+        }
+    }
+    return interactions;
+}
+
+// Checks whether the neighbor list has to be rebuilt: the particle set or the radii changed, or some particle moved more than skin / 2.
+// Two particles that each moved less than skin / 2 cannot have closed a gap of more than skin, so every pair within the cutoff is still listed.
+bool CellListSolver::neighborListIsStale(const ParticleStore& particles) const {
+    if (referenceX.size() != particles.size() || builtCutoff != cutoff || builtSkin != skin) {
+        return true;
+    }
+    const double limitSquared = 0.25 * skin * skin;
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        const double dx = particles.x[i] - referenceX[i];
+        const double dy = particles.y[i] - referenceY[i];
+        const double dz = particles.z[i] - referenceZ[i];
+        if (dx*dx + dy*dy + dz*dz > limitSquared) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Builds the Verlet neighbor list (all pairs closer than cutoff + skin) from the grid.
+// The first pass counts each particle's neighbors, the rows are laid out with a prefix sum, and the second pass fills them.
+void CellListSolver::buildNeighborList(const ParticleStore& particles, ThreadPool& pool) {
+    const std::size_t count = particles.size();
+    const double listRadiusSquared = (cutoff + skin) * (cutoff + skin);
+    const int reach = stencilReach;
+
+    // Visits the listed neighbors of the particle at a sorted position, in cell order.
+    auto forEachNeighbor = [&](std::uint32_t a, auto&& visit) {
+        const std::size_t cell = cellOfParticle[sortedIndex[a]];
+        const long cx = static_cast<long>(cell % dims[0]);
+        const long cy = static_cast<long>((cell / dims[0]) % dims[1]);
+        const long cz = static_cast<long>(cell / (dims[0] * dims[1]));
+        for (long nz = std::max(0L, cz - reach); nz <= std::min<long>(dims[2] - 1, cz + reach); ++nz) {
+            for (long ny = std::max(0L, cy - reach); ny <= std::min<long>(dims[1] - 1, cy + reach); ++ny) {
+                const std::size_t rowBase = (static_cast<std::size_t>(nz) * dims[1] + static_cast<std::size_t>(ny)) * dims[0];
+                const std::uint32_t begin = cellStart[rowBase + std::max(0L, cx - reach)];
+                const std::uint32_t end = cellStart[rowBase + std::min<long>(dims[0] - 1, cx + reach) + 1];
+                for (std::uint32_t b = begin; b < end; ++b) {
+                    const double dx = sx[b] - sx[a];
+                    const double dy = sy[b] - sy[a];
+                    const double dz = sz[b] - sz[a];
+                    if (b != a && dx*dx + dy*dy + dz*dz < listRadiusSquared) {
+                        visit(sortedIndex[b]);
+                    }
+                }
+            }
+        }
+    };
+
+    const std::size_t taskCount = (count + particlesPerTask - 1) / particlesPerTask;
+    neighborStart.assign(count + 1, 0);
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t first = task * particlesPerTask;
+        const std::size_t last = std::min(first + particlesPerTask, count);
+        for (std::size_t a = first; a < last; ++a) {
+            std::uint32_t neighborCount = 0;
+            forEachNeighbor(static_cast<std::uint32_t>(a), [&](std::uint32_t) { ++neighborCount; });
+            neighborStart[sortedIndex[a] + 1] = neighborCount;
+        }
+    });
+    for (std::size_t i = 0; i < count; ++i) {
+        neighborStart[i + 1] += neighborStart[i];
+    }
+    reserveScratch(neighbors, neighborStart[count]);
+    neighbors.resize(neighborStart[count]);
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t first = task * particlesPerTask;
+        const std::size_t last = std::min(first + particlesPerTask, count);
+        for (std::size_t a = first; a < last; ++a) {
+            std::uint32_t slot = neighborStart[sortedIndex[a]];
+            forEachNeighbor(static_cast<std::uint32_t>(a), [&](std::uint32_t j) { neighbors[slot++] = j; });
+        }
+    });
+
+    referenceX.assign(particles.x.begin(), particles.x.end());
+    referenceY.assign(particles.y.begin(), particles.y.end());
+    referenceZ.assign(particles.z.begin(), particles.z.end());
+    builtCutoff = cutoff;
+    builtSkin = skin;
+    ++neighborListBuilds;
+}
+
+// Evaluates the forces over the neighbor list, skipping listed pairs that are currently beyond the cutoff.
+template <typename Policy>
+void CellListSolver::computeFromNeighborList(ParticleStore& particles, const std::uint8_t* isTarget, ThreadPool& pool, const Policy& policy) {
+    const std::size_t count = particles.size();
+    const std::size_t taskCount = (count + particlesPerTask - 1) / particlesPerTask;
+    const double* x = particles.x.data();
+    const double* y = particles.y.data();
+    const double* z = particles.z.data();
+    const double* q = particles.charge.data();
+
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t first = task * particlesPerTask;
+        const std::size_t last = std::min(first + particlesPerTask, count);
+        std::size_t interactions = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            if ((isTarget && !isTarget[i]) || (Policy::skipsNeutral && q[i] == 0.0)) {
+                continue;
+            }
+            double gx = 0.0, gy = 0.0, gz = 0.0;
+            interactions += sumFromNeighborList(i, x, y, z, q, gx, gy, gz, policy);
+            const double kqi = Policy::coupling * q[i];
+            particles.fx[i] += kqi * gx;
+            particles.fy[i] += kqi * gy;
+            particles.fz[i] += kqi * gz;
+        }
+        METRICS_COUNT(Counter::PAIR_INTERACTIONS, interactions);
+    });
+}
+
+// Sums q_j S(r^2) (r_j - r_i) over the listed neighbors of particle i that are within the cutoff, reading positions and charges from the
+// given columns. Returns the number of interactions.
+template <typename Policy>
+std::size_t CellListSolver::sumFromNeighborList(std::size_t i, const double* x, const double* y, const double* z, const double* q,
+                                                double& gx, double& gy, double& gz, const Policy& policy) const {
+    const double cutoffSquared = cutoff * cutoff;
+    const double xi = x[i], yi = y[i], zi = z[i];
+    std::size_t interactions = 0;
+    for (std::uint32_t slot = neighborStart[i]; slot < neighborStart[i + 1]; ++slot) {
+        const std::uint32_t j = neighbors[slot];
+        const double dx = x[j] - xi;
+        const double dy = y[j] - yi;
+        const double dz = z[j] - zi;
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        if (r2 >= cutoffSquared) {
+            continue;
+        }
+        ++interactions;
+        const double scale = policy.pairScale(q[j], r2);
+        gx += scale * dx;
+        gy += scale * dy;
+        gz += scale * dz;
+    }
+    return interactions;
+}
+
+// Bins the particles (and rebuilds the neighbor list if it is stale), and takes the copies that computeRange() reads instead of the store.
+// On the grid path the binned copies are used and rank maps store indices to sorted positions; on the list path the current positions
+// and charges are copied by store index.
+void CellListSolver::prepareRanges(const ParticleStore& particles, ThreadPool& pool) {
+    const std::size_t count = particles.size();
+    if (count < 2) {
+        return;
+    }
+    const InteractionTraits traits = getInteractionTraits(interaction);
+    if (!traits.interacts) {
+        return;
+    }
+    if (skin > 0.0) {
+        if (neighborListIsStale(particles)) {
+            buildGrid(particles, cutoff + skin, false);
+            buildNeighborList(particles, pool);
+        }
+        rangeX.assign(particles.x.begin(), particles.x.end());
+        rangeY.assign(particles.y.begin(), particles.y.end());
+        rangeZ.assign(particles.z.begin(), particles.z.end());
+        rangeQ.assign(particles.charge.begin(), particles.charge.end());
+    } else {
+        buildGrid(particles, cutoff, traits.skipsNeutral);
+        rank.assign(count, notBinned);
+        for (std::size_t a = 0; a < sortedIndex.size(); ++a) {
+            rank[sortedIndex[a]] = static_cast<std::uint32_t>(a);
+        }
+    }
+}
+
+// Adds the short-range forces of the particles in [begin, end) of the store, reading only the solver's copies of the positions.
+// Each particle sums its partners in the same order as computeForces(), so the forces are the same bit for bit.
+void CellListSolver::computeRange(ParticleStore& particles, std::size_t begin, std::size_t end) const {
+    visitInteraction(interaction, [&](const auto& policy) { computeRangeWith(particles, begin, end, policy); });
+}
+
+// Adds the short-range forces of one force law to the particles in [begin, end) of the store.
+template <typename Policy>
+void CellListSolver::computeRangeWith(ParticleStore& particles, std::size_t begin, std::size_t end, const Policy& policy) const {
+    if (!Policy::interacts || particles.size() < 2) {
+        return;
+    }
+    std::size_t interactions = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        double gx = 0.0, gy = 0.0, gz = 0.0;
+        double kqi;
+        if (skin > 0.0) {
+            if (Policy::skipsNeutral && rangeQ[i] == 0.0) {
+                continue;
+            }
+            interactions += sumFromNeighborList(i, rangeX.data(), rangeY.data(), rangeZ.data(), rangeQ.data(), gx, gy, gz, policy);
+            kqi = Policy::coupling * rangeQ[i];
+        } else {
+            const std::uint32_t a = rank[i];
+            if (a == notBinned) {
+                continue;
+            }
+            const std::size_t cell = cellOfParticle[i];
+            interactions += sumFromGrid(a, static_cast<long>(cell % dims[0]), static_cast<long>((cell / dims[0]) % dims[1]),
+                                        static_cast<long>(cell / (dims[0] * dims[1])), gx, gy, gz, policy);
+            kqi = Policy::coupling * sq[a];
+        }
+        particles.fx[i] += kqi * gx;
+        particles.fy[i] += kqi * gy;
+        particles.fz[i] += kqi * gz;
+    }
+    METRICS_COUNT(Counter::PAIR_INTERACTIONS, interactions);
+}
+
+// Writes the parameters and the neighbor list to a checkpoint. The list is part of the state: a list rebuilt after a restart would visit
+// the neighbors in a different order, and the forces would no longer be bit-for-bit those of the uninterrupted run.
+void CellListSolver::save(CheckpointWriter& checkpoint) const {
+    checkpoint.put(cutoff);
+    checkpoint.put(cellSize);
+    checkpoint.put(skin);
+    checkpoint.put(builtCutoff);
+    checkpoint.put(builtSkin);
+    checkpoint.put(static_cast<std::uint64_t>(neighborListBuilds));
+    checkpoint.putColumn(neighborStart);
+    checkpoint.putColumn(neighbors);
+    checkpoint.putColumn(referenceX);
+    checkpoint.putColumn(referenceY);
+    checkpoint.putColumn(referenceZ);
+}
+
+// Restores the solver from a checkpoint written by save(). The grid is rebuilt whenever it is needed, so it is not saved. A cutoff or
+// cell size that Simulation::setCutoff() would ignore can only come from a damaged file and is rejected.
+bool CellListSolver::load(CheckpointReader& checkpoint) {
+    std::uint64_t builds = 0;
+    const bool ok = checkpoint.get(cutoff) && checkpoint.get(cellSize) && checkpoint.get(skin) &&
+                    checkpoint.get(builtCutoff) && checkpoint.get(builtSkin) && checkpoint.get(builds) &&
+                    checkpoint.getColumn(neighborStart) && checkpoint.getColumn(neighbors) &&
+                    checkpoint.getColumn(referenceX) && checkpoint.getColumn(referenceY) && checkpoint.getColumn(referenceZ);
+    neighborListBuilds = static_cast<std::size_t>(builds);
+    return ok && cutoff > 0.0 && std::isfinite(cutoff) && cellSize >= 0.0 && std::isfinite(cellSize);
+}
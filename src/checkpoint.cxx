@@ -0,0 +1,121 @@
+#include "checkpoint.h" // Include the checkpoint payload classes and file functions.
+#include "metrics.h"    // Include the instrumentation macros.
+#include <cstdio>       // Required for std::FILE, std::fopen, std::fread and std::fwrite.
+#ifdef PHYSICS_SIMULATION_HAS_ZLIB
+#include <zlib.h>       // Required for compress2() and uncompress().
+#endif
+
+namespace {
+
+constexpr std::uint32_t compressedFlag = 1;
+constexpr std::uint64_t maxCompressionRatio = 1032; // Deflate never shrinks data by more than about 1032:1.
+
+// Header at the start of every checkpoint file.
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t payloadBytes; // Size of the payload
+    std::uint64_t storedBytes;  // Size of the payload as stored in the file (smaller than payloadBytes if it is compressed)
+};
+static_assert(sizeof(FileHeader) == 32, "The checkpoint header must be 32 bytes.");
+
+} // namespace
+
+// Checks whether this build can compress checkpoints.
+bool isCheckpointCompressionAvailable() {
+#ifdef PHYSICS_SIMULATION_HAS_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Writes the header and the payload with one write each. With compress set (and zlib available), the payload is compressed at zlib's
+// fastest level first; double-precision columns compress poorly, so this trades a lot of time for a modest saving and is off by default.
+bool writeCheckpointFile(const std::string& path, const std::vector<char>& payload, bool compress) {
+    FileHeader header = {};
+    std::memcpy(header.magic, checkpointMagic, 8);
+    header.version = checkpointVersion;
+    header.payloadBytes = payload.size();
+
+    const char* stored = payload.data();
+    header.storedBytes = payload.size();
+#ifdef PHYSICS_SIMULATION_HAS_ZLIB
+    std::vector<char> compressed;
+    if (compress) {
+        uLongf compressedBytes = compressBound(static_cast<uLong>(payload.size()));
+        compressed.resize(compressedBytes);
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedBytes,
+                      reinterpret_cast<const Bytef*>(payload.data()), static_cast<uLong>(payload.size()), Z_BEST_SPEED) != Z_OK) {
+            return false;
+        }
+        header.flags |= compressedFlag;
+        stored = compressed.data();
+        header.storedBytes = compressedBytes;
+    }
+#else
+    if (compress) {
+        return false; // Built without zlib.
+    }
+#endif
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(stored, 1, header.storedBytes, file) == header.storedBytes;
+    METRICS_COUNT(Counter::BYTES_WRITTEN, ok ? sizeof(header) + header.storedBytes : 0);
+    return std::fclose(file) == 0 && ok;
+}
+
+// Reads the header, then the stored payload with a single read (straight into the payload buffer unless it has to be decompressed).
+// Both sizes in the header are checked before anything is allocated: the stored size must be what is left of the file, and the payload
+// size must be one the stored bytes can hold, so a damaged header is reported instead of asking for an enormous buffer.
+bool readCheckpointFile(const std::string& path, std::vector<char>& payload) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    FileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, checkpointMagic, 8) != 0 ||
+        header.version != checkpointVersion) {
+        std::fclose(file);
+        return false;
+    }
+    long fileBytes = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        fileBytes = std::ftell(file);
+    }
+    const bool compressed = (header.flags & compressedFlag) != 0;
+    const bool sizesValid = fileBytes >= static_cast<long>(sizeof(header)) &&
+                            header.storedBytes == static_cast<std::uint64_t>(fileBytes) - sizeof(header) &&
+                            (compressed ? header.payloadBytes / maxCompressionRatio <= header.storedBytes : header.payloadBytes == header.storedBytes);
+    if (!sizesValid || std::fseek(file, sizeof(header), SEEK_SET) != 0) {
+        std::fclose(file);
+        return false;
+    }
+
+    std::vector<char> stored;
+    std::vector<char>& target = compressed ? stored : payload;
+    target.resize(header.storedBytes);
+    const bool ok = std::fread(target.data(), 1, target.size(), file) == target.size();
+    std::fclose(file);
+    if (!ok) {
+        return false;
+    }
+    if (!compressed) {
+        return true;
+    }
+
+#ifdef PHYSICS_SIMULATION_HAS_ZLIB
+    payload.resize(header.payloadBytes);
+    uLongf payloadBytes = static_cast<uLongf>(header.payloadBytes);
+    return uncompress(reinterpret_cast<Bytef*>(payload.data()), &payloadBytes,
+                      reinterpret_cast<const Bytef*>(stored.data()), static_cast<uLong>(stored.size())) == Z_OK &&
+           payloadBytes == header.payloadBytes;
+#else
+    return false; // Compressed, but built without zlib.
+#endif
+}
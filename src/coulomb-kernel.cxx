@@ -0,0 +1,338 @@
+#include "coulomb-kernel.h" // Include the Coulomb pair kernel declarations.
+#include <cmath>            // For mathematical operations.
+
+// The vector kernels are compiled with per-function target attributes, so the rest of the program keeps the baseline instruction set
+// and only the kernel matching the CPU is ever called.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMULATION_HAVE_X86_KERNELS 1
+#include <immintrin.h>      // Required for the AVX2 and AVX-512 intrinsics.
+#endif
+
+namespace {
+
+// Scalar kernel: one pair at a time, using a single division per pair for 1 / r^3.
+void coulombRowScalar(double xi, double yi, double zi, double kqi,
+                      const double* x, const double* y, const double* z, const double* q,
+                      double* fx, double* fy, double* fz, std::size_t count, double targetForce[3], double softening) {
+    double fxi = 0.0, fyi = 0.0, fzi = 0.0;
+    for (std::size_t j = 0; j < count; ++j) {
+        const double dx = x[j] - xi;
+        const double dy = y[j] - yi;
+        const double dz = z[j] - zi;
+        const double distanceSquared = dx*dx + dy*dy + dz*dz + softening;
+        const double scale = kqi * q[j] / (distanceSquared * std::sqrt(distanceSquared));
+        fxi += scale * dx;
+        fyi += scale * dy;
+        fzi += scale * dz;
+        fx[j] -= scale * dx;
+        fy[j] -= scale * dy;
+        fz[j] -= scale * dz;
+    }
+    targetForce[0] += fxi;
+    targetForce[1] += fyi;
+    targetForce[2] += fzi;
+}
+
+// Single-precision scalar kernel: the same loop as coulombRowScalar in float.
+void coulombRowScalarFloat(float xi, float yi, float zi, float kqi,
+                           const float* x, const float* y, const float* z, const float* q,
+                           float* fx, float* fy, float* fz, std::size_t count, float targetForce[3], float softening) {
+    float fxi = 0.0f, fyi = 0.0f, fzi = 0.0f;
+    for (std::size_t j = 0; j < count; ++j) {
+        const float dx = x[j] - xi;
+        const float dy = y[j] - yi;
+        const float dz = z[j] - zi;
+        const float distanceSquared = dx*dx + dy*dy + dz*dz + softening;
+        const float scale = kqi * q[j] / (distanceSquared * std::sqrt(distanceSquared));
+        fxi += scale * dx;
+        fyi += scale * dy;
+        fzi += scale * dz;
+        fx[j] -= scale * dx;
+        fy[j] -= scale * dy;
+        fz[j] -= scale * dz;
+    }
+    targetForce[0] += fxi;
+    targetForce[1] += fyi;
+    targetForce[2] += fzi;
+}
+
+#ifdef SIMULATION_HAVE_X86_KERNELS
+
+// Adds the four lanes of an AVX register.
+__attribute__((target("avx2,fma")))
+inline double horizontalSum(__m256d v) {
+    __m128d low = _mm256_castpd256_pd128(v);
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    low = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+// AVX2 kernel: four sources per iteration. 1 / r^3 is one square root and one division per lane, which keeps full double precision.
+__attribute__((target("avx2,fma")))
+void coulombRowAvx2(double xi, double yi, double zi, double kqi,
+                    const double* x, const double* y, const double* z, const double* q,
+                    double* fx, double* fy, double* fz, std::size_t count, double targetForce[3], double softening) {
+    const __m256d vxi = _mm256_set1_pd(xi);
+    const __m256d vyi = _mm256_set1_pd(yi);
+    const __m256d vzi = _mm256_set1_pd(zi);
+    const __m256d vkqi = _mm256_set1_pd(kqi);
+    const __m256d vsoftening = _mm256_set1_pd(softening);
+    __m256d accX = _mm256_setzero_pd();
+    __m256d accY = _mm256_setzero_pd();
+    __m256d accZ = _mm256_setzero_pd();
+
+    std::size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), vxi);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), vyi);
+        const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + j), vzi);
+        const __m256d distanceSquared = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_fmadd_pd(dx, dx, vsoftening)));
+        const __m256d r3 = _mm256_mul_pd(distanceSquared, _mm256_sqrt_pd(distanceSquared));
+        const __m256d scale = _mm256_div_pd(_mm256_mul_pd(vkqi, _mm256_loadu_pd(q + j)), r3);
+        const __m256d fxj = _mm256_mul_pd(scale, dx);
+        const __m256d fyj = _mm256_mul_pd(scale, dy);
+        const __m256d fzj = _mm256_mul_pd(scale, dz);
+        accX = _mm256_add_pd(accX, fxj);
+        accY = _mm256_add_pd(accY, fyj);
+        accZ = _mm256_add_pd(accZ, fzj);
+        _mm256_storeu_pd(fx + j, _mm256_sub_pd(_mm256_loadu_pd(fx + j), fxj));
+        _mm256_storeu_pd(fy + j, _mm256_sub_pd(_mm256_loadu_pd(fy + j), fyj));
+        _mm256_storeu_pd(fz + j, _mm256_sub_pd(_mm256_loadu_pd(fz + j), fzj));
+    }
+    targetForce[0] += horizontalSum(accX);
+    targetForce[1] += horizontalSum(accY);
+    targetForce[2] += horizontalSum(accZ);
+
+    // The last few sources (fewer than four) go through the scalar kernel.
+    coulombRowScalar(xi, yi, zi, kqi, x + j, y + j, z + j, q + j, fx + j, fy + j, fz + j, count - j, targetForce, softening);
+}
+
+// AVX-512 kernel: eight sources per iteration, with masked loads and stores for the remainder.
+// 1 / sqrt(r^2) starts from the 14-bit hardware estimate and is refined with two Newton-Raphson steps, which brings it to double precision
+// without any division or square root instruction.
+__attribute__((target("avx512f")))
+void coulombRowAvx512(double xi, double yi, double zi, double kqi,
+                      const double* x, const double* y, const double* z, const double* q,
+                      double* fx, double* fy, double* fz, std::size_t count, double targetForce[3], double softening) {
+    const __m512d vxi = _mm512_set1_pd(xi);
+    const __m512d vyi = _mm512_set1_pd(yi);
+    const __m512d vzi = _mm512_set1_pd(zi);
+    const __m512d vkqi = _mm512_set1_pd(kqi);
+    const __m512d vsoftening = _mm512_set1_pd(softening);
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d threeHalves = _mm512_set1_pd(1.5);
+    __m512d accX = _mm512_setzero_pd();
+    __m512d accY = _mm512_setzero_pd();
+    __m512d accZ = _mm512_setzero_pd();
+
+    for (std::size_t j = 0; j < count; j += 8) {
+        const std::size_t remaining = count - j;
+        const __mmask8 mask = remaining >= 8 ? static_cast<__mmask8>(0xFF) : static_cast<__mmask8>((1u << remaining) - 1u);
+        // Masked-off lanes load zero; their charge of zero makes their force zero as well.
+        const __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + j), vxi);
+        const __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, y + j), vyi);
+        const __m512d dz = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, z + j), vzi);
+        const __m512d distanceSquared = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_fmadd_pd(dx, dx, vsoftening)));
+
+        // y ~ 1 / sqrt(d2); each Newton step y = y * (1.5 - 0.5 * d2 * y^2) doubles the number of correct bits.
+        __m512d inverseR = _mm512_rsqrt14_pd(distanceSquared);
+        const __m512d halfD2 = _mm512_mul_pd(half, distanceSquared);
+        inverseR = _mm512_mul_pd(inverseR, _mm512_fnmadd_pd(halfD2, _mm512_mul_pd(inverseR, inverseR), threeHalves));
+        inverseR = _mm512_mul_pd(inverseR, _mm512_fnmadd_pd(halfD2, _mm512_mul_pd(inverseR, inverseR), threeHalves));
+        const __m512d inverseR3 = _mm512_mul_pd(inverseR, _mm512_mul_pd(inverseR, inverseR));
+
+        const __m512d scale = _mm512_mul_pd(_mm512_mul_pd(vkqi, _mm512_maskz_loadu_pd(mask, q + j)), inverseR3);
+        const __m512d fxj = _mm512_mul_pd(scale, dx);
+        const __m512d fyj = _mm512_mul_pd(scale, dy);
+        const __m512d fzj = _mm512_mul_pd(scale, dz);
+        accX = _mm512_add_pd(accX, fxj);
+        accY = _mm512_add_pd(accY, fyj);
+        accZ = _mm512_add_pd(accZ, fzj);
+        _mm512_mask_storeu_pd(fx + j, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, fx + j), fxj));
+        _mm512_mask_storeu_pd(fy + j, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, fy + j), fyj));
+        _mm512_mask_storeu_pd(fz + j, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, fz + j), fzj));
+    }
+    targetForce[0] += _mm512_reduce_add_pd(accX);
+    targetForce[1] += _mm512_reduce_add_pd(accY);
+    targetForce[2] += _mm512_reduce_add_pd(accZ);
+}
+
+// Adds the eight lanes of a single-precision AVX register.
+__attribute__((target("avx2,fma")))
+inline float horizontalSum(__m256 v) {
+    __m128 low = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    low = _mm_add_ps(low, _mm_movehl_ps(low, low));
+    return _mm_cvtss_f32(_mm_add_ss(low, _mm_movehdup_ps(low)));
+}
+
+// Single-precision AVX2 kernel: eight sources per iteration, twice the double kernel's width, with the same square root and division.
+__attribute__((target("avx2,fma")))
+void coulombRowAvx2Float(float xi, float yi, float zi, float kqi,
+                         const float* x, const float* y, const float* z, const float* q,
+                         float* fx, float* fy, float* fz, std::size_t count, float targetForce[3], float softening) {
+    const __m256 vxi = _mm256_set1_ps(xi);
+    const __m256 vyi = _mm256_set1_ps(yi);
+    const __m256 vzi = _mm256_set1_ps(zi);
+    const __m256 vkqi = _mm256_set1_ps(kqi);
+    const __m256 vsoftening = _mm256_set1_ps(softening);
+    __m256 accX = _mm256_setzero_ps();
+    __m256 accY = _mm256_setzero_ps();
+    __m256 accZ = _mm256_setzero_ps();
+
+    std::size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + j), vxi);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + j), vyi);
+        const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + j), vzi);
+        const __m256 distanceSquared = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_fmadd_ps(dx, dx, vsoftening)));
+        const __m256 r3 = _mm256_mul_ps(distanceSquared, _mm256_sqrt_ps(distanceSquared));
+        const __m256 scale = _mm256_div_ps(_mm256_mul_ps(vkqi, _mm256_loadu_ps(q + j)), r3);
+        const __m256 fxj = _mm256_mul_ps(scale, dx);
+        const __m256 fyj = _mm256_mul_ps(scale, dy);
+        const __m256 fzj = _mm256_mul_ps(scale, dz);
+        accX = _mm256_add_ps(accX, fxj);
+        accY = _mm256_add_ps(accY, fyj);
+        accZ = _mm256_add_ps(accZ, fzj);
+        _mm256_storeu_ps(fx + j, _mm256_sub_ps(_mm256_loadu_ps(fx + j), fxj));
+        _mm256_storeu_ps(fy + j, _mm256_sub_ps(_mm256_loadu_ps(fy + j), fyj));
+        _mm256_storeu_ps(fz + j, _mm256_sub_ps(_mm256_loadu_ps(fz + j), fzj));
+    }
+    targetForce[0] += horizontalSum(accX);
+    targetForce[1] += horizontalSum(accY);
+    targetForce[2] += horizontalSum(accZ);
+
+    // The last few sources (fewer than eight) go through the scalar kernel.
+    coulombRowScalarFloat(xi, yi, zi, kqi, x + j, y + j, z + j, q + j, fx + j, fy + j, fz + j, count - j, targetForce, softening);
+}
+
+// Single-precision AVX-512 kernel: sixteen sources per iteration, with masked loads and stores for the remainder.
+// One Newton-Raphson step takes the 14-bit estimate of 1 / sqrt(r^2) past the 24 bits of a float.
+__attribute__((target("avx512f")))
+void coulombRowAvx512Float(float xi, float yi, float zi, float kqi,
+                           const float* x, const float* y, const float* z, const float* q,
+                           float* fx, float* fy, float* fz, std::size_t count, float targetForce[3], float softening) {
+    const __m512 vxi = _mm512_set1_ps(xi);
+    const __m512 vyi = _mm512_set1_ps(yi);
+    const __m512 vzi = _mm512_set1_ps(zi);
+    const __m512 vkqi = _mm512_set1_ps(kqi);
+    const __m512 vsoftening = _mm512_set1_ps(softening);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+    __m512 accX = _mm512_setzero_ps();
+    __m512 accY = _mm512_setzero_ps();
+    __m512 accZ = _mm512_setzero_ps();
+
+    for (std::size_t j = 0; j < count; j += 16) {
+        const std::size_t remaining = count - j;
+        const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << remaining) - 1u);
+        // Masked-off lanes load zero; their charge of zero makes their force zero as well.
+        const __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, x + j), vxi);
+        const __m512 dy = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, y + j), vyi);
+        const __m512 dz = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, z + j), vzi);
+        const __m512 distanceSquared = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_fmadd_ps(dx, dx, vsoftening)));
+
+        __m512 inverseR = _mm512_rsqrt14_ps(distanceSquared);
+        const __m512 halfD2 = _mm512_mul_ps(half, distanceSquared);
+        inverseR = _mm512_mul_ps(inverseR, _mm512_fnmadd_ps(halfD2, _mm512_mul_ps(inverseR, inverseR), threeHalves));
+        const __m512 inverseR3 = _mm512_mul_ps(inverseR, _mm512_mul_ps(inverseR, inverseR));
+
+        const __m512 scale = _mm512_mul_ps(_mm512_mul_ps(vkqi, _mm512_maskz_loadu_ps(mask, q + j)), inverseR3);
+        const __m512 fxj = _mm512_mul_ps(scale, dx);
+        const __m512 fyj = _mm512_mul_ps(scale, dy);
+        const __m512 fzj = _mm512_mul_ps(scale, dz);
+        accX = _mm512_add_ps(accX, fxj);
+        accY = _mm512_add_ps(accY, fyj);
+        accZ = _mm512_add_ps(accZ, fzj);
+        _mm512_mask_storeu_ps(fx + j, mask, _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, fx + j), fxj));
+        _mm512_mask_storeu_ps(fy + j, mask, _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, fy + j), fyj));
+        _mm512_mask_storeu_ps(fz + j, mask, _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, fz + j), fzj));
+    }
+    targetForce[0] += _mm512_reduce_add_ps(accX);
+    targetForce[1] += _mm512_reduce_add_ps(accY);
+    targetForce[2] += _mm512_reduce_add_ps(accZ);
+}
+
+#endif // SIMULATION_HAVE_X86_KERNELS
+
+// Kernel used by the force solvers, chosen when the program starts.
+CoulombRowKernel activeKernel = getCoulombRowKernel(detectSimdLevel());
+FloatCoulombRowKernel activeFloatKernel = getFloatCoulombRowKernel(detectSimdLevel());
+SimdLevel activeLevel = detectSimdLevel();
+
+} // namespace
+
+// Returns the widest instruction set that this CPU (and operating system) supports.
+SimdLevel detectSimdLevel() {
+#ifdef SIMULATION_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+// Checks whether the kernel for level can run on this CPU.
+bool isSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return true;
+        case SimdLevel::AVX2:   return detectSimdLevel() != SimdLevel::SCALAR;
+        case SimdLevel::AVX512: return detectSimdLevel() == SimdLevel::AVX512;
+    }
+    return false;
+}
+
+// Returns the kernel for a given instruction set.
+CoulombRowKernel getCoulombRowKernel(SimdLevel level) {
+#ifdef SIMULATION_HAVE_X86_KERNELS
+    if (level == SimdLevel::AVX512) {
+        return coulombRowAvx512;
+    }
+    if (level == SimdLevel::AVX2) {
+        return coulombRowAvx2;
+    }
+#else
+    (void)level;
+#endif
+    return coulombRowScalar;
+}
+
+// Returns the single-precision kernel for a given instruction set.
+FloatCoulombRowKernel getFloatCoulombRowKernel(SimdLevel level) {
+#ifdef SIMULATION_HAVE_X86_KERNELS
+    if (level == SimdLevel::AVX512) {
+        return coulombRowAvx512Float;
+    }
+    if (level == SimdLevel::AVX2) {
+        return coulombRowAvx2Float;
+    }
+#else
+    (void)level;
+#endif
+    return coulombRowScalarFloat;
+}
+
+// Returns the kernel used by the force solvers.
+CoulombRowKernel getActiveCoulombRowKernel() {
+    return activeKernel;
+}
+
+// Returns the single-precision kernel of the active instruction set.
+FloatCoulombRowKernel getActiveFloatCoulombRowKernel() {
+    return activeFloatKernel;
+}
+
+// Returns the instruction set of the kernel used by the force solvers.
+SimdLevel getActiveSimdLevel() {
+    return activeLevel;
+}
+
+// Overrides the startup choice. Unsupported levels fall back to the scalar kernel.
+void setActiveSimdLevel(SimdLevel level) {
+    activeLevel = isSimdLevelSupported(level) ? level : SimdLevel::SCALAR;
+    activeKernel = getCoulombRowKernel(activeLevel);
+    activeFloatKernel = getFloatCoulombRowKernel(activeLevel);
+}
@@ -0,0 +1,187 @@
+#include "decay.h"      // Include the AliasTable and DecayEngine class definitions.
+#include "species.h"    // Include the species registry.
+#include "metrics.h"    // Include the instrumentation macros.
+#include <algorithm>    // Required for std::is_sorted and std::sort.
+#include <cmath>        // For mathematical operations.
+
+// Builds the alias table for a list of decay modes with Vose's algorithm.
+// Each of the n columns holds probability mass 1/n, split between its own outcome and at most one alias.
+AliasTable::AliasTable(DecayModeList modes) {
+    const std::size_t n = modes.size();
+    if (n == 0) {
+        return;
+    }
+
+    double total = 0.0;
+    for (const auto& mode : modes) {
+        total += mode.branchingRatio;
+    }
+
+    threshold.resize(n);
+    alias.resize(n);
+    outcome.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<std::uint32_t> small, large;
+    for (std::size_t k = 0; k < n; ++k) {
+        outcome[k] = modes[k].productType;
+        scaled[k] = modes[k].branchingRatio / total * static_cast<double>(n);
+        alias[k] = static_cast<std::uint32_t>(k);
+        (scaled[k] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(k));
+    }
+    while (!small.empty() && !large.empty()) {
+        const std::uint32_t less = small.back();
+        small.pop_back();
+        const std::uint32_t more = large.back();
+        large.pop_back();
+        threshold[less] = scaled[less];
+        alias[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        (scaled[more] < 1.0 ? small : large).push_back(more);
+    }
+    // Whatever is left is (up to rounding) exactly full.
+    for (std::uint32_t k : large) {
+        threshold[k] = 1.0;
+    }
+    for (std::uint32_t k : small) {
+        threshold[k] = 1.0;
+    }
+}
+
+// Returns the product type selected by a uniform random number u in [0, 1).
+// The integer part of u * n picks a column and the fractional part decides between the column's outcome and its alias.
+ParticleType AliasTable::sample(double u) const {
+    const double scaled = u * static_cast<double>(outcome.size());
+    std::size_t column = static_cast<std::size_t>(scaled);
+    if (column >= outcome.size()) {
+        column = outcome.size() - 1;
+    }
+    const double fraction = scaled - static_cast<double>(column);
+    return fraction < threshold[column] ? outcome[column] : outcome[alias[column]];
+}
+
+// Returns the alias table of a particle type. The tables of all types are built from the species registry the first time any of them is needed.
+const AliasTable& getDecayAliasTable(ParticleType type) {
+    static const std::vector<AliasTable> tables = [] {
+        std::vector<AliasTable> built;
+        for (const SpeciesInfo& species : speciesRegistry) {
+            built.emplace_back(species.decayModeList());
+        }
+        return built;
+    }();
+    return tables[static_cast<int>(type)];
+}
+
+// Decays the unstable particles of one step. Returns the number of decays (including decays of products within the same step).
+std::size_t DecayEngine::decayParticles(ParticleStore& particles, double deltaTime, const CounterRng& rng, std::uint64_t step) {
+    beginChunks(1);
+    stageChunk(particles, 0, 0, particles.size(), deltaTime, rng, step);
+    return applyStaged(particles);
+}
+
+// Prepares the staging areas of a step split into chunkCount chunks. The areas keep their capacity between steps.
+void DecayEngine::beginChunks(std::size_t count) {
+    if (chunks.size() < count) {
+        chunks.resize(count);
+    }
+    chunkCount = count;
+}
+
+// Decides which particles in [begin, end) decay within the step, and stages their products (after any cascade) without changing the store.
+void DecayEngine::stageChunk(const ParticleStore& particles, std::size_t chunk, std::size_t begin, std::size_t end,
+                             double deltaTime, const CounterRng& rng, std::uint64_t step) {
+    // Exponentially distributed decay time with mean tau (u lies in (0, 1), so the logarithm is finite).
+    auto sampleDecayTime = [](double tau, RandomStream& random) { return -tau * std::log(random.uniform()); };
+
+    ChunkStaging& staging = chunks[chunk];
+    staging.decayedIndices.clear();
+    staging.products.clear();
+    staging.removed = Observables();
+    staging.decays = 0;
+    staging.decaysByType = {};
+
+    // Pass 1: decide which particles decay and stage their products.
+    for (std::size_t i = begin; i < end; ++i) {
+        const double tau = particles.lifetime[i];
+        if (tau <= 0.0) {
+            continue;
+        }
+        const AliasTable& table = getDecayAliasTable(particles.type[i]);
+        if (table.empty()) {
+            continue;
+        }
+        RandomStream random = rng.stream(RandomPurpose::DECAY, particles.id[i], step);
+        const double decayTime = sampleDecayTime(tau, random);
+        if (decayTime >= deltaTime) {
+            continue;
+        }
+        staging.decayedIndices.push_back(static_cast<std::uint32_t>(i));
+        staging.removed.remove(particles.mass[i], particles.charge[i], tau, particles.vx[i], particles.vy[i], particles.vz[i]);
+        const ParticleType productType = table.sample(random.uniform());
+        staging.products.push_back({productType,
+                                    particles.x[i], particles.y[i], particles.z[i],
+                                    particles.vx[i], particles.vy[i], particles.vz[i],
+                                    deltaTime - decayTime, random, particles.id[i]});
+        ++staging.decays;
+        ++staging.decaysByType[static_cast<std::size_t>(particles.type[i])];
+    }
+
+    // Pass 2: let products decay again in the time left in the step. Each decay replaces the staged product in place.
+    for (auto& product : staging.products) {
+        for (int depth = 0; depth < maxCascadeDepth; ++depth) {
+            const double tau = getSpecies(product.type).lifetime;
+            const AliasTable& table = getDecayAliasTable(product.type);
+            if (tau <= 0.0 || table.empty()) {
+                break;
+            }
+            const double decayTime = sampleDecayTime(tau, product.random);
+            if (decayTime >= product.remainingTime) {
+                break;
+            }
+            ++staging.decaysByType[static_cast<std::size_t>(product.type)];
+            product.type = table.sample(product.random.uniform());
+            product.remainingTime -= decayTime;
+            ++staging.decays;
+        }
+    }
+}
+
+// Pass 3: removes the parents of all chunks in one compaction pass, then appends the products in parent id order into (geometrically grown)
+// capacity. Unless the store has been reordered, its ids ascend with the index and chunk order already is parent id order; either way
+// the store ends up exactly as if the whole step had been staged as one chunk.
+std::size_t DecayEngine::applyStaged(ParticleStore& particles) {
+    change = Observables();
+    decayedIndices.clear();
+    std::size_t decays = 0;
+    decaysByType = {};
+    productOrder.clear();
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const ChunkStaging& staging = chunks[chunk];
+        decayedIndices.insert(decayedIndices.end(), staging.decayedIndices.begin(), staging.decayedIndices.end());
+        change += staging.removed;
+        decays += staging.decays;
+        for (std::size_t t = 0; t < particleTypeCount; ++t) {
+            decaysByType[t] += staging.decaysByType[t];
+        }
+        for (const auto& product : staging.products) {
+            productOrder.push_back(&product);
+        }
+    }
+    const std::size_t productCount = productOrder.size();
+    auto byParentId = [](const PendingProduct* a, const PendingProduct* b) { return a->parentId < b->parentId; };
+    if (!std::is_sorted(productOrder.begin(), productOrder.end(), byParentId)) {
+        std::sort(productOrder.begin(), productOrder.end(), byParentId);
+    }
+
+    particles.removeIndices(decayedIndices);
+    particles.ensureCapacity(particles.size() + productCount);
+    for (const PendingProduct* product : productOrder) {
+        const SpeciesInfo& species = getSpecies(product->type);
+        change.add(species.mass, species.charge, species.lifetime, product->vx, product->vy, product->vz);
+        particles.emplace_back(product->type, species.mass, species.charge, species.lifetime,
+                               product->x, product->y, product->z, product->vx, product->vy, product->vz);
+    }
+    METRICS_COUNT(Counter::DECAYS, decays);
+    METRICS_COUNT(Counter::PARTICLES_REMOVED, decayedIndices.size());
+    METRICS_COUNT(Counter::PARTICLES_CREATED, productCount);
+    return decays;
+}
@@ -0,0 +1,288 @@
+#include "distributed-simulation.h" // Include the DistributedSimulation class definition.
+#include "integrator.h"             // Include the fused integration sweeps.
+#include <algorithm>                // Required for std::copy, std::min, std::max and std::sort.
+#include <cmath>                    // For mathematical operations.
+#include <cstdio>                   // Required for std::fprintf.
+#include <limits>                   // Required for std::numeric_limits.
+
+namespace {
+
+// Message tags. A message to the left neighbor and one to the right neighbor use different tags, so the two directions never mix up.
+enum Tag {
+    GHOST_COUNT_TO_LEFT = 10,
+    GHOST_COUNT_TO_RIGHT,
+    GHOSTS_TO_LEFT,
+    GHOSTS_TO_RIGHT,
+    MIGRATING_COUNT_TO_LEFT,
+    MIGRATING_COUNT_TO_RIGHT,
+    MIGRATING_TO_LEFT,
+    MIGRATING_TO_RIGHT
+};
+
+// Returns the element count of a message as an MPI count. Messages count elements of a derived datatype rather than bytes, so the int
+// limit is about two billion particles; a larger message aborts the job instead of being truncated.
+int messageCount(std::size_t count, MPI_Comm communicator) {
+    if (count > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        std::fprintf(stderr, "DistributedSimulation: a message of %zu particles exceeds the MPI count limit\n", count);
+        MPI_Abort(communicator, 1);
+    }
+    return static_cast<int>(count);
+}
+
+// Returns a committed datatype of one plain struct of the given size.
+MPI_Datatype makeStructType(std::size_t bytes) {
+    MPI_Datatype type;
+    MPI_Type_contiguous(static_cast<int>(bytes), MPI_BYTE, &type);
+    MPI_Type_commit(&type);
+    return type;
+}
+
+// Swaps two vectors of plain structs (of the datatype type) with both neighbors (blocking). A neighbor of MPI_PROC_NULL sends nothing
+// and receives nothing.
+template <typename T>
+void exchangeWithNeighbors(MPI_Comm communicator, MPI_Datatype type, int leftRank, int rightRank,
+                           const std::vector<T>& toLeft, const std::vector<T>& toRight, std::vector<T>& fromLeft, std::vector<T>& fromRight) {
+    unsigned long long sendLeft = toLeft.size(), sendRight = toRight.size();
+    unsigned long long receiveLeft = 0, receiveRight = 0;
+    MPI_Sendrecv(&sendLeft, 1, MPI_UNSIGNED_LONG_LONG, leftRank, MIGRATING_COUNT_TO_LEFT,
+                 &receiveRight, 1, MPI_UNSIGNED_LONG_LONG, rightRank, MIGRATING_COUNT_TO_LEFT, communicator, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&sendRight, 1, MPI_UNSIGNED_LONG_LONG, rightRank, MIGRATING_COUNT_TO_RIGHT,
+                 &receiveLeft, 1, MPI_UNSIGNED_LONG_LONG, leftRank, MIGRATING_COUNT_TO_RIGHT, communicator, MPI_STATUS_IGNORE);
+    fromLeft.resize(receiveLeft);
+    fromRight.resize(receiveRight);
+    MPI_Sendrecv(toLeft.data(), messageCount(toLeft.size(), communicator), type, leftRank, MIGRATING_TO_LEFT,
+                 fromRight.data(), messageCount(fromRight.size(), communicator), type, rightRank, MIGRATING_TO_LEFT, communicator, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(toRight.data(), messageCount(toRight.size(), communicator), type, rightRank, MIGRATING_TO_RIGHT,
+                 fromLeft.data(), messageCount(fromLeft.size(), communicator), type, leftRank, MIGRATING_TO_RIGHT, communicator, MPI_STATUS_IGNORE);
+}
+
+} // namespace
+
+// Constructor: Works out this rank's slab and its neighbors. The ghost layer only reaches the neighboring slabs, so slabs narrower than
+// the cutoff would silently lose forces; every rank checks this and aborts the job instead.
+DistributedSimulation::DistributedSimulation(MPI_Comm communicator, double boxMin, double boxMax, double cutoff)
+    : communicator(communicator), boxMin(boxMin), boxMax(boxMax), cutoff(cutoff) {
+    MPI_Comm_rank(communicator, &rank);
+    MPI_Comm_size(communicator, &rankCount);
+    if (rankCount > getMaxRankCount(boxMin, boxMax, cutoff)) {
+        std::fprintf(stderr, "DistributedSimulation: %d ranks need slabs of at least the cutoff %g, but the box [%g, %g) allows at most %d ranks\n",
+                     rankCount, cutoff, boxMin, boxMax, getMaxRankCount(boxMin, boxMax, cutoff));
+        MPI_Abort(communicator, 1);
+    }
+    ghostType = makeStructType(sizeof(Ghost));
+    particleType = makeStructType(sizeof(PackedParticle));
+    leftRank = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+    rightRank = rank + 1 < rankCount ? rank + 1 : MPI_PROC_NULL;
+    slabWidth = (boxMax - boxMin) / rankCount;
+    domainBegin = boxMin + rank * slabWidth;
+    domainEnd = boxMin + (rank + 1) * slabWidth;
+    solver.cutoff = cutoff;
+}
+
+// Destructor: Frees the MPI datatypes.
+DistributedSimulation::~DistributedSimulation() {
+    MPI_Type_free(&ghostType);
+    MPI_Type_free(&particleType);
+}
+
+// Returns how many ranks the box can be split over with slabs at least cutoff wide: floor((boxMax - boxMin) / cutoff), or 0 for an
+// empty box or a cutoff that is not positive and finite.
+int DistributedSimulation::getMaxRankCount(double boxMin, double boxMax, double cutoff) {
+    const double slabs = std::floor((boxMax - boxMin) / cutoff);
+    if (!(cutoff > 0.0) || !std::isfinite(cutoff) || !(slabs >= 1.0)) {
+        return 0;
+    }
+    return static_cast<int>(std::min(slabs, static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+// Returns the rank whose slab holds the x coordinate. Coordinates outside the box belong to the first or last rank.
+int DistributedSimulation::ownerOf(double x) const {
+    const double slab = std::floor((x - boxMin) / slabWidth);
+    if (!(slab > 0.0)) {
+        return 0; // Also catches NaN.
+    }
+    return static_cast<int>(std::min(slab, static_cast<double>(rankCount - 1)));
+}
+
+// Packs one particle of a store.
+DistributedSimulation::PackedParticle DistributedSimulation::pack(const ParticleStore& store, std::size_t index) {
+    return {store.id[index], static_cast<std::uint64_t>(store.type[index]),
+            store.mass[index], store.charge[index], store.lifetime[index],
+            store.x[index], store.y[index], store.z[index],
+            store.vx[index], store.vy[index], store.vz[index],
+            store.fx[index], store.fy[index], store.fz[index]};
+}
+
+// Appends a packed particle to a store. The particle keeps its id (so it draws the same random numbers on any rank) and its force.
+void DistributedSimulation::unpack(const PackedParticle& packed, ParticleStore& store) {
+    store.emplace_back(static_cast<ParticleType>(packed.type), packed.mass, packed.charge, packed.lifetime,
+                       packed.x, packed.y, packed.z, packed.vx, packed.vy, packed.vz);
+    store.id.back() = packed.id;
+    store.fx.back() = packed.fx;
+    store.fy.back() = packed.fy;
+    store.fz.back() = packed.fz;
+}
+
+// Keeps the particles of an event that lie in this rank's slab. Every rank passes the same event.
+void DistributedSimulation::distribute(const ParticleStore& event) {
+    particles.clear();
+    for (std::size_t i = 0; i < event.size(); ++i) {
+        if (ownerOf(event.x[i]) == rank) {
+            unpack(pack(event, i), particles);
+        }
+    }
+}
+
+// Computes the short-range forces of the owned particles.
+// 1. Post the ghost messages: the particles within the cutoff of a slab face go to the neighbor across that face.
+// 2. While they are in flight, compute the forces of the interior particles, whose neighbors are all owned by this rank.
+// 3. Wait for the ghosts, append them behind the owned particles and compute the forces of the boundary particles.
+void DistributedSimulation::computeForces() {
+    const std::size_t count = particles.size();
+    const bool hasLeft = leftRank != MPI_PROC_NULL;
+    const bool hasRight = rightRank != MPI_PROC_NULL;
+    const double leftFace = domainBegin + cutoff;
+    const double rightFace = domainEnd - cutoff;
+
+    ghostsToLeft.clear();
+    ghostsToRight.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        const Ghost ghost = {particles.x[i], particles.y[i], particles.z[i], particles.charge[i]};
+        if (hasLeft && ghost.x < leftFace) {
+            ghostsToLeft.push_back(ghost);
+        }
+        if (hasRight && ghost.x >= rightFace) {
+            ghostsToRight.push_back(ghost);
+        }
+    }
+
+    unsigned long long countToLeft = ghostsToLeft.size(), countToRight = ghostsToRight.size();
+    unsigned long long countFromLeft = 0, countFromRight = 0;
+    MPI_Request countRequests[4];
+    MPI_Irecv(&countFromRight, 1, MPI_UNSIGNED_LONG_LONG, rightRank, GHOST_COUNT_TO_LEFT, communicator, &countRequests[0]);
+    MPI_Irecv(&countFromLeft, 1, MPI_UNSIGNED_LONG_LONG, leftRank, GHOST_COUNT_TO_RIGHT, communicator, &countRequests[1]);
+    MPI_Isend(&countToLeft, 1, MPI_UNSIGNED_LONG_LONG, leftRank, GHOST_COUNT_TO_LEFT, communicator, &countRequests[2]);
+    MPI_Isend(&countToRight, 1, MPI_UNSIGNED_LONG_LONG, rightRank, GHOST_COUNT_TO_RIGHT, communicator, &countRequests[3]);
+    MPI_Request ghostRequests[4];
+    MPI_Isend(ghostsToLeft.data(), messageCount(ghostsToLeft.size(), communicator), ghostType, leftRank, GHOSTS_TO_LEFT, communicator, &ghostRequests[0]);
+    MPI_Isend(ghostsToRight.data(), messageCount(ghostsToRight.size(), communicator), ghostType, rightRank, GHOSTS_TO_RIGHT, communicator, &ghostRequests[1]);
+
+    // Interior forces from the owned particles alone, overlapping the ghost exchange.
+    work.resize(count);
+    std::copy(particles.x.begin(), particles.x.end(), work.x.begin());
+    std::copy(particles.y.begin(), particles.y.end(), work.y.begin());
+    std::copy(particles.z.begin(), particles.z.end(), work.z.begin());
+    std::copy(particles.charge.begin(), particles.charge.end(), work.charge.begin());
+    work.resetForces();
+    isTarget.assign(count, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        isTarget[i] = (!hasLeft || particles.x[i] >= leftFace) && (!hasRight || particles.x[i] < rightFace);
+    }
+    solver.computeForcesOn(work, isTarget, pool);
+
+    // Boundary forces from the owned particles and the ghosts.
+    MPI_Waitall(4, countRequests, MPI_STATUSES_IGNORE);
+    ghostsFromLeft.resize(countFromLeft);
+    ghostsFromRight.resize(countFromRight);
+    MPI_Irecv(ghostsFromRight.data(), messageCount(ghostsFromRight.size(), communicator), ghostType, rightRank, GHOSTS_TO_LEFT, communicator, &ghostRequests[2]);
+    MPI_Irecv(ghostsFromLeft.data(), messageCount(ghostsFromLeft.size(), communicator), ghostType, leftRank, GHOSTS_TO_RIGHT, communicator, &ghostRequests[3]);
+    MPI_Waitall(4, ghostRequests, MPI_STATUSES_IGNORE);
+
+    ghostCount = ghostsFromLeft.size() + ghostsFromRight.size();
+    work.resize(count + ghostCount);
+    std::size_t slot = count;
+    for (const std::vector<Ghost>* ghosts : {&ghostsFromLeft, &ghostsFromRight}) {
+        for (const Ghost& ghost : *ghosts) {
+            work.x[slot] = ghost.x;
+            work.y[slot] = ghost.y;
+            work.z[slot] = ghost.z;
+            work.charge[slot] = ghost.charge;
+            ++slot;
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        isTarget[i] = !isTarget[i];
+    }
+    isTarget.resize(count + ghostCount, 0);
+    solver.computeForcesOn(work, isTarget, pool);
+
+    std::copy(work.fx.begin(), work.fx.begin() + count, particles.fx.begin());
+    std::copy(work.fy.begin(), work.fy.begin() + count, particles.fy.begin());
+    std::copy(work.fz.begin(), work.fz.begin() + count, particles.fz.begin());
+}
+
+// Advances the owned particles by one semi-implicit Euler step (the fused sweep of Simulation's default scheme), then migrates them.
+void DistributedSimulation::updateParticles(double deltaTime) {
+    kickDriftSweep(particles, deltaTime, deltaTime);
+    migrate();
+}
+
+// Sends the particles that have left this rank's slab one slab towards their owner, and repeats until no rank has sent anything.
+void DistributedSimulation::migrate() {
+    for (;;) {
+        leavingLeft.clear();
+        leavingRight.clear();
+        leavingIndices.clear();
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            const int owner = ownerOf(particles.x[i]);
+            if (owner != rank) {
+                (owner < rank ? leavingLeft : leavingRight).push_back(pack(particles, i));
+                leavingIndices.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+        particles.removeIndices(leavingIndices);
+
+        exchangeWithNeighbors(communicator, particleType, leftRank, rightRank, leavingLeft, leavingRight, arrivingLeft, arrivingRight);
+        particles.ensureCapacity(particles.size() + arrivingLeft.size() + arrivingRight.size());
+        for (const std::vector<PackedParticle>* arriving : {&arrivingLeft, &arrivingRight}) {
+            for (const PackedParticle& packed : *arriving) {
+                unpack(packed, particles);
+            }
+        }
+
+        unsigned long long moved = leavingIndices.size(), movedEverywhere = 0;
+        MPI_Allreduce(&moved, &movedEverywhere, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, communicator);
+        if (movedEverywhere == 0) {
+            return;
+        }
+    }
+}
+
+// Returns the number of particles on all ranks together.
+std::size_t DistributedSimulation::getGlobalParticleCount() const {
+    unsigned long long local = particles.size(), global = 0;
+    MPI_Allreduce(&local, &global, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, communicator);
+    return static_cast<std::size_t>(global);
+}
+
+// Collects all particles on root, ordered by id. The other ranks' event is left untouched.
+void DistributedSimulation::gather(ParticleStore& event, int root) const {
+    std::vector<PackedParticle> local(particles.size());
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        local[i] = pack(particles, i);
+    }
+    int count = messageCount(local.size(), communicator);
+    std::vector<int> counts(rankCount), offsets(rankCount);
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, root, communicator);
+
+    std::vector<PackedParticle> all;
+    if (rank == root) {
+        std::size_t total = 0;
+        for (int r = 0; r < rankCount; ++r) {
+            offsets[r] = messageCount(total, communicator); // Displacements count particles, so they share the count limit.
+            total += static_cast<std::size_t>(counts[r]);
+        }
+        all.resize(total);
+    }
+    MPI_Gatherv(local.data(), count, particleType, all.data(), counts.data(), offsets.data(), particleType, root, communicator);
+    if (rank != root) {
+        return;
+    }
+
+    std::sort(all.begin(), all.end(), [](const PackedParticle& a, const PackedParticle& b) { return a.id < b.id; });
+    event.clear();
+    event.reserve(all.size());
+    for (const PackedParticle& packed : all) {
+        unpack(packed, event);
+    }
+}
@@ -0,0 +1,34 @@
+#include "event-batch.h" // Include the EventBatch class definition.
+
+// Constructor: Creates eventCount empty events. Event k gets event id k and computes its forces on the thread that runs it.
+EventBatch::EventBatch(std::size_t eventCount, std::uint32_t seed) : events(eventCount) {
+    for (std::size_t k = 0; k < eventCount; ++k) {
+        events[k].setSeed(seed);
+        events[k].setEventId(static_cast<std::uint32_t>(k));
+        events[k].setThreadCount(1);
+    }
+}
+
+// Generates the particles of every event, one event per loop index.
+void EventBatch::generate(const EventGenerator& eventGenerator, ThreadPool& pool) {
+    pool.parallelFor(events.size(), [&](std::size_t k, std::size_t) {
+        events[k].generateEvent(eventGenerator);
+    });
+}
+
+// Advances every event by steps simulation steps. Events are independent, so each one runs all of its steps without waiting for the others.
+// Simulation::run() reuses forces that are still current, so a velocity Verlet or block-timestep event evaluates them once per step.
+void EventBatch::run(std::size_t steps, double deltaTime, ThreadPool& pool) {
+    pool.parallelFor(events.size(), [&](std::size_t k, std::size_t) {
+        events[k].run(steps, deltaTime);
+    });
+}
+
+// Returns the number of particles in all events together.
+std::size_t EventBatch::getParticleCount() const {
+    std::size_t total = 0;
+    for (const auto& event : events) {
+        total += event.particles.size();
+    }
+    return total;
+}
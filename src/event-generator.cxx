@@ -0,0 +1,73 @@
+#include "event-generator.h" // Include the EventConfig and EventGenerator definitions.
+#include "species.h"         // Include the species registry.
+#include <cmath>             // Required for std::llround.
+#include <random>            // Required for std::poisson_distribution.
+
+namespace {
+
+// Builds the species table. The alias table samples any weighted list of types, so each species becomes one "mode" weighted by its abundance.
+AliasTable buildSpeciesTable(const EventConfig& config) {
+    DecayMode weighted[particleTypeCount];
+    std::size_t count = 0;
+    for (std::size_t t = 0; t < particleTypeCount; ++t) {
+        if (config.speciesWeights[t] > 0.0) {
+            weighted[count++] = {static_cast<ParticleType>(t), config.speciesWeights[t]};
+        }
+    }
+    return AliasTable(DecayModeList{weighted, count});
+}
+
+} // namespace
+
+// Constructor: Stores the configuration and builds its species table.
+EventGenerator::EventGenerator(const EventConfig& config) : config(config), speciesTable(buildSpeciesTable(config)) {}
+
+// Draws the number of particles of the event that rng is keyed to. The multiplicity has its own stream, apart from all particle streams.
+std::size_t EventGenerator::sampleMultiplicity(const CounterRng& rng) const {
+    if (config.meanMultiplicity <= 0.0) {
+        return 0;
+    }
+    if (!config.poissonMultiplicity) {
+        return static_cast<std::size_t>(std::llround(config.meanMultiplicity));
+    }
+    RandomStream random = rng.stream(RandomPurpose::MULTIPLICITY, 0, 0);
+    std::poisson_distribution<long long> multiplicity(config.meanMultiplicity);
+    return static_cast<std::size_t>(multiplicity(random));
+}
+
+// Appends one event to the store and returns its number of particles.
+// All particles start at the collision point (the origin) with zero force, like those of Simulation::simulateCollision(). A particle's
+// species and velocity come from the first block of its creation stream, the same block Simulation::createParticle() draws velocities from.
+std::size_t EventGenerator::generate(ParticleStore& particles, const CounterRng& rng) const {
+    const std::size_t count = speciesTable.empty() ? 0 : sampleMultiplicity(rng);
+    if (count == 0) {
+        return 0;
+    }
+    const std::size_t first = particles.size();
+    particles.ensureCapacity(first + count);
+    particles.resize(first + count); // Positions and forces are zero-initialized, and every new particle gets its id.
+
+    const std::uint64_t* id = particles.id.data() + first;
+    ParticleType* type = particles.type.data() + first;
+    double* mass = particles.mass.data() + first;
+    double* inverseMass = particles.inverseMass.data() + first;
+    double* charge = particles.charge.data() + first;
+    double* lifetime = particles.lifetime.data() + first;
+    double* vx = particles.vx.data() + first;
+    double* vy = particles.vy.data() + first;
+    double* vz = particles.vz.data() + first;
+    const double v = config.velocityRange;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto bits = rng.block(RandomPurpose::CREATION, id[i], 0);
+        type[i] = speciesTable.sample(toUniform(bits[0]));
+        const SpeciesInfo& species = getSpecies(type[i]);
+        mass[i] = species.mass;
+        inverseMass[i] = 1.0 / species.mass;
+        charge[i] = species.charge;
+        lifetime[i] = species.lifetime;
+        vx[i] = v * (2.0 * toUniform(bits[1]) - 1.0);
+        vy[i] = v * (2.0 * toUniform(bits[2]) - 1.0);
+        vz[i] = v * (2.0 * toUniform(bits[3]) - 1.0);
+    }
+    return count;
+}
@@ -0,0 +1,92 @@
+#include "fft.h"   // Include the Fft and Fft3d class definitions.
+#include <cmath>   // Required for std::acos, std::cos and std::sin.
+#include <utility> // Required for std::swap.
+
+// Prepares the bit-reversal permutation and the twiddle factors for transforms of length n.
+void Fft::setLength(std::size_t n) {
+    length = n;
+    std::size_t bits = 0;
+    while ((std::size_t(1) << bits) < n) {
+        ++bits;
+    }
+    bitReversed.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t reversed = 0;
+        for (std::size_t bit = 0; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        bitReversed[i] = reversed;
+    }
+    const double pi = std::acos(-1.0);
+    twiddles.resize(n / 2);
+    for (std::size_t k = 0; k < n / 2; ++k) {
+        const double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(n);
+        twiddles[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+}
+
+// Transforms length contiguous values in place: the values are put into bit-reversed order, then log2(length) passes of butterflies
+// combine transforms of length 2, 4, ... The twiddle of a butterfly in a pass of span s is twiddles[k * length / s], conjugated for the
+// inverse transform.
+void Fft::transform(std::complex<double>* data, bool inverse) const {
+    for (std::size_t i = 0; i < length; ++i) {
+        if (i < bitReversed[i]) {
+            std::swap(data[i], data[bitReversed[i]]);
+        }
+    }
+    for (std::size_t span = 2; span <= length; span *= 2) {
+        const std::size_t half = span / 2;
+        const std::size_t step = length / span;
+        for (std::size_t start = 0; start < length; start += span) {
+            for (std::size_t k = 0; k < half; ++k) {
+                const std::complex<double> twiddle = inverse ? std::conj(twiddles[k * step]) : twiddles[k * step];
+                const std::complex<double> odd = twiddle * data[start + k + half];
+                data[start + k + half] = data[start + k] - odd;
+                data[start + k] += odd;
+            }
+        }
+    }
+}
+
+// Prepares transforms of n x n x n grids.
+void Fft3d::setSize(std::size_t n) {
+    if (n != fft.getLength()) {
+        fft.setLength(n);
+    }
+}
+
+// Transforms the selected lines along one axis. Each task is one value of the second other coordinate (a plane of lines), and each line is
+// gathered into the worker's buffer, transformed and scattered back, so the strided y and z lines are transformed in contiguous memory.
+void Fft3d::transformAxis(std::vector<std::complex<double>>& grid, int axis, std::size_t limitA, std::size_t limitB, bool inverse, ThreadPool& pool) {
+    const std::size_t n = fft.getLength();
+    if (lines.size() < pool.size()) {
+        lines.resize(pool.size());
+    }
+    // Distance between consecutive values of a line, and of the two other coordinates, in grid elements.
+    const std::size_t strides[3] = {1, n, n * n};
+    const std::size_t stride = strides[axis];
+    const std::size_t strideA = axis == 0 ? n : 1;
+    const std::size_t strideB = axis == 2 ? n : n * n;
+    pool.parallelFor(limitB, [&](std::size_t b, std::size_t worker) {
+        std::vector<std::complex<double>>& line = lines[worker];
+        line.resize(n);
+        for (std::size_t a = 0; a < limitA; ++a) {
+            std::complex<double>* first = grid.data() + a * strideA + b * strideB;
+            for (std::size_t k = 0; k < n; ++k) {
+                line[k] = first[k * stride];
+            }
+            fft.transform(line.data(), inverse);
+            for (std::size_t k = 0; k < n; ++k) {
+                first[k * stride] = line[k];
+            }
+        }
+    });
+}
+
+// Transforms a whole grid along x, y and z.
+void Fft3d::transform(std::vector<std::complex<double>>& grid, bool inverse, ThreadPool& pool) {
+    const std::size_t n = fft.getLength();
+    for (int axis = 0; axis < 3; ++axis) {
+        transformAxis(grid, axis, n, n, inverse, pool);
+    }
+}
@@ -0,0 +1,14 @@
+#include "file-output.h" // Include the writeFileAtomically declaration.
+#include <cstdio>        // Required for std::fopen, std::fwrite and std::rename.
+
+// Writes the text to the temporary file with a single write, then renames it over path.
+bool writeFileAtomically(const std::string& path, const std::string& text) {
+    const std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    const bool closed = std::fclose(file) == 0;
+    return written && closed && std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,251 @@
+#include "integrator.h" // Include the Integrator enum and the TimeIntegrator class definition.
+#include <algorithm>    // Required for std::max and std::min.
+#include <cmath>        // For mathematical operations.
+
+namespace {
+
+// Fused kick-drift sweep. Measure is a template parameter so that the plain sweep keeps its tight loop, and the measuring sweep reads the
+// mass column only when it is asked for the kinetic energy and momentum.
+template <bool Drift, bool Measure>
+void sweep(ParticleStore& particles, std::size_t begin, std::size_t end, double kickTime, double driftTime, Observables* motion) {
+    double* __restrict px = particles.x.data();
+    double* __restrict py = particles.y.data();
+    double* __restrict pz = particles.z.data();
+    double* __restrict pvx = particles.vx.data();
+    double* __restrict pvy = particles.vy.data();
+    double* __restrict pvz = particles.vz.data();
+    double* __restrict pfx = particles.fx.data();
+    double* __restrict pfy = particles.fy.data();
+    double* __restrict pfz = particles.fz.data();
+    const double* __restrict pinv = particles.inverseMass.data();
+    const double* __restrict pmass = particles.mass.data();
+    double twiceKinetic = 0.0, momentumX = 0.0, momentumY = 0.0, momentumZ = 0.0;
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const double scale = pinv[i] * kickTime;
+        const double vx = pvx[i] + pfx[i] * scale;
+        const double vy = pvy[i] + pfy[i] * scale;
+        const double vz = pvz[i] + pfz[i] * scale;
+        pvx[i] = vx;
+        pvy[i] = vy;
+        pvz[i] = vz;
+
+        if (Drift) {
+            px[i] += vx * driftTime;
+            py[i] += vy * driftTime;
+            pz[i] += vz * driftTime;
+
+            pfx[i] = 0.0;
+            pfy[i] = 0.0;
+            pfz[i] = 0.0;
+        }
+        if (Measure) {
+            const double m = pmass[i];
+            twiceKinetic += m * (vx * vx + vy * vy + vz * vz);
+            momentumX += m * vx;
+            momentumY += m * vy;
+            momentumZ += m * vz;
+        }
+    }
+
+    if (Measure) {
+        motion->kineticEnergy = 0.5 * twiceKinetic;
+        motion->momentum[0] = momentumX;
+        motion->momentum[1] = momentumY;
+        motion->momentum[2] = momentumZ;
+    }
+}
+
+} // namespace
+
+// Adds kickTime * F / m to every velocity, moves every position by driftTime * v, and zeroes every force.
+// Each column is a plain contiguous array and the inverse mass is precomputed, so the loop has no divisions and vectorizes.
+void kickDriftSweep(ParticleStore& particles, double kickTime, double driftTime, Observables* motion) {
+    kickDriftSweep(particles, 0, particles.size(), kickTime, driftTime, motion);
+}
+
+// Kick-drift sweep over the particles in [begin, end) only.
+void kickDriftSweep(ParticleStore& particles, std::size_t begin, std::size_t end, double kickTime, double driftTime, Observables* motion) {
+    if (motion) {
+        sweep<true, true>(particles, begin, end, kickTime, driftTime, motion);
+    } else {
+        sweep<true, false>(particles, begin, end, kickTime, driftTime, nullptr);
+    }
+}
+
+// Adds kickTime * F / m to every velocity. The forces are kept.
+void kickSweep(ParticleStore& particles, double kickTime, Observables* motion) {
+    if (motion) {
+        sweep<false, true>(particles, 0, particles.size(), kickTime, 0.0, motion);
+    } else {
+        sweep<false, false>(particles, 0, particles.size(), kickTime, 0.0, nullptr);
+    }
+}
+
+// Advances the store by deltaTime with the selected scheme.
+bool TimeIntegrator::step(ParticleStore& particles, double deltaTime, const ForceCallback& computeForces, Observables* motion) {
+    switch (scheme) {
+        case Integrator::EULER:
+        case Integrator::LEAPFROG:
+            kickDriftSweep(particles, beginKickDrift(deltaTime), deltaTime, motion);
+            return false;
+
+        case Integrator::VELOCITY_VERLET:
+            // Half kick and drift with a(t), forces at the new positions, then the closing half kick with a(t + dt).
+            kickDriftSweep(particles, 0.5 * deltaTime, deltaTime);
+            computeForces(nullptr);
+            kickSweep(particles, 0.5 * deltaTime, motion);
+            return true;
+
+        case Integrator::BLOCK_VERLET:
+            blockStep(particles, deltaTime, computeForces, motion);
+            return true;
+    }
+    return false;
+}
+
+// Returns the kick time of a kick-drift step (Euler or leapfrog) and advances the leapfrog state. The drift time is always deltaTime.
+double TimeIntegrator::beginKickDrift(double deltaTime) {
+    if (scheme == Integrator::EULER) {
+        return deltaTime;
+    }
+    // v(t + dt/2) = v(t - dt_prev/2) + a(t) (dt_prev + dt) / 2, then x(t + dt) = x(t) + v(t + dt/2) dt.
+    const double kickTime = staggered ? 0.5 * (previousDeltaTime + deltaTime) : 0.5 * deltaTime;
+    staggered = true;
+    previousDeltaTime = deltaTime;
+    return kickTime;
+}
+
+// Forgets the leapfrog half-step state, so the next leapfrog step starts from whole-step velocities again.
+void TimeIntegrator::restart() {
+    staggered = false;
+    previousDeltaTime = 0.0;
+}
+
+// Writes the scheme, its parameters and its state to a checkpoint. The block levels are chosen afresh at the start of every step, so they
+// are not part of the state.
+void TimeIntegrator::save(CheckpointWriter& checkpoint) const {
+    checkpoint.put(scheme);
+    checkpoint.put(maxLevel);
+    checkpoint.put(accuracy);
+    checkpoint.put(lengthScale);
+    checkpoint.put(staggered);
+    checkpoint.put(previousDeltaTime);
+    checkpoint.put(static_cast<std::uint64_t>(substeps));
+    checkpoint.put(static_cast<std::uint64_t>(targetForces));
+}
+
+// Restores the integrator from a checkpoint written by save(). An unknown scheme or an invalid flag is reported as damage.
+bool TimeIntegrator::load(CheckpointReader& checkpoint) {
+    std::uint64_t savedSubsteps = 0, savedTargetForces = 0;
+    const bool ok = checkpoint.getEnum(scheme, Integrator::BLOCK_VERLET) && checkpoint.get(maxLevel) && checkpoint.get(accuracy) &&
+                    checkpoint.get(lengthScale) && checkpoint.getFlag(staggered) && checkpoint.get(previousDeltaTime) && checkpoint.get(savedSubsteps) && checkpoint.get(savedTargetForces);
+    substeps = static_cast<std::size_t>(savedSubsteps);
+    targetForces = static_cast<std::size_t>(savedTargetForces);
+    return ok;
+}
+
+// Returns the block level for an acceleration magnitude: the smallest level whose substep is no longer than accuracy * sqrt(lengthScale / a).
+int TimeIntegrator::levelFor(double acceleration, double deltaTime) const {
+    if (!(acceleration > 0.0)) {
+        return 0;
+    }
+    const int finestLevel = std::max(0, std::min(maxLevel, maxSupportedLevel));
+    const double wanted = accuracy * std::sqrt(lengthScale / acceleration);
+    if (wanted >= deltaTime) {
+        return 0;
+    }
+    if (!(wanted > 0.0) || deltaTime / wanted > std::ldexp(1.0, finestLevel)) {
+        return finestLevel; // Also catches infinite accelerations.
+    }
+    const int level = static_cast<int>(std::ceil(std::log2(deltaTime / wanted)));
+    return std::min(level, finestLevel);
+}
+
+// Advances the store by deltaTime with hierarchical block timesteps (see integrator.h).
+void TimeIntegrator::blockStep(ParticleStore& particles, double deltaTime, const ForceCallback& computeForces, Observables* motion) {
+    const std::size_t count = particles.size();
+    double* x = particles.x.data();
+    double* y = particles.y.data();
+    double* z = particles.z.data();
+    double* vx = particles.vx.data();
+    double* vy = particles.vy.data();
+    double* vz = particles.vz.data();
+    const double* fx = particles.fx.data();
+    const double* fy = particles.fy.data();
+    const double* fz = particles.fz.data();
+    const double* inverseMass = particles.inverseMass.data();
+
+    auto accelerationOf = [&](std::size_t i) {
+        return std::sqrt(fx[i] * fx[i] + fy[i] * fy[i] + fz[i] * fz[i]) * std::abs(inverseMass[i]);
+    };
+    auto kick = [&](std::size_t i, double kickTime) {
+        const double scale = inverseMass[i] * kickTime;
+        vx[i] += fx[i] * scale;
+        vy[i] += fy[i] * scale;
+        vz[i] += fz[i] * scale;
+    };
+
+    // Pick every particle's level from the forces at the start of the step. The finest level present sets the tick length.
+    levels.resize(count);
+    isTarget.resize(count);
+    int finest = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        levels[i] = static_cast<std::uint8_t>(levelFor(accelerationOf(i), deltaTime));
+        finest = std::max(finest, static_cast<int>(levels[i]));
+    }
+    const std::size_t ticks = std::size_t(1) << finest;
+    const double tickTime = deltaTime / static_cast<double>(ticks);
+
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        // Opening half kicks of the substeps that start at this tick.
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t span = std::size_t(1) << (finest - levels[i]);
+            if (tick % span == 0) {
+                kick(i, 0.5 * static_cast<double>(span) * tickTime);
+            }
+        }
+
+        // Everybody drifts, so the sources are at the right positions for the force evaluation.
+        for (std::size_t i = 0; i < count; ++i) {
+            x[i] += vx[i] * tickTime;
+            y[i] += vy[i] * tickTime;
+            z[i] += vz[i] * tickTime;
+        }
+
+        // New forces for the substeps that end after this tick (all of them at the last tick).
+        std::size_t targets = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t span = std::size_t(1) << (finest - levels[i]);
+            isTarget[i] = ((tick + 1) % span == 0) ? 1 : 0;
+            targets += isTarget[i];
+        }
+        computeForces(targets == count ? nullptr : &isTarget);
+        ++substeps;
+        targetForces += targets;
+
+        // Closing half kicks, then the level of the next substep.
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!isTarget[i]) {
+                continue;
+            }
+            const std::size_t span = std::size_t(1) << (finest - levels[i]);
+            kick(i, 0.5 * static_cast<double>(span) * tickTime);
+
+            int level = std::min(levelFor(accelerationOf(i), deltaTime), finest);
+            while (level < levels[i] && (tick + 1) % (std::size_t(1) << (finest - level)) != 0) {
+                ++level; // A coarser substep must start on its own grid.
+            }
+            levels[i] = static_cast<std::uint8_t>(level);
+        }
+    }
+
+    // Every substep closed at the last tick, so the velocities are final. The block path is scalar anyway, so measure in a separate pass.
+    if (motion) {
+        const Observables measured = measureObservables(particles);
+        motion->kineticEnergy = measured.kineticEnergy;
+        for (int axis = 0; axis < 3; ++axis) {
+            motion->momentum[axis] = measured.momentum[axis];
+        }
+    }
+}
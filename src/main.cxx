@@ -1,39 +1,19 @@
-#include "simulation.h" // Include the Simulation class definition.
+#include "run-driver.h" // Include the run configuration and the driver loop.
 #include <iostream>     // Include iostream for console output.
-#include <iomanip>      // Include iomanip for controlling output formatting (setting precision).
 
-int main() {
-    Simulation sim; // Create a new simulation instance.
-    
-    // Simulate a collision which generates particles.
-    sim.simulateCollision();
-
-    // Run a simple simulation step.
-    sim.computeForces();
-    sim.updateParticles(0.01); // Update with a small time step.
-
-    // Output properties of generated particles to verify that particles have been added and updated.
-    for (const auto& particle : sim.particles) {
-        std::cout << "Particle Type: ";
-        switch (particle.type) {
-            case ParticleType::PION_POSITIVE: std::cout << "Pion (+)"; break;
-            case ParticleType::PION_NEGATIVE: std::cout << "Pion (-)"; break;
-            case ParticleType::PION_NEUTRAL:  std::cout << "Pion (0)"; break;
-            case ParticleType::KAON_POSITIVE: std::cout << "Kaon (+)"; break;
-            case ParticleType::KAON_NEGATIVE: std::cout << "Kaon (-)"; break;
-            case ParticleType::PROTON:        std::cout << "Proton"; break;
-            default:                          std::cout << "Unknown"; break;
-        }
-        std::cout << std::fixed << std::setprecision(5) // Set precision to 5 for more significant digits.
-                  << ", Mass: " << particle.mass 
-                  << ", Charge: " << particle.charge 
-                  << std::setprecision(2) // Reset precision to 2 for position
-                  << ", Position: (" 
-                  << particle.position[0] << ", " 
-                  << particle.position[1] << ", " 
-                  << particle.position[2] << ")"
-                  << std::endl;
+int main(int argc, char* argv[]) {
+    RunConfig config; // Defaults, overridden by the config file and options on the command line.
+    bool showHelp = false;
+    std::string error;
+    if (!parseRunArguments(argc, argv, config, showHelp, error)) {
+        std::cerr << "error: " << error << "\n\n" << getRunUsage();
+        return 2;
+    }
+    if (showHelp) {
+        std::cout << getRunUsage();
+        return 0;
     }
 
-    return 0;
-}
\ No newline at end of file
+    // Run every event, with one progress line per batch of steps.
+    return runSimulations(config, std::cout) ? 0 : 1;
+}
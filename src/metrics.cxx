@@ -0,0 +1,224 @@
+#include "metrics.h"     // Include the metrics declarations.
+#include "file-output.h" // Include writeFileAtomically.
+#include <chrono>        // Required for std::chrono::steady_clock.
+#include <memory>       // Required for std::shared_ptr.
+#include <sstream>      // Required for std::ostringstream.
+
+namespace {
+
+const char* const phaseNames[phaseCount] = {"forces", "integration", "decay", "creation", "output", "reorder", "analysis"};
+const char* const counterNames[counterCount] = {"pair_interactions", "decays", "particles_created", "particles_removed",
+                                                "allocations", "bytes_written"};
+
+const std::chrono::steady_clock::time_point metricsEpoch = std::chrono::steady_clock::now(); // Zero of getMetricsClock()
+std::atomic<bool> tracing(false); // Whether timed phases are recorded for the Chrome trace
+
+// Registry of every thread's metrics. It owns the blocks, so the metrics of a thread that has exited are still reported.
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadMetrics>> registry;
+
+// Registers a new metrics block for the calling thread.
+ThreadMetrics* registerThread() {
+    auto metrics = std::make_shared<ThreadMetrics>();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    metrics->thread = registry.size();
+    registry.push_back(metrics);
+    return metrics.get();
+}
+
+// Appends the counters and phases of one set of values as JSON members.
+void appendJsonValues(std::ostringstream& out, const MetricsSnapshot::Values& values) {
+    out << "\"counters\":{";
+    for (std::size_t c = 0; c < counterCount; ++c) {
+        out << (c ? "," : "") << '"' << counterNames[c] << "\":" << values.counters[c];
+    }
+    out << "},\"phases\":{";
+    for (std::size_t p = 0; p < phaseCount; ++p) {
+        out << (p ? "," : "") << '"' << phaseNames[p] << "\":{\"calls\":" << values.phaseCalls[p]
+            << ",\"seconds\":" << values.phaseNanoseconds[p] * 1e-9 << '}';
+    }
+    out << '}';
+}
+
+} // namespace
+
+// Returns the lower-case name of a phase.
+const char* getPhaseName(Phase phase) {
+    return phaseNames[static_cast<std::size_t>(phase)];
+}
+
+// Returns the lower-case name of a counter.
+const char* getCounterName(Counter counter) {
+    return counterNames[static_cast<std::size_t>(counter)];
+}
+
+// Records one timed call of a phase, and its trace event while tracing is on.
+void ThreadMetrics::addPhase(Phase phase, std::uint64_t start, std::uint64_t duration) {
+    const std::size_t p = static_cast<std::size_t>(phase);
+    phaseCalls[p].store(phaseCalls[p].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    phaseNanoseconds[p].store(phaseNanoseconds[p].load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+    if (tracing.load(std::memory_order_relaxed)) {
+        trace.push_back({phase, start, duration});
+    }
+}
+
+// Returns the calling thread's metrics. Only the first call on a thread takes the registry lock.
+ThreadMetrics& getThreadMetrics() {
+    thread_local ThreadMetrics* metrics = registerThread();
+    return *metrics;
+}
+
+// Returns nanoseconds since the process's metrics epoch.
+std::uint64_t getMetricsClock() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - metricsEpoch).count());
+}
+
+// Sums the metrics of all threads. Threads that have not recorded anything are left out of the per-thread list.
+MetricsSnapshot collectMetrics() {
+    MetricsSnapshot snapshot;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& metrics : registry) {
+        MetricsSnapshot::Values values;
+        values.thread = metrics->thread;
+        bool recorded = false;
+        for (std::size_t c = 0; c < counterCount; ++c) {
+            values.counters[c] = metrics->counters[c].load(std::memory_order_relaxed);
+            snapshot.total.counters[c] += values.counters[c];
+            recorded = recorded || values.counters[c] != 0;
+        }
+        for (std::size_t p = 0; p < phaseCount; ++p) {
+            values.phaseCalls[p] = metrics->phaseCalls[p].load(std::memory_order_relaxed);
+            values.phaseNanoseconds[p] = metrics->phaseNanoseconds[p].load(std::memory_order_relaxed);
+            snapshot.total.phaseCalls[p] += values.phaseCalls[p];
+            snapshot.total.phaseNanoseconds[p] += values.phaseNanoseconds[p];
+            recorded = recorded || values.phaseCalls[p] != 0;
+        }
+        if (recorded) {
+            snapshot.threads.push_back(values);
+        }
+    }
+    return snapshot;
+}
+
+// Zeroes every thread's metrics and trace.
+void resetMetrics() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& metrics : registry) {
+        for (auto& counter : metrics->counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t p = 0; p < phaseCount; ++p) {
+            metrics->phaseCalls[p].store(0, std::memory_order_relaxed);
+            metrics->phaseNanoseconds[p].store(0, std::memory_order_relaxed);
+        }
+        metrics->trace.clear();
+    }
+}
+
+// Checks whether this build records metrics.
+bool areMetricsEnabled() {
+#ifdef PHYSICS_SIMULATION_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Formats metrics as a JSON object with the totals and one entry per thread.
+std::string formatMetricsJson(const MetricsSnapshot& metrics) {
+    std::ostringstream out;
+    out << '{';
+    appendJsonValues(out, metrics.total);
+    out << ",\"threads\":[";
+    for (std::size_t t = 0; t < metrics.threads.size(); ++t) {
+        out << (t ? "," : "") << "{\"thread\":" << metrics.threads[t].thread << ',';
+        appendJsonValues(out, metrics.threads[t]);
+        out << '}';
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+// Formats metrics in the Prometheus text exposition format. Every series carries a thread label; sum over it for the totals.
+std::string formatMetricsPrometheus(const MetricsSnapshot& metrics) {
+    std::ostringstream out;
+    for (std::size_t c = 0; c < counterCount; ++c) {
+        out << "# TYPE physics_simulation_" << counterNames[c] << "_total counter\n";
+        for (const auto& values : metrics.threads) {
+            out << "physics_simulation_" << counterNames[c] << "_total{thread=\"" << values.thread << "\"} " << values.counters[c] << '\n';
+        }
+    }
+    out << "# TYPE physics_simulation_phase_calls_total counter\n";
+    for (const auto& values : metrics.threads) {
+        for (std::size_t p = 0; p < phaseCount; ++p) {
+            out << "physics_simulation_phase_calls_total{phase=\"" << phaseNames[p] << "\",thread=\"" << values.thread << "\"} "
+                << values.phaseCalls[p] << '\n';
+        }
+    }
+    out << "# TYPE physics_simulation_phase_seconds_total counter\n";
+    for (const auto& values : metrics.threads) {
+        for (std::size_t p = 0; p < phaseCount; ++p) {
+            out << "physics_simulation_phase_seconds_total{phase=\"" << phaseNames[p] << "\",thread=\"" << values.thread << "\"} "
+                << values.phaseNanoseconds[p] * 1e-9 << '\n';
+        }
+    }
+    return out.str();
+}
+
+// Starts or stops recording every timed phase for the Chrome trace.
+void setTracing(bool enabled) {
+    tracing.store(enabled, std::memory_order_relaxed);
+}
+
+// Writes the recorded phases as complete ("X") Chrome trace events, one track per thread. Timestamps are in microseconds.
+bool writeChromeTrace(const std::string& path) {
+    std::ostringstream out;
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& metrics : registry) {
+            for (const auto& event : metrics->trace) {
+                out << (first ? "" : ",") << "\n{\"name\":\"" << phaseNames[static_cast<std::size_t>(event.phase)]
+                    << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << metrics->thread
+                    << ",\"ts\":" << event.start * 1e-3 << ",\"dur\":" << event.duration * 1e-3 << '}';
+                first = false;
+            }
+        }
+    }
+    out << "\n]}\n";
+    return writeFileAtomically(path, out.str());
+}
+
+// Starts the background thread, which rewrites the file every intervalSeconds.
+PeriodicMetricsDump::PeriodicMetricsDump(const std::string& path, double intervalSeconds, MetricsFormat format)
+    : path(path), intervalSeconds(intervalSeconds), format(format) {
+    dumpThread = std::thread([this] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::duration<double>(this->intervalSeconds));
+            if (!stopping) {
+                dump();
+            }
+        }
+    });
+}
+
+// Stops the background thread and writes the file one last time, so it holds the final values.
+PeriodicMetricsDump::~PeriodicMetricsDump() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    dumpThread.join();
+    dump();
+}
+
+// Writes the file now. The background thread and other callers go through the same temporary file, so the writes are taken in turn.
+bool PeriodicMetricsDump::dump() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    const MetricsSnapshot metrics = collectMetrics();
+    return writeFileAtomically(path, format == MetricsFormat::JSON ? formatMetricsJson(metrics) : formatMetricsPrometheus(metrics));
+}
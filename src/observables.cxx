@@ -0,0 +1,44 @@
+#include "observables.h" // Include the Observables struct definition.
+
+// Adds one particle.
+void Observables::add(double mass, double charge, double lifetime, double vx, double vy, double vz) {
+    ++count;
+    totalCharge += charge;
+    totalLifetime += lifetime;
+    kineticEnergy += 0.5 * mass * (vx * vx + vy * vy + vz * vz);
+    momentum[0] += mass * vx;
+    momentum[1] += mass * vy;
+    momentum[2] += mass * vz;
+}
+
+// Removes one particle.
+void Observables::remove(double mass, double charge, double lifetime, double vx, double vy, double vz) {
+    --count;
+    totalCharge -= charge;
+    totalLifetime -= lifetime;
+    kineticEnergy -= 0.5 * mass * (vx * vx + vy * vy + vz * vz);
+    momentum[0] -= mass * vx;
+    momentum[1] -= mass * vy;
+    momentum[2] -= mass * vz;
+}
+
+// Adds the particles of another set.
+Observables& Observables::operator+=(const Observables& other) {
+    count += other.count;
+    totalCharge += other.totalCharge;
+    totalLifetime += other.totalLifetime;
+    kineticEnergy += other.kineticEnergy;
+    for (int axis = 0; axis < 3; ++axis) {
+        momentum[axis] += other.momentum[axis];
+    }
+    return *this;
+}
+
+// Measures the observables of the particles in [begin, end) with one pass over the columns.
+Observables measureObservables(const ParticleStore& particles, std::size_t begin, std::size_t end) {
+    Observables observables;
+    for (std::size_t i = begin; i < end; ++i) {
+        observables.add(particles.mass[i], particles.charge[i], particles.lifetime[i], particles.vx[i], particles.vy[i], particles.vz[i]);
+    }
+    return observables;
+}
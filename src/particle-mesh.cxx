@@ -0,0 +1,444 @@
+#include "particle-mesh.h" // Include the ParticleMeshSolver class definition.
+#include "metrics.h"       // Include the instrumentation macros.
+#include <algorithm>       // Required for std::min, std::max and std::fill.
+#include <cmath>           // Required for std::acos, std::erf, std::exp, std::floor, std::pow, std::sin and std::sqrt.
+
+namespace {
+
+// Number of particles handled by one parallel task.
+const std::size_t particlesPerTask = 256;
+
+// Empty mesh nodes kept on each side of the particles, so that the assignment stencils and the finite differences stay inside the mesh.
+const std::size_t meshMargin = 4;
+
+// 2 / sqrt(pi), the slope of erf at zero.
+const double twoOverSqrtPi = 1.1283791670955126;
+
+// Nodes and weights of one assignment stencil along one axis: weight[k] belongs to node first + k.
+struct AxisStencil {
+    long first;
+    int count;
+    double weight[3];
+};
+
+// Returns the stencil of a position u (in mesh cells from node 0) along one axis, clamped to the nodes [0, size).
+inline AxisStencil axisStencil(double u, MeshAssignment assignment, std::size_t size) {
+    AxisStencil stencil;
+    if (assignment == MeshAssignment::CIC) {
+        const double node = std::floor(u);
+        const double f = u - node;
+        stencil.first = static_cast<long>(node);
+        stencil.count = 2;
+        stencil.weight[0] = 1.0 - f;
+        stencil.weight[1] = f;
+        stencil.weight[2] = 0.0;
+    } else {
+        const double node = std::floor(u + 0.5);
+        const double d = u - node;
+        stencil.first = static_cast<long>(node) - 1;
+        stencil.count = 3;
+        stencil.weight[0] = 0.5 * (0.5 - d) * (0.5 - d);
+        stencil.weight[1] = 0.75 - d * d;
+        stencil.weight[2] = 0.5 * (0.5 + d) * (0.5 + d);
+    }
+    stencil.first = std::max(0L, std::min(stencil.first, static_cast<long>(size) - stencil.count));
+    return stencil;
+}
+
+// Returns the smooth part S of the pair force, erf(r / a) / r differentiated like the Coulomb law: the force is k q_i q_j S (r_j - r_i).
+inline double smoothPairScale(double r2, double a) {
+    const double r = std::sqrt(r2);
+    const double x = r / a;
+    if (x < 1e-3) {
+        return twoOverSqrtPi * 2.0 / (3.0 * a * a * a); // The limit at r = 0, where the two terms below cancel.
+    }
+    return (std::erf(x) / r2 - twoOverSqrtPi * std::exp(-x * x) / (a * r)) / r;
+}
+
+// Returns the chaining cell coordinate of a position along one axis, clamped to the chaining mesh.
+inline std::size_t chainCoordinate(double position, double origin, double cellSize, std::size_t dim) {
+    const double cell = std::floor((position - origin) / cellSize);
+    if (!(cell >= 0.0)) {
+        return 0;
+    }
+    return std::min(static_cast<std::size_t>(cell), dim - 1);
+}
+
+} // namespace
+
+// Solves the mesh and adds the forces of every charged particle to the force columns.
+void ParticleMeshSolver::computeForces(ParticleStore& particles, ThreadPool& pool) {
+    if (!prepare(particles, pool)) {
+        return;
+    }
+    const std::size_t taskCount = (particles.size() + particlesPerTask - 1) / particlesPerTask;
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t begin = task * particlesPerTask;
+        computeRange(particles, begin, std::min(begin + particlesPerTask, particles.size()));
+    });
+}
+
+// Solves the mesh with every particle as a source and adds the forces of the flagged particles only (the active particles of a block
+// timestep). The mesh costs the same either way; only the interpolation and the corrections are limited to the targets.
+void ParticleMeshSolver::computeForcesOn(ParticleStore& particles, const std::vector<std::uint8_t>& isTarget, ThreadPool& pool) {
+    if (!prepare(particles, pool)) {
+        return;
+    }
+    const std::size_t taskCount = (particles.size() + particlesPerTask - 1) / particlesPerTask;
+    pool.parallelFor(taskCount, [&](std::size_t task, std::size_t) {
+        const std::size_t begin = task * particlesPerTask;
+        const std::size_t end = std::min(begin + particlesPerTask, particles.size());
+        for (std::size_t i = begin; i < end; ++i) {
+            if (isTarget[i]) {
+                addForce(particles, i);
+            }
+        }
+    });
+}
+
+// Solves the mesh and bins the particles for the corrections; computeRange() does nothing if there is nothing to solve.
+void ParticleMeshSolver::prepareRanges(const ParticleStore& particles, ThreadPool& pool) {
+    prepare(particles, pool);
+}
+
+// Adds the forces of the particles in [begin, end).
+void ParticleMeshSolver::computeRange(ParticleStore& particles, std::size_t begin, std::size_t end) const {
+    if (!solved) {
+        return;
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+        addForce(particles, i);
+    }
+}
+
+// Fits the mesh around the charged particles, then deposits the charges, solves for the potential and its gradient, and bins the
+// particles for the corrections. Returns false (and leaves the forces alone) for the other force laws, or if fewer than two charged
+// particles, or only coincident ones, could interact.
+bool ParticleMeshSolver::prepare(const ParticleStore& particles, ThreadPool& pool) {
+    solved = false;
+    if (interaction.model != InteractionModel::COULOMB || !placeMesh(particles)) {
+        return false;
+    }
+    prepareKernel(pool);
+    depositCharges(particles);
+    solvePotential(pool);
+    differentiatePotential(pool);
+    correctionRadius = correctionCells * cellSize;
+    if (correctionRadius > 0.0) {
+        binForCorrections(particles);
+    }
+    solved = true;
+    return true;
+}
+
+// Fits a cubic mesh of meshSize nodes per axis around the bounding box of the charged particles, with meshMargin empty nodes on each side
+// of the longest axis. Returns false if fewer than two particles are charged or they all sit at one point.
+bool ParticleMeshSolver::placeMesh(const ParticleStore& particles) {
+    std::size_t charged = 0;
+    double low[3] = {0.0, 0.0, 0.0};
+    double high[3] = {0.0, 0.0, 0.0};
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        if (particles.charge[i] == 0.0) {
+            continue;
+        }
+        const double position[3] = {particles.x[i], particles.y[i], particles.z[i]};
+        for (int axis = 0; axis < 3; ++axis) {
+            low[axis] = charged == 0 ? position[axis] : std::min(low[axis], position[axis]);
+            high[axis] = charged == 0 ? position[axis] : std::max(high[axis], position[axis]);
+        }
+        ++charged;
+    }
+    const double extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    if (charged < 2 || !(extent > 0.0)) {
+        return false;
+    }
+    meshSize = 16;
+    while (meshSize < std::min(gridSize, maxGridSize)) {
+        meshSize *= 2;
+    }
+    cellSize = extent / static_cast<double>(meshSize - 2 * meshMargin);
+    for (int axis = 0; axis < 3; ++axis) {
+        meshOrigin[axis] = low[axis] - static_cast<double>(meshMargin) * cellSize;
+    }
+    return true;
+}
+
+// Samples the smooth kernel erf(r / a) / r for a mesh cell of 1 m at every separation of the padded grid (wrapped, so that separation d
+// and N - d are the same node distance) and transforms it. The kernel is real and even, so its transform is real. Depositing and
+// interpolating with the same scheme smooths the field twice by the assignment window, whose transform is the product over the axes of
+// sinc(pi m / N)^p (p = 2 for CIC, 3 for TSC), so the kernel is divided by its square; without this, the mesh force of pairs a few cells
+// apart falls short of the smooth part that the corrections take it to be. A mesh cell of h scales the kernel, and so its transform, by
+// 1 / h, which solvePotential() applies.
+void ParticleMeshSolver::prepareKernel(ThreadPool& pool) {
+    if (kernelSize == meshSize && kernelAssignment == assignment) {
+        return;
+    }
+    const std::size_t n = 2 * meshSize;
+    fft.setSize(n);
+    padded.assign(n * n * n, 0.0);
+    const double a = splittingCells;
+    pool.parallelFor(n, [&](std::size_t z, std::size_t) {
+        const double dz = static_cast<double>(std::min(z, n - z));
+        for (std::size_t y = 0; y < n; ++y) {
+            const double dy = static_cast<double>(std::min(y, n - y));
+            for (std::size_t x = 0; x < n; ++x) {
+                const double dx = static_cast<double>(std::min(x, n - x));
+                const double r = std::sqrt(dx * dx + dy * dy + dz * dz);
+                padded[(z * n + y) * n + x] = r > 0.0 ? std::erf(r / a) / r : twoOverSqrtPi / a;
+            }
+        }
+    });
+    fft.transform(padded, false, pool);
+
+    // Squared window of every wave number along one axis (wave numbers m and N - m are the same, -m).
+    const double pi = std::acos(-1.0);
+    const int order = assignment == MeshAssignment::CIC ? 2 : 3;
+    std::vector<double> window(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        const double angle = pi * static_cast<double>(std::min(k, n - k)) / static_cast<double>(n);
+        window[k] = k == 0 ? 1.0 : std::pow(std::sin(angle) / angle, 2 * order);
+    }
+    kernelTransform.resize(padded.size());
+    pool.parallelFor(n, [&](std::size_t z, std::size_t) {
+        for (std::size_t y = 0; y < n; ++y) {
+            for (std::size_t x = 0; x < n; ++x) {
+                const std::size_t k = (z * n + y) * n + x;
+                kernelTransform[k] = padded[k].real() / (window[x] * window[y] * window[z]);
+            }
+        }
+    });
+    kernelSize = meshSize;
+    kernelAssignment = assignment;
+}
+
+// Spreads every charge over the nodes of its assignment stencil, straight into the corner [0, meshSize)^3 of the zeroed padded grid.
+// This pass is serial: neighboring particles share nodes, and it is O(N) against the O(M log M) of the transforms.
+void ParticleMeshSolver::depositCharges(const ParticleStore& particles) {
+    const std::size_t n = 2 * meshSize;
+    std::fill(padded.begin(), padded.end(), std::complex<double>(0.0, 0.0));
+    const double inverseCell = 1.0 / cellSize;
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        const double q = particles.charge[i];
+        if (q == 0.0) {
+            continue;
+        }
+        const AxisStencil sx = axisStencil((particles.x[i] - meshOrigin[0]) * inverseCell, assignment, meshSize);
+        const AxisStencil sy = axisStencil((particles.y[i] - meshOrigin[1]) * inverseCell, assignment, meshSize);
+        const AxisStencil sz = axisStencil((particles.z[i] - meshOrigin[2]) * inverseCell, assignment, meshSize);
+        for (int c = 0; c < sz.count; ++c) {
+            for (int b = 0; b < sy.count; ++b) {
+                const double weight = q * sz.weight[c] * sy.weight[b];
+                std::complex<double>* row = padded.data() + ((sz.first + c) * n + (sy.first + b)) * n + sx.first;
+                for (int a = 0; a < sx.count; ++a) {
+                    row[a] += weight * sx.weight[a];
+                }
+            }
+        }
+    }
+}
+
+// Convolves the deposited charges with the smooth kernel: forward transform, multiplication by the kernel's transform, inverse transform.
+// Only the corner [0, meshSize)^3 holds charges, so the forward x pass only transforms the lines with y and z below meshSize and the y pass
+// those with z below meshSize; only that corner of the result is needed, so the inverse passes skip the same lines in reverse order.
+void ParticleMeshSolver::solvePotential(ThreadPool& pool) {
+    const std::size_t m = meshSize;
+    const std::size_t n = 2 * m;
+    fft.transformAxis(padded, 0, m, m, false, pool);
+    fft.transformAxis(padded, 1, n, m, false, pool);
+    fft.transformAxis(padded, 2, n, n, false, pool);
+    const double scale = 1.0 / (cellSize * static_cast<double>(n * n * n)); // The kernel's 1 / h and the transforms' normalization
+    pool.parallelFor(n, [&](std::size_t z, std::size_t) {
+        for (std::size_t k = z * n * n; k < (z + 1) * n * n; ++k) {
+            padded[k] *= kernelTransform[k] * scale;
+        }
+    });
+    fft.transformAxis(padded, 2, n, n, true, pool);
+    fft.transformAxis(padded, 1, n, m, true, pool);
+    fft.transformAxis(padded, 0, m, m, true, pool);
+    potential.resize(m * m * m);
+    pool.parallelFor(m, [&](std::size_t z, std::size_t) {
+        for (std::size_t y = 0; y < m; ++y) {
+            for (std::size_t x = 0; x < m; ++x) {
+                potential[(z * m + y) * m + x] = padded[(z * n + y) * n + x].real();
+            }
+        }
+    });
+}
+
+// Computes the gradient of the potential at every node with fourth-order central differences,
+// (8 (phi[+1] - phi[-1]) - (phi[+2] - phi[-2])) / (12 h). The two outermost layers of nodes, which no stencil reaches, get zero.
+void ParticleMeshSolver::differentiatePotential(ThreadPool& pool) {
+    const std::size_t m = meshSize;
+    fieldX.assign(m * m * m, 0.0);
+    fieldY.assign(m * m * m, 0.0);
+    fieldZ.assign(m * m * m, 0.0);
+    const double scale = 1.0 / (12.0 * cellSize);
+    const std::size_t strides[3] = {1, m, m * m};
+    double* field[3] = {fieldX.data(), fieldY.data(), fieldZ.data()};
+    pool.parallelFor(m - 4, [&](std::size_t plane, std::size_t) {
+        const std::size_t z = plane + 2;
+        for (std::size_t y = 2; y + 2 < m; ++y) {
+            for (std::size_t x = 2; x + 2 < m; ++x) {
+                const std::size_t node = (z * m + y) * m + x;
+                for (int axis = 0; axis < 3; ++axis) {
+                    const std::size_t s = strides[axis];
+                    field[axis][node] = (8.0 * (potential[node + s] - potential[node - s]) - (potential[node + 2 * s] - potential[node - 2 * s])) * scale;
+                }
+            }
+        }
+    });
+}
+
+// Bins the charged particles into a chaining mesh of cells at least correctionRadius wide (enlarged, like the cell list's, until there
+// are at most a few cells per particle), so that every correction partner lies in the 3 x 3 x 3 cells around a particle.
+void ParticleMeshSolver::binForCorrections(const ParticleStore& particles) {
+    const std::size_t count = particles.size();
+    std::size_t charged = 0;
+    double high[3] = {0.0, 0.0, 0.0};
+    for (std::size_t i = 0; i < count; ++i) {
+        if (particles.charge[i] == 0.0) {
+            continue;
+        }
+        const double position[3] = {particles.x[i], particles.y[i], particles.z[i]};
+        for (int axis = 0; axis < 3; ++axis) {
+            chainOrigin[axis] = charged == 0 ? position[axis] : std::min(chainOrigin[axis], position[axis]);
+            high[axis] = charged == 0 ? position[axis] : std::max(high[axis], position[axis]);
+        }
+        ++charged;
+    }
+    const std::size_t maxCells = std::max<std::size_t>(27, 4 * charged);
+    chainCellSize = correctionRadius;
+    while (true) {
+        std::size_t total = 1;
+        for (int axis = 0; axis < 3; ++axis) {
+            chainDims[axis] = static_cast<std::size_t>((high[axis] - chainOrigin[axis]) / chainCellSize) + 1;
+            total *= chainDims[axis];
+        }
+        if (total <= maxCells) {
+            break;
+        }
+        chainCellSize *= 2.0;
+    }
+
+    const std::size_t cellCount = chainDims[0] * chainDims[1] * chainDims[2];
+    chainStart.assign(cellCount + 1, 0);
+    chainOfParticle.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (particles.charge[i] == 0.0) {
+            continue;
+        }
+        const std::size_t cx = chainCoordinate(particles.x[i], chainOrigin[0], chainCellSize, chainDims[0]);
+        const std::size_t cy = chainCoordinate(particles.y[i], chainOrigin[1], chainCellSize, chainDims[1]);
+        const std::size_t cz = chainCoordinate(particles.z[i], chainOrigin[2], chainCellSize, chainDims[2]);
+        chainOfParticle[i] = static_cast<std::uint32_t>((cz * chainDims[1] + cy) * chainDims[0] + cx);
+        ++chainStart[chainOfParticle[i] + 1];
+    }
+    for (std::size_t cell = 0; cell < cellCount; ++cell) {
+        chainStart[cell + 1] += chainStart[cell];
+    }
+    sortedIndex.resize(charged);
+    sx.resize(charged);
+    sy.resize(charged);
+    sz.resize(charged);
+    sq.resize(charged);
+    chainCursor.assign(chainStart.begin(), chainStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (particles.charge[i] == 0.0) {
+            continue;
+        }
+        const std::uint32_t position = chainCursor[chainOfParticle[i]]++;
+        sortedIndex[position] = static_cast<std::uint32_t>(i);
+        sx[position] = particles.x[i];
+        sy[position] = particles.y[i];
+        sz[position] = particles.z[i];
+        sq[position] = particles.charge[i];
+    }
+}
+
+// Adds the force of one particle: the field interpolated from the nodes of its assignment stencil, plus the short-range corrections,
+// times Coulomb's constant and its charge (the force on particle i is k q_i grad(phi), which pulls like charges together as
+// Particle::addForce does).
+void ParticleMeshSolver::addForce(ParticleStore& particles, std::size_t i) const {
+    const double qi = particles.charge[i];
+    if (qi == 0.0) {
+        return;
+    }
+    const double xi = particles.x[i], yi = particles.y[i], zi = particles.z[i];
+    const double inverseCell = 1.0 / cellSize;
+    const std::size_t m = meshSize;
+    const AxisStencil stencilX = axisStencil((xi - meshOrigin[0]) * inverseCell, assignment, m);
+    const AxisStencil stencilY = axisStencil((yi - meshOrigin[1]) * inverseCell, assignment, m);
+    const AxisStencil stencilZ = axisStencil((zi - meshOrigin[2]) * inverseCell, assignment, m);
+    double gx = 0.0, gy = 0.0, gz = 0.0;
+    for (int c = 0; c < stencilZ.count; ++c) {
+        for (int b = 0; b < stencilY.count; ++b) {
+            const std::size_t row = ((stencilZ.first + c) * m + (stencilY.first + b)) * m + stencilX.first;
+            for (int a = 0; a < stencilX.count; ++a) {
+                const double weight = stencilZ.weight[c] * stencilY.weight[b] * stencilX.weight[a];
+                gx += weight * fieldX[row + a];
+                gy += weight * fieldY[row + a];
+                gz += weight * fieldZ[row + a];
+            }
+        }
+    }
+    if (correctionRadius > 0.0) {
+        addCorrections(xi, yi, zi, i, gx, gy, gz);
+    }
+    const double kqi = CoulombInteraction::coupling * qi;
+    particles.fx[i] += kqi * gx;
+    particles.fy[i] += kqi * gy;
+    particles.fz[i] += kqi * gz;
+}
+
+// Adds q_j (S_exact - S_smooth) (r_j - r_i) for every charged particle j other than self closer than correctionRadius, where S_exact is
+// the softened Coulomb law of Particle::addForce and S_smooth the part the mesh already applied.
+void ParticleMeshSolver::addCorrections(double xi, double yi, double zi, std::size_t self, double& gx, double& gy, double& gz) const {
+    const CoulombInteraction exact{interaction.softening};
+    const double radiusSquared = correctionRadius * correctionRadius;
+    const double a = splittingCells * cellSize;
+    const long cx = static_cast<long>(chainCoordinate(xi, chainOrigin[0], chainCellSize, chainDims[0]));
+    const long cy = static_cast<long>(chainCoordinate(yi, chainOrigin[1], chainCellSize, chainDims[1]));
+    const long cz = static_cast<long>(chainCoordinate(zi, chainOrigin[2], chainCellSize, chainDims[2]));
+    std::size_t corrections = 0;
+    for (long nz = std::max(0L, cz - 1); nz <= std::min<long>(chainDims[2] - 1, cz + 1); ++nz) {
+        for (long ny = std::max(0L, cy - 1); ny <= std::min<long>(chainDims[1] - 1, cy + 1); ++ny) {
+            // Cells along x are adjacent in memory, so a row of the stencil is one contiguous range of particles.
+            const std::size_t rowCell = (static_cast<std::size_t>(nz) * chainDims[1] + static_cast<std::size_t>(ny)) * chainDims[0];
+            const std::uint32_t first = chainStart[rowCell + static_cast<std::size_t>(std::max(0L, cx - 1))];
+            const std::uint32_t last = chainStart[rowCell + static_cast<std::size_t>(std::min<long>(chainDims[0] - 1, cx + 1)) + 1];
+            for (std::uint32_t b = first; b < last; ++b) {
+                const double dx = sx[b] - xi;
+                const double dy = sy[b] - yi;
+                const double dz = sz[b] - zi;
+                const double r2 = dx*dx + dy*dy + dz*dz;
+                if (sortedIndex[b] == self || r2 >= radiusSquared || r2 == 0.0) {
+                    continue;
+                }
+                const double scale = exact.pairScale(sq[b], r2) - sq[b] * smoothPairScale(r2, a);
+                gx += scale * dx;
+                gy += scale * dy;
+                gz += scale * dz;
+                ++corrections;
+            }
+        }
+    }
+    METRICS_COUNT(Counter::PAIR_INTERACTIONS, corrections);
+}
+
+// Writes the mesh parameters to a checkpoint. The mesh is solved again for every force computation, so nothing else is saved.
+void ParticleMeshSolver::save(CheckpointWriter& checkpoint) const {
+    checkpoint.put(static_cast<std::uint64_t>(gridSize));
+    checkpoint.put(assignment);
+    checkpoint.put(correctionCells);
+}
+
+// Restores the mesh parameters from a checkpoint written by save(). A mesh size outside [1, maxGridSize] or an unknown assignment scheme
+// can only come from a damaged file, so it is rejected rather than used.
+bool ParticleMeshSolver::load(CheckpointReader& checkpoint) {
+    std::uint64_t savedGridSize = 0;
+    if (!checkpoint.get(savedGridSize) || savedGridSize == 0 || savedGridSize > maxGridSize) {
+        return false;
+    }
+    gridSize = static_cast<std::size_t>(savedGridSize);
+    return checkpoint.getEnum(assignment, MeshAssignment::TSC) && checkpoint.get(correctionCells);
+}
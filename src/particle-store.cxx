@@ -0,0 +1,273 @@
+#include "particle-store.h" // Include the ParticleStore class definition.
+#include "integrator.h"     // Include the fused integration sweeps.
+#include "checkpoint.h"     // Include the CheckpointWriter and CheckpointReader classes.
+#include "metrics.h"        // Include the instrumentation macros.
+#include <algorithm>        // Required for std::all_of, std::fill, std::max and std::move.
+
+// Reserves room for count particles in every column. Growing the capacity counts as one allocation in the metrics.
+void ParticleStore::reserve(std::size_t count) {
+    if (count > capacity()) {
+        METRICS_COUNT(Counter::ALLOCATIONS, 1);
+    }
+    id.reserve(count);
+    type.reserve(count);
+    mass.reserve(count);
+    inverseMass.reserve(count);
+    charge.reserve(count);
+    lifetime.reserve(count);
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    vx.reserve(count);
+    vy.reserve(count);
+    vz.reserve(count);
+    fx.reserve(count);
+    fy.reserve(count);
+    fz.reserve(count);
+}
+
+// Grows the capacity if fewer than count particles fit. Growing at least geometrically keeps repeated appends amortized O(1),
+// and once a run has reached its steady-state size the columns never reallocate again.
+void ParticleStore::ensureCapacity(std::size_t count) {
+    if (count > capacity()) {
+        reserve(std::max(count, 2 * capacity()));
+    }
+}
+
+// Removes all particles. The columns keep their capacity, so refilling the store does not allocate.
+// Ids start at 0 again, so a store that is cleared and refilled with the same event draws the same random numbers.
+void ParticleStore::clear() {
+    resize(0);
+    nextId = 0;
+}
+
+// Shrinks or grows every column to count particles. Added particles get consecutive fresh ids.
+void ParticleStore::resize(std::size_t count) {
+    if (count > capacity()) {
+        METRICS_COUNT(Counter::ALLOCATIONS, 1);
+    }
+    for (std::size_t i = size(); i < count; ++i) {
+        id.push_back(nextId++);
+    }
+    id.resize(count);
+    type.resize(count, ParticleType::PION_POSITIVE);
+    mass.resize(count, 0.0);
+    inverseMass.resize(count, 0.0); // Zero mass: whoever fills in the mass also fills in its inverse.
+    charge.resize(count, 0.0);
+    lifetime.resize(count, 0.0);
+    x.resize(count, 0.0);
+    y.resize(count, 0.0);
+    z.resize(count, 0.0);
+    vx.resize(count, 0.0);
+    vy.resize(count, 0.0);
+    vz.resize(count, 0.0);
+    fx.resize(count, 0.0);
+    fy.resize(count, 0.0);
+    fz.resize(count, 0.0);
+}
+
+// Appends a copy of a standalone particle record. Its fields are scattered into the columns.
+void ParticleStore::push_back(const Particle& particle) {
+    if (size() == capacity()) {
+        METRICS_COUNT(Counter::ALLOCATIONS, 1); // The columns are about to reallocate.
+    }
+    id.push_back(nextId++);
+    type.push_back(particle.type);
+    mass.push_back(particle.mass);
+    inverseMass.push_back(1.0 / particle.mass);
+    charge.push_back(particle.charge);
+    lifetime.push_back(particle.lifetime);
+    x.push_back(particle.position[0]);
+    y.push_back(particle.position[1]);
+    z.push_back(particle.position[2]);
+    vx.push_back(particle.velocity[0]);
+    vy.push_back(particle.velocity[1]);
+    vz.push_back(particle.velocity[2]);
+    fx.push_back(particle.force[0]);
+    fy.push_back(particle.force[1]);
+    fz.push_back(particle.force[2]);
+}
+
+// Appends a particle from its fields. Unlike push_back(), no Particle record (and no decay-mode table) is constructed.
+void ParticleStore::emplace_back(ParticleType type, double mass, double charge, double lifetime,
+                                 double x, double y, double z, double vx, double vy, double vz) {
+    if (size() == capacity()) {
+        METRICS_COUNT(Counter::ALLOCATIONS, 1); // The columns are about to reallocate.
+    }
+    id.push_back(nextId++);
+    this->type.push_back(type);
+    this->mass.push_back(mass);
+    inverseMass.push_back(1.0 / mass);
+    this->charge.push_back(charge);
+    this->lifetime.push_back(lifetime);
+    this->x.push_back(x);
+    this->y.push_back(y);
+    this->z.push_back(z);
+    this->vx.push_back(vx);
+    this->vy.push_back(vy);
+    this->vz.push_back(vz);
+    fx.push_back(0.0);
+    fy.push_back(0.0);
+    fz.push_back(0.0);
+}
+
+namespace {
+
+// Removes the elements at the given ascending indices from one column, sliding the kept ranges down in a single pass.
+template <typename Column>
+void compactColumn(Column& column, const std::vector<std::uint32_t>& sortedIndices) {
+    std::size_t write = sortedIndices[0];
+    for (std::size_t k = 0; k < sortedIndices.size(); ++k) {
+        const std::size_t keptBegin = sortedIndices[k] + 1;
+        const std::size_t keptEnd = (k + 1 < sortedIndices.size()) ? sortedIndices[k + 1] : column.size();
+        write = std::move(column.begin() + keptBegin, column.begin() + keptEnd, column.begin() + write) - column.begin();
+    }
+    column.resize(write);
+}
+
+// Gathers one column into spare in the given order and swaps the two, so column ends up permuted and spare holds its old buffer.
+template <typename Column>
+void gatherColumn(Column& column, Column& spare, const std::vector<std::uint32_t>& order) {
+    spare.reserve(column.capacity());
+    spare.resize(order.size());
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        spare[k] = column[order[k]];
+    }
+    column.swap(spare);
+}
+
+} // namespace
+
+// Removes the particles at the given ascending indices in one compaction pass per column, keeping the order of the remaining particles.
+// Removing a batch this way costs O(N) in total, instead of O(N) per removed particle with repeated erase() calls.
+void ParticleStore::removeIndices(const std::vector<std::uint32_t>& sortedIndices) {
+    if (sortedIndices.empty()) {
+        return;
+    }
+    compactColumn(id, sortedIndices);
+    compactColumn(type, sortedIndices);
+    compactColumn(mass, sortedIndices);
+    compactColumn(inverseMass, sortedIndices);
+    compactColumn(charge, sortedIndices);
+    compactColumn(lifetime, sortedIndices);
+    compactColumn(x, sortedIndices);
+    compactColumn(y, sortedIndices);
+    compactColumn(z, sortedIndices);
+    compactColumn(vx, sortedIndices);
+    compactColumn(vy, sortedIndices);
+    compactColumn(vz, sortedIndices);
+    compactColumn(fx, sortedIndices);
+    compactColumn(fy, sortedIndices);
+    compactColumn(fz, sortedIndices);
+}
+
+// Reorders every column so that the particle at index k is the one that was at order[k]. Each column is gathered into a spare column
+// of its type and swapped with it, so this costs one pass over the state and keeps the capacity; the ids move with the particles, so a
+// particle's random numbers do not depend on where it is stored. Views of the columns are invalidated.
+void ParticleStore::permute(const std::vector<std::uint32_t>& order) {
+    gatherColumn(id, spareIds, order);
+    gatherColumn(type, spareTypes, order);
+    gatherColumn(mass, spareValues, order);
+    gatherColumn(inverseMass, spareValues, order);
+    gatherColumn(charge, spareValues, order);
+    gatherColumn(lifetime, spareValues, order);
+    gatherColumn(x, spareValues, order);
+    gatherColumn(y, spareValues, order);
+    gatherColumn(z, spareValues, order);
+    gatherColumn(vx, spareValues, order);
+    gatherColumn(vy, spareValues, order);
+    gatherColumn(vz, spareValues, order);
+    gatherColumn(fx, spareValues, order);
+    gatherColumn(fy, spareValues, order);
+    gatherColumn(fz, spareValues, order);
+}
+
+// Changes the mass of the particle at index, together with its inverse mass.
+void ParticleStore::setMass(std::size_t index, double newMass) {
+    mass[index] = newMass;
+    inverseMass[index] = 1.0 / newMass;
+}
+
+// Returns a standalone copy of the stored particle at index. The particle's fields are gathered from the columns.
+Particle ParticleStore::get(std::size_t index) const {
+    Particle particle(type[index], mass[index], charge[index], lifetime[index], x[index], y[index], z[index]);
+    particle.velocity[0] = vx[index];
+    particle.velocity[1] = vy[index];
+    particle.velocity[2] = vz[index];
+    particle.force[0] = fx[index];
+    particle.force[1] = fy[index];
+    particle.force[2] = fz[index];
+    return particle;
+}
+
+// Resets the net force on every particle to zero.
+void ParticleStore::resetForces() {
+    std::fill(fx.begin(), fx.end(), 0.0);
+    std::fill(fy.begin(), fy.end(), 0.0);
+    std::fill(fz.begin(), fz.end(), 0.0);
+}
+
+// Advances every particle by deltaTime using the same Euler scheme as Particle::update() (kick, then drift, then clear the forces).
+// This is the fused sweep of the integrator layer, which multiplies by the precomputed inverse mass instead of dividing by the mass.
+void ParticleStore::update(double deltaTime) {
+    kickDriftSweep(*this, deltaTime, deltaTime);
+}
+
+// Writes every column and the next id to a checkpoint. Each column is copied as one block.
+void ParticleStore::save(CheckpointWriter& checkpoint) const {
+    checkpoint.put(nextId);
+    checkpoint.putColumn(id);
+    checkpoint.putColumn(type);
+    checkpoint.putColumn(mass);
+    checkpoint.putColumn(inverseMass);
+    checkpoint.putColumn(charge);
+    checkpoint.putColumn(lifetime);
+    checkpoint.putColumn(x);
+    checkpoint.putColumn(y);
+    checkpoint.putColumn(z);
+    checkpoint.putColumn(vx);
+    checkpoint.putColumn(vy);
+    checkpoint.putColumn(vz);
+    checkpoint.putColumn(fx);
+    checkpoint.putColumn(fy);
+    checkpoint.putColumn(fz);
+}
+
+// Restores the store from a checkpoint written by save(). Returns false if the checkpoint is damaged, its columns differ in length or a
+// particle has a type outside ParticleType (the species tables are indexed by type).
+bool ParticleStore::load(CheckpointReader& checkpoint) {
+    const bool ok = checkpoint.get(nextId) &&
+                    checkpoint.getColumn(id) && checkpoint.getColumn(type) && checkpoint.getColumn(mass) &&
+                    checkpoint.getColumn(inverseMass) && checkpoint.getColumn(charge) && checkpoint.getColumn(lifetime) &&
+                    checkpoint.getColumn(x) && checkpoint.getColumn(y) && checkpoint.getColumn(z) &&
+                    checkpoint.getColumn(vx) && checkpoint.getColumn(vy) && checkpoint.getColumn(vz) &&
+                    checkpoint.getColumn(fx) && checkpoint.getColumn(fy) && checkpoint.getColumn(fz);
+    const std::size_t count = type.size();
+    for (const auto* column : {&mass, &inverseMass, &charge, &lifetime, &x, &y, &z, &vx, &vy, &vz, &fx, &fy, &fz}) {
+        if (column->size() != count) {
+            return false;
+        }
+    }
+    const bool typesValid = std::all_of(type.begin(), type.end(), [](ParticleType t) { return static_cast<std::size_t>(t) < particleTypeCount; });
+    return ok && id.size() == count && typesValid;
+}
+
+// Returns a mutable proxy for the particle at index.
+ParticleRef ParticleStore::operator[](std::size_t index) {
+    return ParticleRef{
+        type[index], mass[index], charge[index], lifetime[index],
+        {{&x[index], &y[index], &z[index]}},
+        {{&vx[index], &vy[index], &vz[index]}},
+        {{&fx[index], &fy[index], &fz[index]}}
+    };
+}
+
+// Returns a read-only proxy for the particle at index.
+ConstParticleRef ParticleStore::operator[](std::size_t index) const {
+    return ConstParticleRef{
+        type[index], mass[index], charge[index], lifetime[index],
+        {{&x[index], &y[index], &z[index]}},
+        {{&vx[index], &vy[index], &vz[index]}},
+        {{&fx[index], &fy[index], &fz[index]}}
+    };
+}
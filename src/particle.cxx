@@ -1,4 +1,5 @@
 #include "particle.h"   // Include the Particle class definition.
+#include "species.h"    // Include the species registry (decay modes of each particle type).
 #include <cmath>        // For mathematical operations.
 
 // Constructor: Initializes a particle.
@@ -15,7 +16,7 @@ Particle::Particle(ParticleType type, double m, double q, double lt, double x, d
         setDecayModes();
     }
     else {
-        decayModes = {};
+        decayModes = DecayModeList{};
     }
 }
 
@@ -27,51 +28,24 @@ void Particle::resetForce() {
 }
 
 // Sets two possible decay modes for each particle type. This will be called if the particle is unstable.
-// In a true particle physics context, decay modes are quite varied and dependent on many factors.
-// For simplicity, I will choose representative decay modes.
 void Particle::setDecayModes() {
-    if (type == ParticleType::PION_POSITIVE) {
-        decayModes = {
-            {ParticleType::KAON_POSITIVE, 0.2},
-            {ParticleType::PROTON, 0.1}
-        };
-    } else if (type == ParticleType::PION_NEGATIVE) {
-        decayModes = {
-            {ParticleType::KAON_NEGATIVE, 0.2},
-            {ParticleType::PROTON, 0.1}
-        };
-    } else if (type == ParticleType::PION_NEUTRAL) {
-        decayModes = {
-            {ParticleType::PION_POSITIVE, 0.5}, // In reality, neutral pions decay into photons, but this is a simplification.
-            {ParticleType::PION_NEGATIVE, 0.5}
-        };
-    } else if (type == ParticleType::KAON_POSITIVE) {
-        decayModes = {
-            {ParticleType::PION_POSITIVE, 0.63},
-            {ParticleType::PION_NEUTRAL, 0.21}
-        };
-    } else if (type == ParticleType::KAON_NEGATIVE) {
-        decayModes = {
-            {ParticleType::PION_NEGATIVE, 0.63},
-            {ParticleType::PION_NEUTRAL, 0.21}
-        };
-    } else if (type == ParticleType::PROTON) {
-        decayModes = {
-            // Protons are stable for all practical purposes in this context.
-            // So, they do not have decay modes in this simplified simulation.
-        };
-    }
+    decayModes = decayModesFor(type);
+}
+
+// Returns the decay modes of a particle type, as listed in the species registry.
+DecayModeList Particle::decayModesFor(ParticleType type) {
+    return getSpecies(type).decayModeList();
 }
 
 // Calculates and adds the electromagnetic force exerted by another particle.
 // This is based on Coulomb's law, where the force magnitude is proportional to the product of the charges
 // and inversely proportional to the square of the distance between the particles.
 void Particle::addForce(Particle& other) {
-    const double k_e = 8.9875517873681764e9; // Coulomb's constant in N m^2/C^2
+    const double k_e = coulombConstant; // Coulomb's constant in N m^2/C^2
     double dx = other.position[0] - this->position[0];
     double dy = other.position[1] - this->position[1];
     double dz = other.position[2] - this->position[2];
-    double distanceSquared = dx*dx + dy*dy + dz*dz + 1e-10; // Add a small term to prevent division by zero when calculating forceMagnitude.
+    double distanceSquared = dx*dx + dy*dy + dz*dz + forceSoftening; // Add a small term to prevent division by zero when calculating forceMagnitude.
     double distance = sqrt(distanceSquared);
     double forceMagnitude = k_e * this->charge * other.charge / distanceSquared;
 
@@ -0,0 +1,463 @@
+#include "run-driver.h"      // Include the RunConfig struct and the driver functions.
+#include "analysis.h"        // Include the InSituAnalysis class definition.
+#include "event-generator.h" // Include the EventGenerator class definition.
+#include "metrics.h"         // Include the PeriodicMetricsDump class and the Chrome trace functions.
+#include "snapshot.h"        // Include the SnapshotWriter class definition.
+#include <algorithm>         // Required for std::min.
+#include <cerrno>            // Required for errno.
+#include <chrono>            // Required for timing the progress reports.
+#include <cmath>             // Required for std::isfinite.
+#include <cstdlib>           // Required for std::strtod and std::strtoull.
+#include <fstream>           // Required for reading config files.
+#include <limits>            // Required for std::numeric_limits.
+#include <memory>            // Required for std::unique_ptr.
+
+namespace {
+
+// Removes leading and trailing whitespace.
+std::string trim(const std::string& text) {
+    const std::size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+// Parses a non-negative integer that fits in maximum. Signs, fractions and trailing characters are rejected.
+bool parseCount(const std::string& value, unsigned long long maximum, unsigned long long& result) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    errno = 0;
+    result = std::strtoull(value.c_str(), nullptr, 10);
+    return errno == 0 && result <= maximum;
+}
+
+// Parses a finite floating-point number. Trailing characters are rejected.
+bool parseNumber(const std::string& value, double& result) {
+    if (value.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    result = std::strtod(value.c_str(), &end);
+    return errno == 0 && *end == '\0' && std::isfinite(result);
+}
+
+// Sets a size_t field, which must be at least minimum.
+bool setCount(std::size_t& field, const std::string& key, const std::string& value, std::size_t minimum, std::string& error) {
+    unsigned long long parsed = 0;
+    if (!parseCount(value, std::numeric_limits<std::size_t>::max(), parsed) || parsed < minimum) {
+        error = "--" + key + " expects a whole number of at least " + std::to_string(minimum) + ", not \"" + value + "\"";
+        return false;
+    }
+    field = static_cast<std::size_t>(parsed);
+    return true;
+}
+
+// Sets a double field, which must be positive (or, if zero is allowed, not negative).
+bool setPositive(double& field, const std::string& key, const std::string& value, bool allowZero, std::string& error) {
+    double parsed = 0.0;
+    if (!parseNumber(value, parsed) || parsed < 0.0 || (parsed == 0.0 && !allowZero)) {
+        error = "--" + key + " expects a " + (allowZero ? "non-negative" : "positive") + " number, not \"" + value + "\"";
+        return false;
+    }
+    field = parsed;
+    return true;
+}
+
+// Writes one progress line for an event.
+void reportProgress(std::ostream& log, const RunConfig& config, std::size_t event, std::size_t step, const Simulation& sim,
+                    std::size_t particles, double stepsPerSecond) {
+    log << "event " << event + 1 << "/" << config.events << "  step " << step << "/" << config.steps
+        << "  particles " << particles << "  decays " << sim.getDecayCount()
+        << "  " << stepsPerSecond << " steps/s\n";
+}
+
+// Records every timed phase for the Chrome trace while it exists, so that recording stops on every way out of a run.
+struct TraceRecording {
+    explicit TraceRecording(bool enabled) : enabled(enabled) {
+        if (enabled) {
+            setTracing(true);
+        }
+    }
+    ~TraceRecording() {
+        if (enabled) {
+            setTracing(false);
+        }
+    }
+    bool enabled;
+};
+
+} // namespace
+
+// Sets one field of a run configuration by its option name (the long command-line option without the leading dashes).
+bool setRunOption(RunConfig& config, const std::string& key, const std::string& value, std::string& error) {
+    if (key == "events") {
+        return setCount(config.events, key, value, 1, error);
+    }
+    if (key == "steps") {
+        return setCount(config.steps, key, value, 0, error);
+    }
+    if (key == "dt") {
+        return setPositive(config.deltaTime, key, value, false, error);
+    }
+    if (key == "multiplicity") {
+        return setPositive(config.multiplicity, key, value, true, error);
+    }
+    if (key == "solver") {
+        if (value == "all-pairs") {
+            config.solver = ForceSolver::ALL_PAIRS;
+        } else if (value == "barnes-hut") {
+            config.solver = ForceSolver::BARNES_HUT;
+        } else if (value == "cell-list") {
+            config.solver = ForceSolver::CELL_LIST;
+        } else if (value == "particle-mesh") {
+            config.solver = ForceSolver::PARTICLE_MESH;
+        } else {
+            error = "--solver expects all-pairs, barnes-hut, cell-list or particle-mesh, not \"" + value + "\"";
+            return false;
+        }
+        return true;
+    }
+    if (key == "integrator") {
+        if (value == "euler") {
+            config.integrator = Integrator::EULER;
+        } else if (value == "leapfrog") {
+            config.integrator = Integrator::LEAPFROG;
+        } else if (value == "velocity-verlet") {
+            config.integrator = Integrator::VELOCITY_VERLET;
+        } else if (value == "block-verlet") {
+            config.integrator = Integrator::BLOCK_VERLET;
+        } else {
+            error = "--integrator expects euler, leapfrog, velocity-verlet or block-verlet, not \"" + value + "\"";
+            return false;
+        }
+        return true;
+    }
+    if (key == "interaction") {
+        if (value == "coulomb") {
+            config.interaction = InteractionModel::COULOMB;
+        } else if (value == "yukawa") {
+            config.interaction = InteractionModel::YUKAWA;
+        } else if (value == "cutoff") {
+            config.interaction = InteractionModel::CUTOFF_COULOMB;
+        } else if (value == "none") {
+            config.interaction = InteractionModel::NONE;
+        } else {
+            error = "--interaction expects coulomb, yukawa, cutoff or none, not \"" + value + "\"";
+            return false;
+        }
+        return true;
+    }
+    if (key == "precision") {
+        if (value == "double") {
+            config.precision = ForcePrecision::DOUBLE;
+        } else if (value == "mixed") {
+            config.precision = ForcePrecision::MIXED;
+        } else {
+            error = "--precision expects double or mixed, not \"" + value + "\"";
+            return false;
+        }
+        return true;
+    }
+    if (key == "range") {
+        return setPositive(config.range, key, value, false, error);
+    }
+    if (key == "theta") {
+        double theta = 0.0;
+        if (!setPositive(theta, key, value, true, error)) {
+            return false;
+        }
+        if (theta > BarnesHutSolver::maxOpeningAngle) {
+            error = "--theta expects a number from 0 to 1 (larger angles let a cell act on particles inside it), not \"" + value + "\"";
+            return false;
+        }
+        config.openingAngle = theta;
+        return true;
+    }
+    if (key == "cutoff") {
+        return setPositive(config.cutoff, key, value, false, error);
+    }
+    if (key == "skin") {
+        return setPositive(config.skin, key, value, true, error);
+    }
+    if (key == "mesh") {
+        std::size_t meshSize = 0;
+        if (!setCount(meshSize, key, value, 1, error)) {
+            return false;
+        }
+        if (meshSize > ParticleMeshSolver::maxGridSize) {
+            error = "--mesh expects at most " + std::to_string(ParticleMeshSolver::maxGridSize) + " nodes per axis, not \"" + value + "\"";
+            return false;
+        }
+        config.meshSize = meshSize;
+        return true;
+    }
+    if (key == "p3m-cells") {
+        return setPositive(config.correctionCells, key, value, true, error);
+    }
+    if (key == "assignment") {
+        if (value == "cic") {
+            config.assignment = MeshAssignment::CIC;
+        } else if (value == "tsc") {
+            config.assignment = MeshAssignment::TSC;
+        } else {
+            error = "--assignment expects cic or tsc, not \"" + value + "\"";
+            return false;
+        }
+        return true;
+    }
+    if (key == "reorder-every") {
+        return setCount(config.reorderInterval, key, value, 0, error);
+    }
+    if (key == "reorder-disorder") {
+        return setPositive(config.reorderDisorder, key, value, true, error);
+    }
+    if (key == "threads") {
+        return setCount(config.threads, key, value, 0, error);
+    }
+    if (key == "seed") {
+        unsigned long long parsed = 0;
+        if (!parseCount(value, std::numeric_limits<std::uint32_t>::max(), parsed)) {
+            error = "--seed expects a whole number below 2^32, not \"" + value + "\"";
+            return false;
+        }
+        config.seed = static_cast<std::uint32_t>(parsed);
+        return true;
+    }
+    if (key == "output") {
+        config.output = value;
+        return true;
+    }
+    if (key == "snapshot-every") {
+        return setCount(config.snapshotInterval, key, value, 1, error);
+    }
+    if (key == "progress-every") {
+        return setCount(config.progressInterval, key, value, 0, error);
+    }
+    if (key == "metrics") {
+        config.metricsPath = value;
+        return true;
+    }
+    if (key == "metrics-every") {
+        return setPositive(config.metricsInterval, key, value, false, error);
+    }
+    if (key == "trace") {
+        config.tracePath = value;
+        return true;
+    }
+    if (key == "analysis") {
+        config.analysisPath = value;
+        return true;
+    }
+    if (key == "analysis-every") {
+        return setCount(config.analysisInterval, key, value, 1, error);
+    }
+    error = "unknown option \"" + key + "\"";
+    return false;
+}
+
+// Applies a config file. Each line holds one "key = value" pair with the same keys as the command-line options; text after a '#' is a
+// comment and blank lines are skipped.
+bool loadRunConfigFile(const std::string& path, RunConfig& config, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open config file \"" + path + "\"";
+        return false;
+    }
+    std::string line;
+    for (std::size_t number = 1; std::getline(file, line); ++number) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        const std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = path + ":" + std::to_string(number) + ": expected \"key = value\"";
+            return false;
+        }
+        std::string lineError;
+        if (!setRunOption(config, trim(line.substr(0, equals)), trim(line.substr(equals + 1)), lineError)) {
+            error = path + ":" + std::to_string(number) + ": " + lineError;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Applies command-line options in order, so later options override earlier ones. "--config file" applies the file where it appears,
+// so options after it override the file. "--help" (or "-h") sets showHelp and stops.
+bool parseRunArguments(int argc, const char* const argv[], RunConfig& config, bool& showHelp, std::string& error) {
+    showHelp = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--help" || argument == "-h") {
+            showHelp = true;
+            return true;
+        }
+        if (argument.compare(0, 2, "--") != 0 || argument.size() == 2) {
+            error = "unexpected argument \"" + argument + "\"";
+            return false;
+        }
+        std::string key = argument.substr(2);
+        std::string value;
+        const std::size_t equals = key.find('=');
+        if (equals != std::string::npos) {
+            value = key.substr(equals + 1);
+            key.resize(equals);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            error = "--" + key + " expects a value";
+            return false;
+        }
+        if (key == "config" ? !loadRunConfigFile(value, config, error) : !setRunOption(config, key, value, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the help text listing every option and its default.
+std::string getRunUsage() {
+    return "Usage: app [options]\n"
+           "Options are applied in order; \"--key value\" and \"--key=value\" both work.\n"
+           "  --config FILE          Applies a file of \"key = value\" lines (same keys as the options below)\n"
+           "  --events N             Events to simulate, one after the other (default 1)\n"
+           "  --steps N              Steps per event (default 100)\n"
+           "  --dt SECONDS           Time step (default 1e-12)\n"
+           "  --multiplicity N       Mean number of particles per event (default 1000)\n"
+           "  --solver NAME          all-pairs, barnes-hut, cell-list or particle-mesh (default barnes-hut)\n"
+           "  --integrator NAME      euler, leapfrog, velocity-verlet or block-verlet (default leapfrog)\n"
+           "  --interaction NAME     Force law: coulomb, yukawa, cutoff or none (default coulomb)\n"
+           "  --range METERS         Screening length (yukawa) or cutoff radius (cutoff) of the force law (default 1e-3)\n"
+           "  --precision NAME       double, or mixed for float all-pairs Coulomb kernels with double sums (default double)\n"
+           "  --theta X              Opening angle of the Barnes-Hut solver, from 0 to 1 (default 0.5)\n"
+           "  --cutoff METERS        Cutoff radius of the cell-list solver (default 1e-3)\n"
+           "  --skin METERS          Verlet skin of the cell-list solver (default 0, no neighbor list)\n"
+           "  --mesh N               Nodes per axis of the particle-mesh solver, rounded up to a power of two, at most 512 (default 32)\n"
+           "  --p3m-cells X          Radius of the exact short-range corrections in mesh cells (default 0, plain PM; about 4 for P3M)\n"
+           "  --assignment NAME      Charge assignment of the particle-mesh solver: cic or tsc (default tsc)\n"
+           "  --reorder-every N      Steps between Morton reorders of the particles (default 0, none)\n"
+           "  --reorder-disorder X   Reorders whenever this fraction of stored neighbors is out of order (default 0.25, 0 for never)\n"
+           "  --threads N            Worker threads (default 0, one per hardware thread)\n"
+           "  --seed N               Seed of the random number generator (default 0)\n"
+           "  --output FILE          Snapshot file; with several events, FILE gets an -eventK suffix (default none)\n"
+           "  --snapshot-every N     Steps between snapshots (default 10)\n"
+           "  --progress-every N     Steps between progress lines (default 10, 0 for none)\n"
+           "  --metrics FILE         Metrics file rewritten during the run; JSON if FILE ends in .json, else Prometheus\n"
+           "  --metrics-every SEC    Seconds between rewrites of the metrics file (default 10)\n"
+           "  --trace FILE           Records every timed phase and writes them to FILE as a Chrome trace at the end (default none)\n"
+           "  --analysis FILE        Fills per-species spectra during the run and writes them to FILE as JSON (default none)\n"
+           "  --analysis-every N     Steps between the analysis' histogram fills (default 10)\n"
+           "  --help                 Prints this text\n";
+}
+
+// Returns the snapshot file of one event. A single event writes to output itself; with several events, "-eventK" is inserted before the
+// file extension (run.snap becomes run-event0.snap, run-event1.snap, ...).
+std::string getEventOutputPath(const std::string& output, std::size_t event, std::size_t eventCount) {
+    if (eventCount <= 1 || output.empty()) {
+        return output;
+    }
+    const std::string suffix = "-event" + std::to_string(event);
+    const std::size_t dot = output.find_last_of('.');
+    const std::size_t slash = output.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash) || dot == 0 || dot == slash + 1) {
+        return output + suffix;
+    }
+    return output.substr(0, dot) + suffix + output.substr(dot);
+}
+
+// Runs every event of a configuration. One Simulation is reused for all events (startEvent() keeps its buffers), and the steps of an event
+// run through Simulation::run() in batches of progressInterval steps, with one progress line per batch. Nothing is printed per particle.
+bool runSimulations(const RunConfig& config, std::ostream& log) {
+    using Clock = std::chrono::steady_clock;
+
+    Simulation sim;
+    sim.setThreadCount(config.threads);
+    sim.setSeed(config.seed);
+    sim.setForceSolver(config.solver);
+    sim.setIntegrator(config.integrator);
+    sim.setOpeningAngle(config.openingAngle);
+    sim.setCutoff(config.cutoff);
+    sim.setNeighborListSkin(config.skin);
+    sim.setParticleMesh(config.meshSize, config.correctionCells, config.assignment);
+    sim.setReorder(config.reorderInterval, config.reorderDisorder);
+    InteractionSettings interaction;
+    interaction.model = config.interaction;
+    interaction.range = config.range;
+    sim.setInteraction(interaction);
+    sim.setForcePrecision(config.precision);
+
+    EventConfig eventConfig;
+    eventConfig.meanMultiplicity = config.multiplicity;
+    const EventGenerator generator(eventConfig);
+
+    std::unique_ptr<PeriodicMetricsDump> metricsDump;
+    if (!config.metricsPath.empty()) {
+        const bool json = config.metricsPath.size() >= 5 && config.metricsPath.compare(config.metricsPath.size() - 5, 5, ".json") == 0;
+        metricsDump.reset(new PeriodicMetricsDump(config.metricsPath, config.metricsInterval, json ? MetricsFormat::JSON : MetricsFormat::PROMETHEUS));
+    }
+
+    InSituAnalysis analysis;
+    if (!config.analysisPath.empty()) {
+        sim.setAnalysis(&analysis, config.analysisInterval);
+    }
+
+    TraceRecording trace(!config.tracePath.empty());
+    const Clock::time_point runStart = Clock::now();
+    std::size_t totalDecays = 0;
+    std::size_t totalParticleSteps = 0;
+    for (std::size_t event = 0; event < config.events; ++event) {
+        sim.startEvent(static_cast<std::uint32_t>(event));
+        sim.generateEvent(generator);
+
+        SnapshotWriter snapshots;
+        const std::string path = getEventOutputPath(config.output, event, config.events);
+        if (!path.empty() && !snapshots.open(path)) {
+            log << "error: cannot open snapshot file \"" << path << "\"\n";
+            return false;
+        }
+
+        const std::size_t batch = config.progressInterval > 0 ? config.progressInterval : config.steps;
+        for (std::size_t done = 0; done < config.steps;) {
+            const std::size_t count = std::min(batch, config.steps - done);
+            const std::size_t particles = sim.particles.size();
+            const Clock::time_point batchStart = Clock::now();
+            sim.run(count, config.deltaTime, path.empty() ? nullptr : &snapshots, config.snapshotInterval);
+            const double seconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+            done += count;
+            totalParticleSteps += count * particles;
+            if (config.progressInterval > 0) {
+                reportProgress(log, config, event, done, sim, sim.particles.size(), seconds > 0.0 ? count / seconds : 0.0);
+            }
+        }
+        if (!path.empty() && !snapshots.close()) {
+            log << "error: writing snapshot file \"" << path << "\" failed\n";
+            return false;
+        }
+        totalDecays += sim.getDecayCount();
+        analysis.endEvent();
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+    log << "finished " << config.events << " event(s) of " << config.steps << " step(s) in " << seconds << " s  decays "
+        << totalDecays << "  " << (seconds > 0.0 ? totalParticleSteps / seconds : 0.0) << " particle-steps/s\n";
+    if (trace.enabled) {
+        setTracing(false);
+        if (!writeChromeTrace(config.tracePath)) {
+            log << "error: writing trace file \"" << config.tracePath << "\" failed\n";
+            return false;
+        }
+    }
+    if (metricsDump && !metricsDump->dump()) {
+        log << "error: writing metrics file \"" << config.metricsPath << "\" failed\n";
+        return false;
+    }
+    if (!config.analysisPath.empty() && !analysis.writeResults(config.analysisPath)) {
+        log << "error: writing analysis file \"" << config.analysisPath << "\" failed\n";
+        return false;
+    }
+    return true;
+}
@@ -1,44 +1,256 @@
 #include "particle.h"       // Include the Particle class definition.
 #include "simulation.h"     // Include the Simulation class definition.
-#include <numeric>          // Required for using std::accumulate (in getTotalLifetime())
+#include "species.h"        // Include the species registry.
 #include <tuple>            // Required for using std::tuple.
+#include "checkpoint.h"     // Include the CheckpointWriter and CheckpointReader classes.
+#include "metrics.h"        // Include the instrumentation macros.
+#include "snapshot.h"       // Include the SnapshotWriter class definition.
+#include <algorithm>        // Required for std::min.
+#include <cmath>            // Required for std::isfinite.
+#include <utility>          // Required for std::move.
 
 // Simulates a collision that generates three particles.
 void Simulation::simulateCollision() {
 
-    // Parameters for particles generated in a typical Pb-Pb collision.
-    double pionMass = 0.13957; // in electronvolts (GeV/c^2)
-    double kaonMass = 0.49367; // in electronvolts
-    double protonMass = 0.93827; // in electronvolts
-
-    // In this simulation, all particles are produced with random initial velocities within a range.
-    std::uniform_real_distribution<double> velocityDist(-0.1, 0.1);
+    // Masses and charges of particles generated in a typical Pb-Pb collision come from the species registry.
+    const SpeciesInfo& pion = getSpecies(ParticleType::PION_POSITIVE);
+    const SpeciesInfo& kaon = getSpecies(ParticleType::KAON_POSITIVE);
+    const SpeciesInfo& proton = getSpecies(ParticleType::PROTON);
 
     // Create particles. Since we are simulating the result of a collision, these particles are created at the same intial position.
-    createParticle(ParticleType::PION_POSITIVE, pionMass, +1.0, 0.0, 0.0, 0.0, 0.0); // Stable particle with a lifetime of 0.0
-    createParticle(ParticleType::KAON_POSITIVE, kaonMass, +1.0, 1.24e-8, 0.0, 0.0, 0.0); // Unstable particle with a lifetime of 1.24e-8
-    createParticle(ParticleType::PROTON, protonMass, +1, 0.0, 0.0, 0.0, 0.0); // Stable particle with a lifetime of 0.0
+    createParticle(ParticleType::PION_POSITIVE, pion.mass, pion.charge, 0.0, 0.0, 0.0, 0.0); // The primary pion is kept stable (lifetime 0.0) in this collision
+    createParticle(ParticleType::KAON_POSITIVE, kaon.mass, kaon.charge, kaon.lifetime, 0.0, 0.0, 0.0); // Unstable particle with a lifetime of 1.24e-8
+    createParticle(ParticleType::PROTON, proton.mass, proton.charge, proton.lifetime, 0.0, 0.0, 0.0); // Stable particle with a lifetime of 0.0
+}
+
+// Appends a whole collision event (multiplicity and species drawn from the generator's configuration) in one bulk operation.
+size_t Simulation::generateEvent(const EventGenerator& eventGenerator) {
+    METRICS_PHASE(Phase::CREATION);
+    forcesCurrent = false;
+    const size_t first = particles.size();
+    const size_t count = eventGenerator.generate(particles, rng);
+    observables += measureObservables(particles, first, particles.size());
+    METRICS_COUNT(Counter::PARTICLES_CREATED, count);
+    return count;
+}
+
+// Sets the seed of the random number generator.
+void Simulation::setSeed(std::uint32_t seed) {
+    rng = CounterRng(seed, rng.getEvent());
+}
+
+// Sets the event id. Simulations with the same seed and different event ids (for example the events of a batch) draw independent numbers.
+void Simulation::setEventId(std::uint32_t event) {
+    rng = CounterRng(rng.getSeed(), event);
+}
+
+// Empties the simulation for the next event and sets its event id, as if it had just been constructed with the same settings (only the
+// integrator's substep statistics keep counting).
+// The particle columns, the solvers' grids, trees and lists, the decay buffers and the thread pool are kept with their capacity, so
+// running events of similar size one after another on the same simulation does not allocate once the first event has reached its size.
+void Simulation::startEvent(std::uint32_t event) {
+    setEventId(event);
+    particles.clear();
+    step = 0;
+    decayCount = 0;
+    forcesCurrent = false;
+    observables = Observables();
+    timeIntegrator.restart();
+    cellListSolver.invalidateNeighborList();
+}
+
+// Creates a particle of a given type with the mass, charge and lifetime from the species registry.
+void Simulation::createParticle(ParticleType type) {
+    const SpeciesInfo& species = getSpecies(type);
+    createParticle(type, species.mass, species.charge, species.lifetime, 0.0, 0.0, 0.0);
 }
 
 // Creates a particle and adds it to the simulation.
 void Simulation::createParticle(ParticleType type, double mass, double charge, double lifetime, double x, double y, double z) {
 
-    std::uniform_real_distribution<double> velocityDist(-0.1, 0.1);
-    double vx = velocityDist(generator);
-    double vy = velocityDist(generator);
-    double vz = velocityDist(generator);
+    // Velocities are uniform in [-0.1, 0.1) and only depend on the seed, the event and the id the particle will get.
+    const auto bits = rng.block(RandomPurpose::CREATION, particles.getNextId(), 0);
+    double vx = 0.1 * (2.0 * toUniform(bits[1]) - 1.0);
+    double vy = 0.1 * (2.0 * toUniform(bits[2]) - 1.0);
+    double vz = 0.1 * (2.0 * toUniform(bits[3]) - 1.0);
 
     // TODO: I may pass in specific initial positions later (x, y, z), but for now I'll set them to zero.
-    Particle newParticle(type, mass, charge, lifetime, 0.0, 0.0, 0.0);
-    newParticle.velocity[0] = vx;
-    newParticle.velocity[1] = vy;
-    newParticle.velocity[2] = vz;
-    particles.push_back(newParticle);
+    // The fields go straight into the store's columns, so no Particle record is built.
+    particles.emplace_back(type, mass, charge, lifetime, 0.0, 0.0, 0.0, vx, vy, vz);
+    observables.add(mass, charge, lifetime, vx, vy, vz);
+    METRICS_COUNT(Counter::PARTICLES_CREATED, 1);
+    forcesCurrent = false;
 }
 
-// Computes the forces between all pairs of particles.
+// Computes the forces between all pairs of particles with the selected solver.
+// This always recomputes, because particles is public and its columns may have been written since the last step. The forces it leaves
+// are current, so a following run() does not compute them again.
 void Simulation::computeForces() {
-    // TODO
+    evaluateForces();
+    forcesCurrent = true;
+}
+
+// Clears the force columns and computes the forces with the selected solver.
+// The previous forces are cleared first, so calling this twice in a row does not double the forces.
+// With a mask, only the flagged particles' forces are cleared and recomputed (the active particles of a block timestep).
+void Simulation::evaluateForces(const std::vector<std::uint8_t>* isTarget) {
+    METRICS_PHASE(Phase::FORCES);
+    if (isTarget) {
+        const std::vector<std::uint8_t>& mask = *isTarget;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            if (mask[i]) {
+                particles.fx[i] = 0.0;
+                particles.fy[i] = 0.0;
+                particles.fz[i] = 0.0;
+            }
+        }
+        switch (getActiveSolver()) {
+            case ForceSolver::ALL_PAIRS:     allPairsSolver.computeForcesOn(particles, mask, pool()); break;
+            case ForceSolver::BARNES_HUT:    barnesHutSolver.computeForcesOn(particles, mask, pool()); break;
+            case ForceSolver::CELL_LIST:     cellListSolver.computeForcesOn(particles, mask, pool()); break;
+            case ForceSolver::PARTICLE_MESH: meshSolver.computeForcesOn(particles, mask, pool()); break;
+        }
+        return;
+    }
+    particles.resetForces();
+    switch (getActiveSolver()) {
+        case ForceSolver::ALL_PAIRS:     allPairsSolver.computeForces(particles, pool()); break;
+        case ForceSolver::BARNES_HUT:    barnesHutSolver.computeForces(particles, pool()); break;
+        case ForceSolver::CELL_LIST:     cellListSolver.computeForces(particles, pool()); break;
+        case ForceSolver::PARTICLE_MESH: meshSolver.computeForces(particles, pool()); break;
+    }
+}
+
+// Selects the force algorithm used by computeForces().
+void Simulation::setForceSolver(ForceSolver solver) {
+    forceSolver = solver;
+    forcesCurrent = false;
+}
+
+// Returns the solver that computes the forces: the selected one, except that the mesh only solves the Coulomb law, so the particle-mesh
+// solver hands the other force laws to the Barnes-Hut solver.
+ForceSolver Simulation::getActiveSolver() const {
+    if (forceSolver == ForceSolver::PARTICLE_MESH && meshSolver.interaction.model != InteractionModel::COULOMB) {
+        return ForceSolver::BARNES_HUT;
+    }
+    return forceSolver;
+}
+
+// Selects the time integration scheme used by updateParticles(). A new scheme starts from whole-step velocities.
+void Simulation::setIntegrator(Integrator integrator) {
+    timeIntegrator.scheme = integrator;
+    timeIntegrator.restart();
+}
+
+// Configures the block timesteps of the BLOCK_VERLET scheme: the finest level (substeps down to deltaTime / 2^maxLevel) and the accuracy
+// parameter and length scale of the level criterion.
+void Simulation::setBlockTimesteps(int maxLevel, double accuracy, double lengthScale) {
+    timeIntegrator.maxLevel = maxLevel;
+    timeIntegrator.accuracy = accuracy;
+    timeIntegrator.lengthScale = lengthScale;
+}
+
+// Sets the opening angle of the Barnes-Hut solver, clamped to [0, BarnesHutSolver::maxOpeningAngle] (NaN opens every cell).
+void Simulation::setOpeningAngle(double theta) {
+    barnesHutSolver.openingAngle = (theta > 0.0) ? std::min(theta, BarnesHutSolver::maxOpeningAngle) : 0.0;
+    forcesCurrent = false;
+}
+
+// Sets the cutoff radius and grid cell size of the cell-list solver. The solver divides by both, so a cutoff that is not positive and finite,
+// or a cell size that is negative or not finite, is ignored and the previous settings are kept (as the run driver rejects them).
+void Simulation::setCutoff(double cutoff, double cellSize) {
+    if (!(cutoff > 0.0 && std::isfinite(cutoff)) || !(cellSize >= 0.0 && std::isfinite(cellSize))) {
+        return;
+    }
+    cellListSolver.cutoff = cutoff;
+    cellListSolver.cellSize = cellSize;
+    forcesCurrent = false;
+}
+
+// Configures the particle-mesh solver: nodes per axis, radius of the exact short-range corrections in mesh cells (0 for plain PM, about 4
+// for P3M) and the charge assignment scheme.
+void Simulation::setParticleMesh(size_t gridSize, double correctionCells, MeshAssignment assignment) {
+    meshSolver.gridSize = gridSize;
+    meshSolver.correctionCells = correctionCells;
+    meshSolver.assignment = assignment;
+    forcesCurrent = false;
+}
+
+// Sets the Verlet skin distance of the cell-list solver.
+void Simulation::setNeighborListSkin(double skin) {
+    cellListSolver.skin = skin;
+}
+
+// Configures the reordering stage that runs at the end of every step (after the decays, which append their products at the end).
+void Simulation::setReorder(size_t interval, double disorderThreshold) {
+    spatialSorter.interval = interval;
+    spatialSorter.disorderThreshold = disorderThreshold;
+}
+
+// Sorts the particles into Morton order now.
+void Simulation::reorderParticles() {
+    METRICS_PHASE(Phase::REORDER);
+    spatialSorter.reorder(particles);
+    cellListSolver.invalidateNeighborList();
+}
+
+// Attaches an in-situ analysis (or detaches it with null). The simulation only borrows it: the caller ends its events and writes it.
+void Simulation::setAnalysis(InSituAnalysis* inSituAnalysis, size_t interval) {
+    analysis = inSituAnalysis;
+    analysisInterval = std::max<size_t>(1, interval);
+}
+
+// Runs the in-situ analysis stage if one is attached: every step adds its decays, and every analysisInterval-th step (counted like the
+// snapshots, from the event start) also bins the particles. It runs before the reordering stage, which does not change any spectrum.
+void Simulation::analyzeStep() {
+    if (!analysis) {
+        return;
+    }
+    METRICS_PHASE(Phase::ANALYSIS);
+    analysis->addDecays(decayEngine.getLastDecaysByType());
+    if (step % analysisInterval == 0) {
+        analysis->fill(particles, pool());
+    }
+}
+
+// Runs the reordering stage if it is on. Every column moves, the forces included, so current forces stay current; the neighbor list
+// holds store indices and is rebuilt. Particles keep their ids, so decays draw the same random numbers wherever a particle is stored.
+void Simulation::reorderIfNeeded() {
+    if (!spatialSorter.isEnabled()) {
+        return;
+    }
+    METRICS_PHASE(Phase::REORDER);
+    if (spatialSorter.reorderIfNeeded(particles, step)) {
+        cellListSolver.invalidateNeighborList();
+    }
+}
+
+// Selects the force law of every force solver, so that switching solvers keeps the law.
+void Simulation::setInteraction(const InteractionSettings& interaction) {
+    allPairsSolver.interaction = interaction;
+    barnesHutSolver.interaction = interaction;
+    cellListSolver.interaction = interaction;
+    meshSolver.interaction = interaction;
+    forcesCurrent = false;
+}
+
+// Selects the precision of the all-pairs Coulomb pair loop. The other solvers and force laws always run in double.
+void Simulation::setForcePrecision(ForcePrecision precision) {
+    allPairsSolver.precision = precision;
+    forcesCurrent = false;
+}
+
+// Sets how many threads the force computation uses (0 means one per hardware thread).
+void Simulation::setThreadCount(size_t threadCount) {
+    threadPool = std::make_shared<ThreadPool>(threadCount);
+}
+
+// Returns the thread pool, creating it with one thread per hardware thread if none was set.
+ThreadPool& Simulation::pool() {
+    if (!threadPool) {
+        threadPool = std::make_shared<ThreadPool>();
+    }
+    return *threadPool;
 }
 
 // Returns the number of particles in the simulation.
@@ -49,40 +261,272 @@ size_t Simulation::getParticleCount() {
 // Returns the position of each particle in the simulation as vectors of triples.
 std::vector<std::tuple<double, double, double>> Simulation::getParticlePositions() const {
     std::vector<std::tuple<double, double, double>> positions;
-    for (const auto& particle : particles) {
-        positions.emplace_back(particle.position[0], particle.position[1], particle.position[2]);
+    positions.reserve(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        positions.emplace_back(particles.x[i], particles.y[i], particles.z[i]);
     }
     return positions;
 }
 
-// Returns the sum of all particle lifetimes in the simulation.
+// Returns the sum of all particle lifetimes in the simulation (kept up to date incrementally, see getObservables()).
 double Simulation::getTotalLifetime() const {
-    // Use std::accumulate to sum up the lifetimes.
-    double totalLifetime = std::accumulate(particles.begin(), particles.end(), 0.0,
-            [](double sum, const Particle& particle) {
-            return sum + particle.lifetime;
-            });
-    return totalLifetime;
+    return getObservables().totalLifetime;
+}
+
+// Returns the aggregate observables. They are updated where the particles change: creation and event generation add the new particles,
+// the last velocity sweep of each step measures the kinetic energy and momentum on the fly, and each decay step adds the products and
+// subtracts their parents. This only reads them, so concurrent readers are safe; after writing the particle store directly (adding,
+// removing or changing particles), call refreshObservables() first.
+const Observables& Simulation::getObservables() const {
+    return observables;
+}
+
+// Re-measures the observables with a full scan.
+void Simulation::refreshObservables() {
+    observables = measureObservables(particles);
 }
 
 // Updates the state of all particles based on the computed forces and decay properties.
 void Simulation::updateParticles(double deltaTime) {
-    for (auto& particle : particles) {
-        particle.update(deltaTime);
+    // One fused sweep over the particle columns per kick-drift (see integrator.h); velocity Verlet also computes the new forces.
+    // The last velocity sweep of the step also measures the kinetic energy and momentum.
+    {
+        METRICS_PHASE(Phase::INTEGRATION);
+        forcesCurrent = timeIntegrator.step(particles, deltaTime, [this](const std::vector<std::uint8_t>* isTarget) { evaluateForces(isTarget); }, &observables);
     }
     decayParticles(deltaTime);
+    reorderIfNeeded();
 }
 
 // Checks for unstable particles and handles their decay.
+// Each unstable particle decays within the step with the probability given by its exponential lifetime distribution. A decayed particle is
+// replaced by a product chosen by branching ratio (see DecayEngine).
 void Simulation::decayParticles(double deltaTime) {
-    // Iterate through all particles.
-    for (auto& particle : particles) {
-        // Check if particle is unstable and should decay.
-        if (particle.isUnstable()) {
-            // For now, decrease lifetime by deltaTime as a placeholder for simplified decay logic.
-            particle.lifetime -= deltaTime;
-
-            // TODO: Comprehensive decay logic, involving decay mode selection and particle transformation or removal.
+    METRICS_PHASE(Phase::DECAY);
+    const size_t decays = decayEngine.decayParticles(particles, deltaTime, rng, step);
+    ++step;
+    if (decays > 0) {
+        forcesCurrent = false; // Removed parents and new products change the forces.
+        observables += decayEngine.getLastChange();
+    }
+    decayCount += decays;
+    analyzeStep();
+}
+
+// Runs steps steps of deltaTime. Each step computes the forces, integrates and decays, like computeForces() followed by updateParticles().
+// With a writer, the state after every step whose count since the start of the event is a multiple of snapshotInterval is written as a
+// frame whose time is the step count times deltaTime. Counting from the event start keeps the cadence when the steps are split over calls.
+// An interval of 0 is treated as 1 (a frame after every step), as setAnalysis() does.
+// Forces that are still current (left by a velocity Verlet step or by computeForces()) are not computed again, so columns of particles
+// written directly between calls need a computeForces() first.
+//
+// Euler and leapfrog steps run as a task graph over chunks of particlesPerChunk particles instead of as global phases: a chunk is
+// integrated as soon as its forces are done, its decays are staged as soon as it is integrated, and a frame is staged while the next
+// step's forces are computed (only integration has to wait for it). The remaining synchronization points are the ones the algorithms need:
+// the tree or grid is built from all positions before any forces, and parents are removed and products appended once all chunks are staged.
+// The force solvers compute each particle's force exactly as computeForces() does, and the decays are applied in chunk order, so positions,
+// velocities and decays are the same, bit for bit, as with the serial calls; only the kinetic energy and momentum are summed chunk by chunk.
+// The all-pairs solver has no per-chunk split (its tiles apply Newton's third law across chunks), so its forces are computed before the graph.
+// Velocity Verlet and block timesteps need the new forces within the step and run as serial phases.
+void Simulation::run(size_t steps, double deltaTime, SnapshotWriter* snapshots, size_t snapshotInterval) {
+    snapshotInterval = std::max<size_t>(1, snapshotInterval);
+    if (!timeIntegrator.isKickDrift()) {
+        for (size_t n = 1; n <= steps; ++n) {
+            if (!forcesCurrent) { // A velocity Verlet step leaves the forces at the new positions.
+                evaluateForces();
+            }
+            updateParticles(deltaTime);
+            if (snapshots && step % snapshotInterval == 0) {
+                snapshots->write(particles, static_cast<double>(step) * deltaTime);
+            }
         }
+        return;
+    }
+
+    scheduled.snapshot = nullptr;
+    for (size_t n = 1; n <= steps; ++n) {
+        scheduled.deltaTime = deltaTime;
+        runScheduledStep();
+        scheduled.snapshot = (snapshots && step % snapshotInterval == 0) ? snapshots : nullptr;
+        scheduled.snapshotTime = static_cast<double>(step) * deltaTime;
     }
+    if (scheduled.snapshot) {
+        scheduled.snapshot->write(particles, scheduled.snapshotTime);
+        scheduled.snapshot = nullptr;
+    }
+}
+
+// Runs one kick-drift step through the task graph. scheduled.deltaTime and scheduled.snapshot are set by the caller.
+void Simulation::runScheduledStep() {
+    const size_t count = particles.size();
+    const size_t chunkCount = std::max<size_t>(1, (count + particlesPerChunk - 1) / particlesPerChunk);
+    if (chunkCount != graphChunks) {
+        buildStepGraph(chunkCount);
+    }
+
+    scheduled.count = count;
+    scheduled.computeForces = !forcesCurrent;
+    if (scheduled.computeForces) {
+        METRICS_PHASE(Phase::FORCES);
+        switch (getActiveSolver()) {
+            case ForceSolver::ALL_PAIRS:     evaluateForces(); scheduled.computeForces = false; break;
+            case ForceSolver::BARNES_HUT:    barnesHutSolver.prepareRanges(particles); break;
+            case ForceSolver::CELL_LIST:     cellListSolver.prepareRanges(particles, pool()); break;
+            case ForceSolver::PARTICLE_MESH: meshSolver.prepareRanges(particles, pool()); break;
+        }
+    }
+    scheduled.kickTime = timeIntegrator.beginKickDrift(scheduled.deltaTime);
+    decayEngine.beginChunks(chunkCount);
+
+    stepGraph.run(pool());
+
+    forcesCurrent = false; // The kick-drift sweeps consumed the forces.
+    observables.kineticEnergy = 0.0;
+    observables.momentum[0] = observables.momentum[1] = observables.momentum[2] = 0.0;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        observables.kineticEnergy += chunkMotion[chunk].kineticEnergy;
+        for (int axis = 0; axis < 3; ++axis) {
+            observables.momentum[axis] += chunkMotion[chunk].momentum[axis];
+        }
+    }
+
+    METRICS_PHASE(Phase::DECAY);
+    const size_t decays = decayEngine.applyStaged(particles);
+    ++step;
+    if (decays > 0) {
+        observables += decayEngine.getLastChange();
+    }
+    decayCount += decays;
+    analyzeStep();
+    reorderIfNeeded();
+}
+
+// Builds the task graph of a step: one snapshot task, and per chunk a force, an integration and a decay task.
+// A chunk's integration waits for its own forces and for the snapshot (which reads the positions it moves); its decays wait for its
+// integration. Nothing else is ordered, so chunks flow through the stages independently.
+void Simulation::buildStepGraph(size_t chunkCount) {
+    stepGraph.clear();
+    chunkMotion.resize(chunkCount);
+    const size_t snapshotTask = stepGraph.add([this](size_t) {
+        if (scheduled.snapshot) {
+            scheduled.snapshot->write(particles, scheduled.snapshotTime);
+        }
+    });
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const size_t forceTask = stepGraph.add([this, chunk](size_t) {
+            if (!scheduled.computeForces) {
+                return;
+            }
+            METRICS_PHASE(Phase::FORCES);
+            const size_t begin = chunk * particlesPerChunk;
+            const size_t end = std::min(begin + particlesPerChunk, scheduled.count);
+            std::fill(particles.fx.begin() + begin, particles.fx.begin() + end, 0.0);
+            std::fill(particles.fy.begin() + begin, particles.fy.begin() + end, 0.0);
+            std::fill(particles.fz.begin() + begin, particles.fz.begin() + end, 0.0);
+            switch (getActiveSolver()) {
+                case ForceSolver::BARNES_HUT:    barnesHutSolver.computeRange(particles, begin, end); break;
+                case ForceSolver::CELL_LIST:     cellListSolver.computeRange(particles, begin, end); break;
+                case ForceSolver::PARTICLE_MESH: meshSolver.computeRange(particles, begin, end); break;
+                case ForceSolver::ALL_PAIRS:     break; // Computed up front by runScheduledStep()
+            }
+        });
+        const size_t integrateTask = stepGraph.add([this, chunk](size_t) {
+            METRICS_PHASE(Phase::INTEGRATION);
+            const size_t begin = chunk * particlesPerChunk;
+            const size_t end = std::min(begin + particlesPerChunk, scheduled.count);
+            kickDriftSweep(particles, begin, end, scheduled.kickTime, scheduled.deltaTime, &chunkMotion[chunk]);
+        });
+        const size_t decayTask = stepGraph.add([this, chunk](size_t) {
+            METRICS_PHASE(Phase::DECAY);
+            const size_t begin = chunk * particlesPerChunk;
+            const size_t end = std::min(begin + particlesPerChunk, scheduled.count);
+            decayEngine.stageChunk(particles, chunk, begin, end, scheduled.deltaTime, rng, step);
+        });
+        stepGraph.addDependency(forceTask, integrateTask);
+        stepGraph.addDependency(snapshotTask, integrateTask);
+        stepGraph.addDependency(integrateTask, decayTask);
+    }
+    graphChunks = chunkCount;
+}
+
+// Writes the whole simulation state to one checkpoint file: the particle columns, the random number key and step, the decay count, the
+// solver, force law, precision, reordering and integrator settings and state, the force flag and the observables. The columns are copied into the payload block by block
+// and the payload is written with a single write, so a checkpoint costs about as much as copying the particle columns once.
+// Only the thread count is not saved; it is a property of the machine, and the force solvers give the same results on any thread count.
+bool Simulation::saveCheckpoint(const std::string& path, bool compress) const {
+    METRICS_PHASE(Phase::OUTPUT);
+    CheckpointWriter checkpoint;
+    checkpoint.reserve(particles.size() * (3 * sizeof(std::uint64_t) + 12 * sizeof(double)) + 4096);
+    particles.save(checkpoint);
+    checkpoint.put(rng.getSeed());
+    checkpoint.put(rng.getEvent());
+    checkpoint.put(step);
+    checkpoint.put(static_cast<std::uint64_t>(decayCount));
+    checkpoint.put(forceSolver);
+    checkpoint.put(barnesHutSolver.openingAngle);
+    checkpoint.put(allPairsSolver.interaction);
+    checkpoint.put(allPairsSolver.precision);
+    cellListSolver.save(checkpoint);
+    meshSolver.save(checkpoint);
+    spatialSorter.save(checkpoint);
+    timeIntegrator.save(checkpoint);
+    checkpoint.put(forcesCurrent);
+    checkpoint.put(observables);
+    return writeCheckpointFile(path, checkpoint.getPayload(), compress);
+}
+
+// Restores the state written by saveCheckpoint(). The payload is read with a single read and every column is copied out of it as one
+// block, so there is no per-particle parsing. A restored simulation continues exactly (bit for bit) like the one that was saved.
+// Everything is decoded into scratch objects and validated first; the simulation is only changed once the whole payload has been read,
+// so a damaged checkpoint leaves it as it was.
+bool Simulation::loadCheckpoint(const std::string& path) {
+    std::vector<char> payload;
+    if (!readCheckpointFile(path, payload)) {
+        return false;
+    }
+    CheckpointReader checkpoint(payload.data(), payload.size());
+    ParticleStore loadedParticles;
+    CellListSolver loadedCellList;
+    ParticleMeshSolver loadedMesh;
+    SpatialSorter loadedSorter;
+    TimeIntegrator loadedIntegrator;
+    std::uint32_t seed = 0, event = 0;
+    std::uint64_t loadedStep = 0, decays = 0;
+    ForceSolver loadedSolver = ForceSolver::ALL_PAIRS;
+    double openingAngle = 0.0;
+    InteractionSettings interaction;
+    ForcePrecision precision = ForcePrecision::DOUBLE;
+    bool loadedForcesCurrent = false;
+    Observables loadedObservables;
+    const bool ok = loadedParticles.load(checkpoint) &&
+                    checkpoint.get(seed) && checkpoint.get(event) && checkpoint.get(loadedStep) && checkpoint.get(decays) &&
+                    checkpoint.getEnum(loadedSolver, ForceSolver::PARTICLE_MESH) && checkpoint.get(openingAngle) && checkpoint.get(interaction) &&
+                    checkpoint.getEnum(precision, ForcePrecision::MIXED) &&
+                    loadedCellList.load(checkpoint) && loadedMesh.load(checkpoint) && loadedSorter.load(checkpoint) && loadedIntegrator.load(checkpoint) &&
+                    checkpoint.getFlag(loadedForcesCurrent) && checkpoint.get(loadedObservables) && checkpoint.atEnd();
+    const bool valid = ok && openingAngle >= 0.0 && openingAngle <= BarnesHutSolver::maxOpeningAngle &&
+                       static_cast<unsigned>(interaction.model) <= static_cast<unsigned>(InteractionModel::NONE) &&
+                       loadedObservables.count == loadedParticles.size();
+    if (!valid) {
+        return false;
+    }
+
+    particles = std::move(loadedParticles);
+    rng = CounterRng(seed, event);
+    step = loadedStep;
+    decayCount = static_cast<size_t>(decays);
+    forceSolver = loadedSolver;
+    barnesHutSolver.openingAngle = openingAngle;
+    allPairsSolver.precision = precision;
+    cellListSolver = std::move(loadedCellList);
+    meshSolver = std::move(loadedMesh);
+    spatialSorter = std::move(loadedSorter);
+    timeIntegrator = std::move(loadedIntegrator);
+    allPairsSolver.interaction = interaction;
+    barnesHutSolver.interaction = interaction;
+    cellListSolver.interaction = interaction;
+    meshSolver.interaction = interaction;
+    forcesCurrent = loadedForcesCurrent;
+    observables = loadedObservables;
+    return true;
 }
\ No newline at end of file
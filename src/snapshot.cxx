@@ -0,0 +1,238 @@
+#include "snapshot.h"   // Include the SnapshotWriter and SnapshotReader class definitions.
+#include "metrics.h"    // Include the instrumentation macros.
+#include <cstring>      // Required for std::memcpy and std::memcmp.
+#include <fcntl.h>      // Required for open().
+#include <sys/mman.h>   // Required for mmap() and munmap().
+#include <sys/stat.h>   // Required for fstat().
+#include <unistd.h>     // Required for close().
+
+namespace {
+
+constexpr std::size_t fileHeaderBytes = 16;
+constexpr std::size_t frameHeaderBytes = 48;
+constexpr std::uint64_t frameMagic = 0x454d415246534950ull; // "PISFRAME" as little-endian bytes
+
+// Header at the start of every frame.
+struct FrameHeader {
+    std::uint64_t magic;
+    std::uint64_t index;
+    std::uint64_t count;
+    double time;
+    std::uint64_t bytes; // Size of the whole frame, header included
+    std::uint64_t reserved;
+};
+static_assert(sizeof(FrameHeader) == frameHeaderBytes, "The frame header must be 48 bytes.");
+
+// Returns count rounded up to a multiple of 8.
+std::size_t padded(std::size_t count) {
+    return (count + 7) & ~std::size_t(7);
+}
+
+// Returns the size of a frame of count particles.
+std::size_t frameBytes(std::size_t count) {
+    return frameHeaderBytes + 7 * 8 * count + padded(count);
+}
+
+} // namespace
+
+// Creates (or truncates) the file, writes its header and starts the I/O thread. Returns false if the file cannot be created.
+bool SnapshotWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    char header[fileHeaderBytes] = {};
+    std::memcpy(header, snapshotMagic, 8);
+    const std::uint32_t version = snapshotVersion;
+    const std::uint32_t headerBytes = fileHeaderBytes;
+    std::memcpy(header + 8, &version, 4);
+    std::memcpy(header + 12, &headerBytes, 4);
+    if (std::fwrite(header, 1, fileHeaderBytes, file) != fileHeaderBytes) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    nextBuffer = 0;
+    nextFrame = 0;
+    failed = false;
+    stopping = false;
+    ioThread = std::thread(&SnapshotWriter::ioLoop, this);
+    return true;
+}
+
+// Lets the I/O thread write the remaining frames, then closes the file. Returns false if any write failed.
+bool SnapshotWriter::close() {
+    if (!file) {
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    bufferReady.notify_all();
+    ioThread.join();
+    const bool ok = std::fclose(file) == 0 && !failed;
+    file = nullptr;
+    return ok;
+}
+
+// Destructor: Closes the file (writing whatever is still staged).
+SnapshotWriter::~SnapshotWriter() {
+    close();
+}
+
+// Stages one frame. The columns are copied into the next staging buffer; waits only if the I/O thread is still writing that buffer.
+void SnapshotWriter::write(const ParticleStore& particles, double time) {
+    METRICS_PHASE(Phase::OUTPUT);
+    const int buffer = nextBuffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bufferFree.wait(lock, [&] { return !busy[buffer]; });
+        busy[buffer] = true;
+    }
+
+    const std::size_t count = particles.size();
+    std::vector<char>& bytes = buffers[buffer];
+    bytes.resize(frameBytes(count));
+    char* out = bytes.data();
+    const FrameHeader header = {frameMagic, nextFrame, count, time, bytes.size(), 0};
+    std::memcpy(out, &header, frameHeaderBytes);
+    out += frameHeaderBytes;
+    std::memcpy(out, particles.id.data(), 8 * count);
+    out += 8 * count;
+    for (const auto* column : {&particles.x, &particles.y, &particles.z, &particles.vx, &particles.vy, &particles.vz}) {
+        std::memcpy(out, column->data(), 8 * count);
+        out += 8 * count;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<char>(particles.type[i]);
+    }
+    std::memset(out + count, 0, padded(count) - count);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(buffer);
+    }
+    bufferReady.notify_one();
+    nextBuffer = 1 - buffer;
+    ++nextFrame;
+}
+
+// Waits until every staged frame has been written and flushed to the operating system. Returns false if any write failed.
+bool SnapshotWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    bufferFree.wait(lock, [&] { return !busy[0] && !busy[1]; });
+    if (std::fflush(file) != 0) {
+        failed = true;
+    }
+    return !failed;
+}
+
+// Writes staged buffers in order until the writer is destroyed and no buffer is left.
+void SnapshotWriter::ioLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        bufferReady.wait(lock, [&] { return stopping || !ready.empty(); });
+        if (ready.empty()) {
+            return; // Stopping, and everything is written.
+        }
+        const int buffer = ready.front();
+        ready.pop_front();
+
+        // The buffer is busy, so the simulation thread does not touch it while it is written without the lock.
+        lock.unlock();
+        const std::vector<char>& bytes = buffers[buffer];
+        const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        METRICS_COUNT(Counter::BYTES_WRITTEN, ok ? bytes.size() : 0);
+        lock.lock();
+
+        failed = failed || !ok;
+        busy[buffer] = false;
+        bufferFree.notify_all();
+    }
+}
+
+// Maps the file read-only, checks its header and records the offset of every complete frame.
+// Returns false if the file cannot be mapped or is not a snapshot file of this version.
+bool SnapshotReader::open(const std::string& path) {
+    close();
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < fileHeaderBytes) {
+        ::close(descriptor);
+        return false;
+    }
+    const std::size_t fileSize = static_cast<std::size_t>(status.st_size);
+    void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor); // The mapping keeps the file alive.
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const char*>(mapping);
+    size = fileSize;
+
+    std::uint32_t version = 0;
+    std::memcpy(&version, data + 8, 4);
+    if (std::memcmp(data, snapshotMagic, 8) != 0 || version != snapshotVersion) {
+        close();
+        return false;
+    }
+
+    // Hop from frame to frame; stop at the first frame that is damaged or cut off.
+    std::size_t offset = fileHeaderBytes;
+    while (offset + frameHeaderBytes <= size) {
+        FrameHeader header;
+        std::memcpy(&header, data + offset, frameHeaderBytes);
+        if (header.magic != frameMagic || header.bytes != frameBytes(header.count) || header.bytes > size - offset) {
+            break;
+        }
+        frameOffsets.push_back(offset);
+        offset += header.bytes;
+    }
+    return true;
+}
+
+// Unmaps the file.
+void SnapshotReader::close() {
+    if (data) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    frameOffsets.clear();
+}
+
+// Destructor: Unmaps the file.
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+// Returns a view of a frame. The columns point straight into the mapping.
+// Returns an empty frame (no particles, null columns) if the index is not below getFrameCount().
+SnapshotFrame SnapshotReader::getFrame(std::size_t index) const {
+    SnapshotFrame frame;
+    if (index >= getFrameCount()) {
+        return frame;
+    }
+    const char* base = data + frameOffsets[index];
+    FrameHeader header;
+    std::memcpy(&header, base, frameHeaderBytes);
+
+    frame.index = header.index;
+    frame.time = header.time;
+    frame.count = header.count;
+    const char* column = base + frameHeaderBytes;
+    frame.id = reinterpret_cast<const std::uint64_t*>(column);
+    const double** doubles[6] = {&frame.x, &frame.y, &frame.z, &frame.vx, &frame.vy, &frame.vz};
+    for (int k = 0; k < 6; ++k) {
+        column += 8 * frame.count;
+        *doubles[k] = reinterpret_cast<const double*>(column);
+    }
+    column += 8 * frame.count;
+    frame.type = reinterpret_cast<const std::uint8_t*>(column);
+    return frame;
+}
@@ -0,0 +1,155 @@
+#include "spatial-sort.h" // Include the SpatialSorter class definition.
+#include <algorithm>      // Required for std::min and std::max.
+#include <cmath>          // Required for std::floor.
+
+namespace {
+
+// Number of cells along each axis of the key grid (21 bits per axis fill a 63-bit key).
+const std::uint32_t gridCells = 1u << 21;
+
+// Spreads the low 21 bits of v so that two zero bits follow each of them.
+inline std::uint64_t spreadBits(std::uint64_t v) {
+    v &= 0x1FFFFF;
+    v = (v | (v << 32)) & 0x1F00000000FFFFull;
+    v = (v | (v << 16)) & 0x1F0000FF0000FFull;
+    v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+    v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+// Returns the key-grid cell of a position along one axis, clamped to the grid (a non-finite position lands in cell 0).
+inline std::uint32_t gridCoordinate(double position, double low, double scale) {
+    const double cell = std::floor((position - low) * scale);
+    if (!(cell >= 0.0)) {
+        return 0;
+    }
+    return static_cast<std::uint32_t>(std::min(cell, static_cast<double>(gridCells - 1)));
+}
+
+} // namespace
+
+// Interleaves three 21-bit cell coordinates into a Morton key: bit 3k of the key is bit k of cx, bit 3k + 1 of cy and bit 3k + 2 of cz.
+std::uint64_t getMortonKey(std::uint32_t cx, std::uint32_t cy, std::uint32_t cz) {
+    return spreadBits(cx) | (spreadBits(cy) << 1) | (spreadBits(cz) << 2);
+}
+
+// Reorders the store if step is a multiple of interval, or if the disorder check is on and the store is too disordered.
+// The disorder is measured on the keys the sort would use, so a triggered reorder computes the keys only once.
+bool SpatialSorter::reorderIfNeeded(ParticleStore& particles, std::uint64_t step) {
+    if (particles.size() < 2) {
+        return false;
+    }
+    const bool periodic = interval > 0 && step % interval == 0;
+    if (!periodic && disorderThreshold <= 0.0) {
+        return false;
+    }
+    computeKeys(particles);
+    if (!periodic && disorderOfKeys() <= disorderThreshold) {
+        return false;
+    }
+    sortByKeys(particles);
+    return true;
+}
+
+// Sorts the store into Morton order over its current bounding cube.
+void SpatialSorter::reorder(ParticleStore& particles) {
+    computeKeys(particles);
+    sortByKeys(particles);
+}
+
+// Returns the fraction of adjacent stored particles whose Morton keys are in decreasing order.
+double SpatialSorter::measureDisorder(const ParticleStore& particles) {
+    computeKeys(particles);
+    return disorderOfKeys();
+}
+
+// Computes the Morton key of every particle. The grid spans the bounding cube of the particles (the largest extent along any axis), so
+// cells are cubes and the curve keeps neighbors close along every axis.
+void SpatialSorter::computeKeys(const ParticleStore& particles) {
+    const std::size_t count = particles.size();
+    keys.resize(count);
+    if (count == 0) {
+        return;
+    }
+    double low[3] = {particles.x[0], particles.y[0], particles.z[0]};
+    double high[3] = {low[0], low[1], low[2]};
+    for (std::size_t i = 1; i < count; ++i) {
+        low[0] = std::min(low[0], particles.x[i]);
+        low[1] = std::min(low[1], particles.y[i]);
+        low[2] = std::min(low[2], particles.z[i]);
+        high[0] = std::max(high[0], particles.x[i]);
+        high[1] = std::max(high[1], particles.y[i]);
+        high[2] = std::max(high[2], particles.z[i]);
+    }
+    const double extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    const double scale = extent > 0.0 ? gridCells / extent : 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        keys[i] = getMortonKey(gridCoordinate(particles.x[i], low[0], scale), gridCoordinate(particles.y[i], low[1], scale),
+                               gridCoordinate(particles.z[i], low[2], scale));
+    }
+}
+
+// Returns the fraction of adjacent pairs of computed keys that are in decreasing order.
+double SpatialSorter::disorderOfKeys() const {
+    if (keys.size() < 2) {
+        return 0.0;
+    }
+    std::size_t descents = 0;
+    for (std::size_t i = 1; i < keys.size(); ++i) {
+        descents += keys[i] < keys[i - 1] ? 1 : 0;
+    }
+    return static_cast<double>(descents) / static_cast<double>(keys.size() - 1);
+}
+
+// Sorts the computed keys with a least-significant-digit radix sort (8 bits per pass, skipping passes in which every key has the same
+// digit) and permutes the store into the sorted order. The sort is stable, so particles in the same cell keep their relative order.
+void SpatialSorter::sortByKeys(ParticleStore& particles) {
+    const std::size_t count = keys.size();
+    order.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        order[i] = static_cast<std::uint32_t>(i);
+    }
+    spareKeys.resize(count);
+    spareOrder.resize(count);
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::size_t offsets[256] = {};
+        for (std::size_t i = 0; i < count; ++i) {
+            ++offsets[(keys[i] >> shift) & 0xFF];
+        }
+        if (offsets[(keys[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+        std::size_t start = 0;
+        for (std::size_t& offset : offsets) {
+            const std::size_t bucket = offset;
+            offset = start;
+            start += bucket;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t position = offsets[(keys[i] >> shift) & 0xFF]++;
+            spareKeys[position] = keys[i];
+            spareOrder[position] = order[i];
+        }
+        keys.swap(spareKeys);
+        order.swap(spareOrder);
+    }
+    particles.permute(order);
+    ++reorders;
+}
+
+// Writes the triggers and the reorder count to a checkpoint. The keys are recomputed for every reorder, so they are not saved.
+void SpatialSorter::save(CheckpointWriter& checkpoint) const {
+    checkpoint.put(static_cast<std::uint64_t>(interval));
+    checkpoint.put(disorderThreshold);
+    checkpoint.put(static_cast<std::uint64_t>(reorders));
+}
+
+// Restores the sorter from a checkpoint written by save().
+bool SpatialSorter::load(CheckpointReader& checkpoint) {
+    std::uint64_t savedInterval = 0, savedReorders = 0;
+    const bool ok = checkpoint.get(savedInterval) && checkpoint.get(disorderThreshold) && checkpoint.get(savedReorders);
+    interval = static_cast<std::size_t>(savedInterval);
+    reorders = static_cast<std::size_t>(savedReorders);
+    return ok;
+}
@@ -0,0 +1,109 @@
+#include "task-graph.h" // Include the TaskGraph class definition.
+
+// Adds a task; returns its id.
+std::size_t TaskGraph::add(Task task) {
+    nodes.push_back(Node{std::move(task), {}, 0});
+    return nodes.size() - 1;
+}
+
+// Makes the task after wait until the task before has finished.
+void TaskGraph::addDependency(std::size_t before, std::size_t after) {
+    nodes[before].successors.push_back(static_cast<std::uint32_t>(after));
+    ++nodes[after].prerequisites;
+}
+
+// Removes every task.
+void TaskGraph::clear() {
+    nodes.clear();
+}
+
+// Runs every task once and returns once all have finished. Every pool thread takes part as one worker; the tasks without prerequisites
+// are dealt out round-robin, and from then on the threads hand each other work only by stealing.
+void TaskGraph::run(ThreadPool& pool) {
+    const std::size_t count = nodes.size();
+    if (count == 0) {
+        return;
+    }
+    if (remainingSize < count) {
+        remaining.reset(new std::atomic<std::uint32_t>[count]);
+        remainingSize = count;
+    }
+    while (queues.size() < pool.size()) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (auto& queue : queues) {
+        if (queue->slots.size() < count) {
+            queue->slots.resize(count);
+        }
+        queue->head = 0;
+        queue->tail = 0;
+    }
+
+    unfinished.store(count);
+    ready.store(0);
+    std::size_t nextQueue = 0;
+    for (std::size_t task = 0; task < count; ++task) {
+        remaining[task].store(nodes[task].prerequisites, std::memory_order_relaxed);
+        if (nodes[task].prerequisites == 0) {
+            WorkQueue& queue = *queues[nextQueue];
+            queue.slots[queue.tail++] = static_cast<std::uint32_t>(task);
+            ready.fetch_add(1);
+            nextQueue = (nextQueue + 1) % pool.size();
+        }
+    }
+
+    pool.parallelFor(pool.size(), [this](std::size_t, std::size_t worker) { work(worker); });
+}
+
+// Runs ready tasks on one thread until the whole graph has finished.
+void TaskGraph::work(std::size_t worker) {
+    while (true) {
+        std::uint32_t task;
+        if (take(worker, task)) {
+            nodes[task].task(worker);
+            for (const std::uint32_t successor : nodes[task].successors) {
+                if (remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    push(worker, successor);
+                }
+            }
+            if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                wake.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return ready.load() > 0 || unfinished.load() == 0; });
+        if (unfinished.load() == 0) {
+            return;
+        }
+    }
+}
+
+// Makes a task ready on a thread's queue and wakes a sleeping thread to steal it.
+void TaskGraph::push(std::size_t worker, std::uint32_t task) {
+    {
+        WorkQueue& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.slots[queue.tail++] = task;
+    }
+    ready.fetch_add(1);
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    wake.notify_one();
+}
+
+// Takes the newest task of the thread's own queue (its data is most likely still in cache), or steals the oldest task of another queue.
+bool TaskGraph::take(std::size_t worker, std::uint32_t& task) {
+    for (std::size_t offset = 0; offset < queues.size(); ++offset) {
+        const std::size_t victim = (worker + offset) % queues.size();
+        WorkQueue& queue = *queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head == queue.tail) {
+            continue;
+        }
+        task = (offset == 0) ? queue.slots[--queue.tail] : queue.slots[queue.head++];
+        ready.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
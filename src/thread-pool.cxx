@@ -0,0 +1,104 @@
+#include "thread-pool.h" // Include the ThreadPool class definition.
+#include "metrics.h"     // Include the instrumentation macros.
+
+// Constructor: Starts threadCount - 1 worker threads and waits until they are ready. The calling thread acts as the last worker.
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1; // hardware_concurrency() may return 0 when it cannot tell.
+    }
+    workers.reserve(threadCount - 1);
+    for (std::size_t worker = 1; worker < threadCount; ++worker) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    loopFinished.wait(lock, [this] { return startedWorkers == workers.size(); });
+}
+
+// Destructor: Wakes all workers, tells them to exit and joins them.
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+// Calls body(index, worker) for every index in [0, count) and returns once all calls have finished.
+void ThreadPool::parallelFor(std::size_t count, LoopBody body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Small loops (or a pool without workers) are not worth waking anyone up for.
+    if (workers.empty() || count == 1) {
+        for (std::size_t index = 0; index < count; ++index) {
+            body(index, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->body = &body;
+        this->count = count;
+        next.store(0, std::memory_order_relaxed);
+        activeWorkers = workers.size();
+        ++generation;
+    }
+    wakeWorkers.notify_all();
+
+    // The caller works on the loop too.
+    runIndices(0);
+
+    // Wait until every worker has left the loop, so body can safely go out of scope.
+    std::unique_lock<std::mutex> lock(mutex);
+    loopFinished.wait(lock, [this] { return activeWorkers == 0; });
+    this->body = nullptr;
+}
+
+// Waits for loops and runs their bodies until the pool is destroyed.
+void ThreadPool::workerLoop(std::size_t worker) {
+    // A worker sets up its thread-local state before the constructor returns, so no later loop pays for it (or allocates for it).
+    METRICS_REGISTER_THREAD();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++startedWorkers;
+    }
+    loopFinished.notify_one();
+
+    std::size_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runIndices(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--activeWorkers == 0) {
+            loopFinished.notify_one();
+        }
+    }
+}
+
+// Claims and runs indices of the current loop until none are left.
+void ThreadPool::runIndices(std::size_t worker) {
+    while (true) {
+        std::size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= count) {
+            return;
+        }
+        (*body)(index, worker);
+    }
+}
@@ -0,0 +1,118 @@
+// This file uses the Googletest framework to check that the steady-state paths of physics-simulation/src/simulation.cxx make no heap
+// allocations.
+
+// It is built into its own executable (allocation-unit), because it replaces the global operator new and operator delete to count every
+// heap allocation, and those replacements apply to the whole executable they are linked into.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "simulation.h"
+#include "analysis.h"
+#include "event-generator.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every heap allocation of this executable goes through these replacements, so a test can count the allocations of a stretch of code.
+static std::atomic<long> heapAllocations(0);
+
+void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    ++heapAllocations;
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Both allocation functions return memory from the C allocator, so every form of delete releases it with std::free. The sized and
+// aligned forms forward to the plain one, so the compiler sees a single free of new-allocated memory.
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { ::operator delete(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { ::operator delete(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { ::operator delete(memory); }
+
+// Test fixture for the steady-state allocations of the Simulation class
+class SimulationTest : public ::testing::Test {
+protected:
+
+    // Runs steps serial steps (forces, then integration and decays).
+    static void step(Simulation& sim, int steps) {
+        for (int n = 0; n < steps; ++n) {
+            sim.computeForces();
+            sim.updateParticles(1e-12);
+        }
+    }
+};
+
+// Testing updateParticles()
+TEST_F(SimulationTest, updateParticlesDoesNotAllocateInSteadyState) {
+    for (ForceSolver solver : {ForceSolver::ALL_PAIRS, ForceSolver::BARNES_HUT, ForceSolver::CELL_LIST, ForceSolver::PARTICLE_MESH}) {
+        for (Integrator scheme : {Integrator::EULER, Integrator::LEAPFROG, Integrator::VELOCITY_VERLET, Integrator::BLOCK_VERLET}) {
+            for (double skin : {0.0, 1e-4}) {
+                Simulation sim;
+                sim.setThreadCount(2);
+                sim.setForceSolver(solver);
+                sim.setIntegrator(scheme);
+                sim.setCutoff(1e-3);
+                sim.setNeighborListSkin(skin);
+                sim.setParticleMesh(32, 3.0);
+                EventConfig config;
+                config.meanMultiplicity = 200;
+                sim.generateEvent(EventGenerator(config));
+                step(sim, 5); // Warm-up steps: size the scratch buffers and start the thread pool.
+                const long before = heapAllocations.load();
+                step(sim, 5);
+                EXPECT_EQ(heapAllocations.load() - before, 0)
+                    << "Steady-state steps allocated (solver " << static_cast<int>(solver) << ", integrator " << static_cast<int>(scheme)
+                    << ", skin " << skin << ").";
+            }
+        }
+    }
+}
+
+// Testing run()
+TEST_F(SimulationTest, runDoesNotAllocateInSteadyState) {
+    EventConfig config;
+    config.meanMultiplicity = 5000; // Three chunks
+    config.poissonMultiplicity = false;
+    Simulation sim;
+    sim.setThreadCount(2);
+    sim.setForceSolver(ForceSolver::CELL_LIST);
+    sim.setIntegrator(Integrator::LEAPFROG);
+    sim.setCutoff(1e-3);
+    InSituAnalysis analysis;
+    sim.setAnalysis(&analysis, 2);
+    sim.generateEvent(EventGenerator(config));
+    sim.run(4, 1e-12); // Warm-up steps: build the task graph and size the buffers and the analysis bins.
+    const long before = heapAllocations.load();
+    sim.run(4, 1e-12);
+    EXPECT_EQ(heapAllocations.load() - before, 0) << "Steady-state task-graph steps with an attached analysis allocated.";
+}
+
+// Testing startEvent()
+TEST_F(SimulationTest, startEventReusesThePreviousEventsStorage) {
+    EventConfig config;
+    config.meanMultiplicity = 500;
+    config.poissonMultiplicity = false;
+    const EventGenerator generator(config);
+    Simulation sim;
+    sim.setThreadCount(1);
+    sim.setIntegrator(Integrator::LEAPFROG);
+    sim.generateEvent(generator);
+    step(sim, 3);
+    sim.startEvent(1);
+    const long before = heapAllocations.load();
+    sim.generateEvent(generator);
+    step(sim, 3);
+    EXPECT_EQ(heapAllocations.load() - before, 0) << "An event of the same size should reuse the previous event's storage.";
+}
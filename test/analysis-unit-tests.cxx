@@ -0,0 +1,175 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/analysis.cxx
+
+// Each class in analysis.cxx (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "analysis.h"
+#include "particle-store.h"
+#include "particle.h"
+#include "thread-pool.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+
+// Test fixture for the InSituAnalysis class
+class InSituAnalysisTest : public ::testing::Test {
+protected:
+
+    // Ten bins of 0.1 GeV/c for both momenta, ten bins of 0.2 in rapidity and ten bins of 0.1 mm in radius, so that the test values
+    // fall well inside their bins.
+    AnalysisConfig config;
+    ParticleStore store;
+    ThreadPool pool{2};
+
+    void SetUp() override {
+        config.axes = {{{10, 0.0, 1.0}, {10, 0.0, 1.0}, {10, -1.0, 1.0}, {10, 0.0, 1e-3}}};
+    }
+
+    // Returns the total count of one histogram, underflow and overflow included.
+    static std::uint64_t totalOf(const InSituAnalysis& analysis, ParticleType type, Spectrum spectrum) {
+        std::uint64_t total = analysis.getUnderflow(type, spectrum) + analysis.getOverflow(type, spectrum);
+        for (std::uint64_t count : analysis.getCounts(type, spectrum)) {
+            total += count;
+        }
+        return total;
+    }
+};
+
+// Testing fill()
+TEST_F(InSituAnalysisTest, fillBinsEachSpeciesAndSpectrum) {
+    // p = (0.225, 0.3, 0) GeV/c at a radius of 0.35 mm: momentum and transverse momentum in bin 3, rapidity 0 in bin 5, radius in bin 3.
+    store.emplace_back(ParticleType::PROTON, 1.5, 1.0, 0.0, 3.5e-4, 0.0, 0.0, 0.15, 0.2, 0.0);
+    // p = (0, 0, 1.35) GeV/c 1 cm out: momentum and radius overflow, transverse momentum in bin 0, rapidity about 0.81 in bin 9.
+    store.emplace_back(ParticleType::PROTON, 1.5, 1.0, 0.0, 0.0, 0.0, -1e-2, 0.0, 0.0, 0.9);
+    // p = (0, 0, -0.014) GeV/c at the origin: rapidity asinh(-0.1) in bin 4, everything else in bin 0.
+    store.emplace_back(ParticleType::PION_POSITIVE, 0.14, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, -0.1);
+    InSituAnalysis analysis(config);
+    analysis.fill(store, pool);
+    analysis.endEvent();
+
+    const ParticleType proton = ParticleType::PROTON, pion = ParticleType::PION_POSITIVE;
+    EXPECT_EQ(analysis.getCounts(proton, Spectrum::MOMENTUM)[3], 1u) << "The momentum 0.375 GeV/c belongs in bin 3.";
+    EXPECT_EQ(analysis.getOverflow(proton, Spectrum::MOMENTUM), 1u) << "The momentum 1.35 GeV/c is above the range.";
+    EXPECT_EQ(analysis.getCounts(proton, Spectrum::TRANSVERSE_MOMENTUM)[3], 1u) << "The transverse momentum 0.375 GeV/c belongs in bin 3.";
+    EXPECT_EQ(analysis.getCounts(proton, Spectrum::TRANSVERSE_MOMENTUM)[0], 1u) << "A particle along the beam has no transverse momentum.";
+    EXPECT_EQ(analysis.getCounts(proton, Spectrum::RAPIDITY)[5], 1u) << "A transverse particle has rapidity 0.";
+    EXPECT_EQ(analysis.getCounts(proton, Spectrum::RAPIDITY)[9], 1u) << "The rapidity of 1.35 GeV/c along the beam belongs in bin 9.";
+    EXPECT_EQ(analysis.getCounts(proton, Spectrum::RADIUS)[3], 1u) << "The radius 0.35 mm belongs in bin 3.";
+    EXPECT_EQ(analysis.getOverflow(proton, Spectrum::RADIUS), 1u) << "The radius 1 cm is above the range.";
+    EXPECT_EQ(analysis.getCounts(pion, Spectrum::RAPIDITY)[4], 1u) << "The pion's negative rapidity belongs in bin 4.";
+    EXPECT_EQ(analysis.getCounts(pion, Spectrum::MOMENTUM)[0], 1u) << "The pion's small momentum belongs in bin 0.";
+    for (std::size_t s = 0; s < spectrumCount; ++s) {
+        const Spectrum spectrum = static_cast<Spectrum>(s);
+        EXPECT_EQ(totalOf(analysis, proton, spectrum), 2u) << "Spectrum " << s << " should count both protons once.";
+        EXPECT_EQ(totalOf(analysis, pion, spectrum), 1u) << "Spectrum " << s << " should count the pion once.";
+        EXPECT_EQ(totalOf(analysis, ParticleType::KAON_NEGATIVE, spectrum), 0u) << "Spectrum " << s << " of an absent species should be empty.";
+    }
+}
+
+// Testing fill()
+TEST_F(InSituAnalysisTest, fillIsIndependentOfThreadCount) {
+    std::default_random_engine engine(11);
+    std::uniform_real_distribution<double> positionDist(-1e-3, 1e-3), velocityDist(-0.5, 0.5);
+    std::uniform_int_distribution<int> typeDist(0, static_cast<int>(particleTypeCount) - 1);
+    for (int i = 0; i < 20000; ++i) {
+        store.emplace_back(static_cast<ParticleType>(typeDist(engine)), 0.5, 0.0, 0.0, positionDist(engine), positionDist(engine),
+                           positionDist(engine), velocityDist(engine), velocityDist(engine), velocityDist(engine));
+    }
+    InSituAnalysis serial(config), parallel(config);
+    ThreadPool serialPool(1), widePool(4);
+    serial.fill(store, serialPool);
+    parallel.fill(store, widePool);
+    serial.endEvent();
+    parallel.endEvent();
+    std::uint64_t total = 0;
+    for (std::size_t t = 0; t < particleTypeCount; ++t) {
+        for (std::size_t s = 0; s < spectrumCount; ++s) {
+            const ParticleType type = static_cast<ParticleType>(t);
+            const Spectrum spectrum = static_cast<Spectrum>(s);
+            for (std::size_t b = 0; b < config.axes[s].bins; ++b) {
+                ASSERT_EQ(parallel.getCounts(type, spectrum)[b], serial.getCounts(type, spectrum)[b])
+                    << "Bin " << b << " of spectrum " << s << " of species " << t << " depends on the thread count.";
+            }
+            EXPECT_EQ(parallel.getOverflow(type, spectrum), serial.getOverflow(type, spectrum)) << "The overflow depends on the thread count.";
+        }
+        total += totalOf(parallel, static_cast<ParticleType>(t), Spectrum::MOMENTUM);
+    }
+    EXPECT_EQ(total, store.size()) << "Every particle should be counted exactly once per spectrum.";
+}
+
+// Testing endEvent()
+TEST_F(InSituAnalysisTest, endEventMergesTheEventIntoTheTotals) {
+    store.emplace_back(ParticleType::PROTON, 1.5, 1.0, 0.0, 3.5e-4, 0.0, 0.0, 0.15, 0.2, 0.0);
+    InSituAnalysis analysis(config);
+    analysis.fill(store, pool);
+    analysis.fill(store, pool);
+    EXPECT_EQ(totalOf(analysis, ParticleType::PROTON, Spectrum::MOMENTUM), 0u) << "The totals should only change when the event ends.";
+    EXPECT_EQ(analysis.getFillCount(), 0u) << "The fills of an unfinished event should not be counted yet.";
+    analysis.endEvent();
+    analysis.fill(store, pool);
+    analysis.endEvent();
+    EXPECT_EQ(analysis.getEventCount(), 2u) << "Two events were ended.";
+    EXPECT_EQ(analysis.getFillCount(), 3u) << "Three fills were made over the two events.";
+    EXPECT_EQ(analysis.getCounts(ParticleType::PROTON, Spectrum::MOMENTUM)[3], 3u) << "Each fill should count the proton once.";
+    analysis.endEvent();
+    EXPECT_EQ(analysis.getCounts(ParticleType::PROTON, Spectrum::MOMENTUM)[3], 3u) << "Ending an empty event should not add anything.";
+}
+
+// Testing addDecays()
+TEST_F(InSituAnalysisTest, addDecaysCountsEachParentSpecies) {
+    InSituAnalysis analysis(config);
+    analysis.addDecays({{0, 0, 0, 2, 1, 0}});
+    analysis.addDecays({{3, 0, 0, 1, 0, 0}});
+    EXPECT_EQ(analysis.getDecays(ParticleType::KAON_POSITIVE), 0u) << "The decays should only be counted when the event ends.";
+    analysis.endEvent();
+    EXPECT_EQ(analysis.getDecays(ParticleType::KAON_POSITIVE), 3u) << "The K+ decays of both steps should be added.";
+    EXPECT_EQ(analysis.getDecays(ParticleType::KAON_NEGATIVE), 1u) << "The K- decay was not counted.";
+    EXPECT_EQ(analysis.getDecays(ParticleType::PION_POSITIVE), 3u) << "The pi+ decays were not counted.";
+    EXPECT_EQ(analysis.getDecays(ParticleType::PROTON), 0u) << "No proton decayed.";
+}
+
+// Testing reset()
+TEST_F(InSituAnalysisTest, resetClearsTheTotalsAndTheCurrentEvent) {
+    store.emplace_back(ParticleType::PROTON, 1.5, 1.0, 0.0, 3.5e-4, 0.0, 0.0, 0.15, 0.2, 0.0);
+    InSituAnalysis analysis(config);
+    analysis.fill(store, pool);
+    analysis.addDecays({{1, 0, 0, 0, 0, 0}});
+    analysis.endEvent();
+    analysis.fill(store, pool);
+    analysis.reset();
+    analysis.endEvent();
+    EXPECT_EQ(analysis.getEventCount(), 1u) << "Only the event ended after the reset should be counted.";
+    EXPECT_EQ(analysis.getFillCount(), 0u) << "The fill of the cleared event should be dropped.";
+    EXPECT_EQ(totalOf(analysis, ParticleType::PROTON, Spectrum::MOMENTUM), 0u) << "The histograms should be empty after a reset.";
+    EXPECT_EQ(analysis.getDecays(ParticleType::PION_POSITIVE), 0u) << "The decays should be cleared by a reset.";
+}
+
+// Testing writeResults() and formatAnalysisJson()
+TEST_F(InSituAnalysisTest, writeResultsWritesTheJsonTotals) {
+    store.emplace_back(ParticleType::PROTON, 1.5, 1.0, 0.0, 3.5e-4, 0.0, 0.0, 0.15, 0.2, 0.0);
+    InSituAnalysis analysis(config);
+    analysis.fill(store, pool);
+    analysis.addDecays({{0, 0, 0, 4, 0, 0}});
+    analysis.endEvent();
+    const std::string path = ::testing::TempDir() + "analysis.json";
+    ASSERT_TRUE(analysis.writeResults(path)) << "The results could not be written.";
+
+    std::ifstream file(path);
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(text, formatAnalysisJson(analysis)) << "The file should hold the formatted totals.";
+    EXPECT_EQ(text.find("{\"events\":1,\"fills\":1,\"species\":[{\"name\":"), 0u) << "The header is wrong: " << text.substr(0, 80);
+    EXPECT_NE(text.find("\"decays\":4,"), std::string::npos) << "The K+ decays are missing.";
+    EXPECT_NE(text.find("\"momentum\":{\"low\":0,\"high\":1,\"counts\":[0,0,0,1,0,0,0,0,0,0],\"underflow\":0,\"overflow\":0}"), std::string::npos)
+        << "The proton momentum spectrum is missing.";
+    EXPECT_EQ(text.back(), '\n') << "The file should end with a newline.";
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(analysis.writeResults(::testing::TempDir() + "no-such-directory/analysis.json")) << "An unwritable path should fail.";
+}
@@ -0,0 +1,137 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/checkpoint.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "checkpoint.h"
+#include "particle-store.h"
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+
+// Returns a path for a temporary checkpoint file.
+static std::string checkpointPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+// Test fixture for the CheckpointWriter and CheckpointReader classes
+class CheckpointTest : public ::testing::Test {
+};
+
+// Testing putColumn() and getColumn()
+TEST_F(CheckpointTest, putColumnRoundTripsValuesAndColumns) {
+    CheckpointWriter writer;
+    const AlignedVector<ParticleType> types = {ParticleType::PROTON, ParticleType::KAON_NEGATIVE, ParticleType::PION_NEUTRAL};
+    const std::vector<double> values = {1.5, -2.25, 3.0e-8};
+    writer.put(std::uint32_t(7));
+    writer.putColumn(types);
+    writer.putColumn(values);
+    writer.put(true);
+
+    const std::vector<char>& payload = writer.getPayload();
+    CheckpointReader reader(payload.data(), payload.size());
+    std::uint32_t seven = 0;
+    AlignedVector<ParticleType> readTypes;
+    std::vector<double> readValues;
+    bool flag = false;
+    ASSERT_TRUE(reader.get(seven) && reader.getColumn(readTypes) && reader.getColumn(readValues) && reader.get(flag)) << "Reading back the payload failed.";
+    EXPECT_EQ(seven, 7u) << "A plain value did not round-trip.";
+    EXPECT_EQ(readTypes, types) << "A column of one-byte values (padded in the payload) did not round-trip.";
+    EXPECT_EQ(readValues, values) << "A column of doubles did not round-trip.";
+    EXPECT_TRUE(flag) << "The value after the padded column was misread.";
+    EXPECT_TRUE(reader.atEnd()) << "The reader did not consume the whole payload.";
+}
+
+// Testing getColumn()
+TEST_F(CheckpointTest, getColumnRejectsATruncatedPayload) {
+    CheckpointWriter writer;
+    writer.putColumn(std::vector<double>(100, 1.0));
+    const std::vector<char>& payload = writer.getPayload();
+
+    CheckpointReader reader(payload.data(), payload.size() - 8);
+    std::vector<double> column;
+    EXPECT_FALSE(reader.getColumn(column)) << "getColumn() read past the end of a truncated payload.";
+}
+
+// Testing writeCheckpointFile() and readCheckpointFile()
+TEST_F(CheckpointTest, writeCheckpointFileRoundTripsThePayload) {
+    CheckpointWriter writer;
+    std::vector<double> column(10000);
+    for (std::size_t i = 0; i < column.size(); ++i) {
+        column[i] = 0.001 * static_cast<double>(i % 97);
+    }
+    writer.putColumn(column);
+    const std::string path = checkpointPath("payload.ckpt");
+
+    for (bool compress : {false, true}) {
+        if (compress && !isCheckpointCompressionAvailable()) {
+            EXPECT_FALSE(writeCheckpointFile(path, writer.getPayload(), true)) << "A build without zlib accepted a compressed checkpoint.";
+            continue;
+        }
+        ASSERT_TRUE(writeCheckpointFile(path, writer.getPayload(), compress)) << "writeCheckpointFile() failed (compress = " << compress << ").";
+        std::vector<char> payload;
+        ASSERT_TRUE(readCheckpointFile(path, payload)) << "readCheckpointFile() failed (compress = " << compress << ").";
+        EXPECT_EQ(payload, writer.getPayload()) << "The payload changed on its way through the file (compress = " << compress << ").";
+    }
+    std::remove(path.c_str());
+}
+
+// Testing readCheckpointFile()
+TEST_F(CheckpointTest, readCheckpointFileRejectsForeignAndTruncatedFiles) {
+    const std::string path = checkpointPath("foreign.ckpt");
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("this is not a checkpoint file, but it is long enough for a header", file);
+    std::fclose(file);
+    std::vector<char> payload;
+    EXPECT_FALSE(readCheckpointFile(path, payload)) << "readCheckpointFile() accepted a file without the checkpoint magic.";
+
+    CheckpointWriter writer;
+    writer.putColumn(std::vector<double>(1000, 2.0));
+    ASSERT_TRUE(writeCheckpointFile(path, writer.getPayload(), false));
+    std::vector<char> bytes(1 << 16);
+    file = std::fopen(path.c_str(), "rb");
+    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size() - 16, file);
+    std::fclose(file);
+    EXPECT_FALSE(readCheckpointFile(path, payload)) << "readCheckpointFile() accepted a truncated file.";
+    EXPECT_FALSE(readCheckpointFile(checkpointPath("missing.ckpt"), payload)) << "readCheckpointFile() accepted a missing file.";
+    std::remove(path.c_str());
+}
+
+// Testing readCheckpointFile()
+TEST_F(CheckpointTest, readCheckpointFileRejectsImpossibleSizesWithoutAllocating) {
+    const std::string path = checkpointPath("huge-size.ckpt");
+    CheckpointWriter writer;
+    writer.putColumn(std::vector<double>(1000, 2.0));
+    for (bool compress : {false, true}) {
+        if (compress && !isCheckpointCompressionAvailable()) {
+            continue;
+        }
+        ASSERT_TRUE(writeCheckpointFile(path, writer.getPayload(), compress));
+        // The payload size is at offset 16 of the header and the stored size at offset 24; 2^62 bytes cannot be allocated.
+        for (long offset : {16L, 24L}) {
+            std::vector<char> bytes(1 << 16);
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+            std::fclose(file);
+            const std::uint64_t huge = std::uint64_t(1) << 62;
+            std::vector<char> damaged = bytes;
+            std::memcpy(damaged.data() + offset, &huge, sizeof(huge));
+            file = std::fopen(path.c_str(), "wb");
+            std::fwrite(damaged.data(), 1, damaged.size(), file);
+            std::fclose(file);
+            std::vector<char> payload;
+            EXPECT_FALSE(readCheckpointFile(path, payload)) << "A size of 2^62 at offset " << offset << " was accepted (compress = " << compress << ").";
+            file = std::fopen(path.c_str(), "wb");
+            std::fwrite(bytes.data(), 1, bytes.size(), file);
+            std::fclose(file);
+        }
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,143 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/coulomb-kernel.cxx
+
+// The Coulomb row kernels are free functions, so they share one Googletest fixture.
+// Each individual test checks one specific functionality of the kernels.
+
+// The naming convention for testing a function is as follows: TEST_F([ModuleName]Test, [functionName][SpecificFunctionalityBeingTested])
+
+#include "coulomb-kernel.h"
+#include "particle.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Test fixture for the Coulomb row kernels
+class CoulombKernelTest : public ::testing::Test {
+protected:
+
+    // One target particle and a row of source particles with random positions and charges of both signs.
+    // 37 sources leave a remainder for both the 4-wide and the 8-wide kernels.
+    std::vector<Particle> sources;
+    std::unique_ptr<Particle> target;
+    std::vector<double> x, y, z, q;
+
+    void SetUp() override {
+        std::default_random_engine engine(3);
+        std::uniform_real_distribution<double> positionDist(-1.0, 1.0);
+        target = std::make_unique<Particle>(ParticleType::PION_NEGATIVE, 0.13957, -1.0, 0.0, 0.1, -0.2, 0.3);
+        for (int j = 0; j < 37; ++j) {
+            double charge = (j % 3 == 0) ? -1.0 : +1.0;
+            sources.emplace_back(ParticleType::PROTON, 0.93827, charge, 0.0, positionDist(engine), positionDist(engine), positionDist(engine));
+        }
+        // One source sits on top of the target, which exercises the softening term.
+        sources.emplace_back(ParticleType::PROTON, 0.93827, +1.0, 0.0, 0.1, -0.2, 0.3);
+        for (const auto& source : sources) {
+            x.push_back(source.position[0]);
+            y.push_back(source.position[1]);
+            z.push_back(source.position[2]);
+            q.push_back(source.charge);
+        }
+    }
+
+    // Checks one kernel against repeated calls to the scalar Particle::addForce().
+    void expectKernelMatchesAddForce(SimdLevel level) {
+        std::vector<Particle> reference = sources;
+        Particle referenceTarget = *target;
+        for (auto& source : reference) {
+            referenceTarget.addForce(source);
+        }
+
+        std::vector<double> fx(sources.size(), 0.0), fy(sources.size(), 0.0), fz(sources.size(), 0.0);
+        double targetForce[3] = {0.0, 0.0, 0.0};
+        getCoulombRowKernel(level)(target->position[0], target->position[1], target->position[2], coulombConstant * target->charge,
+                                   x.data(), y.data(), z.data(), q.data(), fx.data(), fy.data(), fz.data(), sources.size(), targetForce, forceSoftening);
+
+        for (int axis = 0; axis < 3; ++axis) {
+            EXPECT_NEAR(targetForce[axis], referenceTarget.force[axis], 1e-12 * std::abs(referenceTarget.force[axis])) << "Kernel's force on the target differs from addForce() along axis " << axis;
+        }
+        for (size_t j = 0; j < sources.size(); ++j) {
+            EXPECT_NEAR(fx[j], reference[j].force[0], 1e-12 * std::abs(reference[j].force[0])) << "Kernel's force on source " << j << " differs from addForce().";
+            EXPECT_NEAR(fy[j], reference[j].force[1], 1e-12 * std::abs(reference[j].force[1])) << "Kernel's force on source " << j << " differs from addForce().";
+            EXPECT_NEAR(fz[j], reference[j].force[2], 1e-12 * std::abs(reference[j].force[2])) << "Kernel's force on source " << j << " differs from addForce().";
+        }
+    }
+
+    // Checks one single-precision kernel against addForce(). Each source's force is one pair, so it must match to float precision; the
+    // target's force is a sum of both signs, so its error is measured against the sum of the magnitudes of its terms.
+    void expectFloatKernelMatchesAddForce(SimdLevel level) {
+        std::vector<Particle> reference = sources;
+        Particle referenceTarget = *target;
+        double magnitudeSum[3] = {0.0, 0.0, 0.0};
+        for (auto& source : reference) {
+            Particle pairTarget = *target;
+            pairTarget.addForce(source);
+            referenceTarget.force[0] += pairTarget.force[0];
+            referenceTarget.force[1] += pairTarget.force[1];
+            referenceTarget.force[2] += pairTarget.force[2];
+            for (int axis = 0; axis < 3; ++axis) {
+                magnitudeSum[axis] += std::abs(pairTarget.force[axis]);
+            }
+        }
+
+        std::vector<float> xf(x.begin(), x.end()), yf(y.begin(), y.end()), zf(z.begin(), z.end()), qf(q.begin(), q.end());
+        std::vector<float> fx(sources.size(), 0.0f), fy(sources.size(), 0.0f), fz(sources.size(), 0.0f);
+        float targetForce[3] = {0.0f, 0.0f, 0.0f};
+        getFloatCoulombRowKernel(level)(static_cast<float>(target->position[0]), static_cast<float>(target->position[1]),
+                                        static_cast<float>(target->position[2]), static_cast<float>(coulombConstant * target->charge),
+                                        xf.data(), yf.data(), zf.data(), qf.data(), fx.data(), fy.data(), fz.data(), sources.size(),
+                                        targetForce, static_cast<float>(forceSoftening));
+
+        for (int axis = 0; axis < 3; ++axis) {
+            EXPECT_NEAR(targetForce[axis], referenceTarget.force[axis], 1e-5 * magnitudeSum[axis]) << "Float kernel's force on the target differs from addForce() along axis " << axis;
+        }
+        for (size_t j = 0; j < sources.size(); ++j) {
+            EXPECT_NEAR(fx[j], reference[j].force[0], 1e-5 * std::abs(reference[j].force[0])) << "Float kernel's force on source " << j << " differs from addForce().";
+            EXPECT_NEAR(fy[j], reference[j].force[1], 1e-5 * std::abs(reference[j].force[1])) << "Float kernel's force on source " << j << " differs from addForce().";
+            EXPECT_NEAR(fz[j], reference[j].force[2], 1e-5 * std::abs(reference[j].force[2])) << "Float kernel's force on source " << j << " differs from addForce().";
+        }
+    }
+
+};
+
+// Testing the scalar kernel
+TEST_F(CoulombKernelTest, scalarKernelMatchesAddForce) {
+    expectKernelMatchesAddForce(SimdLevel::SCALAR);
+}
+
+// Testing the AVX2 kernel
+TEST_F(CoulombKernelTest, avx2KernelMatchesAddForce) {
+    if (!isSimdLevelSupported(SimdLevel::AVX2)) {
+        GTEST_SKIP() << "This CPU does not support AVX2.";
+    }
+    expectKernelMatchesAddForce(SimdLevel::AVX2);
+}
+
+// Testing the AVX-512 kernel
+TEST_F(CoulombKernelTest, avx512KernelMatchesAddForce) {
+    if (!isSimdLevelSupported(SimdLevel::AVX512)) {
+        GTEST_SKIP() << "This CPU does not support AVX-512.";
+    }
+    expectKernelMatchesAddForce(SimdLevel::AVX512);
+}
+
+// Testing the single-precision kernels
+TEST_F(CoulombKernelTest, floatKernelsMatchAddForceToSinglePrecision) {
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (isSimdLevelSupported(level)) {
+            expectFloatKernelMatchesAddForce(level);
+        }
+    }
+}
+
+// Testing setActiveSimdLevel()
+TEST_F(CoulombKernelTest, setActiveSimdLevelSelectsKernel) {
+    SimdLevel detected = getActiveSimdLevel();
+    setActiveSimdLevel(SimdLevel::SCALAR);
+    EXPECT_EQ(getActiveSimdLevel(), SimdLevel::SCALAR) << "setActiveSimdLevel() did not switch to the scalar kernel.";
+    EXPECT_EQ(getActiveCoulombRowKernel(), getCoulombRowKernel(SimdLevel::SCALAR)) << "The active kernel does not match the selected level.";
+    EXPECT_EQ(getActiveFloatCoulombRowKernel(), getFloatCoulombRowKernel(SimdLevel::SCALAR)) << "The active float kernel does not match the selected level.";
+    setActiveSimdLevel(detected);
+    EXPECT_EQ(getActiveSimdLevel(), detectSimdLevel()) << "setActiveSimdLevel() did not restore the detected kernel.";
+}
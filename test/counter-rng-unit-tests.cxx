@@ -0,0 +1,87 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/include/counter-rng.h
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "counter-rng.h"
+#include "simulation.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+
+// Test fixture for the CounterRng class
+class CounterRngTest : public ::testing::Test {
+};
+
+// Testing philox4x32()
+// Known-answer vectors of the Random123 reference implementation.
+TEST_F(CounterRngTest, philox4x32MatchesReferenceVectors) {
+    using Words = std::array<std::uint32_t, 4>;
+    EXPECT_EQ(philox4x32({0, 0, 0, 0}, {0, 0}), (Words{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u})) << "Philox4x32-10 does not match the reference for a zero counter and key.";
+    EXPECT_EQ(philox4x32({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu}),
+              (Words{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu})) << "Philox4x32-10 does not match the reference for an all-ones counter and key.";
+    EXPECT_EQ(philox4x32({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u}),
+              (Words{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u})) << "Philox4x32-10 does not match the reference for the digits of pi.";
+}
+
+// Testing stream()
+// A stream only depends on its key and counter: streams of different particles, steps, purposes or events all differ, and the same stream
+// can be recreated at any time.
+TEST_F(CounterRngTest, streamDependsOnlyOnItsKey) {
+    CounterRng rng(5, 1);
+    RandomStream a = rng.stream(RandomPurpose::DECAY, 12, 3);
+    std::uint32_t first[8];
+    for (auto& word : first) {
+        word = a();
+    }
+    RandomStream again = CounterRng(5, 1).stream(RandomPurpose::DECAY, 12, 3);
+    for (int k = 0; k < 8; ++k) {
+        EXPECT_EQ(again(), first[k]) << "Word " << k << " of a recreated stream differs.";
+    }
+    EXPECT_NE(rng.stream(RandomPurpose::DECAY, 13, 3)(), first[0]) << "Neighboring particles share their random numbers.";
+    EXPECT_NE(rng.stream(RandomPurpose::DECAY, 12, 4)(), first[0]) << "Consecutive steps share their random numbers.";
+    EXPECT_NE(rng.stream(RandomPurpose::CREATION, 12, 3)(), first[0]) << "Different purposes share their random numbers.";
+    EXPECT_NE(CounterRng(5, 2).stream(RandomPurpose::DECAY, 12, 3)(), first[0]) << "Different events share their random numbers.";
+}
+
+// Testing RandomStream::uniform()
+TEST_F(CounterRngTest, uniformIsInOpenUnitIntervalWithMeanOneHalf) {
+    RandomStream random = CounterRng(8).stream(RandomPurpose::CREATION, 0, 0);
+    const int draws = 100000;
+    double sum = 0.0;
+    for (int k = 0; k < draws; ++k) {
+        double u = random.uniform();
+        ASSERT_GT(u, 0.0) << "A uniform number is not above 0.";
+        ASSERT_LT(u, 1.0) << "A uniform number is not below 1.";
+        sum += u;
+    }
+    EXPECT_NEAR(sum / draws, 0.5, 0.005) << "The mean of the uniform numbers is not 1/2.";
+}
+
+// Testing Simulation::createParticle() and Simulation::decayParticles()
+// A particle's velocity and decays depend only on (seed, event, particle id, step), so reordering how the particles are processed, or adding
+// particles after it, does not change them.
+TEST_F(CounterRngTest, simulationDecaysAreIndependentOfOtherParticles) {
+    Simulation small, large;
+    small.setSeed(21);
+    large.setSeed(21);
+    for (int i = 0; i < 50; ++i) {
+        small.createParticle(ParticleType::PION_NEUTRAL);
+    }
+    for (int i = 0; i < 500; ++i) {
+        large.createParticle(ParticleType::PION_NEUTRAL);
+    }
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_EQ(small.particles.vx[i], large.particles.vx[i]) << "Particle " << i << " got a different velocity in a larger simulation.";
+    }
+
+    small.decayParticles(1e-16);
+    large.decayParticles(1e-16);
+    // Survivors keep their ids, so the first particles of both stores must match up by id and type.
+    for (size_t i = 0; i < small.particles.size() && small.particles.id[i] < 50; ++i) {
+        ASSERT_EQ(small.particles.id[i], large.particles.id[i]) << "A different set of the first 50 particles survived in the larger simulation.";
+    }
+}
@@ -0,0 +1,154 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/distributed-simulation.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+// These tests run under MPI (ctest starts them with mpiexec on several local ranks). Every rank runs every test; a rank that fails makes
+// mpiexec fail.
+
+#include "distributed-simulation.h"
+#include "event-generator.h"
+#include "simulation.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <mpi.h>
+#include <random>
+
+// Returns the same event on every rank: particles of all species spread over a cube of edge 2 centered on the origin, with charges scaled
+// down so that the forces stay moderate over a few steps, and without lifetimes (the distributed simulation carries out no decays).
+static ParticleStore spreadEvent(std::size_t count) {
+    EventConfig config;
+    config.meanMultiplicity = static_cast<double>(count);
+    config.poissonMultiplicity = false;
+    ParticleStore event;
+    EventGenerator(config).generate(event, CounterRng(3));
+    std::mt19937_64 engine(5);
+    std::uniform_real_distribution<double> position(-1.0, 1.0);
+    for (std::size_t i = 0; i < event.size(); ++i) {
+        event.x[i] = position(engine);
+        event.y[i] = position(engine);
+        event.z[i] = position(engine);
+        event.charge[i] *= 1e-9;
+        event.lifetime[i] = 0.0;
+    }
+    return event;
+}
+
+// Returns the largest difference between two columns, relative to the largest magnitude in the reference column.
+template <typename Column>
+static double relativeDifference(const Column& value, const Column& reference) {
+    double difference = 0.0, scale = 0.0;
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        difference = std::max(difference, std::abs(value[i] - reference[i]));
+        scale = std::max(scale, std::abs(reference[i]));
+    }
+    return scale > 0.0 ? difference / scale : difference;
+}
+
+// Test fixture for the DistributedSimulation class
+class DistributedSimulationTest : public ::testing::Test {
+protected:
+    static constexpr double cutoff = 0.2;
+};
+
+// Testing getMaxRankCount()
+// The constructor aborts the job when the communicator has more ranks than this, since the ghost layer would skip the second neighbor.
+TEST_F(DistributedSimulationTest, getMaxRankCountKeepsSlabsAtLeastACutoffWide) {
+    EXPECT_EQ(DistributedSimulation::getMaxRankCount(-1.0, 1.0, cutoff), 10) << "A box of width 2 holds ten slabs of width 0.2.";
+    EXPECT_EQ(DistributedSimulation::getMaxRankCount(-1.0, 1.0, 0.3), 6) << "Slabs of width 2/7 would be narrower than the cutoff 0.3.";
+    EXPECT_EQ(DistributedSimulation::getMaxRankCount(0.0, 1.0, 2.0), 0) << "A box narrower than the cutoff cannot hold even one slab.";
+    EXPECT_EQ(DistributedSimulation::getMaxRankCount(0.0, 1.0, 0.0), 0) << "A zero cutoff is invalid.";
+    EXPECT_EQ(DistributedSimulation::getMaxRankCount(0.0, 1.0, std::nan("")), 0) << "A NaN cutoff is invalid.";
+    EXPECT_GE(DistributedSimulation::getMaxRankCount(-1.0, 1.0, cutoff), DistributedSimulation(MPI_COMM_WORLD, -1.0, 1.0, cutoff).getRankCount())
+        << "The tests' own configuration should pass the check.";
+}
+
+// Testing distribute()
+TEST_F(DistributedSimulationTest, distributeKeepsEveryParticleExactlyOnce) {
+    const ParticleStore event = spreadEvent(2000);
+    DistributedSimulation distributed(MPI_COMM_WORLD, -1.0, 1.0, cutoff);
+    distributed.distribute(event);
+
+    EXPECT_EQ(distributed.getGlobalParticleCount(), event.size()) << "Particles were lost or duplicated when the event was distributed.";
+    for (std::size_t i = 0; i < distributed.particles.size(); ++i) {
+        ASSERT_EQ(distributed.ownerOf(distributed.particles.x[i]), distributed.getRank()) << "A rank holds a particle outside its slab.";
+    }
+}
+
+// Testing computeForces()
+TEST_F(DistributedSimulationTest, computeForcesMatchesTheSingleProcessCellList) {
+    const ParticleStore event = spreadEvent(2000);
+    Simulation reference;
+    reference.setThreadCount(1);
+    reference.setForceSolver(ForceSolver::CELL_LIST);
+    reference.setCutoff(cutoff);
+    reference.particles = event;
+    reference.computeForces();
+
+    DistributedSimulation distributed(MPI_COMM_WORLD, -1.0, 1.0, cutoff);
+    distributed.distribute(event);
+    distributed.computeForces();
+    ParticleStore gathered;
+    distributed.gather(gathered);
+
+    if (distributed.getRankCount() > 1) {
+        EXPECT_GT(distributed.getGhostCount(), 0u) << "No ghost particles were exchanged, so the test did not exercise the ghost layers.";
+    }
+    if (distributed.getRank() == 0) {
+        ASSERT_EQ(gathered.size(), event.size()) << "gather() did not collect every particle.";
+        EXPECT_TRUE(gathered.id == event.id) << "gather() did not order the particles by id.";
+        EXPECT_LT(relativeDifference(gathered.fx, reference.particles.fx), 1e-12) << "The x forces differ from the single-process run.";
+        EXPECT_LT(relativeDifference(gathered.fy, reference.particles.fy), 1e-12) << "The y forces differ from the single-process run.";
+        EXPECT_LT(relativeDifference(gathered.fz, reference.particles.fz), 1e-12) << "The z forces differ from the single-process run.";
+    }
+}
+
+// Testing updateParticles()
+TEST_F(DistributedSimulationTest, updateParticlesMigratesAndMatchesTheSingleProcessRun) {
+    ParticleStore event = spreadEvent(2000);
+    for (std::size_t i = 0; i < event.size(); ++i) {
+        event.vx[i] *= 5.0; // Fast enough that many particles cross a slab face within the run.
+    }
+    Simulation reference;
+    reference.setThreadCount(1);
+    reference.setForceSolver(ForceSolver::CELL_LIST);
+    reference.setCutoff(cutoff);
+    reference.particles = event;
+
+    DistributedSimulation distributed(MPI_COMM_WORLD, -1.0, 1.0, cutoff);
+    distributed.distribute(event);
+    const double deltaTime = 0.2;
+    for (int step = 0; step < 10; ++step) {
+        reference.computeForces();
+        reference.updateParticles(deltaTime);
+        distributed.computeForces();
+        distributed.updateParticles(deltaTime);
+    }
+    for (std::size_t i = 0; i < distributed.particles.size(); ++i) {
+        ASSERT_EQ(distributed.ownerOf(distributed.particles.x[i]), distributed.getRank()) << "A particle was not migrated to the rank that owns it.";
+    }
+
+    ParticleStore gathered;
+    distributed.gather(gathered);
+    if (distributed.getRank() == 0) {
+        ASSERT_EQ(gathered.size(), event.size()) << "Particles were lost or duplicated during migration.";
+        EXPECT_TRUE(gathered.id == event.id) << "gather() did not return every particle id exactly once.";
+        EXPECT_LT(relativeDifference(gathered.x, reference.particles.x), 1e-9) << "The x positions differ from the single-process run.";
+        EXPECT_LT(relativeDifference(gathered.y, reference.particles.y), 1e-9) << "The y positions differ from the single-process run.";
+        EXPECT_LT(relativeDifference(gathered.vz, reference.particles.vz), 1e-9) << "The z velocities differ from the single-process run.";
+    }
+}
+
+// Initializes MPI around the Googletest run.
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    const int result = RUN_ALL_TESTS();
+    int worst = 0;
+    MPI_Allreduce(&result, &worst, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return worst;
+}
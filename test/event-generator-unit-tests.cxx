@@ -0,0 +1,179 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/event-generator.cxx and physics-simulation/src/event-batch.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "event-generator.h"
+#include "event-batch.h"
+#include "metrics.h"
+#include "species.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+// Returns a configuration whose events all have exactly count particles.
+static EventConfig fixedConfig(double count) {
+    EventConfig config;
+    config.meanMultiplicity = count;
+    config.poissonMultiplicity = false;
+    return config;
+}
+
+// Test fixture for the EventGenerator class
+class EventGeneratorTest : public ::testing::Test {
+};
+
+// Test fixture for the EventBatch class
+class EventBatchTest : public ::testing::Test {
+};
+
+// Testing generate()
+TEST_F(EventGeneratorTest, generateAppendsFixedMultiplicityWithOneAllocation) {
+    EventGenerator eventGenerator(fixedConfig(5000));
+    ParticleStore particles;
+    CounterRng rng(42);
+
+    EXPECT_EQ(eventGenerator.generate(particles, rng), 5000u) << "generate() did not report the configured multiplicity.";
+    EXPECT_EQ(particles.size(), 5000u) << "generate() did not append the configured number of particles.";
+    EXPECT_EQ(particles.capacity(), 5000u) << "An event in an empty store should be allocated with a single reserve of exactly its size.";
+}
+
+// Testing generate()
+TEST_F(EventGeneratorTest, generateUsesRegistryPropertiesAndVelocityRange) {
+    EventConfig config = fixedConfig(2000);
+    config.velocityRange = 0.25;
+    EventGenerator eventGenerator(config);
+    ParticleStore particles;
+    CounterRng rng(7);
+    eventGenerator.generate(particles, rng);
+
+    for (size_t i = 0; i < particles.size(); ++i) {
+        const SpeciesInfo& species = getSpecies(particles.type[i]);
+        ASSERT_DOUBLE_EQ(particles.mass[i], species.mass) << "Particle " << i << " does not have its species' mass.";
+        ASSERT_DOUBLE_EQ(particles.charge[i], species.charge) << "Particle " << i << " does not have its species' charge.";
+        ASSERT_DOUBLE_EQ(particles.lifetime[i], species.lifetime) << "Particle " << i << " does not have its species' lifetime.";
+        ASSERT_DOUBLE_EQ(particles.x[i], 0.0) << "Particle " << i << " was not created at the collision point.";
+        ASSERT_DOUBLE_EQ(particles.fx[i], 0.0) << "Particle " << i << " was not created with zero force.";
+        for (double v : {particles.vx[i], particles.vy[i], particles.vz[i]}) {
+            ASSERT_GE(v, -0.25) << "Particle " << i << " has a velocity component below the configured range.";
+            ASSERT_LT(v, 0.25) << "Particle " << i << " has a velocity component above the configured range.";
+        }
+    }
+}
+
+// Testing generate()
+// With 100000 particles, each species fraction should be within a few standard deviations (about 0.0015 for the pions) of its weight.
+TEST_F(EventGeneratorTest, generateDrawsSpeciesByWeight) {
+    EventConfig config = fixedConfig(100000);
+    EventGenerator eventGenerator(config);
+    ParticleStore particles;
+    CounterRng rng(3);
+    eventGenerator.generate(particles, rng);
+
+    double counts[particleTypeCount] = {};
+    for (size_t i = 0; i < particles.size(); ++i) {
+        counts[static_cast<size_t>(particles.type[i])] += 1.0;
+    }
+    for (size_t t = 0; t < particleTypeCount; ++t) {
+        EXPECT_NEAR(counts[t] / particles.size(), config.speciesWeights[t], 0.01) << "The fraction of species " << getSpecies(static_cast<ParticleType>(t)).name << " does not match its weight.";
+    }
+}
+
+// Testing sampleMultiplicity()
+TEST_F(EventGeneratorTest, sampleMultiplicityIsPoissonAroundTheMean) {
+    EventConfig config;
+    config.meanMultiplicity = 400.0;
+    EventGenerator eventGenerator(config);
+
+    const int events = 2000;
+    double sum = 0.0, sumSquares = 0.0;
+    for (int k = 0; k < events; ++k) {
+        double n = static_cast<double>(eventGenerator.sampleMultiplicity(CounterRng(11, k)));
+        sum += n;
+        sumSquares += n * n;
+    }
+    double mean = sum / events;
+    double variance = sumSquares / events - mean * mean;
+    EXPECT_NEAR(mean, 400.0, 2.0) << "The mean multiplicity is not the configured one.";
+    EXPECT_NEAR(variance / mean, 1.0, 0.15) << "The multiplicity does not have the variance of a Poisson distribution.";
+}
+
+// Testing generate() and run()
+TEST_F(EventBatchTest, runIsIndependentOfThreadCount) {
+    EventGenerator eventGenerator(fixedConfig(64));
+    EventBatch serial(8, 5), parallel(8, 5);
+    ThreadPool onePool(1), fourPool(4);
+
+    serial.generate(eventGenerator, onePool);
+    parallel.generate(eventGenerator, fourPool);
+    serial.run(3, 1e-9, onePool);
+    parallel.run(3, 1e-9, fourPool);
+
+    ASSERT_EQ(serial.getParticleCount(), parallel.getParticleCount()) << "The batches have different numbers of particles.";
+    for (size_t k = 0; k < serial.events.size(); ++k) {
+        const ParticleStore& a = serial.events[k].particles;
+        const ParticleStore& b = parallel.events[k].particles;
+        ASSERT_EQ(a.size(), b.size()) << "Event " << k << " has a different size on more threads.";
+        for (size_t i = 0; i < a.size(); ++i) {
+            ASSERT_EQ(a.type[i], b.type[i]) << "Event " << k << ", particle " << i << " has a different type on more threads.";
+            ASSERT_EQ(a.x[i], b.x[i]) << "Event " << k << ", particle " << i << " has a different position on more threads.";
+            ASSERT_EQ(a.vz[i], b.vz[i]) << "Event " << k << ", particle " << i << " has a different velocity on more threads.";
+        }
+    }
+}
+
+// Testing run()
+// A velocity Verlet step leaves the forces at the new positions, so each event evaluates its forces once to start and then once per step.
+// The particles are made stable, so no decay changes them (which would need the forces again).
+TEST_F(EventBatchTest, runEvaluatesForcesOncePerVelocityVerletStep) {
+    if (!areMetricsEnabled()) {
+        GTEST_SKIP() << "Built with ENABLE_METRICS=OFF";
+    }
+    EventGenerator eventGenerator(fixedConfig(64));
+    EventBatch batch(2, 5);
+    ThreadPool pool(2);
+    for (Simulation& event : batch.events) {
+        event.setIntegrator(Integrator::VELOCITY_VERLET);
+    }
+    batch.generate(eventGenerator, pool);
+    for (Simulation& event : batch.events) {
+        std::fill(event.particles.lifetime.begin(), event.particles.lifetime.end(), 0.0);
+        event.refreshObservables();
+    }
+    resetMetrics();
+    batch.run(4, 1e-9, pool);
+    ASSERT_EQ(batch.events[0].getDecayCount() + batch.events[1].getDecayCount(), 0u) << "A decay would force extra evaluations.";
+    const std::uint64_t evaluations = collectMetrics().total.phaseCalls[static_cast<std::size_t>(Phase::FORCES)];
+    EXPECT_EQ(evaluations, 2u * (1 + 4)) << "Each of the two events should evaluate its forces once to start and once per step.";
+}
+
+// Testing generate()
+// An event of a batch is the same event that a standalone simulation with the same seed and event id generates.
+TEST_F(EventBatchTest, generateMatchesStandaloneSimulation) {
+    EventGenerator eventGenerator(fixedConfig(32));
+    EventBatch batch(3, 9);
+    ThreadPool pool(2);
+    batch.generate(eventGenerator, pool);
+
+    Simulation standalone;
+    standalone.setSeed(9);
+    standalone.setEventId(2);
+    standalone.generateEvent(eventGenerator);
+    ASSERT_EQ(standalone.particles.size(), batch.events[2].particles.size()) << "The standalone event has a different size.";
+    for (size_t i = 0; i < standalone.particles.size(); ++i) {
+        ASSERT_EQ(standalone.particles.type[i], batch.events[2].particles.type[i]) << "Particle " << i << " has a different type in the batch.";
+        ASSERT_EQ(standalone.particles.vx[i], batch.events[2].particles.vx[i]) << "Particle " << i << " has a different velocity in the batch.";
+    }
+}
+
+// Testing the EventBatch constructor
+TEST_F(EventBatchTest, InitializationSeedsEventsIndependently) {
+    EventGenerator eventGenerator(fixedConfig(16));
+    EventBatch batch(2);
+    ThreadPool pool(1);
+    batch.generate(eventGenerator, pool);
+
+    EXPECT_NE(batch.events[0].particles.vx[0], batch.events[1].particles.vx[0]) << "Two events of a batch drew the same random numbers.";
+}
@@ -0,0 +1,128 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/fft.cxx
+
+// Each class in fft.cxx (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "fft.h"
+#include "thread-pool.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+// Test fixture for the Fft and Fft3d classes
+class FftTest : public ::testing::Test {
+protected:
+
+    // Returns n random complex values with parts in [-1, 1).
+    static std::vector<std::complex<double>> randomValues(std::size_t n, unsigned seed) {
+        std::default_random_engine engine(seed);
+        std::uniform_real_distribution<double> valueDist(-1.0, 1.0);
+        std::vector<std::complex<double>> values(n);
+        for (std::complex<double>& value : values) {
+            value = std::complex<double>(valueDist(engine), valueDist(engine));
+        }
+        return values;
+    }
+
+    // Returns the discrete Fourier transform of values, summed directly: X[k] = sum_j x[j] exp(-2 pi i j k / n).
+    static std::vector<std::complex<double>> directTransform(const std::vector<std::complex<double>>& values) {
+        const std::size_t n = values.size();
+        const double pi = std::acos(-1.0);
+        std::vector<std::complex<double>> result(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            for (std::size_t j = 0; j < n; ++j) {
+                result[k] += values[j] * std::polar(1.0, -2.0 * pi * static_cast<double>(j * k % n) / static_cast<double>(n));
+            }
+        }
+        return result;
+    }
+};
+
+// Testing isPowerOfTwo()
+TEST_F(FftTest, isPowerOfTwoAcceptsOnlyPowersOfTwo) {
+    EXPECT_TRUE(isPowerOfTwo(1)) << "1 is 2^0.";
+    EXPECT_TRUE(isPowerOfTwo(64)) << "64 is 2^6.";
+    EXPECT_FALSE(isPowerOfTwo(0)) << "0 is not a power of two.";
+    EXPECT_FALSE(isPowerOfTwo(48)) << "48 is not a power of two.";
+}
+
+// Testing Fft::transform()
+TEST_F(FftTest, transformMatchesTheDirectSum) {
+    for (std::size_t n : {1, 2, 8, 64}) {
+        Fft fft;
+        fft.setLength(n);
+        std::vector<std::complex<double>> values = randomValues(n, 3);
+        const std::vector<std::complex<double>> expected = directTransform(values);
+        fft.transform(values.data(), false);
+        for (std::size_t k = 0; k < n; ++k) {
+            EXPECT_NEAR(std::abs(values[k] - expected[k]), 0.0, 1e-12 * static_cast<double>(n)) << "Coefficient " << k << " of a length-" << n << " transform is wrong.";
+        }
+    }
+}
+
+// Testing Fft::transform()
+TEST_F(FftTest, transformInverseRestoresTheValuesTimesTheLength) {
+    Fft fft;
+    fft.setLength(32);
+    const std::vector<std::complex<double>> original = randomValues(32, 5);
+    std::vector<std::complex<double>> values = original;
+    fft.transform(values.data(), false);
+    fft.transform(values.data(), true);
+    for (std::size_t k = 0; k < values.size(); ++k) {
+        EXPECT_NEAR(std::abs(values[k] / 32.0 - original[k]), 0.0, 1e-14) << "Value " << k << " did not survive the round trip.";
+    }
+}
+
+// Testing Fft3d::transform()
+// The transform of a single nonzero value at (x0, y0, z0) is the plane wave exp(-2 pi i (x0 kx + y0 ky + z0 kz) / n).
+TEST_F(FftTest, transform3dOfAPointIsAPlaneWave) {
+    const std::size_t n = 8;
+    const std::size_t x0 = 1, y0 = 2, z0 = 5;
+    Fft3d fft;
+    ThreadPool pool(2);
+    fft.setSize(n);
+    std::vector<std::complex<double>> grid(n * n * n);
+    grid[(z0 * n + y0) * n + x0] = 1.0;
+    fft.transform(grid, false, pool);
+    const double pi = std::acos(-1.0);
+    for (std::size_t kz = 0; kz < n; ++kz) {
+        for (std::size_t ky = 0; ky < n; ++ky) {
+            for (std::size_t kx = 0; kx < n; ++kx) {
+                const double phase = -2.0 * pi * static_cast<double>(x0 * kx + y0 * ky + z0 * kz) / static_cast<double>(n);
+                EXPECT_NEAR(std::abs(grid[(kz * n + ky) * n + kx] - std::polar(1.0, phase)), 0.0, 1e-12) << "Coefficient (" << kx << ", " << ky << ", " << kz << ") is wrong.";
+            }
+        }
+    }
+}
+
+// Testing Fft3d::transformAxis()
+// Lines outside the limits are left alone, and lines holding only zeros transform to zeros, so a pruned transform of a grid whose data
+// sits in one corner equals the full transform.
+TEST_F(FftTest, transformAxisPrunedMatchesTheFullTransformOfAPaddedGrid) {
+    const std::size_t n = 16, m = 8;
+    Fft3d fft;
+    ThreadPool pool(3);
+    fft.setSize(n);
+    std::vector<std::complex<double>> full(n * n * n);
+    const std::vector<std::complex<double>> values = randomValues(m * m * m, 7);
+    for (std::size_t z = 0; z < m; ++z) {
+        for (std::size_t y = 0; y < m; ++y) {
+            for (std::size_t x = 0; x < m; ++x) {
+                full[(z * n + y) * n + x] = values[(z * m + y) * m + x];
+            }
+        }
+    }
+    std::vector<std::complex<double>> pruned = full;
+    fft.transform(full, false, pool);
+    fft.transformAxis(pruned, 0, m, m, false, pool);
+    fft.transformAxis(pruned, 1, n, m, false, pool);
+    fft.transformAxis(pruned, 2, n, n, false, pool);
+    for (std::size_t k = 0; k < full.size(); ++k) {
+        ASSERT_NEAR(std::abs(pruned[k] - full[k]), 0.0, 1e-10) << "Coefficient " << k << " of the pruned transform differs from the full one.";
+    }
+}
@@ -0,0 +1,217 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/integrator.cxx
+
+// Each class in integrator.cxx (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "integrator.h"
+#include "simulation.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+// Test fixture for the TimeIntegrator class
+class TimeIntegratorTest : public ::testing::Test {
+protected:
+
+    // Places two protons on a circular orbit around their common center (in this simulation like charges attract).
+    // Returns the orbital period.
+    static double setUpOrbit(Simulation& sim) {
+        const double mass = 0.93827;
+        const double separation = 1.0;
+        const double force = coulombConstant / (separation * separation);
+        const double speed = std::sqrt(force * 0.5 * separation / mass);
+        sim.createParticle(ParticleType::PROTON, mass, +1.0, 0.0, 0.0, 0.0, 0.0);
+        sim.createParticle(ParticleType::PROTON, mass, +1.0, 0.0, 0.0, 0.0, 0.0);
+        sim.particles.x[0] = -0.5 * separation;
+        sim.particles.x[1] = +0.5 * separation;
+        sim.particles.vx[0] = sim.particles.vx[1] = 0.0;
+        sim.particles.vy[0] = -speed;
+        sim.particles.vy[1] = +speed;
+        sim.particles.vz[0] = sim.particles.vz[1] = 0.0;
+        return 2.0 * M_PI * 0.5 * separation / speed;
+    }
+
+    // Returns the total energy of the system: kinetic energy plus the potential -k qi qj / r of every (attractive) pair.
+    static double energy(const Simulation& sim) {
+        const ParticleStore& p = sim.particles;
+        double total = 0.0;
+        for (size_t i = 0; i < p.size(); ++i) {
+            total += 0.5 * p.mass[i] * (p.vx[i] * p.vx[i] + p.vy[i] * p.vy[i] + p.vz[i] * p.vz[i]);
+            for (size_t j = i + 1; j < p.size(); ++j) {
+                const double r = std::sqrt(std::pow(p.x[j] - p.x[i], 2) + std::pow(p.y[j] - p.y[i], 2) + std::pow(p.z[j] - p.z[i], 2));
+                total -= coulombConstant * p.charge[i] * p.charge[j] / r;
+            }
+        }
+        return total;
+    }
+
+    // Places a tight orbiting pair (as in setUpOrbit()) and eight slow protons 200 m apart, far from the pair. Returns the pair's period.
+    static double setUpEncounter(Simulation& sim) {
+        const double period = setUpOrbit(sim);
+        for (int k = 0; k < 8; ++k) {
+            sim.createParticle(ParticleType::PROTON, 0.93827, +1.0, 0.0, 0.0, 0.0, 0.0);
+            sim.particles.x[2 + k] = 0.0;
+            sim.particles.y[2 + k] = 200.0 * (k + 1);
+            sim.particles.z[2 + k] = 0.0;
+            sim.particles.vx[2 + k] = sim.particles.vy[2 + k] = sim.particles.vz[2 + k] = 0.0;
+        }
+        return period;
+    }
+
+    // Runs steps steps of length deltaTime and returns the largest relative energy deviation seen.
+    static double runAndMeasureDrift(Simulation& sim, double deltaTime, int steps) {
+        const double initial = energy(sim);
+        double drift = 0.0;
+        for (int step = 0; step < steps; ++step) {
+            sim.computeForces();
+            sim.updateParticles(deltaTime);
+            drift = std::max(drift, std::abs(energy(sim) / initial - 1.0));
+        }
+        return drift;
+    }
+
+    // Runs the orbit with the given scheme and returns the largest relative energy deviation seen after any step.
+    static double maxEnergyDrift(Integrator scheme, int stepsPerOrbit, int orbits) {
+        Simulation sim;
+        sim.setThreadCount(1);
+        sim.setIntegrator(scheme);
+        const double period = setUpOrbit(sim);
+        const double deltaTime = period / stepsPerOrbit;
+        const double initial = energy(sim);
+        double drift = 0.0;
+        for (int step = 0; step < stepsPerOrbit * orbits; ++step) {
+            sim.computeForces();
+            sim.updateParticles(deltaTime);
+            drift = std::max(drift, std::abs(energy(sim) / initial - 1.0));
+        }
+        return drift;
+    }
+
+};
+
+// Testing kickDriftSweep()
+TEST_F(TimeIntegratorTest, kickDriftSweepMatchesParticleUpdate) {
+    ParticleStore store;
+    Particle reference(ParticleType::KAON_POSITIVE, 0.49367, +1.0, 0.0, 1.0, 2.0, 3.0);
+    reference.velocity[0] = 0.5;
+    reference.force[0] = 3.0;
+    reference.force[1] = -2.0;
+    reference.force[2] = 1.0;
+    store.push_back(reference);
+
+    kickDriftSweep(store, 0.1, 0.1);
+    reference.update(0.1);
+
+    EXPECT_DOUBLE_EQ(store.vx[0], reference.velocity[0]) << "The fused sweep's velocity does not match Particle::update().";
+    EXPECT_DOUBLE_EQ(store.vy[0], reference.velocity[1]) << "The fused sweep's velocity does not match Particle::update().";
+    EXPECT_DOUBLE_EQ(store.x[0], reference.position[0]) << "The fused sweep's position does not match Particle::update().";
+    EXPECT_DOUBLE_EQ(store.z[0], reference.position[2]) << "The fused sweep's position does not match Particle::update().";
+    EXPECT_EQ(store.fx[0], 0.0) << "The fused sweep did not clear the force.";
+}
+
+// Testing step()
+// Over ten orbits, velocity Verlet (second order) keeps the energy far better than Euler (first order) at the same step size.
+// Leapfrog follows the same trajectory (see below), but its stored velocities are half a step off, so its energy is not checked here.
+TEST_F(TimeIntegratorTest, stepVelocityVerletConservesEnergy) {
+    const double euler = maxEnergyDrift(Integrator::EULER, 200, 10);
+    const double verlet = maxEnergyDrift(Integrator::VELOCITY_VERLET, 200, 10);
+    EXPECT_LT(verlet, 1e-3) << "Velocity Verlet drifted by " << verlet << " over ten orbits.";
+    EXPECT_LT(verlet * 10.0, euler) << "Velocity Verlet (" << verlet << ") is not clearly better than Euler (" << euler << ").";
+}
+
+// Testing step()
+// Velocity Verlet with 5x larger steps still drifts less than Euler.
+TEST_F(TimeIntegratorTest, stepVelocityVerletAllowsLargerSteps) {
+    const double euler = maxEnergyDrift(Integrator::EULER, 200, 10);
+    const double verlet = maxEnergyDrift(Integrator::VELOCITY_VERLET, 40, 10);
+    EXPECT_LT(verlet, euler) << "Velocity Verlet at 40 steps per orbit (" << verlet << ") drifted more than Euler at 200 (" << euler << ").";
+}
+
+// Testing step()
+// Leapfrog and velocity Verlet produce the same trajectory; only the time at which velocities are stored differs.
+TEST_F(TimeIntegratorTest, stepLeapfrogAndVelocityVerletShareTrajectory) {
+    Simulation leapfrog, verlet;
+    leapfrog.setIntegrator(Integrator::LEAPFROG);
+    verlet.setIntegrator(Integrator::VELOCITY_VERLET);
+    const double period = setUpOrbit(leapfrog);
+    setUpOrbit(verlet);
+    for (int step = 0; step < 100; ++step) {
+        leapfrog.computeForces();
+        leapfrog.updateParticles(period / 100);
+        verlet.computeForces();
+        verlet.updateParticles(period / 100);
+    }
+    EXPECT_NEAR(leapfrog.particles.x[0], verlet.particles.x[0], 1e-9) << "Leapfrog and velocity Verlet positions differ.";
+    EXPECT_NEAR(leapfrog.particles.y[1], verlet.particles.y[1], 1e-9) << "Leapfrog and velocity Verlet positions differ.";
+}
+
+// Testing step()
+// A velocity Verlet step leaves the forces at the new positions in the store, so the next computeForces() call does not need to recompute them.
+TEST_F(TimeIntegratorTest, stepVelocityVerletLeavesCurrentForces) {
+    Simulation sim;
+    sim.setIntegrator(Integrator::VELOCITY_VERLET);
+    const double period = setUpOrbit(sim);
+    sim.computeForces();
+    sim.updateParticles(period / 100);
+    const double fx = sim.particles.fx[0];
+    EXPECT_NE(fx, 0.0) << "The velocity Verlet step did not leave the new forces in the store.";
+
+    Simulation check;
+    setUpOrbit(check);
+    for (size_t i = 0; i < 2; ++i) {
+        check.particles.x[i] = sim.particles.x[i];
+        check.particles.y[i] = sim.particles.y[i];
+    }
+    check.computeForces();
+    EXPECT_DOUBLE_EQ(fx, check.particles.fx[0]) << "The forces left by the velocity Verlet step are not the forces at the new positions.";
+}
+
+// Testing step()
+// When every particle is on level 0, a block step is exactly one velocity Verlet step.
+TEST_F(TimeIntegratorTest, stepBlockVerletMatchesVelocityVerletForWeakForces) {
+    Simulation block, verlet;
+    block.setIntegrator(Integrator::BLOCK_VERLET);
+    verlet.setIntegrator(Integrator::VELOCITY_VERLET);
+    const double period = setUpOrbit(block);
+    setUpOrbit(verlet);
+    block.setBlockTimesteps(8, 1e6, 1.0); // A huge accuracy parameter keeps everyone on level 0.
+    for (int step = 0; step < 20; ++step) {
+        block.computeForces();
+        block.updateParticles(period / 100);
+        verlet.computeForces();
+        verlet.updateParticles(period / 100);
+    }
+    EXPECT_EQ(block.getTimeIntegrator().getSubstepCount(), 20u) << "Level-0 block steps should take one substep each.";
+    for (size_t i = 0; i < 2; ++i) {
+        EXPECT_EQ(block.particles.x[i], verlet.particles.x[i]) << "Particle " << i << "'s position differs from velocity Verlet.";
+        EXPECT_EQ(block.particles.vy[i], verlet.particles.vy[i]) << "Particle " << i << "'s velocity differs from velocity Verlet.";
+    }
+}
+
+// Testing step()
+// A tight pair next to slow, distant particles: the pair is refined to small substeps while the others keep the large step, so the pair's
+// orbit is resolved at a fraction of the cost of refining everybody.
+TEST_F(TimeIntegratorTest, stepBlockVerletRefinesOnlyCloseEncounters) {
+    Simulation block, coarse;
+    block.setThreadCount(1);
+    coarse.setThreadCount(1);
+    block.setIntegrator(Integrator::BLOCK_VERLET);
+    coarse.setIntegrator(Integrator::VELOCITY_VERLET);
+    block.setBlockTimesteps(8, 0.02, 1.0);
+    const double period = setUpEncounter(block);
+    setUpEncounter(coarse);
+
+    const double blockDrift = runAndMeasureDrift(block, period / 10, 20);
+    const double coarseDrift = runAndMeasureDrift(coarse, period / 10, 20);
+
+    const TimeIntegrator& integrator = block.getTimeIntegrator();
+    EXPECT_EQ(integrator.getLevels()[0], 5) << "The orbiting pair did not get the expected block level.";
+    EXPECT_EQ(integrator.getLevels()[5], 0) << "A distant particle was refined although its acceleration is small.";
+    EXPECT_LT(blockDrift, 1e-3) << "Block timesteps did not resolve the orbit (energy drift " << blockDrift << ").";
+    EXPECT_LT(blockDrift * 100.0, coarseDrift) << "Block timesteps (" << blockDrift << ") are not much better than the coarse global step (" << coarseDrift << ").";
+
+    const double everyoneRefined = static_cast<double>(integrator.getSubstepCount()) * block.particles.size();
+    EXPECT_LT(integrator.getTargetForceCount(), 0.25 * everyoneRefined) << "Block timesteps computed nearly as many forces as refining every particle.";
+}
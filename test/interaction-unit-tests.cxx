@@ -0,0 +1,188 @@
+// This file uses the Googletest framework to unit-test the interaction policies of physics-simulation/include/interaction.h, through the
+// force solvers that are instantiated with them.
+
+// The policies are plain structs, so they share one Googletest fixture.
+// Each individual test checks one specific functionality of the policies or of the solvers running them.
+
+// The naming convention for testing a function is as follows: TEST_F([ModuleName]Test, [functionName][SpecificFunctionalityBeingTested])
+
+#include "interaction.h"
+#include "particle.h"
+#include "simulation.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Test fixture for the interaction policies
+class InteractionTest : public ::testing::Test {
+protected:
+
+    // A cloud of charged particles of both signs, 0.1 mm across, so that the default ranges of the short-range laws cut some of the pairs.
+    std::vector<Particle> cloud;
+
+    void SetUp() override {
+        std::default_random_engine engine(11);
+        std::uniform_real_distribution<double> positionDist(0.0, 1e-4);
+        for (int i = 0; i < 60; ++i) {
+            const double charge = (i % 3 == 0) ? -1.0 : +1.0;
+            cloud.emplace_back(ParticleType::PROTON, 0.93827, charge, 0.0, positionDist(engine), positionDist(engine), positionDist(engine));
+        }
+    }
+
+    // Returns the settings of one model, with a range that cuts or screens part of the cloud.
+    static InteractionSettings settingsFor(InteractionModel model) {
+        InteractionSettings settings;
+        settings.model = model;
+        settings.range = 4e-5;
+        return settings;
+    }
+
+    // Sums the pairwise forces of a particle set with the scalar Particle::addForce() of a policy.
+    static std::vector<Particle> referenceForces(std::vector<Particle> particles, const InteractionSettings& settings) {
+        visitInteraction(settings, [&](const auto& policy) {
+            for (size_t i = 0; i < particles.size(); ++i) {
+                for (size_t j = i + 1; j < particles.size(); ++j) {
+                    particles[i].addForce(particles[j], policy);
+                }
+            }
+        });
+        return particles;
+    }
+
+    // Loads a particle set into a simulation configured for one solver and force law. createParticle() places particles at the origin,
+    // so the positions are written into the columns afterwards.
+    static void load(Simulation& simulation, const std::vector<Particle>& particles, ForceSolver solver, const InteractionSettings& settings) {
+        simulation.setThreadCount(2);
+        simulation.setForceSolver(solver);
+        simulation.setOpeningAngle(0.0); // Opens every cell, so the tree solver is exact.
+        simulation.setCutoff(1.0);       // Larger than the cloud, so the cell list only applies the force law's own range.
+        simulation.setInteraction(settings);
+        for (const auto& particle : particles) {
+            simulation.createParticle(particle.type, particle.mass, particle.charge, particle.lifetime,
+                                      particle.position[0], particle.position[1], particle.position[2]);
+            simulation.particles.x.back() = particle.position[0];
+            simulation.particles.y.back() = particle.position[1];
+            simulation.particles.z.back() = particle.position[2];
+        }
+    }
+
+    // Checks that the simulation's force columns match the reference forces particle by particle.
+    static void expectForcesMatch(const Simulation& simulation, const std::vector<Particle>& reference, const std::string& what) {
+        const double* force[3] = {simulation.particles.fx.data(), simulation.particles.fy.data(), simulation.particles.fz.data()};
+        for (size_t i = 0; i < reference.size(); ++i) {
+            const double magnitude = std::sqrt(reference[i].force[0] * reference[i].force[0] + reference[i].force[1] * reference[i].force[1] +
+                                               reference[i].force[2] * reference[i].force[2]);
+            for (int axis = 0; axis < 3; ++axis) {
+                EXPECT_NEAR(force[axis][i], reference[i].force[axis], 1e-9 * magnitude)
+                    << what << ": the force on particle " << i << " differs from addForce() along axis " << axis;
+            }
+        }
+    }
+};
+
+// Testing Particle::addForce()
+TEST_F(InteractionTest, addForceWithTheCoulombPolicyMatchesAddForce) {
+    Particle a = cloud[0], b = cloud[1];
+    Particle c = cloud[0], d = cloud[1];
+    a.addForce(b);
+    c.addForce(d, CoulombInteraction{});
+    for (int axis = 0; axis < 3; ++axis) {
+        EXPECT_DOUBLE_EQ(c.force[axis], a.force[axis]) << "The Coulomb policy should reproduce addForce() on the target along axis " << axis;
+        EXPECT_DOUBLE_EQ(d.force[axis], b.force[axis]) << "The Coulomb policy should reproduce addForce() on the source along axis " << axis;
+    }
+}
+
+// Testing Particle::addForce()
+TEST_F(InteractionTest, addForceFollowsTheRangeOfEachLaw) {
+    Particle near = cloud[0], farAway = cloud[1];
+    farAway.position[0] = near.position[0] + 1e-3;
+    farAway.position[1] = near.position[1];
+    farAway.position[2] = near.position[2];
+
+    Particle coulombTarget = near, coulombSource = farAway;
+    coulombTarget.addForce(coulombSource, CoulombInteraction{0.0});
+    Particle yukawaTarget = near, yukawaSource = farAway;
+    yukawaTarget.addForce(yukawaSource, YukawaInteraction{0.0, 1e-4});
+    Particle cutoffTarget = near, cutoffSource = farAway;
+    cutoffTarget.addForce(cutoffSource, CutoffCoulombInteraction{forceSoftening, 1e-4});
+
+    // Ten screening lengths apart (without softening): exp(-10) (1 + 10) of the Coulomb force.
+    EXPECT_NEAR(yukawaTarget.force[0], coulombTarget.force[0] * std::exp(-10.0) * 11.0, 1e-9 * std::abs(coulombTarget.force[0]))
+        << "The Yukawa force should be the Coulomb force times exp(-r / lambda) (1 + r / lambda)";
+    EXPECT_EQ(cutoffTarget.force[0], 0.0) << "A pair beyond the cutoff radius should not interact";
+}
+
+// Testing Simulation::computeForces()
+TEST_F(InteractionTest, computeForcesMatchesAddForceForEveryLawAndSolver) {
+    const InteractionModel models[] = {InteractionModel::COULOMB, InteractionModel::YUKAWA, InteractionModel::CUTOFF_COULOMB};
+    const ForceSolver solvers[] = {ForceSolver::ALL_PAIRS, ForceSolver::BARNES_HUT, ForceSolver::CELL_LIST};
+    for (InteractionModel model : models) {
+        const std::vector<Particle> reference = referenceForces(cloud, settingsFor(model));
+        for (ForceSolver solver : solvers) {
+            Simulation simulation;
+            load(simulation, cloud, solver, settingsFor(model));
+            simulation.computeForces();
+            expectForcesMatch(simulation, reference, "Model " + std::to_string(static_cast<int>(model)) + ", solver " +
+                                                     std::to_string(static_cast<int>(solver)));
+        }
+    }
+}
+
+// Testing Simulation::computeForces()
+TEST_F(InteractionTest, computeForcesLeavesNeutralParticlesOut) {
+    std::vector<Particle> withNeutrals = cloud;
+    std::default_random_engine engine(5);
+    std::uniform_real_distribution<double> positionDist(0.0, 1e-4);
+    for (int i = 0; i < 25; ++i) {
+        withNeutrals.emplace_back(ParticleType::PION_NEUTRAL, 0.13498, 0.0, 0.0, positionDist(engine), positionDist(engine), positionDist(engine));
+    }
+    const std::vector<Particle> reference = referenceForces(cloud, settingsFor(InteractionModel::COULOMB));
+
+    const ForceSolver solvers[] = {ForceSolver::ALL_PAIRS, ForceSolver::BARNES_HUT, ForceSolver::CELL_LIST};
+    for (ForceSolver solver : solvers) {
+        for (double skin : {0.0, 1e-5}) {
+            Simulation simulation;
+            load(simulation, withNeutrals, solver, settingsFor(InteractionModel::COULOMB));
+            simulation.setNeighborListSkin(skin);
+            simulation.computeForces();
+            expectForcesMatch(simulation, reference, "Charged particles among neutral ones");
+            for (size_t i = cloud.size(); i < withNeutrals.size(); ++i) {
+                EXPECT_EQ(simulation.particles.fx[i], 0.0) << "A neutral particle should feel no force (solver " << static_cast<int>(solver) << ")";
+                EXPECT_EQ(simulation.particles.fy[i], 0.0) << "A neutral particle should feel no force (solver " << static_cast<int>(solver) << ")";
+                EXPECT_EQ(simulation.particles.fz[i], 0.0) << "A neutral particle should feel no force (solver " << static_cast<int>(solver) << ")";
+            }
+        }
+    }
+}
+
+// Testing Simulation::computeForces()
+TEST_F(InteractionTest, computeForcesDoesNothingWithoutAnInteraction) {
+    const ForceSolver solvers[] = {ForceSolver::ALL_PAIRS, ForceSolver::BARNES_HUT, ForceSolver::CELL_LIST};
+    for (ForceSolver solver : solvers) {
+        Simulation simulation;
+        load(simulation, cloud, solver, settingsFor(InteractionModel::NONE));
+        simulation.computeForces();
+        for (size_t i = 0; i < cloud.size(); ++i) {
+            EXPECT_EQ(simulation.particles.fx[i], 0.0) << "No force law should leave the forces zero (solver " << static_cast<int>(solver) << ")";
+            EXPECT_EQ(simulation.particles.fy[i], 0.0) << "No force law should leave the forces zero (solver " << static_cast<int>(solver) << ")";
+            EXPECT_EQ(simulation.particles.fz[i], 0.0) << "No force law should leave the forces zero (solver " << static_cast<int>(solver) << ")";
+        }
+    }
+}
+
+// Testing Simulation::saveCheckpoint() and Simulation::loadCheckpoint()
+TEST_F(InteractionTest, loadCheckpointRestoresTheInteraction) {
+    Simulation simulation;
+    load(simulation, cloud, ForceSolver::ALL_PAIRS, settingsFor(InteractionModel::YUKAWA));
+    const std::string path = "interaction-test.ckpt";
+    ASSERT_TRUE(simulation.saveCheckpoint(path)) << "The checkpoint could not be written";
+
+    Simulation restored;
+    ASSERT_TRUE(restored.loadCheckpoint(path)) << "The checkpoint could not be read back";
+    std::remove(path.c_str());
+    EXPECT_EQ(restored.getInteraction().model, InteractionModel::YUKAWA) << "The force law should be restored";
+    EXPECT_DOUBLE_EQ(restored.getInteraction().range, 4e-5) << "The range of the force law should be restored";
+}
@@ -0,0 +1,149 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/metrics.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "metrics.h"
+#include "simulation.h"
+#include "event-generator.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <gtest/gtest.h>
+
+// Returns the contents of a file.
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Test fixture for the metrics functions. Every test starts from zeroed metrics and is skipped in builds without metrics.
+class MetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!areMetricsEnabled()) {
+            GTEST_SKIP() << "Built with ENABLE_METRICS=OFF";
+        }
+        resetMetrics();
+    }
+
+    // Returns the total of one counter.
+    static std::uint64_t total(const MetricsSnapshot& metrics, Counter counter) {
+        return metrics.total.counters[static_cast<std::size_t>(counter)];
+    }
+};
+
+// Testing collectMetrics()
+TEST_F(MetricsTest, collectMetricsCountsEveryAllPairsInteraction) {
+    Simulation simulation;
+    simulation.setThreadCount(4);
+    EventConfig config;
+    config.meanMultiplicity = 300.0;
+    const std::size_t count = simulation.generateEvent(EventGenerator(config));
+    simulation.computeForces();
+    // Neutral particles are left out of the pair loop, so only pairs of charged particles are counted.
+    std::size_t charged = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        charged += simulation.particles.charge[i] != 0.0 ? 1 : 0;
+    }
+
+    const MetricsSnapshot metrics = collectMetrics();
+    EXPECT_EQ(total(metrics, Counter::PAIR_INTERACTIONS), charged * (charged - 1) / 2)
+        << "The all-pairs solver should count every pair of charged particles exactly once";
+    EXPECT_EQ(total(metrics, Counter::PARTICLES_CREATED), count) << "Every generated particle should be counted as created";
+    EXPECT_EQ(metrics.total.phaseCalls[static_cast<std::size_t>(Phase::FORCES)], 1u) << "One force evaluation should be timed";
+    EXPECT_EQ(metrics.total.phaseCalls[static_cast<std::size_t>(Phase::CREATION)], 1u) << "One event generation should be timed";
+
+    std::uint64_t perThread = 0;
+    for (const auto& values : metrics.threads) {
+        perThread += values.counters[static_cast<std::size_t>(Counter::PAIR_INTERACTIONS)];
+    }
+    EXPECT_EQ(perThread, charged * (charged - 1) / 2) << "The per-thread counts should add up to the total";
+}
+
+// Testing collectMetrics()
+TEST_F(MetricsTest, collectMetricsCountsDecaysAndTheirParticles) {
+    Simulation simulation;
+    for (int i = 0; i < 50; ++i) {
+        simulation.createParticle(ParticleType::KAON_POSITIVE);
+    }
+    simulation.decayParticles(1e-7); // Several kaon lifetimes, so most of them decay
+
+    const MetricsSnapshot metrics = collectMetrics();
+    EXPECT_GT(simulation.getDecayCount(), 0u) << "Some kaons should decay";
+    EXPECT_EQ(total(metrics, Counter::DECAYS), simulation.getDecayCount()) << "The decay counter should match the simulation's decay count";
+    EXPECT_EQ(total(metrics, Counter::PARTICLES_REMOVED), total(metrics, Counter::PARTICLES_CREATED) - 50)
+        << "Every removed parent should be replaced by exactly one product";
+    EXPECT_EQ(metrics.total.phaseCalls[static_cast<std::size_t>(Phase::DECAY)], 1u) << "One decay pass should be timed";
+}
+
+// Testing resetMetrics()
+TEST_F(MetricsTest, resetMetricsZeroesEveryCounter) {
+    METRICS_COUNT(Counter::BYTES_WRITTEN, 123);
+    EXPECT_EQ(total(collectMetrics(), Counter::BYTES_WRITTEN), 123u) << "The counter should hold the counted bytes";
+    resetMetrics();
+    EXPECT_EQ(total(collectMetrics(), Counter::BYTES_WRITTEN), 0u) << "The counter should be zero after a reset";
+}
+
+// Testing formatMetricsJson() and formatMetricsPrometheus()
+TEST_F(MetricsTest, formatMetricsWritesEveryCounterInBothFormats) {
+    METRICS_COUNT(Counter::DECAYS, 7);
+    const MetricsSnapshot metrics = collectMetrics();
+    const std::string json = formatMetricsJson(metrics);
+    const std::string prometheus = formatMetricsPrometheus(metrics);
+
+    EXPECT_NE(json.find("\"decays\":7"), std::string::npos) << "The JSON should hold the decay total: " << json;
+    EXPECT_NE(json.find("\"threads\":[{"), std::string::npos) << "The JSON should list the thread that counted: " << json;
+    EXPECT_NE(prometheus.find("# TYPE physics_simulation_decays_total counter"), std::string::npos)
+        << "The Prometheus text should declare the counter: " << prometheus;
+    EXPECT_NE(prometheus.find("physics_simulation_decays_total{thread=\"" + std::to_string(getThreadMetrics().thread) + "\"} 7"),
+              std::string::npos) << "The Prometheus text should hold this thread's count: " << prometheus;
+}
+
+// Testing writeChromeTrace()
+TEST_F(MetricsTest, writeChromeTraceWritesTheRecordedPhases) {
+    Simulation simulation;
+    simulation.simulateCollision();
+    setTracing(true);
+    simulation.computeForces();
+    simulation.updateParticles(1e-12);
+    setTracing(false);
+
+    const std::string path = ::testing::TempDir() + "metrics-trace.json";
+    ASSERT_TRUE(writeChromeTrace(path)) << "The trace should be written";
+    const std::string trace = readFile(path);
+    EXPECT_NE(trace.find("{\"name\":\"forces\",\"ph\":\"X\""), std::string::npos) << "The trace should hold the force phase: " << trace;
+    EXPECT_NE(trace.find("{\"name\":\"integration\""), std::string::npos) << "The trace should hold the integration phase: " << trace;
+    EXPECT_NE(trace.find("{\"name\":\"decay\""), std::string::npos) << "The trace should hold the decay phase: " << trace;
+    std::remove(path.c_str());
+}
+
+// Testing PeriodicMetricsDump
+TEST_F(MetricsTest, PeriodicMetricsDumpWritesTheFinalValuesWhenDestroyed) {
+    const std::string path = ::testing::TempDir() + "metrics-dump.prom";
+    {
+        PeriodicMetricsDump dump(path, 60.0);
+        METRICS_COUNT(Counter::ALLOCATIONS, 3);
+    }
+    const std::string text = readFile(path);
+    EXPECT_NE(text.find("physics_simulation_allocations_total{thread=\"" + std::to_string(getThreadMetrics().thread) + "\"} 3"),
+              std::string::npos) << "The dump should hold the final counter values: " << text;
+    std::remove(path.c_str());
+}
+
+// Testing PeriodicMetricsDump::dump()
+TEST_F(MetricsTest, PeriodicMetricsDumpDumpSucceedsWhileTheBackgroundThreadDumps) {
+    const std::string path = ::testing::TempDir() + "metrics-concurrent.prom";
+    {
+        PeriodicMetricsDump dump(path, 1e-5);
+        for (int n = 0; n < 500; ++n) {
+            ASSERT_TRUE(dump.dump()) << "dump() " << n << " failed while the background thread was writing the same file.";
+        }
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,227 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/particle-mesh.cxx
+
+// Each class in particle-mesh.cxx (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "particle-mesh.h"
+#include "all-pairs.h"
+#include "particle-store.h"
+#include "particle.h"
+#include "thread-pool.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Test fixture for the ParticleMeshSolver class
+class ParticleMeshSolverTest : public ::testing::Test {
+protected:
+
+    // Particles scattered at random in a 1 cm cube (a mesh cell of about 0.4 mm at 32 nodes, well above the softening length of 10 um),
+    // every third one negative, so that there is both a smooth field and short-range structure.
+    ParticleStore store;
+    ThreadPool pool{2};
+
+    void SetUp() override {
+        std::default_random_engine engine(31);
+        std::uniform_real_distribution<double> positionDist(0.0, 1e-2);
+        for (int i = 0; i < 2000; ++i) {
+            store.emplace_back(ParticleType::PROTON, 0.938, (i % 3 == 0) ? -1.0 : +1.0, 0.0, positionDist(engine), positionDist(engine),
+                               positionDist(engine), 0.0, 0.0, 0.0);
+        }
+    }
+
+    // Returns the forces of the exact all-pairs solver.
+    ParticleStore exactForces() {
+        ParticleStore exact = store;
+        AllPairsSolver allPairs;
+        exact.resetForces();
+        allPairs.computeForces(exact, pool);
+        return exact;
+    }
+
+    // Returns the forces of a mesh solver.
+    ParticleStore meshForces(ParticleMeshSolver& solver) {
+        ParticleStore result = store;
+        result.resetForces();
+        solver.computeForces(result, pool);
+        return result;
+    }
+
+    // Returns the RMS force error relative to the RMS force, sqrt(sum |F - F_exact|^2 / sum |F_exact|^2).
+    static double relativeError(const ParticleStore& forces, const ParticleStore& exact) {
+        double error = 0.0, norm = 0.0;
+        for (std::size_t i = 0; i < exact.size(); ++i) {
+            const double dx = forces.fx[i] - exact.fx[i], dy = forces.fy[i] - exact.fy[i], dz = forces.fz[i] - exact.fz[i];
+            error += dx*dx + dy*dy + dz*dz;
+            norm += exact.fx[i] * exact.fx[i] + exact.fy[i] * exact.fy[i] + exact.fz[i] * exact.fz[i];
+        }
+        return std::sqrt(error / norm);
+    }
+};
+
+// Testing computeForces()
+// Plain PM gives the Coulomb force of pairs many cells apart and a blurred, finite force within a cell or so.
+TEST_F(ParticleMeshSolverTest, computeForcesMatchesCoulombForDistantPairsOnly) {
+    for (double separation : {5e-3, 3e-4}) {
+        store.clear();
+        store.emplace_back(ParticleType::PROTON, 0.938, 1.0, 0.0, 2e-3, 3e-3, 4e-3, 0.0, 0.0, 0.0);
+        store.emplace_back(ParticleType::PROTON, 0.938, 1.0, 0.0, 2e-3 + separation, 3e-3, 4e-3, 0.0, 0.0, 0.0);
+        store.emplace_back(ParticleType::PROTON, 0.938, 1e-9, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0); // Markers that stretch the mesh to 1 cm
+        store.emplace_back(ParticleType::PROTON, 0.938, 1e-9, 0.0, 1e-2, 1e-2, 1e-2, 0.0, 0.0, 0.0);
+        const ParticleStore exact = exactForces();
+        ParticleMeshSolver solver;
+        const ParticleStore mesh = meshForces(solver);
+        EXPECT_NEAR(solver.getCellSize(), 1e-2 / 24.0, 1e-9) << "The mesh should span the particles with four empty nodes on each side.";
+        if (separation > 10.0 * solver.getCellSize()) {
+            EXPECT_NEAR(mesh.fx[0], exact.fx[0], 1e-3 * exact.fx[0]) << "PM should give the Coulomb force of a pair 12 cells apart.";
+        } else {
+            EXPECT_GT(mesh.fx[0], 0.0) << "The blurred force should still pull like charges together.";
+            EXPECT_LT(mesh.fx[0], 0.2 * exact.fx[0]) << "PM should blur the force of a pair less than a cell apart.";
+        }
+        EXPECT_NEAR(mesh.fx[1], -mesh.fx[0], 1e-6 * exact.fx[0]) << "The mesh forces of the pair should be equal and opposite.";
+        EXPECT_NEAR(mesh.fy[0], 0.0, 1e-6 * exact.fx[0]) << "The mesh force should point along the separation.";
+    }
+}
+
+// Testing computeForces()
+TEST_F(ParticleMeshSolverTest, computeForcesWithCorrectionsMatchesAllPairs) {
+    const ParticleStore exact = exactForces();
+    ParticleMeshSolver pm, p3m;
+    p3m.correctionCells = 5.0;
+    const double pmError = relativeError(meshForces(pm), exact);
+    const double p3mError = relativeError(meshForces(p3m), exact);
+    EXPECT_LT(p3mError, 5e-3) << "P3M should match the all-pairs forces; the relative RMS error is " << p3mError;
+    EXPECT_LT(p3mError, 0.01 * pmError) << "The short-range corrections should remove most of the PM error (" << pmError << " without, "
+                                        << p3mError << " with).";
+}
+
+// Testing computeForces()
+TEST_F(ParticleMeshSolverTest, computeForcesTscIsMoreAccurateThanCic) {
+    const ParticleStore exact = exactForces();
+    ParticleMeshSolver cic, tsc;
+    cic.assignment = MeshAssignment::CIC;
+    cic.correctionCells = tsc.correctionCells = 5.0;
+    const double cicError = relativeError(meshForces(cic), exact);
+    const double tscError = relativeError(meshForces(tsc), exact);
+    EXPECT_LT(cicError, 1e-2) << "CIC with corrections should still follow the exact forces; the relative RMS error is " << cicError;
+    EXPECT_LT(tscError, cicError) << "The smoother TSC assignment should alias less than CIC (" << tscError << " against " << cicError << ").";
+}
+
+// Testing computeForces()
+TEST_F(ParticleMeshSolverTest, computeForcesIgnoresNeutralParticles) {
+    ParticleMeshSolver solver;
+    solver.correctionCells = 5.0;
+    const ParticleStore charged = meshForces(solver);
+    store.emplace_back(ParticleType::PROTON, 0.938, 0.0, 0.0, 5e-3, 5e-3, 5e-3, 0.0, 0.0, 0.0);
+    store.emplace_back(ParticleType::PROTON, 0.938, 0.0, 0.0, 1.0, 1.0, 1.0, 0.0, 0.0, 0.0); // Far outside the charged particles
+    const ParticleStore withNeutral = meshForces(solver);
+    for (std::size_t i = 0; i < charged.size(); ++i) {
+        ASSERT_EQ(withNeutral.fx[i], charged.fx[i]) << "A neutral particle changed the force on particle " << i;
+    }
+    for (std::size_t i = charged.size(); i < withNeutral.size(); ++i) {
+        EXPECT_EQ(withNeutral.fx[i], 0.0) << "Neutral particle " << i << " received a force.";
+        EXPECT_EQ(withNeutral.fy[i], 0.0) << "Neutral particle " << i << " received a force.";
+        EXPECT_EQ(withNeutral.fz[i], 0.0) << "Neutral particle " << i << " received a force.";
+    }
+}
+
+// Testing computeForces()
+TEST_F(ParticleMeshSolverTest, computeForcesLeavesTheForcesAloneWithoutAMeshLaw) {
+    ParticleMeshSolver solver;
+    solver.interaction.model = InteractionModel::YUKAWA;
+    const ParticleStore screened = meshForces(solver);
+    store.resize(1);
+    solver.interaction.model = InteractionModel::COULOMB;
+    const ParticleStore single = meshForces(solver);
+    for (std::size_t i = 0; i < screened.size(); ++i) {
+        ASSERT_EQ(screened.fx[i], 0.0) << "The mesh only solves the Coulomb law, but particle " << i << " received a screened force.";
+    }
+    EXPECT_EQ(single.fx[0], 0.0) << "A single particle has nothing to interact with.";
+}
+
+// Testing computeForces()
+TEST_F(ParticleMeshSolverTest, computeForcesIsIndependentOfThreadCount) {
+    ParticleMeshSolver solver;
+    solver.correctionCells = 3.0;
+    const ParticleStore twoThreads = meshForces(solver);
+    ThreadPool serialPool(1), widePool(5);
+    for (ThreadPool* other : {&serialPool, &widePool}) {
+        ParticleStore result = store;
+        result.resetForces();
+        solver.computeForces(result, *other);
+        for (std::size_t i = 0; i < store.size(); ++i) {
+            ASSERT_EQ(result.fx[i], twoThreads.fx[i]) << "The force on particle " << i << " depends on the thread count.";
+            ASSERT_EQ(result.fz[i], twoThreads.fz[i]) << "The force on particle " << i << " depends on the thread count.";
+        }
+    }
+}
+
+// Testing computeRange()
+TEST_F(ParticleMeshSolverTest, computeRangeMatchesComputeForces) {
+    ParticleMeshSolver solver;
+    solver.correctionCells = 5.0;
+    const ParticleStore full = meshForces(solver);
+    ParticleStore ranges = store;
+    ranges.resetForces();
+    solver.prepareRanges(ranges, pool);
+    for (std::size_t begin = 0; begin < ranges.size(); begin += 300) {
+        solver.computeRange(ranges, begin, std::min<std::size_t>(begin + 300, ranges.size()));
+    }
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        ASSERT_EQ(ranges.fx[i], full.fx[i]) << "The split computation differs from computeForces() for particle " << i;
+        ASSERT_EQ(ranges.fy[i], full.fy[i]) << "The split computation differs from computeForces() for particle " << i;
+    }
+}
+
+// Testing computeForcesOn()
+TEST_F(ParticleMeshSolverTest, computeForcesOnOnlyTouchesTheTargets) {
+    ParticleMeshSolver solver;
+    solver.correctionCells = 5.0;
+    const ParticleStore full = meshForces(solver);
+    std::vector<std::uint8_t> isTarget(store.size(), 0);
+    for (std::size_t i = 0; i < store.size(); i += 5) {
+        isTarget[i] = 1;
+    }
+    ParticleStore subset = store;
+    subset.resetForces();
+    solver.computeForcesOn(subset, isTarget, pool);
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        ASSERT_EQ(subset.fx[i], isTarget[i] ? full.fx[i] : 0.0) << "Particle " << i << (isTarget[i] ? " did not get its full force." : " is not a target but received a force.");
+    }
+}
+
+// Testing save() and load()
+TEST_F(ParticleMeshSolverTest, loadRestoresTheMeshParameters) {
+    ParticleMeshSolver saved;
+    saved.gridSize = 64;
+    saved.assignment = MeshAssignment::CIC;
+    saved.correctionCells = 3.5;
+    CheckpointWriter writer;
+    saved.save(writer);
+
+    ParticleMeshSolver restored;
+    CheckpointReader reader(writer.getPayload().data(), writer.getPayload().size());
+    ASSERT_TRUE(restored.load(reader)) << "A complete checkpoint should load.";
+    EXPECT_EQ(restored.gridSize, 64u) << "The grid size was not restored.";
+    EXPECT_EQ(restored.assignment, MeshAssignment::CIC) << "The assignment scheme was not restored.";
+    EXPECT_EQ(restored.correctionCells, 3.5) << "The correction radius was not restored.";
+
+    CheckpointReader truncated(writer.getPayload().data(), writer.getPayload().size() - 1);
+    EXPECT_FALSE(ParticleMeshSolver().load(truncated)) << "A truncated checkpoint should be rejected.";
+
+    for (std::uint64_t damagedGridSize : {std::uint64_t(0), std::uint64_t(1) << 20}) {
+        CheckpointWriter damaged;
+        damaged.put(damagedGridSize);
+        damaged.put(MeshAssignment::TSC);
+        damaged.put(0.0);
+        CheckpointReader damagedReader(damaged.getPayload().data(), damaged.getPayload().size());
+        ParticleMeshSolver loaded;
+        EXPECT_FALSE(loaded.load(damagedReader)) << "A mesh size of " << damagedGridSize << " should be rejected.";
+        EXPECT_EQ(loaded.gridSize, 32u) << "A rejected mesh size should not be stored.";
+    }
+}
@@ -0,0 +1,132 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/particle-store.cxx
+
+// Each class in particle-store.cxx (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "particle-store.h"
+#include "particle.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+
+// Test fixture for the ParticleStore class
+class ParticleStoreTest : public ::testing::Test {
+protected:
+
+    ParticleStore store;
+
+    void SetUp() override {
+        // Store the same particles that the Particle tests use.
+        store.push_back(Particle(ParticleType::PROTON, 0.938, +1.0, 0.0, 0.0, 0.0, 0.0)); // Stable particle
+        store.push_back(Particle(ParticleType::PROTON, 0.938, +1.0, 0.0, 1.0, 0.0, 0.0)); // Stable particle
+        store.push_back(Particle(ParticleType::KAON_POSITIVE, 0.493, +1.0, 1.24e-8, 0.0, 0.0, 0.0)); // Unstable particle
+        store.push_back(Particle(ParticleType::PION_NEGATIVE, 0.13957, -1.0, 2.6e-8, -1.0, 0.0, 0.0)); // Unstable particle
+    }
+
+};
+
+// Testing push_back()
+TEST_F(ParticleStoreTest, push_backScattersFieldsIntoColumns) {
+    EXPECT_EQ(store.size(), 4u) << "push_back() did not add one particle per call.";
+    EXPECT_EQ(store.type[3], ParticleType::PION_NEGATIVE) << "Particle's type was not stored in the type column.";
+    EXPECT_DOUBLE_EQ(store.mass[3], 0.13957) << "Particle's mass was not stored in the mass column.";
+    EXPECT_DOUBLE_EQ(store.charge[3], -1.0) << "Particle's charge was not stored in the charge column.";
+    EXPECT_DOUBLE_EQ(store.lifetime[3], 2.6e-8) << "Particle's lifetime was not stored in the lifetime column.";
+    EXPECT_DOUBLE_EQ(store.x[1], 1.0) << "Particle's x position was not stored in the x column.";
+    EXPECT_DOUBLE_EQ(store.x[3], -1.0) << "Particle's x position was not stored in the x column.";
+}
+
+// Testing the column allocator
+TEST_F(ParticleStoreTest, columnsAreCacheLineAligned) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(store.x.data()) % 64, 0u) << "The x column is not aligned to a cache line.";
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(store.vx.data()) % 64, 0u) << "The vx column is not aligned to a cache line.";
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(store.fz.data()) % 64, 0u) << "The fz column is not aligned to a cache line.";
+}
+
+// Testing operator[]
+TEST_F(ParticleStoreTest, operatorIndexProxyWritesThroughToColumns) {
+    ParticleRef particle = store[2];
+    particle.velocity[1] = 0.5;
+    particle.force[2] = 3.0;
+    particle.lifetime = 1.0;
+    EXPECT_DOUBLE_EQ(store.vy[2], 0.5) << "Writing the velocity through the proxy did not change the vy column.";
+    EXPECT_DOUBLE_EQ(store.fz[2], 3.0) << "Writing the force through the proxy did not change the fz column.";
+    EXPECT_DOUBLE_EQ(store.lifetime[2], 1.0) << "Writing the lifetime through the proxy did not change the lifetime column.";
+    EXPECT_TRUE(particle.isUnstable()) << "The proxy's isUnstable() does not follow the lifetime column.";
+}
+
+// Testing get()
+TEST_F(ParticleStoreTest, getReturnsEquivalentParticle) {
+    store.vx[2] = 0.25;
+    Particle particle = store.get(2);
+    EXPECT_EQ(particle.type, ParticleType::KAON_POSITIVE) << "get() did not copy the particle's type.";
+    EXPECT_DOUBLE_EQ(particle.lifetime, 1.24e-8) << "get() did not copy the particle's lifetime.";
+    EXPECT_DOUBLE_EQ(particle.velocity[0], 0.25) << "get() did not copy the particle's velocity.";
+    EXPECT_FALSE(particle.decayModes.empty()) << "get() did not rebuild the unstable particle's decay modes.";
+}
+
+// Testing update()
+TEST_F(ParticleStoreTest, updateMatchesParticleUpdate) {
+    // Apply the same force to a standalone pair and to the stored pair, then compare one step of each.
+    Particle p3 = store.get(2);
+    Particle p4 = store.get(3);
+    p4.addForce(p3);
+    store.fx[2] = p3.force[0];
+    store.fx[3] = p4.force[0];
+
+    p3.update(1);
+    p4.update(1);
+    store.update(1);
+
+    EXPECT_DOUBLE_EQ(store.x[2], p3.position[0]) << "update() did not move the stored particle like Particle::update().";
+    EXPECT_DOUBLE_EQ(store.vx[3], p4.velocity[0]) << "update() did not accelerate the stored particle like Particle::update().";
+    EXPECT_DOUBLE_EQ(store.fx[2], 0.0) << "update() did not reset the force after the step.";
+}
+
+// Testing clear()
+TEST_F(ParticleStoreTest, clearKeepsCapacity) {
+    size_t capacity = store.capacity();
+    store.clear();
+    EXPECT_TRUE(store.empty()) << "clear() did not remove all particles.";
+    EXPECT_EQ(store.capacity(), capacity) << "clear() released the columns' capacity.";
+}
+
+// Testing removeIndices() and clear()
+// Particle ids are handed out in insertion order, survive compaction, are never reused while the store lives, and restart after clear().
+TEST_F(ParticleStoreTest, removeIndicesKeepsParticleIds) {
+    store.removeIndices({0, 2});
+    ASSERT_EQ(store.size(), 2u) << "removeIndices() did not remove two particles.";
+    EXPECT_EQ(store.id[0], 1u) << "The first survivor lost its id.";
+    EXPECT_EQ(store.id[1], 3u) << "The second survivor lost its id.";
+
+    store.emplace_back(ParticleType::PROTON, 0.938, +1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    EXPECT_EQ(store.id[2], 4u) << "A new particle reused the id of a removed one.";
+
+    store.clear();
+    EXPECT_EQ(store.getNextId(), 0u) << "clear() did not restart the particle ids.";
+}
+
+// Testing permute()
+// Every column moves with its particle, the capacity is kept, and later particles still get fresh ids.
+TEST_F(ParticleStoreTest, permuteMovesEveryColumnTogether) {
+    store.fx[2] = 5.0;
+    const std::size_t capacity = store.capacity();
+    store.permute({2, 0, 3, 1});
+    ASSERT_EQ(store.size(), 4u) << "permute() changed the number of particles.";
+    EXPECT_EQ(store.id[0], 2u) << "The particle moved to index 0 lost its id.";
+    EXPECT_EQ(store.type[0], ParticleType::KAON_POSITIVE) << "The type did not move with the particle.";
+    EXPECT_DOUBLE_EQ(store.mass[0], 0.493) << "The mass did not move with the particle.";
+    EXPECT_DOUBLE_EQ(store.inverseMass[0], 1.0 / 0.493) << "The inverse mass did not move with the particle.";
+    EXPECT_DOUBLE_EQ(store.lifetime[0], 1.24e-8) << "The lifetime did not move with the particle.";
+    EXPECT_DOUBLE_EQ(store.fx[0], 5.0) << "The force did not move with the particle.";
+    EXPECT_EQ(store.id[2], 3u) << "The particle moved to index 2 lost its id.";
+    EXPECT_DOUBLE_EQ(store.x[2], -1.0) << "The position did not move with the particle.";
+    EXPECT_DOUBLE_EQ(store.charge[2], -1.0) << "The charge did not move with the particle.";
+    EXPECT_DOUBLE_EQ(store.x[3], 1.0) << "The particle moved to index 3 is not the one that was at index 1.";
+    EXPECT_GE(store.capacity(), capacity) << "permute() shrank the capacity.";
+
+    store.emplace_back(ParticleType::PROTON, 0.938, +1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    EXPECT_EQ(store.id[4], 4u) << "A particle added after permute() did not get a fresh id.";
+}
@@ -7,6 +7,7 @@
 // The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
 
 #include "particle.h"
+#include "species.h"
 #include <gtest/gtest.h>
 
 // Test fixture for the Particle class
@@ -105,6 +106,16 @@ TEST_F(ParticleTest, ConstructorInitializesCorrectly) {
     EXPECT_DOUBLE_EQ(p4->force[2], 0.0) << "Particle's force in z direction (fz) is not initialized as expected.";
 }
 
+// Testing setDecayModes()
+// Particles of the same type share their decay modes through the species registry instead of each holding a copy.
+TEST_F(ParticleTest, setDecayModesSharesSpeciesRegistryTable) {
+    Particle other(ParticleType::KAON_POSITIVE, 0.493, +1.0, 1.24e-8, 1.0, 1.0, 1.0);
+    EXPECT_EQ(other.decayModes.begin(), p3->decayModes.begin()) << "Two particles of the same type do not share their decay modes.";
+    EXPECT_EQ(p3->decayModes.begin(), getSpecies(ParticleType::KAON_POSITIVE).decayModeList().begin()) << "The particle's decay modes do not point into the species registry.";
+    EXPECT_EQ(getSpecies(ParticleType::PROTON).decayModeCount, 0u) << "Protons should have no decay modes in the registry.";
+    EXPECT_STREQ(getSpecies(ParticleType::PION_NEUTRAL).name, "Pion (0)") << "The registry name of PION_NEUTRAL is not as expected.";
+}
+
 // Testing resetForce()
 TEST_F(ParticleTest, resetForceSetsForceToZero) {
     p1->force[0] = 10.0; // Set a non-zero force.
@@ -0,0 +1,229 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/run-driver.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "run-driver.h"
+#include "metrics.h"
+#include "snapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <gtest/gtest.h>
+
+// Test fixture for the run driver functions
+class RunDriverTest : public ::testing::Test {
+protected:
+    // Writes text to a file in the test's temporary directory and returns its path.
+    static std::string writeFile(const std::string& name, const std::string& text) {
+        const std::string path = ::testing::TempDir() + name;
+        std::ofstream(path) << text;
+        return path;
+    }
+};
+
+// Testing setRunOption()
+TEST_F(RunDriverTest, setRunOptionSetsEveryField) {
+    RunConfig config;
+    std::string error;
+    const char* options[][2] = {{"events", "3"}, {"steps", "7"}, {"dt", "2.5e-13"}, {"multiplicity", "50"}, {"solver", "particle-mesh"},
+                                {"integrator", "euler"}, {"theta", "0.3"}, {"cutoff", "2e-3"}, {"skin", "1e-4"}, {"threads", "2"},
+                                {"seed", "42"}, {"output", "run.snap"}, {"snapshot-every", "4"}, {"progress-every", "0"},
+                                {"metrics", "run.json"}, {"metrics-every", "1.5"}, {"interaction", "yukawa"}, {"range", "5e-4"},
+                                {"precision", "mixed"}, {"mesh", "64"}, {"p3m-cells", "5"}, {"assignment", "cic"},
+                                {"analysis", "spectra.json"}, {"analysis-every", "3"}, {"trace", "run.trace.json"}};
+    for (const auto& option : options) {
+        EXPECT_TRUE(setRunOption(config, option[0], option[1], error)) << "Option " << option[0] << " was rejected: " << error;
+    }
+    EXPECT_EQ(config.events, 3u) << "events was not set.";
+    EXPECT_EQ(config.steps, 7u) << "steps was not set.";
+    EXPECT_DOUBLE_EQ(config.deltaTime, 2.5e-13) << "dt was not set.";
+    EXPECT_DOUBLE_EQ(config.multiplicity, 50.0) << "multiplicity was not set.";
+    EXPECT_EQ(config.solver, ForceSolver::PARTICLE_MESH) << "solver was not set.";
+    EXPECT_EQ(config.integrator, Integrator::EULER) << "integrator was not set.";
+    EXPECT_DOUBLE_EQ(config.openingAngle, 0.3) << "theta was not set.";
+    EXPECT_DOUBLE_EQ(config.cutoff, 2e-3) << "cutoff was not set.";
+    EXPECT_DOUBLE_EQ(config.skin, 1e-4) << "skin was not set.";
+    EXPECT_EQ(config.threads, 2u) << "threads was not set.";
+    EXPECT_EQ(config.seed, 42u) << "seed was not set.";
+    EXPECT_EQ(config.output, "run.snap") << "output was not set.";
+    EXPECT_EQ(config.snapshotInterval, 4u) << "snapshot-every was not set.";
+    EXPECT_EQ(config.progressInterval, 0u) << "progress-every was not set.";
+    EXPECT_EQ(config.metricsPath, "run.json") << "metrics was not set.";
+    EXPECT_DOUBLE_EQ(config.metricsInterval, 1.5) << "metrics-every was not set.";
+    EXPECT_EQ(config.interaction, InteractionModel::YUKAWA) << "interaction was not set.";
+    EXPECT_DOUBLE_EQ(config.range, 5e-4) << "range was not set.";
+    EXPECT_EQ(config.precision, ForcePrecision::MIXED) << "precision was not set.";
+    EXPECT_EQ(config.meshSize, 64u) << "mesh was not set.";
+    EXPECT_DOUBLE_EQ(config.correctionCells, 5.0) << "p3m-cells was not set.";
+    EXPECT_EQ(config.assignment, MeshAssignment::CIC) << "assignment was not set.";
+    EXPECT_EQ(config.analysisPath, "spectra.json") << "analysis was not set.";
+    EXPECT_EQ(config.analysisInterval, 3u) << "analysis-every was not set.";
+    EXPECT_EQ(config.tracePath, "run.trace.json") << "trace was not set.";
+}
+
+// Testing setRunOption()
+TEST_F(RunDriverTest, setRunOptionRejectsBadValues) {
+    const char* options[][2] = {{"events", "0"}, {"steps", "-1"}, {"steps", "1.5"}, {"dt", "0"}, {"dt", "abc"}, {"dt", "1e-12x"},
+                                {"dt", "inf"}, {"solver", "fmm"}, {"integrator", "rk4"}, {"seed", "4294967296"},
+                                {"snapshot-every", "0"}, {"cutoff", "-1"}, {"theta", "1.5"}, {"interaction", "gravity"}, {"range", "0"},
+                                {"precision", "half"}, {"mesh", "0"}, {"mesh", "1024"}, {"p3m-cells", "-2"}, {"assignment", "ngp"}, {"analysis-every", "0"},
+                                {"colour", "blue"}};
+    for (const auto& option : options) {
+        RunConfig config;
+        std::string error;
+        EXPECT_FALSE(setRunOption(config, option[0], option[1], error)) << "Option " << option[0] << " = " << option[1] << " should be rejected.";
+        EXPECT_FALSE(error.empty()) << "Rejecting " << option[0] << " = " << option[1] << " should explain why.";
+    }
+}
+
+// Testing loadRunConfigFile()
+TEST_F(RunDriverTest, loadRunConfigFileAppliesKeyValueLines) {
+    const std::string path = writeFile("run-driver.cfg", "# A sweep point\n\nsteps = 20\n  solver=all-pairs  # exact forces\nseed = 7\n");
+    RunConfig config;
+    std::string error;
+    ASSERT_TRUE(loadRunConfigFile(path, config, error)) << "The config file was rejected: " << error;
+    EXPECT_EQ(config.steps, 20u) << "steps was not read from the file.";
+    EXPECT_EQ(config.solver, ForceSolver::ALL_PAIRS) << "A line with surrounding spaces and a comment was not read.";
+    EXPECT_EQ(config.seed, 7u) << "seed was not read from the file.";
+    EXPECT_EQ(config.events, 1u) << "Keys missing from the file should keep their defaults.";
+    std::remove(path.c_str());
+}
+
+// Testing loadRunConfigFile()
+TEST_F(RunDriverTest, loadRunConfigFileReportsTheBadLine) {
+    const std::string path = writeFile("run-driver-bad.cfg", "steps = 20\nsolver barnes-hut\n");
+    RunConfig config;
+    std::string error;
+    EXPECT_FALSE(loadRunConfigFile(path, config, error)) << "A line without '=' should be rejected.";
+    EXPECT_NE(error.find(":2:"), std::string::npos) << "The error should name line 2, but was: " << error;
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(loadRunConfigFile(::testing::TempDir() + "missing.cfg", config, error)) << "A missing file should be rejected.";
+}
+
+// Testing parseRunArguments()
+TEST_F(RunDriverTest, parseRunArgumentsAppliesOptionsInOrder) {
+    const std::string path = writeFile("run-driver-args.cfg", "steps = 20\nthreads = 4\n");
+    const std::string configArgument = "--config=" + path;
+    const char* argv[] = {"app", "--steps", "5", configArgument.c_str(), "--threads=1", "--solver", "cell-list"};
+    RunConfig config;
+    bool showHelp = true;
+    std::string error;
+    ASSERT_TRUE(parseRunArguments(7, argv, config, showHelp, error)) << "The arguments were rejected: " << error;
+    EXPECT_FALSE(showHelp) << "No help was asked for.";
+    EXPECT_EQ(config.steps, 20u) << "The config file should override the options before it.";
+    EXPECT_EQ(config.threads, 1u) << "Options after the config file should override it.";
+    EXPECT_EQ(config.solver, ForceSolver::CELL_LIST) << "A separate option value was not read.";
+    std::remove(path.c_str());
+}
+
+// Testing parseRunArguments()
+TEST_F(RunDriverTest, parseRunArgumentsHandlesHelpAndErrors) {
+    RunConfig config;
+    bool showHelp = false;
+    std::string error;
+    const char* help[] = {"app", "--help"};
+    EXPECT_TRUE(parseRunArguments(2, help, config, showHelp, error)) << "--help should be accepted.";
+    EXPECT_TRUE(showHelp) << "--help should ask for the usage text.";
+
+    const char* missingValue[] = {"app", "--steps"};
+    EXPECT_FALSE(parseRunArguments(2, missingValue, config, showHelp, error)) << "An option without a value should be rejected.";
+    const char* positional[] = {"app", "steps"};
+    EXPECT_FALSE(parseRunArguments(2, positional, config, showHelp, error)) << "A positional argument should be rejected.";
+    EXPECT_NE(getRunUsage().find("--snapshot-every"), std::string::npos) << "The usage text should list every option.";
+}
+
+// Testing getEventOutputPath()
+TEST_F(RunDriverTest, getEventOutputPathSuffixesEachEvent) {
+    EXPECT_EQ(getEventOutputPath("out/run.snap", 0, 1), "out/run.snap") << "A single event should write to the path itself.";
+    EXPECT_EQ(getEventOutputPath("out/run.snap", 2, 3), "out/run-event2.snap") << "The suffix goes before the extension.";
+    EXPECT_EQ(getEventOutputPath("out.d/run", 1, 3), "out.d/run-event1") << "A dot in a directory name is not an extension.";
+    EXPECT_EQ(getEventOutputPath("", 1, 3), "") << "No output stays no output.";
+}
+
+// Testing runSimulations()
+TEST_F(RunDriverTest, runSimulationsWritesEveryEventAndReportsProgress) {
+    RunConfig config;
+    config.events = 2;
+    config.steps = 6;
+    config.multiplicity = 200;
+    config.threads = 2;
+    config.snapshotInterval = 2;
+    config.progressInterval = 4;
+    config.output = ::testing::TempDir() + "run-driver.snap";
+    std::ostringstream log;
+    ASSERT_TRUE(runSimulations(config, log)) << "The run failed: " << log.str();
+
+    // Batches of 4 and 2 steps, with frames after steps 2, 4 and 6 of each event.
+    for (std::size_t event = 0; event < 2; ++event) {
+        const std::string path = getEventOutputPath(config.output, event, config.events);
+        SnapshotReader reader;
+        ASSERT_TRUE(reader.open(path)) << "Event " << event << " wrote no snapshot file.";
+        ASSERT_EQ(reader.getFrameCount(), 3u) << "Event " << event << " should have one frame every two steps across the batches.";
+        EXPECT_DOUBLE_EQ(reader.getFrame(2).time, 6 * config.deltaTime) << "The last frame of event " << event << " has the wrong time.";
+        reader.close();
+        std::remove(path.c_str());
+    }
+    const std::string text = log.str();
+    EXPECT_NE(text.find("event 1/2  step 4/6"), std::string::npos) << "A progress line is missing:\n" << text;
+    EXPECT_NE(text.find("event 2/2  step 6/6"), std::string::npos) << "A progress line is missing:\n" << text;
+    EXPECT_NE(text.find("finished 2 event(s)"), std::string::npos) << "The summary line is missing:\n" << text;
+
+    config.output = ::testing::TempDir() + "no-such-directory/run.snap";
+    EXPECT_FALSE(runSimulations(config, log)) << "An unwritable output path should fail the run.";
+}
+
+// Testing runSimulations()
+TEST_F(RunDriverTest, runSimulationsWritesTheAnalysis) {
+    RunConfig config;
+    config.events = 2;
+    config.steps = 6;
+    config.multiplicity = 200;
+    config.threads = 2;
+    config.progressInterval = 0;
+    config.analysisInterval = 3;
+    config.analysisPath = ::testing::TempDir() + "run-driver-analysis.json";
+    std::ostringstream log;
+    ASSERT_TRUE(runSimulations(config, log)) << "The run failed: " << log.str();
+
+    std::ifstream file(config.analysisPath);
+    ASSERT_TRUE(file.good()) << "The run wrote no analysis file.";
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(text.find("{\"events\":2,\"fills\":4,"), 0u) << "Two events with fills after steps 3 and 6 should be recorded:\n" << text.substr(0, 80);
+    EXPECT_NE(text.find("\"rapidity\":{"), std::string::npos) << "The analysis file should hold the rapidity spectra.";
+    std::remove(config.analysisPath.c_str());
+
+    config.analysisPath = ::testing::TempDir() + "no-such-directory/spectra.json";
+    EXPECT_FALSE(runSimulations(config, log)) << "An unwritable analysis path should fail the run.";
+    EXPECT_NE(log.str().find("error: writing analysis file"), std::string::npos) << "The failure should be reported.";
+}
+
+// Testing runSimulations()
+TEST_F(RunDriverTest, runSimulationsWritesTheChromeTrace) {
+    RunConfig config;
+    config.steps = 4;
+    config.multiplicity = 200;
+    config.threads = 2;
+    config.progressInterval = 0;
+    config.tracePath = ::testing::TempDir() + "run-driver-trace.json";
+    std::ostringstream log;
+    ASSERT_TRUE(runSimulations(config, log)) << "The run failed: " << log.str();
+
+    std::ifstream file(config.tracePath);
+    ASSERT_TRUE(file.good()) << "The run wrote no trace file.";
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(text.find("{\"traceEvents\":["), 0u) << "The trace file should hold Chrome trace events:\n" << text.substr(0, 80);
+    if (areMetricsEnabled()) {
+        EXPECT_NE(text.find("\"name\":\"forces\",\"ph\":\"X\""), std::string::npos) << "The trace should record the force phases.";
+    }
+    std::remove(config.tracePath.c_str());
+
+    config.tracePath = ::testing::TempDir() + "no-such-directory/run.trace.json";
+    EXPECT_FALSE(runSimulations(config, log)) << "An unwritable trace path should fail the run.";
+    EXPECT_NE(log.str().find("error: writing trace file"), std::string::npos) << "The failure should be reported.";
+}
@@ -9,8 +9,14 @@
 
 #include "simulation.h"
 #include "particle.h"
+#include "snapshot.h"
+#include "checkpoint.h"
 #include <gtest/gtest.h>
 #include <memory>
+#include <cmath>
+#include <random>
+#include <cstdio>
+#include <unordered_map>
 
 // Test fixture for the Simulation class
 class SimulationTest : public ::testing::Test {
@@ -22,6 +28,19 @@ protected:
         simulation = std::make_unique<Simulation>();
     }
 
+    // Fills a simulation with count charged particles scattered randomly inside a unit cube.
+    static void scatterParticles(Simulation& sim, size_t count, unsigned seed) {
+        std::default_random_engine engine(seed);
+        std::uniform_real_distribution<double> positionDist(-1.0, 1.0);
+        for (size_t i = 0; i < count; ++i) {
+            double charge = (i % 2 == 0) ? +1.0 : -1.0;
+            sim.createParticle(ParticleType::PROTON, 0.93827, charge, 0.0, 0.0, 0.0, 0.0);
+            sim.particles.x[i] = positionDist(engine);
+            sim.particles.y[i] = positionDist(engine);
+            sim.particles.z[i] = positionDist(engine);
+        }
+    }
+
 };
 
 TEST_F(SimulationTest, Initialization) {
@@ -78,7 +97,388 @@ TEST_F(SimulationTest, computeForcesNoCrash) {
 
 // Testing computeForces()
 TEST_F(SimulationTest, computeForcesComputesAsExpected) {
-    // TODO
+    // Place the particles from the Particle tests and compare with pairwise addForce() calls.
+    Particle p2(ParticleType::PROTON, 0.938, +1.0, 0.0, 1.0, 0.0, 0.0);
+    Particle p3(ParticleType::KAON_POSITIVE, 0.493, +1.0, 1.24e-8, 0.0, 0.0, 0.0);
+    Particle p4(ParticleType::PION_NEGATIVE, 0.13957, -1.0, 2.6e-8, -1.0, 0.0, 0.0);
+    simulation->particles.push_back(p2);
+    simulation->particles.push_back(p3);
+    simulation->particles.push_back(p4);
+    p2.addForce(p3);
+    p2.addForce(p4);
+    p3.addForce(p4);
+
+    simulation->computeForces();
+    EXPECT_NEAR(simulation->particles.fx[0], p2.force[0], 1e-12 * std::abs(p2.force[0])) << "computeForces() did not match addForce() for particle 0.";
+    EXPECT_NEAR(simulation->particles.fx[1], p3.force[0], 1e-12 * std::abs(p3.force[0])) << "computeForces() did not match addForce() for particle 1.";
+    EXPECT_NEAR(simulation->particles.fx[2], p4.force[0], 1e-12 * std::abs(p4.force[0])) << "computeForces() did not match addForce() for particle 2.";
+
+    // Calling computeForces() again must not accumulate on top of the previous result.
+    simulation->computeForces();
+    EXPECT_NEAR(simulation->particles.fx[0], p2.force[0], 1e-12 * std::abs(p2.force[0])) << "computeForces() accumulated forces across calls.";
+}
+
+// Testing computeForces()
+TEST_F(SimulationTest, computeForcesMatchesPairwiseAddForceForManyParticles) {
+    // 600 particles span three tiles, so the round-robin schedule needs a bye block.
+    const size_t count = 600;
+    scatterParticles(*simulation, count, 7);
+    std::vector<Particle> reference;
+    for (size_t i = 0; i < count; ++i) {
+        reference.push_back(simulation->particles.get(i));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = i + 1; j < count; ++j) {
+            reference[i].addForce(reference[j]);
+        }
+    }
+
+    simulation->setThreadCount(3);
+    simulation->computeForces();
+    for (size_t i = 0; i < count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            double expected = reference[i].force[axis];
+            EXPECT_NEAR(simulation->particles[i].force[axis], expected, 1e-9 * std::abs(expected) + 1e-3) << "computeForces() did not match addForce() for particle " << i << " along axis " << axis;
+        }
+    }
+}
+
+// Testing computeForces()
+TEST_F(SimulationTest, computeForcesIsIndependentOfThreadCount) {
+    Simulation serial, parallel;
+    scatterParticles(serial, 1000, 11);
+    scatterParticles(parallel, 1000, 11);
+    serial.setThreadCount(1);
+    parallel.setThreadCount(4);
+    serial.computeForces();
+    parallel.computeForces();
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(serial.particles.fx[i], parallel.particles.fx[i]) << "Force on particle " << i << " depends on the thread count.";
+        EXPECT_EQ(serial.particles.fy[i], parallel.particles.fy[i]) << "Force on particle " << i << " depends on the thread count.";
+        EXPECT_EQ(serial.particles.fz[i], parallel.particles.fz[i]) << "Force on particle " << i << " depends on the thread count.";
+    }
+}
+
+// Returns the root-mean-square force error of a simulation relative to the root-mean-square exact force.
+static double relativeForceError(const Simulation& approximate, const Simulation& exact) {
+    double errorSum = 0.0, forceSum = 0.0;
+    for (size_t i = 0; i < exact.particles.size(); ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            double difference = approximate.particles[i].force[axis] - exact.particles[i].force[axis];
+            errorSum += difference * difference;
+            forceSum += exact.particles[i].force[axis] * exact.particles[i].force[axis];
+        }
+    }
+    return std::sqrt(errorSum / forceSum);
+}
+
+// Testing computeForces()
+// A velocity Verlet step leaves current forces, but positions written directly afterwards must still be seen by computeForces().
+TEST_F(SimulationTest, computeForcesRecomputesAfterDirectWrites) {
+    scatterParticles(*simulation, 50, 3);
+    simulation->setIntegrator(Integrator::VELOCITY_VERLET);
+    simulation->computeForces();
+    simulation->updateParticles(1e-12);
+    simulation->particles.x[0] += 0.5;
+    simulation->computeForces();
+    Simulation fresh;
+    scatterParticles(fresh, 50, 3);
+    for (size_t i = 0; i < fresh.particles.size(); ++i) {
+        fresh.particles.x[i] = simulation->particles.x[i];
+        fresh.particles.y[i] = simulation->particles.y[i];
+        fresh.particles.z[i] = simulation->particles.z[i];
+    }
+    fresh.computeForces();
+    for (size_t i = 0; i < fresh.particles.size(); ++i) {
+        ASSERT_EQ(simulation->particles.fx[i], fresh.particles.fx[i]) << "computeForces() returned stale forces for particle " << i;
+    }
+}
+
+// Testing computeForces() with the Barnes-Hut solver
+TEST_F(SimulationTest, computeForcesBarnesHutWithZeroOpeningAngleIsExact) {
+    Simulation exact, tree;
+    scatterParticles(exact, 700, 5);
+    scatterParticles(tree, 700, 5);
+    tree.setForceSolver(ForceSolver::BARNES_HUT);
+    tree.setOpeningAngle(0.0);
+    exact.computeForces();
+    tree.computeForces();
+    EXPECT_LT(relativeForceError(tree, exact), 1e-12) << "Barnes-Hut with theta = 0 should reduce to the exact pairwise sum.";
+}
+
+// Testing computeForces() with the Barnes-Hut solver
+TEST_F(SimulationTest, computeForcesBarnesHutErrorShrinksWithOpeningAngle) {
+    Simulation exact;
+    scatterParticles(exact, 2000, 9);
+    exact.computeForces();
+
+    double previousError = 1.0;
+    for (double theta : {0.8, 0.5, 0.3}) {
+        Simulation tree;
+        scatterParticles(tree, 2000, 9);
+        tree.setForceSolver(ForceSolver::BARNES_HUT);
+        tree.setOpeningAngle(theta);
+        tree.computeForces();
+        double error = relativeForceError(tree, exact);
+        EXPECT_LT(error, previousError) << "Barnes-Hut error did not shrink when theta was lowered to " << theta;
+        EXPECT_LT(error, 0.05) << "Barnes-Hut error is too large for theta = " << theta;
+        previousError = error;
+    }
+}
+
+// Testing setOpeningAngle()
+// Two particles sit at opposite corners of the root cell, sqrt(3)/2 cell sizes from its center. Above an opening angle of 2/sqrt(3) the
+// root cell would be accepted for both, and each particle would feel its own charge through the cell's expansion; clamping the angle
+// to 1 keeps the root cell open, so the forces stay exact.
+TEST_F(SimulationTest, setOpeningAngleAboveOneIsClampedSoNoParticleFeelsItself) {
+    Simulation exact, tree;
+    for (Simulation* sim : {&exact, &tree}) {
+        sim->createParticle(ParticleType::PROTON, 0.93827, +1.0, 0.0, 0.0, 0.0, 0.0);
+        sim->createParticle(ParticleType::PROTON, 0.93827, -1.0, 0.0, 0.0, 0.0, 0.0);
+        sim->particles.x[1] = sim->particles.y[1] = sim->particles.z[1] = 1e-3;
+    }
+    tree.setForceSolver(ForceSolver::BARNES_HUT);
+    tree.setOpeningAngle(1.5);
+    exact.computeForces();
+    tree.computeForces();
+    EXPECT_LT(relativeForceError(tree, exact), 1e-12) << "An opening angle above 1 let a cell act on a particle inside it.";
+}
+
+// Testing setForcePrecision()
+TEST_F(SimulationTest, setForcePrecisionMixedMatchesDoubleForcesFarFromTheOrigin) {
+    // The cloud sits 100 m from the coordinate origin, where a float coordinate is only good to about 1e-5 m; the block origins keep the
+    // separations accurate anyway. Every fifth particle is neutral, so the charged particles are gathered into compact columns first.
+    Simulation exact, mixed;
+    for (Simulation* sim : {&exact, &mixed}) {
+        scatterParticles(*sim, 700, 13);
+        for (size_t i = 0; i < sim->particles.size(); ++i) {
+            sim->particles.x[i] += 100.0;
+            sim->particles.charge[i] = (i % 5 == 0) ? 0.0 : sim->particles.charge[i];
+        }
+        sim->setThreadCount(3);
+    }
+    mixed.setForcePrecision(ForcePrecision::MIXED);
+    EXPECT_EQ(mixed.getForcePrecision(), ForcePrecision::MIXED) << "setForcePrecision() did not select mixed precision.";
+    exact.computeForces();
+    mixed.computeForces();
+    EXPECT_LT(relativeForceError(mixed, exact), 1e-5) << "Mixed-precision forces should match the double forces to single precision.";
+    EXPECT_GT(relativeForceError(mixed, exact), 0.0) << "Mixed precision did not run the float kernels.";
+    for (size_t i = 0; i < mixed.particles.size(); i += 5) {
+        EXPECT_EQ(mixed.particles.fx[i], 0.0) << "A neutral particle should feel no force in mixed precision.";
+    }
+}
+
+// Returns the potential energy of a simulation: -k q_i q_j / sqrt(r^2 + softening) summed over every pair, the potential whose negative
+// gradient is the force of Particle::addForce() (which pulls particle i towards j for a positive product of charges).
+static double potentialEnergy(const Simulation& sim) {
+    const ParticleStore& p = sim.particles;
+    double potential = 0.0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        for (size_t j = i + 1; j < p.size(); ++j) {
+            const double dx = p.x[j] - p.x[i], dy = p.y[j] - p.y[i], dz = p.z[j] - p.z[i];
+            potential -= coulombConstant * p.charge[i] * p.charge[j] / std::sqrt(dx*dx + dy*dy + dz*dz + forceSoftening);
+        }
+    }
+    return potential;
+}
+
+// Testing setForcePrecision()
+TEST_F(SimulationTest, setForcePrecisionMixedKeepsTheEnergyDriftOfDouble) {
+    // A cloud of like charges 0.1 mm across, far from the coordinate origin, contracts under its own pull and turns part of its potential
+    // energy into kinetic energy. Velocity Verlet conserves the total energy up to its truncation error, and mixed precision must not add a
+    // drift of its own on top of it. The charges start at rest on a jittered 8 x 8 x 8 lattice; drifts are measured in units of the
+    // initial potential energy.
+    const size_t side = 8;
+    const double spacing = 1.25e-5, offset = 10.0;
+    Simulation reference, mixed;
+    for (Simulation* sim : {&reference, &mixed}) {
+        sim->setThreadCount(2);
+        sim->setIntegrator(Integrator::VELOCITY_VERLET);
+        std::default_random_engine engine(21);
+        std::uniform_real_distribution<double> jitterDist(-0.2 * spacing, 0.2 * spacing);
+        for (size_t i = 0; i < side * side * side; ++i) {
+            sim->createParticle(ParticleType::PROTON, 0.93827, +1.0, 0.0, 0.0, 0.0, 0.0);
+            sim->particles.x[i] = offset + spacing * static_cast<double>(i % side) + jitterDist(engine);
+            sim->particles.y[i] = offset + spacing * static_cast<double>(i / side % side) + jitterDist(engine);
+            sim->particles.z[i] = offset + spacing * static_cast<double>(i / (side * side)) + jitterDist(engine);
+        }
+    }
+    mixed.setForcePrecision(ForcePrecision::MIXED);
+
+    const double initialEnergy = potentialEnergy(reference);
+    ASSERT_DOUBLE_EQ(potentialEnergy(mixed), initialEnergy) << "Both runs should start from the same state.";
+    for (int step = 0; step < 300; ++step) {
+        reference.updateParticles(5e-15);
+        mixed.updateParticles(5e-15);
+    }
+    auto drift = [&](const Simulation& sim) {
+        return std::abs(sim.getObservables().kineticEnergy + potentialEnergy(sim) - initialEnergy) / std::abs(initialEnergy);
+    };
+    const double referenceDrift = drift(reference);
+    const double mixedDrift = drift(mixed);
+    const double kineticFraction = reference.getObservables().kineticEnergy / std::abs(initialEnergy);
+    EXPECT_GT(kineticFraction, 0.1) << "The cloud did not contract enough for the test to mean anything.";
+    EXPECT_LT(referenceDrift, 1e-3) << "The double-precision run does not conserve energy, so it is no reference.";
+    EXPECT_LT(mixedDrift, referenceDrift + 1e-5) << "Mixed precision drifts by " << mixedDrift << " of the energy, against " << referenceDrift << " in double.";
+    EXPECT_NEAR(mixed.getObservables().kineticEnergy, reference.getObservables().kineticEnergy, 1e-5 * reference.getObservables().kineticEnergy)
+        << "Mixed precision should follow the double-precision trajectory.";
+}
+
+// Testing computeForces() with the cell-list solver
+TEST_F(SimulationTest, computeForcesCellListMatchesPairsWithinCutoff) {
+    const size_t count = 800;
+    const double cutoff = 0.3;
+    scatterParticles(*simulation, count, 13);
+    std::vector<Particle> reference;
+    for (size_t i = 0; i < count; ++i) {
+        reference.push_back(simulation->particles.get(i));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = i + 1; j < count; ++j) {
+            double dx = reference[j].position[0] - reference[i].position[0];
+            double dy = reference[j].position[1] - reference[i].position[1];
+            double dz = reference[j].position[2] - reference[i].position[2];
+            if (dx*dx + dy*dy + dz*dz < cutoff * cutoff) {
+                reference[i].addForce(reference[j]);
+            }
+        }
+    }
+
+    // A cell size below the cutoff makes the stencil reach two cells.
+    simulation->setForceSolver(ForceSolver::CELL_LIST);
+    simulation->setCutoff(cutoff, 0.2);
+    simulation->computeForces();
+    for (size_t i = 0; i < count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            double expected = reference[i].force[axis];
+            EXPECT_NEAR(simulation->particles[i].force[axis], expected, 1e-9 * std::abs(expected) + 1e-3) << "Cell-list force on particle " << i << " does not match the pairs within the cutoff.";
+        }
+    }
+}
+
+// Testing computeForces() with the particle-mesh solver
+// The mesh only solves the Coulomb law, so the other force laws run on the Barnes-Hut solver instead of being dropped.
+TEST_F(SimulationTest, computeForcesParticleMeshRunsOtherLawsOnBarnesHut) {
+    Simulation mesh, tree;
+    scatterParticles(mesh, 400, 29);
+    scatterParticles(tree, 400, 29);
+    InteractionSettings yukawa;
+    yukawa.model = InteractionModel::YUKAWA;
+    yukawa.range = 0.5;
+    for (Simulation* sim : {&mesh, &tree}) {
+        sim->setInteraction(yukawa);
+    }
+    mesh.setForceSolver(ForceSolver::PARTICLE_MESH);
+    tree.setForceSolver(ForceSolver::BARNES_HUT);
+    mesh.computeForces();
+    tree.computeForces();
+    bool anyForce = false;
+    for (size_t i = 0; i < 400; ++i) {
+        ASSERT_EQ(mesh.particles.fx[i], tree.particles.fx[i]) << "The screened force on particle " << i << " should come from the Barnes-Hut solver.";
+        anyForce = anyForce || mesh.particles.fx[i] != 0.0;
+    }
+    EXPECT_TRUE(anyForce) << "The screened forces were dropped.";
+}
+
+// Testing the solvers' computeForcesOn() (used by block timesteps)
+// Every solver gives a flagged particle the same force as a full evaluation and leaves the other particles' forces alone.
+TEST_F(SimulationTest, computeForcesOnMatchesFullEvaluationForTargets) {
+    const size_t count = 600;
+    scatterParticles(*simulation, count, 23);
+    std::vector<std::uint8_t> isTarget(count, 0);
+    for (size_t i = 0; i < count; i += 7) {
+        isTarget[i] = 1;
+    }
+    ThreadPool pool(2);
+
+    auto check = [&](auto& solver, const char* name, double tolerance) {
+        ParticleStore full = simulation->particles;
+        ParticleStore subset = simulation->particles;
+        full.resetForces();
+        subset.resetForces();
+        solver.computeForces(full, pool);
+        solver.computeForcesOn(subset, isTarget, pool);
+        for (size_t i = 0; i < count; ++i) {
+            if (isTarget[i]) {
+                EXPECT_NEAR(subset.fx[i], full.fx[i], tolerance * std::abs(full.fx[i]) + 1e-3) << name << ": force on flagged particle " << i << " differs from the full evaluation.";
+            } else {
+                EXPECT_EQ(subset.fx[i], 0.0) << name << ": particle " << i << " is not flagged but received a force.";
+            }
+        }
+    };
+    AllPairsSolver allPairs;
+    BarnesHutSolver barnesHut;
+    CellListSolver cellList;
+    cellList.cutoff = 0.4;
+    check(allPairs, "All pairs", 1e-9);
+    check(barnesHut, "Barnes-Hut", 1e-12);
+    check(cellList, "Cell list", 1e-12);
+}
+
+// Testing setCutoff()
+TEST_F(SimulationTest, setCutoffIgnoresInvalidValues) {
+    Simulation reference, guarded;
+    scatterParticles(reference, 800, 17);
+    scatterParticles(guarded, 800, 17);
+    reference.setForceSolver(ForceSolver::CELL_LIST);
+    guarded.setForceSolver(ForceSolver::CELL_LIST);
+    reference.setCutoff(0.3, 0.1);
+    guarded.setCutoff(0.3, 0.1);
+    guarded.setCutoff(-1.0);
+    guarded.setCutoff(0.0);
+    guarded.setCutoff(std::nan(""));
+    guarded.setCutoff(HUGE_VAL);
+    guarded.setCutoff(0.5, -0.1);
+    guarded.setCutoff(0.5, std::nan(""));
+    reference.computeForces();
+    guarded.computeForces();
+    for (size_t i = 0; i < 800; ++i) {
+        ASSERT_EQ(guarded.particles.fx[i], reference.particles.fx[i]) << "An invalid cutoff or cell size changed the force on particle " << i << ".";
+    }
+}
+
+// Testing computeForces() with the cell-list solver and a Verlet neighbor list
+TEST_F(SimulationTest, computeForcesNeighborListIsReusedWithinSkin) {
+    Simulation grid, list;
+    scatterParticles(grid, 800, 17);
+    scatterParticles(list, 800, 17);
+    grid.setForceSolver(ForceSolver::CELL_LIST);
+    list.setForceSolver(ForceSolver::CELL_LIST);
+    grid.setCutoff(0.3);
+    list.setCutoff(0.3);
+    list.setNeighborListSkin(0.1);
+
+    for (int step = 0; step < 3; ++step) {
+        // Move every particle by less than half the skin, so the list built in the first step stays valid.
+        for (size_t i = 0; i < 800; ++i) {
+            double shift = 0.01 * ((i % 7) - 3.0) / 3.0;
+            grid.particles.x[i] += shift;
+            list.particles.x[i] += shift;
+        }
+        grid.computeForces();
+        list.computeForces();
+        for (size_t i = 0; i < 800; ++i) {
+            EXPECT_NEAR(list.particles.fx[i], grid.particles.fx[i], 1e-9 * std::abs(grid.particles.fx[i]) + 1e-3) << "Neighbor-list force on particle " << i << " differs from the grid in step " << step;
+        }
+    }
+}
+
+// Testing CellListSolver's neighbor-list bookkeeping
+TEST_F(SimulationTest, computeForcesNeighborListRebuildsOnlyAfterLargeMoves) {
+    scatterParticles(*simulation, 200, 19);
+    CellListSolver solver;
+    ThreadPool pool(1);
+    solver.cutoff = 0.3;
+    solver.skin = 0.1;
+
+    solver.computeForces(simulation->particles, pool);
+    simulation->particles.x[0] += 0.04; // Less than skin / 2: the list stays valid.
+    solver.computeForces(simulation->particles, pool);
+    EXPECT_EQ(solver.getNeighborListBuildCount(), 1u) << "The neighbor list was rebuilt although no particle moved more than skin / 2.";
+
+    simulation->particles.x[0] += 0.04; // Now 0.08 from the reference position, more than skin / 2.
+    solver.computeForces(simulation->particles, pool);
+    EXPECT_EQ(solver.getNeighborListBuildCount(), 2u) << "The neighbor list was not rebuilt after a particle moved more than skin / 2.";
 }
 
 // Testing updateParticles()
@@ -109,6 +509,169 @@ TEST_F(SimulationTest, updateParticlesUpdatesPositionsBasedOnForce) {
     // TODO
 }
 
+// Testing getObservables()
+TEST_F(SimulationTest, getObservablesMatchesFullScanAfterStepsAndDecays) {
+    for (Integrator scheme : {Integrator::EULER, Integrator::LEAPFROG, Integrator::VELOCITY_VERLET, Integrator::BLOCK_VERLET}) {
+        Simulation sim;
+        sim.setThreadCount(1);
+        sim.setIntegrator(scheme);
+        EventConfig config;
+        config.meanMultiplicity = 300;
+        config.poissonMultiplicity = false;
+        config.speciesWeights = {0.2, 0.2, 0.2, 0.2, 0.2, 0.0}; // Plenty of kaons, so there are decays.
+        sim.generateEvent(EventGenerator(config));
+        sim.createParticle(ParticleType::KAON_NEGATIVE);
+        for (int step = 0; step < 5; ++step) {
+            sim.computeForces();
+            sim.updateParticles(5e-9);
+        }
+        ASSERT_GT(sim.getDecayCount(), 0u) << "No particle decayed, so the test did not exercise the decay bookkeeping.";
+
+        const Observables kept = sim.getObservables();
+        const Observables measured = measureObservables(sim.particles);
+        EXPECT_EQ(kept.count, measured.count) << "The particle count drifted for scheme " << static_cast<int>(scheme) << ".";
+        EXPECT_NEAR(kept.totalCharge, measured.totalCharge, 1e-9) << "The total charge drifted for scheme " << static_cast<int>(scheme) << ".";
+        EXPECT_NEAR(kept.totalLifetime, measured.totalLifetime, 1e-9 * measured.totalLifetime) << "The total lifetime drifted for scheme " << static_cast<int>(scheme) << ".";
+        EXPECT_NEAR(kept.kineticEnergy, measured.kineticEnergy, 1e-9 * measured.kineticEnergy) << "The kinetic energy drifted for scheme " << static_cast<int>(scheme) << ".";
+        for (int axis = 0; axis < 3; ++axis) {
+            EXPECT_NEAR(kept.momentum[axis], measured.momentum[axis], 1e-9 * std::abs(measured.momentum[axis]) + 1e-12) << "Momentum component " << axis << " drifted for scheme " << static_cast<int>(scheme) << ".";
+        }
+    }
+}
+
+// Testing getObservables()
+TEST_F(SimulationTest, getObservablesOnlyChangesOnRefreshAfterDirectWrites) {
+    simulation->simulateCollision();
+    const Simulation& reader = *simulation;
+    const Observables before = reader.getObservables();
+    simulation->particles.push_back(Particle(ParticleType::PROTON, 0.93827, +1.0, 0.0, 0.0, 0.0, 0.0));
+    simulation->particles.charge[0] = -simulation->particles.charge[0];
+    EXPECT_EQ(reader.getObservables().count, before.count) << "A const read should not re-measure the observables.";
+    simulation->refreshObservables();
+    EXPECT_EQ(reader.getObservables().count, simulation->particles.size()) << "A particle added through the store was not counted.";
+    EXPECT_NEAR(reader.getObservables().totalCharge, measureObservables(simulation->particles).totalCharge, 1e-12)
+        << "The refresh missed a particle added or a charge changed through the store.";
+}
+
+// Testing getPositionView()
+TEST_F(SimulationTest, getPositionViewReadsTheColumnsWithoutCopying) {
+    simulation->simulateCollision();
+    const PositionView positions = simulation->getPositionView();
+    ASSERT_EQ(positions.size(), simulation->getParticleCount()) << "The view does not cover every particle.";
+    EXPECT_EQ(positions.x.data, simulation->particles.x.data()) << "The view does not point into the position column.";
+    simulation->updateParticles(0.1);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_EQ(positions.x[i], simulation->particles.x[i]) << "The view does not see the update of particle " << i << ".";
+    }
+}
+
+// Testing loadCheckpoint()
+TEST_F(SimulationTest, loadCheckpointContinuesBitIdentically) {
+    struct Setup {
+        Integrator scheme;
+        ForceSolver solver;
+        bool compress;
+    };
+    const Setup setups[] = {
+        {Integrator::VELOCITY_VERLET, ForceSolver::CELL_LIST, false},
+        {Integrator::LEAPFROG, ForceSolver::ALL_PAIRS, true},
+        {Integrator::BLOCK_VERLET, ForceSolver::BARNES_HUT, false},
+    };
+    const std::string path = ::testing::TempDir() + "simulation.ckpt";
+
+    for (const Setup& setup : setups) {
+        Simulation original;
+        original.setThreadCount(1);
+        original.setSeed(11);
+        original.setIntegrator(setup.scheme);
+        original.setForceSolver(setup.solver);
+        original.setCutoff(1e-6);
+        original.setNeighborListSkin(1e-6);
+        original.setForcePrecision(setup.solver == ForceSolver::ALL_PAIRS ? ForcePrecision::MIXED : ForcePrecision::DOUBLE);
+        EventConfig config;
+        config.meanMultiplicity = 200;
+        config.poissonMultiplicity = false;
+        config.speciesWeights = {0.2, 0.2, 0.2, 0.2, 0.2, 0.0};
+        original.generateEvent(EventGenerator(config));
+        for (int step = 0; step < 5; ++step) {
+            original.computeForces();
+            original.updateParticles(5e-9);
+        }
+        const bool compress = setup.compress && isCheckpointCompressionAvailable();
+        ASSERT_TRUE(original.saveCheckpoint(path, compress)) << "saveCheckpoint() failed for scheme " << static_cast<int>(setup.scheme) << ".";
+
+        Simulation restored;
+        restored.setThreadCount(1);
+        ASSERT_TRUE(restored.loadCheckpoint(path)) << "loadCheckpoint() failed for scheme " << static_cast<int>(setup.scheme) << ".";
+        EXPECT_EQ(restored.getForcePrecision(), original.getForcePrecision()) << "The force precision was not restored.";
+        for (Simulation* sim : {&original, &restored}) {
+            for (int step = 0; step < 5; ++step) {
+                sim->computeForces();
+                sim->updateParticles(5e-9);
+            }
+        }
+
+        ASSERT_GT(original.getDecayCount(), 0u) << "No particle decayed, so the test did not exercise the random number state.";
+        EXPECT_EQ(restored.getDecayCount(), original.getDecayCount()) << "The restored run decayed differently for scheme " << static_cast<int>(setup.scheme) << ".";
+        ASSERT_EQ(restored.particles.size(), original.particles.size()) << "The restored run has a different particle count.";
+        EXPECT_TRUE(restored.particles.id == original.particles.id) << "The restored run has different particle ids.";
+        EXPECT_TRUE(restored.particles.x == original.particles.x && restored.particles.vx == original.particles.vx &&
+                    restored.particles.fz == original.particles.fz)
+            << "The restored run is not bit-identical for scheme " << static_cast<int>(setup.scheme) << ".";
+        EXPECT_EQ(restored.getObservables().kineticEnergy, original.getObservables().kineticEnergy) << "The observables were not restored.";
+    }
+    std::remove(path.c_str());
+}
+
+// Testing loadCheckpoint()
+TEST_F(SimulationTest, loadCheckpointRejectsAMissingFile) {
+    EXPECT_FALSE(simulation->loadCheckpoint(::testing::TempDir() + "does-not-exist.ckpt")) << "loadCheckpoint() accepted a missing file.";
+}
+
+// Testing loadCheckpoint()
+TEST_F(SimulationTest, loadCheckpointRejectsDamagedValuesAndKeepsTheSimulation) {
+    Simulation source;
+    scatterParticles(source, 50, 3);
+    source.setForceSolver(ForceSolver::BARNES_HUT);
+    source.computeForces();
+    const std::string path = ::testing::TempDir() + "damaged-values.ckpt";
+    ASSERT_TRUE(source.saveCheckpoint(path)) << "saveCheckpoint() failed.";
+    std::vector<char> payload;
+    ASSERT_TRUE(readCheckpointFile(path, payload)) << "The checkpoint could not be read back.";
+
+    // The force solver follows the store, the seed and event ids and the step and decay counts; the force flag precedes the observables.
+    CheckpointWriter storeOnly;
+    source.particles.save(storeOnly);
+    const size_t solverOffset = storeOnly.getPayload().size() + 2 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t);
+    const size_t flagOffset = payload.size() - sizeof(Observables) - 1;
+    ASSERT_EQ(payload[solverOffset], static_cast<char>(ForceSolver::BARNES_HUT)) << "The force solver is not where the test expects it.";
+    ASSERT_EQ(payload[flagOffset], 1) << "The force flag is not where the test expects it.";
+
+    struct Damage {
+        size_t offset;
+        char value;
+        const char* what;
+    };
+    for (const Damage& damage : {Damage{solverOffset, 9, "an unknown force solver"}, Damage{flagOffset, 2, "a force flag that is not a bool"},
+                                 Damage{payload.size(), 0, "a payload cut short"}}) {
+        std::vector<char> damaged = payload;
+        if (damage.offset < damaged.size()) {
+            damaged[damage.offset] = damage.value;
+        } else {
+            damaged.resize(damaged.size() - 8);
+        }
+        ASSERT_TRUE(writeCheckpointFile(path, damaged, false));
+        Simulation target;
+        scatterParticles(target, 20, 5);
+        const double firstX = target.particles.x[0];
+        EXPECT_FALSE(target.loadCheckpoint(path)) << "loadCheckpoint() accepted " << damage.what << ".";
+        EXPECT_EQ(target.getParticleCount(), 20u) << "Rejecting " << damage.what << " replaced the particles.";
+        EXPECT_EQ(target.particles.x[0], firstX) << "Rejecting " << damage.what << " changed the positions.";
+        EXPECT_EQ(target.getObservables().count, 20u) << "Rejecting " << damage.what << " changed the observables.";
+    }
+    std::remove(path.c_str());
+}
+
 // Testing decayParticles() implicitly within updateParticles()
 TEST_F(SimulationTest, decayParticlesReducesLifetimeOrRemovesParticles) {
     simulation->simulateCollision();
@@ -121,12 +684,286 @@ TEST_F(SimulationTest, decayParticlesReducesLifetimeOrRemovesParticles) {
 
 // Testing decayParticles() implicitly within updateParticles()
 TEST_F(SimulationTest, decayParticlesSelectsValidDecayMode) {
-    // TODO
+    // Sweep the alias table of KAON_POSITIVE with evenly spaced random numbers. The branching ratios 0.63 and 0.21 normalize to 3:1.
+    const AliasTable& table = getDecayAliasTable(ParticleType::KAON_POSITIVE);
+    const int samples = 100000;
+    int pions = 0, neutralPions = 0;
+    for (int k = 0; k < samples; ++k) {
+        ParticleType product = table.sample((k + 0.5) / samples);
+        if (product == ParticleType::PION_POSITIVE) {
+            ++pions;
+        } else if (product == ParticleType::PION_NEUTRAL) {
+            ++neutralPions;
+        } else {
+            ADD_FAILURE() << "The alias table selected a product that is not a decay mode of KAON_POSITIVE.";
+        }
+    }
+    EXPECT_NEAR(pions / static_cast<double>(samples), 0.75, 1e-3) << "PION_POSITIVE was not selected in proportion to its branching ratio.";
+    EXPECT_NEAR(neutralPions / static_cast<double>(samples), 0.25, 1e-3) << "PION_NEUTRAL was not selected in proportion to its branching ratio.";
+    EXPECT_TRUE(getDecayAliasTable(ParticleType::PROTON).empty()) << "The stable PROTON should have no decay modes.";
 }
 
 // Testing decayParticles()
 TEST_F(SimulationTest, decayParticlesDecaysParticlesAsExpected) {
-    // TODO
+    // Over one mean lifetime, 1 - 1/e of the neutral pions decay. Their charged pion products live ~10^8 times longer and do not decay again.
+    const size_t count = 10000;
+    const double tau = 8.5e-17;
+    for (size_t i = 0; i < count; ++i) {
+        simulation->createParticle(ParticleType::PION_NEUTRAL, 0.13498, 0.0, tau, 0.0, 0.0, 0.0);
+    }
+    simulation->decayParticles(tau);
+
+    size_t neutral = 0, positive = 0, negative = 0;
+    for (const auto& particle : simulation->particles) {
+        if (particle.type == ParticleType::PION_NEUTRAL) ++neutral;
+        if (particle.type == ParticleType::PION_POSITIVE) ++positive;
+        if (particle.type == ParticleType::PION_NEGATIVE) ++negative;
+    }
+    EXPECT_EQ(simulation->getParticleCount(), count) << "Each decay should replace its parent with exactly one product.";
+    EXPECT_EQ(simulation->getDecayCount(), count - neutral) << "getDecayCount() does not match the number of decayed particles.";
+    EXPECT_NEAR(neutral / static_cast<double>(count), std::exp(-1.0), 0.02) << "The surviving fraction does not follow the exponential decay law.";
+    EXPECT_NEAR(positive / static_cast<double>(positive + negative), 0.5, 0.03) << "The products do not follow the 50/50 branching ratios.";
+    EXPECT_DOUBLE_EQ(simulation->particles.lifetime[count - 1], 2.6e-8) << "Products should be created with their species' lifetime.";
+}
+
+// Testing decayParticles()
+TEST_F(SimulationTest, decayParticlesDoesNotReallocateInSteadyState) {
+    for (size_t i = 0; i < 2000; ++i) {
+        simulation->createParticle(ParticleType::KAON_POSITIVE, 0.49367, +1.0, 1.24e-8, 0.0, 0.0, 0.0);
+    }
+    simulation->decayParticles(1e-9); // Warm-up step: sizes the scratch buffers and the store.
+    const double* columnBefore = simulation->particles.x.data();
+    for (int step = 0; step < 20; ++step) {
+        simulation->decayParticles(1e-9);
+    }
+    EXPECT_GT(simulation->getDecayCount(), 0u) << "No particle decayed, so the test did not exercise the decay path.";
+    EXPECT_EQ(simulation->particles.x.data(), columnBefore) << "A decay step reallocated the particle columns.";
+}
+
+// Testing startEvent()
+TEST_F(SimulationTest, startEventRunsTheNextEventLikeAFreshSimulation) {
+    EventConfig config;
+    config.meanMultiplicity = 500;
+    config.poissonMultiplicity = false;
+    const EventGenerator generator(config);
+    auto run = [&](Simulation& sim) {
+        sim.generateEvent(generator);
+        for (int step = 0; step < 3; ++step) {
+            sim.computeForces();
+            sim.updateParticles(1e-12);
+        }
+    };
+
+    Simulation reused;
+    reused.setThreadCount(1);
+    reused.setIntegrator(Integrator::LEAPFROG);
+    run(reused);
+    reused.startEvent(1);
+    run(reused);
+
+    Simulation fresh;
+    fresh.setThreadCount(1);
+    fresh.setIntegrator(Integrator::LEAPFROG);
+    fresh.setEventId(1);
+    run(fresh);
+    ASSERT_EQ(reused.particles.size(), fresh.particles.size()) << "Both simulations should hold the same event.";
+    EXPECT_EQ(reused.getDecayCount(), fresh.getDecayCount()) << "The decay count should restart with the event.";
+    for (size_t i = 0; i < fresh.particles.size(); ++i) {
+        ASSERT_EQ(reused.particles.id[i], fresh.particles.id[i]) << "Particle ids should restart with the event.";
+        ASSERT_EQ(reused.particles.x[i], fresh.particles.x[i]) << "Particle " << i << " should move exactly as in a fresh simulation.";
+        ASSERT_EQ(reused.particles.vz[i], fresh.particles.vz[i]) << "Particle " << i << " should move exactly as in a fresh simulation.";
+    }
+    EXPECT_EQ(reused.getObservables().count, fresh.getObservables().count) << "The observables should restart with the event.";
+}
+
+// Testing run()
+TEST_F(SimulationTest, runMatchesTheSerialStepLoop) {
+    EventConfig config;
+    config.meanMultiplicity = 4500; // Three chunks
+    config.poissonMultiplicity = false;
+    config.speciesWeights = {0.2, 0.2, 0.2, 0.2, 0.2, 0.0}; // Plenty of kaons, so there are decays.
+    for (ForceSolver solver : {ForceSolver::ALL_PAIRS, ForceSolver::BARNES_HUT, ForceSolver::CELL_LIST, ForceSolver::PARTICLE_MESH}) {
+        for (Integrator scheme : {Integrator::EULER, Integrator::LEAPFROG}) {
+            for (double skin : {0.0, 1e-4}) {
+                if (solver != ForceSolver::CELL_LIST && skin > 0.0) {
+                    continue;
+                }
+                Simulation serial, scheduled;
+                for (Simulation* sim : {&serial, &scheduled}) {
+                    sim->setThreadCount(sim == &serial ? 1 : 3);
+                    sim->setForceSolver(solver);
+                    sim->setIntegrator(scheme);
+                    sim->setCutoff(1e-3);
+                    sim->setNeighborListSkin(skin);
+                    sim->setParticleMesh(32, 5.0);
+                    sim->generateEvent(EventGenerator(config));
+                }
+                for (int step = 0; step < 3; ++step) {
+                    serial.computeForces();
+                    serial.updateParticles(5e-9);
+                }
+                scheduled.run(3, 5e-9);
+
+                const std::string label = "solver " + std::to_string(static_cast<int>(solver)) + ", integrator " +
+                                          std::to_string(static_cast<int>(scheme)) + ", skin " + std::to_string(skin);
+                ASSERT_GT(serial.getDecayCount(), 0u) << "No particle decayed, so the test did not exercise the decay tasks (" << label << ").";
+                EXPECT_EQ(scheduled.getDecayCount(), serial.getDecayCount()) << "The decays differ (" << label << ").";
+                ASSERT_EQ(scheduled.particles.size(), serial.particles.size()) << "The particle counts differ (" << label << ").";
+                for (size_t i = 0; i < serial.particles.size(); ++i) {
+                    ASSERT_EQ(scheduled.particles.id[i], serial.particles.id[i]) << "Particle " << i << " differs (" << label << ").";
+                    ASSERT_EQ(scheduled.particles.x[i], serial.particles.x[i]) << "Particle " << i << " moved differently (" << label << ").";
+                    ASSERT_EQ(scheduled.particles.vy[i], serial.particles.vy[i]) << "Particle " << i << " moved differently (" << label << ").";
+                }
+                const double energy = serial.getObservables().kineticEnergy;
+                EXPECT_NEAR(scheduled.getObservables().kineticEnergy, energy, 1e-12 * std::abs(energy))
+                    << "The kinetic energies differ by more than the chunked summation can explain (" << label << ").";
+            }
+        }
+    }
+}
+
+// Testing setReorder()
+// Reordering only changes where particles are stored: decays are keyed by particle id, so the same particles decay, and every particle
+// follows the same trajectory up to the rounding of forces summed in a different order.
+TEST_F(SimulationTest, setReorderKeepsEveryParticlesTrajectory) {
+    EventConfig config;
+    config.meanMultiplicity = 3000;
+    config.poissonMultiplicity = false;
+    config.speciesWeights = {0.2, 0.2, 0.2, 0.2, 0.2, 0.0}; // Plenty of kaons, so there are decays.
+    Simulation plain, reordered;
+    for (Simulation* sim : {&plain, &reordered}) {
+        sim->setThreadCount(2);
+        sim->setForceSolver(ForceSolver::CELL_LIST);
+        sim->setIntegrator(Integrator::LEAPFROG);
+        sim->setCutoff(1e-3);
+        sim->setNeighborListSkin(1e-4);
+        sim->generateEvent(EventGenerator(config));
+    }
+    reordered.setReorder(1);
+    plain.run(2, 5e-9);
+    reordered.run(2, 5e-9);
+    for (int step = 0; step < 2; ++step) {
+        plain.computeForces();
+        plain.updateParticles(5e-9);
+        reordered.computeForces();
+        reordered.updateParticles(5e-9);
+    }
+
+    EXPECT_EQ(reordered.getReorderCount(), 4u) << "A reorder interval of one should reorder after every step of run() and updateParticles().";
+    ASSERT_GT(plain.getDecayCount(), 0u) << "No particle decayed, so the test did not exercise decay products.";
+    EXPECT_EQ(reordered.getDecayCount(), plain.getDecayCount()) << "Reordering changed the decays.";
+    ASSERT_EQ(reordered.particles.size(), plain.particles.size()) << "Reordering changed the particle count.";
+    std::unordered_map<std::uint64_t, size_t> indexOfId;
+    for (size_t i = 0; i < plain.particles.size(); ++i) {
+        indexOfId[plain.particles.id[i]] = i;
+    }
+    for (size_t i = 0; i < reordered.particles.size(); ++i) {
+        const auto found = indexOfId.find(reordered.particles.id[i]);
+        ASSERT_NE(found, indexOfId.end()) << "Particle " << reordered.particles.id[i] << " only exists in the reordered run.";
+        const size_t j = found->second;
+        EXPECT_NEAR(reordered.particles.x[i], plain.particles.x[j], 1e-9 * std::abs(plain.particles.x[j]))
+            << "Particle " << plain.particles.id[j] << " moved differently after reordering.";
+        EXPECT_NEAR(reordered.particles.vz[i], plain.particles.vz[j], 1e-9 * std::abs(plain.particles.vz[j]))
+            << "Particle " << plain.particles.id[j] << " moved differently after reordering.";
+    }
+}
+
+// Testing setAnalysis()
+// The analysis sees every decay of both the task-graph steps of run() and the serial steps, and bins the particles every interval steps.
+TEST_F(SimulationTest, setAnalysisRecordsEveryDecayAndFill) {
+    EventConfig config;
+    config.meanMultiplicity = 3000;
+    config.poissonMultiplicity = false;
+    config.speciesWeights = {0.2, 0.2, 0.2, 0.2, 0.2, 0.0}; // Plenty of kaons, so there are decays.
+    Simulation sim;
+    sim.setThreadCount(2);
+    sim.setForceSolver(ForceSolver::CELL_LIST);
+    sim.setIntegrator(Integrator::LEAPFROG);
+    sim.setCutoff(1e-3);
+    sim.generateEvent(EventGenerator(config));
+    InSituAnalysis analysis;
+    sim.setAnalysis(&analysis, 2);
+    sim.run(3, 5e-9);
+    for (int step = 0; step < 3; ++step) {
+        sim.computeForces();
+        sim.updateParticles(5e-9);
+    }
+    analysis.endEvent();
+
+    std::uint64_t decays = 0;
+    for (size_t t = 0; t < particleTypeCount; ++t) {
+        decays += analysis.getDecays(static_cast<ParticleType>(t));
+    }
+    ASSERT_GT(sim.getDecayCount(), 0u) << "No particle decayed, so the test did not exercise the decay counts.";
+    EXPECT_EQ(decays, sim.getDecayCount()) << "The analysis should see every decay of both step paths.";
+    EXPECT_EQ(analysis.getDecays(ParticleType::PROTON), 0u) << "Protons are stable.";
+    EXPECT_EQ(analysis.getFillCount(), 3u) << "An interval of two should fill after steps 2, 4 and 6.";
+
+    sim.setAnalysis(nullptr);
+    sim.run(2, 5e-9);
+    analysis.endEvent();
+    EXPECT_EQ(analysis.getFillCount(), 3u) << "A detached analysis should not be filled.";
+}
+
+// Testing run()
+TEST_F(SimulationTest, runWritesASnapshotEveryInterval) {
+    EventConfig config;
+    config.meanMultiplicity = 3000;
+    config.poissonMultiplicity = false;
+    Simulation serial, scheduled;
+    for (Simulation* sim : {&serial, &scheduled}) {
+        sim->setThreadCount(2);
+        sim->setForceSolver(ForceSolver::BARNES_HUT);
+        sim->setIntegrator(Integrator::LEAPFROG);
+        sim->generateEvent(EventGenerator(config));
+    }
+    const std::string path = ::testing::TempDir() + "simulation-run.snap";
+    SnapshotWriter writer;
+    ASSERT_TRUE(writer.open(path)) << "The snapshot file could not be opened.";
+    scheduled.run(5, 1e-9, &writer, 2);
+    ASSERT_TRUE(writer.close()) << "The snapshot file could not be written.";
+
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << "The snapshot file could not be read.";
+    ASSERT_EQ(reader.getFrameCount(), 2u) << "Five steps with an interval of two should write two frames.";
+    for (size_t frame = 0; frame < 2; ++frame) {
+        for (int step = 0; step < 2; ++step) {
+            serial.computeForces();
+            serial.updateParticles(1e-9);
+        }
+        const SnapshotFrame snapshot = reader.getFrame(frame);
+        EXPECT_DOUBLE_EQ(snapshot.time, 2e-9 * (frame + 1)) << "Frame " << frame << " has the wrong time.";
+        ASSERT_EQ(snapshot.count, serial.particles.size()) << "Frame " << frame << " has the wrong particle count.";
+        for (size_t i = 0; i < snapshot.count; ++i) {
+            ASSERT_EQ(snapshot.x[i], serial.particles.x[i]) << "Frame " << frame << " does not hold the state after its step.";
+        }
+    }
+    reader.close();
+    std::remove(path.c_str());
+}
+
+// Testing run()
+TEST_F(SimulationTest, runWithASnapshotIntervalOfZeroWritesEveryStep) {
+    EventConfig config;
+    config.meanMultiplicity = 500;
+    config.poissonMultiplicity = false;
+    for (Integrator scheme : {Integrator::LEAPFROG, Integrator::VELOCITY_VERLET}) {
+        Simulation sim;
+        sim.setThreadCount(2);
+        sim.setIntegrator(scheme);
+        sim.generateEvent(EventGenerator(config));
+        const std::string path = ::testing::TempDir() + "simulation-run-zero.snap";
+        SnapshotWriter writer;
+        ASSERT_TRUE(writer.open(path)) << "The snapshot file could not be opened.";
+        sim.run(3, 1e-9, &writer, 0);
+        ASSERT_TRUE(writer.close()) << "The snapshot file could not be written.";
+        SnapshotReader reader;
+        ASSERT_TRUE(reader.open(path)) << "The snapshot file could not be read.";
+        EXPECT_EQ(reader.getFrameCount(), 3u) << "An interval of 0 should write a frame after every step (integrator "
+                                              << static_cast<int>(scheme) << ").";
+        reader.close();
+        std::remove(path.c_str());
+    }
 }
 
 // Testing createParticle()
@@ -0,0 +1,175 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/snapshot.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "snapshot.h"
+#include "event-generator.h"
+#include <cstdio>
+#include <gtest/gtest.h>
+
+// Returns a path for a temporary snapshot file.
+static std::string snapshotPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+// Returns a store holding one generated event of count particles.
+static ParticleStore generatedStore(double count, std::uint32_t event) {
+    EventConfig config;
+    config.meanMultiplicity = count;
+    config.poissonMultiplicity = false;
+    ParticleStore particles;
+    EventGenerator(config).generate(particles, CounterRng(7, event));
+    return particles;
+}
+
+// Test fixture for the SnapshotWriter class
+class SnapshotWriterTest : public ::testing::Test {
+};
+
+// Test fixture for the SnapshotReader class
+class SnapshotReaderTest : public ::testing::Test {
+};
+
+// Testing write()
+TEST_F(SnapshotWriterTest, writeRoundTripsEveryColumn) {
+    const std::string path = snapshotPath("round-trip.psnap");
+    const ParticleStore particles = generatedStore(1001, 0);
+    {
+        SnapshotWriter writer;
+        ASSERT_TRUE(writer.open(path)) << "open() could not create the snapshot file.";
+        writer.write(particles, 0.25);
+        EXPECT_TRUE(writer.close()) << "close() reported a failed write.";
+    }
+
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << "open() could not map the snapshot file that was just written.";
+    ASSERT_EQ(reader.getFrameCount(), 1u) << "One written frame should give one frame in the file.";
+    const SnapshotFrame frame = reader.getFrame(0);
+    EXPECT_EQ(frame.index, 0u) << "The first frame should have index 0.";
+    EXPECT_EQ(frame.time, 0.25) << "The frame time was not stored.";
+    ASSERT_EQ(frame.count, particles.size()) << "The frame does not hold every particle.";
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        ASSERT_EQ(frame.id[i], particles.id[i]) << "Id of particle " << i << " differs.";
+        ASSERT_EQ(frame.type[i], static_cast<std::uint8_t>(particles.type[i])) << "Type of particle " << i << " differs.";
+        ASSERT_EQ(frame.x[i], particles.x[i]) << "x of particle " << i << " differs.";
+        ASSERT_EQ(frame.y[i], particles.y[i]) << "y of particle " << i << " differs.";
+        ASSERT_EQ(frame.z[i], particles.z[i]) << "z of particle " << i << " differs.";
+        ASSERT_EQ(frame.vx[i], particles.vx[i]) << "vx of particle " << i << " differs.";
+        ASSERT_EQ(frame.vy[i], particles.vy[i]) << "vy of particle " << i << " differs.";
+        ASSERT_EQ(frame.vz[i], particles.vz[i]) << "vz of particle " << i << " differs.";
+    }
+    std::remove(path.c_str());
+}
+
+// Testing write()
+TEST_F(SnapshotWriterTest, writeKeepsFramesInOrderWhileTheStoreChanges) {
+    const std::string path = snapshotPath("many-frames.psnap");
+    const int frameCount = 50;
+    {
+        SnapshotWriter writer;
+        ASSERT_TRUE(writer.open(path)) << "open() could not create the snapshot file.";
+        for (int k = 0; k < frameCount; ++k) {
+            // The store is rebuilt right after each write, so a frame that was not copied at write() time would be corrupted.
+            ParticleStore particles = generatedStore(10 + k, static_cast<std::uint32_t>(k));
+            writer.write(particles, 0.1 * k);
+            particles.clear();
+        }
+        EXPECT_EQ(writer.getFrameCount(), static_cast<std::uint64_t>(frameCount)) << "getFrameCount() does not count the staged frames.";
+        EXPECT_TRUE(writer.flush()) << "flush() reported a failed write.";
+    }
+
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << "open() could not map the snapshot file that was just written.";
+    ASSERT_EQ(reader.getFrameCount(), static_cast<std::size_t>(frameCount)) << "Some frames are missing from the file.";
+    for (int k = 0; k < frameCount; ++k) {
+        const SnapshotFrame frame = reader.getFrame(k);
+        EXPECT_EQ(frame.index, static_cast<std::uint64_t>(k)) << "Frame " << k << " is out of order.";
+        EXPECT_EQ(frame.count, static_cast<std::size_t>(10 + k)) << "Frame " << k << " has the wrong particle count.";
+    }
+    std::remove(path.c_str());
+}
+
+// Testing open()
+TEST_F(SnapshotReaderTest, openRandomAccessMatchesTheWrittenFrame) {
+    const std::string path = snapshotPath("random-access.psnap");
+    {
+        SnapshotWriter writer;
+        ASSERT_TRUE(writer.open(path)) << "open() could not create the snapshot file.";
+        for (std::uint32_t k = 0; k < 8; ++k) {
+            writer.write(generatedStore(100, k), k);
+        }
+    }
+
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << "open() could not map the snapshot file that was just written.";
+    const ParticleStore expected = generatedStore(100, 5);
+    const SnapshotFrame frame = reader.getFrame(5);
+    EXPECT_EQ(frame.time, 5.0) << "getFrame(5) returned the wrong frame.";
+    ASSERT_EQ(frame.count, expected.size()) << "getFrame(5) returned the wrong particle count.";
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        ASSERT_EQ(frame.x[i], expected.x[i]) << "Position of particle " << i << " in frame 5 differs.";
+    }
+    std::remove(path.c_str());
+}
+
+// Testing open()
+TEST_F(SnapshotReaderTest, openIgnoresATruncatedLastFrame) {
+    const std::string path = snapshotPath("truncated.psnap");
+    {
+        SnapshotWriter writer;
+        ASSERT_TRUE(writer.open(path)) << "open() could not create the snapshot file.";
+        writer.write(generatedStore(100, 0), 0.0);
+        writer.write(generatedStore(100, 1), 1.0);
+    }
+    // Cut the last frame short, as a crash while writing would.
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::vector<char> bytes(1 << 16);
+    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size() - 100, file);
+    std::fclose(file);
+
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << "A truncated file should still open.";
+    EXPECT_EQ(reader.getFrameCount(), 1u) << "Only the complete frame should be indexed.";
+    std::remove(path.c_str());
+}
+
+// Testing getFrame()
+TEST_F(SnapshotReaderTest, getFrameOutOfRangeReturnsAnEmptyFrame) {
+    const std::string path = snapshotPath("out-of-range.psnap");
+    {
+        SnapshotWriter writer;
+        ASSERT_TRUE(writer.open(path)) << "open() could not create the snapshot file.";
+        writer.write(generatedStore(100, 0), 0.0);
+    }
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << "open() could not map the snapshot file that was just written.";
+    const SnapshotFrame frame = reader.getFrame(1);
+    EXPECT_EQ(frame.count, 0u) << "A frame past the end should hold no particles.";
+    EXPECT_EQ(frame.x, nullptr) << "A frame past the end should have no columns.";
+    reader.close();
+    EXPECT_EQ(reader.getFrame(0).count, 0u) << "A closed reader should return an empty frame.";
+    std::remove(path.c_str());
+}
+
+// Testing open()
+TEST_F(SnapshotReaderTest, openRejectsFilesThatAreNotSnapshots) {
+    const std::string path = snapshotPath("not-a-snapshot.psnap");
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("this is not a snapshot file", file);
+    std::fclose(file);
+
+    SnapshotReader reader;
+    EXPECT_FALSE(reader.open(path)) << "open() accepted a file without the snapshot magic.";
+    EXPECT_FALSE(reader.open(snapshotPath("does-not-exist.psnap"))) << "open() accepted a missing file.";
+    EXPECT_EQ(reader.getFrameCount(), 0u) << "A failed open() should leave no frames.";
+    std::remove(path.c_str());
+}
@@ -0,0 +1,87 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/spatial-sort.cxx
+
+// Each class in spatial-sort.cxx (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "spatial-sort.h"
+#include "particle-store.h"
+#include "particle.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <map>
+#include <random>
+
+// Test fixture for the SpatialSorter class
+class SpatialSorterTest : public ::testing::Test {
+protected:
+
+    // Particles scattered at random in a unit cube, stored in creation order.
+    ParticleStore store;
+    SpatialSorter sorter;
+
+    void SetUp() override {
+        std::default_random_engine engine(4);
+        std::uniform_real_distribution<double> positionDist(0.0, 1.0);
+        for (int i = 0; i < 1000; ++i) {
+            store.emplace_back(ParticleType::PROTON, 0.938, (i % 2 == 0) ? +1.0 : -1.0, 0.0, positionDist(engine), positionDist(engine),
+                               positionDist(engine), positionDist(engine), 0.0, 0.0);
+        }
+    }
+};
+
+// Testing getMortonKey()
+TEST_F(SpatialSorterTest, getMortonKeyInterleavesTheCoordinates) {
+    EXPECT_EQ(getMortonKey(1, 0, 0), 1u) << "Bit 0 of x should be bit 0 of the key.";
+    EXPECT_EQ(getMortonKey(0, 1, 0), 2u) << "Bit 0 of y should be bit 1 of the key.";
+    EXPECT_EQ(getMortonKey(0, 0, 1), 4u) << "Bit 0 of z should be bit 2 of the key.";
+    EXPECT_EQ(getMortonKey(2, 0, 0), 8u) << "Bit 1 of x should be bit 3 of the key.";
+    EXPECT_EQ(getMortonKey(0, 0, 1u << 20), std::uint64_t(1) << 62) << "Bit 20 of z should be bit 62 of the key.";
+    EXPECT_EQ(getMortonKey(0x1FFFFF, 0x1FFFFF, 0x1FFFFF), (std::uint64_t(1) << 63) - 1) << "All 63 key bits should be used.";
+}
+
+// Testing reorder()
+TEST_F(SpatialSorterTest, reorderSortsTheStoreAndKeepsEveryParticle) {
+    std::map<std::uint64_t, double> vxById;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        vxById[store.id[i]] = store.vx[i];
+    }
+    EXPECT_GT(sorter.measureDisorder(store), 0.3) << "Particles in random order should be about half out of order.";
+
+    sorter.reorder(store);
+    EXPECT_EQ(sorter.measureDisorder(store), 0.0) << "A reordered store should be in Morton order.";
+    EXPECT_EQ(sorter.getReorderCount(), 1u) << "The reorder was not counted.";
+    ASSERT_EQ(store.size(), vxById.size()) << "The reorder changed the number of particles.";
+    std::map<std::uint64_t, int> seen;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        ++seen[store.id[i]];
+        EXPECT_EQ(store.vx[i], vxById[store.id[i]]) << "Particle " << store.id[i] << " was separated from its velocity.";
+    }
+    EXPECT_EQ(seen.size(), vxById.size()) << "Every particle should appear exactly once after the reorder.";
+    const std::vector<std::uint32_t>& order = sorter.getLastOrder();
+    EXPECT_EQ(store.id[0], order[0]) << "getLastOrder() should give the previous index of each particle (the ids were their indices).";
+}
+
+// Testing reorderIfNeeded()
+TEST_F(SpatialSorterTest, reorderIfNeededFollowsTheTriggers) {
+    EXPECT_FALSE(sorter.reorderIfNeeded(store, 10)) << "A sorter with both triggers off should never reorder.";
+
+    sorter.interval = 5;
+    EXPECT_FALSE(sorter.reorderIfNeeded(store, 7)) << "A step that is not a multiple of the interval should not reorder.";
+    EXPECT_TRUE(sorter.reorderIfNeeded(store, 10)) << "A step that is a multiple of the interval should reorder.";
+
+    sorter.interval = 0;
+    sorter.disorderThreshold = 0.1;
+    EXPECT_FALSE(sorter.reorderIfNeeded(store, 11)) << "A sorted store should not be reordered by the disorder check.";
+    store.permute([&] {
+        std::vector<std::uint32_t> reversed(store.size());
+        for (std::size_t i = 0; i < reversed.size(); ++i) {
+            reversed[i] = static_cast<std::uint32_t>(reversed.size() - 1 - i);
+        }
+        return reversed;
+    }());
+    EXPECT_TRUE(sorter.reorderIfNeeded(store, 12)) << "A store in reverse Morton order should be reordered by the disorder check.";
+    EXPECT_EQ(sorter.getReorderCount(), 2u) << "Two reorders should have been counted.";
+}
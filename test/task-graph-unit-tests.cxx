@@ -0,0 +1,101 @@
+// This file uses the Googletest framework to unit-test the C++ code found in physics-simulation/src/task-graph.cxx
+
+// Each class (that contains one or more methods) has its own Googletest fixture.
+// Each method is given one or more individual tests (located within the corresponding class's fixture).
+// Each individual test checks one specific functionality of the corresponding method.
+
+// The naming convention for testing a method is as follows: TEST_F([ClassName]Test, [methodName][SpecificFunctionalityBeingTested])
+
+#include "task-graph.h"
+#include <atomic>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Test fixture for the TaskGraph class
+class TaskGraphTest : public ::testing::Test {
+protected:
+    // Builds layers of width tasks, where every task depends on two tasks of the previous layer. Each task records when it finished.
+    static void buildLayers(TaskGraph& graph, std::size_t layers, std::size_t width, std::vector<std::atomic<int>>& finished,
+                            std::atomic<int>& clock, std::vector<std::atomic<int>>& runs) {
+        for (std::size_t task = 0; task < layers * width; ++task) {
+            graph.add([task, &finished, &clock, &runs](std::size_t) {
+                ++runs[task];
+                finished[task] = ++clock;
+            });
+        }
+        for (std::size_t layer = 1; layer < layers; ++layer) {
+            for (std::size_t k = 0; k < width; ++k) {
+                graph.addDependency((layer - 1) * width + k, layer * width + k);
+                graph.addDependency((layer - 1) * width + (k + 1) % width, layer * width + k);
+            }
+        }
+    }
+};
+
+// Testing run()
+TEST_F(TaskGraphTest, runStartsEveryTaskAfterItsPrerequisites) {
+    for (std::size_t threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        TaskGraph graph;
+        const std::size_t layers = 20, width = 16;
+        std::vector<std::atomic<int>> finished(layers * width);
+        std::vector<std::atomic<int>> runs(layers * width);
+        std::atomic<int> clock(0);
+        buildLayers(graph, layers, width, finished, clock, runs);
+        graph.run(pool);
+
+        for (std::size_t layer = 1; layer < layers; ++layer) {
+            for (std::size_t k = 0; k < width; ++k) {
+                const std::size_t task = layer * width + k;
+                EXPECT_GT(finished[task].load(), finished[(layer - 1) * width + k].load())
+                    << "Task " << task << " finished before its prerequisite (" << threads << " threads).";
+                EXPECT_GT(finished[task].load(), finished[(layer - 1) * width + (k + 1) % width].load())
+                    << "Task " << task << " finished before its prerequisite (" << threads << " threads).";
+            }
+        }
+        for (std::size_t task = 0; task < layers * width; ++task) {
+            EXPECT_EQ(runs[task].load(), 1) << "Task " << task << " should run exactly once (" << threads << " threads).";
+        }
+    }
+}
+
+// Testing run()
+TEST_F(TaskGraphTest, runCanBeRepeated) {
+    ThreadPool pool(3);
+    TaskGraph graph;
+    const std::size_t layers = 5, width = 8;
+    std::vector<std::atomic<int>> finished(layers * width);
+    std::vector<std::atomic<int>> runs(layers * width);
+    std::atomic<int> clock(0);
+    buildLayers(graph, layers, width, finished, clock, runs);
+    for (int repeat = 0; repeat < 10; ++repeat) {
+        graph.run(pool);
+    }
+    for (std::size_t task = 0; task < layers * width; ++task) {
+        EXPECT_EQ(runs[task].load(), 10) << "Task " << task << " should run once per run.";
+    }
+}
+
+// Testing run()
+TEST_F(TaskGraphTest, runPassesEachThreadItsWorkerIndex) {
+    ThreadPool pool(4);
+    TaskGraph graph;
+    std::vector<std::atomic<int>> seen(pool.size());
+    std::atomic<bool> outOfRange(false);
+    for (int task = 0; task < 200; ++task) {
+        graph.add([&](std::size_t worker) {
+            if (worker >= pool.size()) {
+                outOfRange = true;
+                return;
+            }
+            ++seen[worker];
+        });
+    }
+    graph.run(pool);
+    EXPECT_FALSE(outOfRange) << "A task received a worker index outside the pool.";
+    int total = 0;
+    for (const auto& count : seen) {
+        total += count.load();
+    }
+    EXPECT_EQ(total, 200) << "Every task should run on some worker.";
+}